@@ -1,19 +1,46 @@
 #!/usr/bin/python
 
-import subprocess
+# Maps addresses in firmware output back to symbols in the ELF.
+#
+# By default every 0x... address on stdin that starts a symbol is printed
+# with that symbol. With --profile, reads the "prof" lines dumped over RTT by
+# a build with FK_PROFILER and prints a flat profile and the call edges seen,
+# summed over every complete dump in the input. They're on RTT up-buffer 1,
+# not the log's:
+#
+#   JLinkRTTLogger ... -RTTChannel 1 rtt.log
+#   ./decode-calls.py --profile < rtt.log
+#
+# Call edges come from the LR of the interrupted code. That is the caller
+# for leaf functions, anywhere else it's the return address of the most
+# recent call, so treat edges as hints.
+
+from __future__ import print_function
+
+import argparse
+import bisect
+import os
 import re
+import subprocess
 import sys
 
 class CallsDecoder:
-    def read_symbols(self, elf):
+    def read_symbols(self, nm, elf):
         self.table = {}
-        nm = subprocess.Popen(["nm", "-S", elf], stdout=subprocess.PIPE)
-        process = subprocess.Popen(["c++filt"], stdin=nm.stdout, stdout=subprocess.PIPE)
-        for line in iter(process.stdout.readline,''):
+        self.functions = []
+        output = subprocess.check_output([nm, "-C", "-S", elf])
+        if not isinstance(output, str):
+            output = output.decode("utf-8", "replace")
+        for line in output.splitlines():
             fields = line.rstrip().split(" ", 3)
             if len(fields[0]) > 0:
                 address = int(fields[0], 16)
                 self.table[address] = fields
+                if len(fields) == 4 and fields[2] in "tTwW":
+                    # Thumb functions have bit 0 set.
+                    self.functions.append((address & ~1, int(fields[1], 16), fields[3]))
+        self.functions.sort()
+        self.starts = [ f[0] for f in self.functions ]
 
     def find_addresses(self, raw):
         strings = re.findall("0x([0-9a-f]+)", raw)
@@ -21,13 +48,98 @@ class CallsDecoder:
 
     def reverse_addresses(self, addresses):
         for address in addresses:
-            if self.table.has_key(address):
+            if address in self.table:
                 symbol = self.table[address]
-                print symbol[0], symbol[-1]
+                print(symbol[0], symbol[-1])
+
+    def function(self, address):
+        if address >= 0xfffffff0:
+            return "(exception return)"
+        address &= ~1
+        i = bisect.bisect_right(self.starts, address) - 1
+        if i >= 0:
+            start, size, name = self.functions[i]
+            if address < start + max(size, 2):
+                return name
+        return "(unknown 0x%08x)" % address
+
+class Profile:
+    def __init__(self):
+        self.rate = 0
+        self.samples = 0
+        self.dropped = 0
+        self.pairs = {}
+
+    def read(self, lines):
+        # A dump the firmware gave up on has no prof-end, its samples are
+        # in the next one so drop what we have of it.
+        dump = None
+        for line in lines:
+            m = re.search(r"prof-begin (\d+) (\d+) (\d+)", line)
+            if m:
+                dump = (int(m.group(1)), int(m.group(2)), int(m.group(3)), {})
+                continue
+            if dump is None:
+                continue
+            if "prof-end" in line:
+                rate, samples, dropped, pairs = dump
+                self.rate = rate
+                self.samples += samples
+                self.dropped += dropped
+                for key, count in pairs.items():
+                    self.pairs[key] = self.pairs.get(key, 0) + count
+                dump = None
+                continue
+            m = re.search(r"prof ([0-9a-f]{8}) ([0-9a-f]{8}) (\d+)", line)
+            if m:
+                key = (int(m.group(1), 16), int(m.group(2), 16))
+                dump[3][key] = dump[3].get(key, 0) + int(m.group(3))
+
+    def report(self, decoder, limit):
+        flat = {}
+        edges = {}
+        for (pc, lr), count in self.pairs.items():
+            callee = decoder.function(pc)
+            caller = decoder.function(lr)
+            flat[callee] = flat.get(callee, 0) + count
+            if caller != callee:
+                edges[(caller, callee)] = edges.get((caller, callee), 0) + count
+
+        counted = sum(flat.values())
+        if counted == 0:
+            print("no samples")
+            return
+
+        seconds = float(self.samples) / self.rate if self.rate > 0 else 0.0
+        print("%d samples at %dHz (%.1fs), %d dropped" % (self.samples, self.rate, seconds, self.dropped))
+        print()
+        print("%8s %7s  %s" % ("samples", "%", "function"))
+        for name, count in sorted(flat.items(), key=lambda f: -f[1])[:limit]:
+            print("%8d %6.2f%%  %s" % (count, 100.0 * count / counted, name))
+        print()
+        print("%8s  %s" % ("samples", "caller -> callee"))
+        for (caller, callee), count in sorted(edges.items(), key=lambda e: -e[1])[:limit]:
+            print("%8d  %s -> %s" % (count, caller, callee))
+
+def main():
+    parser = argparse.ArgumentParser(description="Map firmware addresses to symbols.")
+    parser.add_argument("--elf", default="build/firmware/main/fk-naturalist-standard.elf")
+    parser.add_argument("--nm", default=os.environ.get("NM", "nm"))
+    parser.add_argument("--profile", action="store_true", help="summarize prof lines from FK_PROFILER")
+    parser.add_argument("--limit", type=int, default=40)
+    args = parser.parse_args()
+
+    decoder = CallsDecoder()
+    decoder.read_symbols(args.nm, args.elf)
 
-decoder = CallsDecoder()
-decoder.read_symbols("build/fk-naturalist-main.elf")
-for line in sys.stdin.readlines():
-    addresses = decoder.find_addresses(line)
-    decoder.reverse_addresses(addresses)
+    if args.profile:
+        profile = Profile()
+        profile.read(sys.stdin)
+        profile.report(decoder, args.limit)
+    else:
+        for line in sys.stdin.readlines():
+            addresses = decoder.find_addresses(line)
+            decoder.reverse_addresses(addresses)
 
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+#include <cstring>
+#include <cmath>
+
+#include "fast_math.h"
+
+namespace fk {
+
+constexpr float Ln2 = 0.693147180559945f;
+constexpr float Log10Of2 = 0.301029995663981f;
+constexpr float DbPerOctave = 20.0f * Log10Of2;
+constexpr float InverseLn2 = 1.442695040888963f;
+constexpr float Sqrt2 = 1.414213562373095f;
+
+static inline uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float bits_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+float fast_log2f(float x) {
+    auto bits = float_bits(x);
+    if (bits & 0x80000000) {
+        return (bits & 0x7fffffff) == 0 ? -INFINITY : NAN;
+    }
+    if ((bits & 0x7f800000) == 0) {
+        return -INFINITY;
+    }
+    if ((bits & 0x7f800000) == 0x7f800000) {
+        return x;
+    }
+
+    // x = m 2^e with m in [sqrt(1/2), sqrt(2)), so that t below stays small.
+    auto e = (int32_t)((bits >> 23) & 0xff) - 127;
+    auto m = bits_float((bits & 0x007fffff) | 0x3f800000);
+    if (m > Sqrt2) {
+        m *= 0.5f;
+        e++;
+    }
+
+    // ln(m) = 2 atanh(t), |t| < 0.172 so the t^9 term is under 2e-8.
+    auto t = (m - 1.0f) / (m + 1.0f);
+    auto t2 = t * t;
+    auto ln = 2.0f * t * (1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f))));
+
+    return (float)e + ln * InverseLn2;
+}
+
+float fast_log10f(float x) {
+    return fast_log2f(x) * Log10Of2;
+}
+
+float fast_dbf(float x) {
+    return fast_log2f(x) * DbPerOctave;
+}
+
+float fast_exp2f(float x) {
+    if (std::isnan(x)) {
+        return x;
+    }
+    if (x >= 128.0f) {
+        return INFINITY;
+    }
+    if (x < -126.0f) {
+        return 0.0f;
+    }
+
+    // 2^x = 2^i e^(f ln 2) with f in [-0.5, 0.5], the g^7 term is under 1.3e-7.
+    auto i = (int32_t)(x + (x >= 0.0f ? 0.5f : -0.5f));
+    auto g = (x - (float)i) * Ln2;
+    auto p = 1.0f + g * (1.0f + g * (1.0f / 2.0f + g * (1.0f / 6.0f + g * (1.0f / 24.0f + g * (1.0f / 120.0f + g * (1.0f / 720.0f))))));
+
+    // Exponents of 128 happen for x just under 128, scale in two steps.
+    if (i > 127) {
+        return p * bits_float((uint32_t)(i - 1 + 127) << 23) * 2.0f;
+    }
+    if (i < -126) {
+        return p * bits_float((uint32_t)(i + 1 + 127) << 23) * 0.5f;
+    }
+    return p * bits_float((uint32_t)(i + 127) << 23);
+}
+
+float fast_powf(float x, float y) {
+    if (y == 0.0f) {
+        return 1.0f;
+    }
+    if (x == 0.0f) {
+        return y > 0.0f ? 0.0f : INFINITY;
+    }
+    if (x < 0.0f) {
+        return NAN;
+    }
+    return fast_exp2f(y * fast_log2f(x));
+}
+
+float fast_sqrtf(float x) {
+    if (!(x > 0.0f)) {
+        return x == 0.0f ? x : NAN;
+    }
+
+    auto bits = float_bits(x);
+    if ((bits & 0x7f800000) == 0) {
+        return 0.0f;
+    }
+    if ((bits & 0x7f800000) == 0x7f800000) {
+        return x;
+    }
+
+    // Reciprocal square root from the exponent trick, then Newton's method
+    // which only needs multiplies. Each step squares the error.
+    auto half = 0.5f * x;
+    auto r = bits_float(0x5f375a86 - (bits >> 1));
+    r = r * (1.5f - half * r * r);
+    r = r * (1.5f - half * r * r);
+    r = r * (1.5f - half * r * r);
+
+    auto s = x * r;
+    // One last correction on the root itself, this one rounds better.
+    return s + 0.5f * r * (x - s * s);
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef FK_FAST_MATH_H_INCLUDED
+#define FK_FAST_MATH_H_INCLUDED
+
+#include <cstdint>
+
+namespace fk {
+
+/**
+ * Single precision replacements for the libm calls on our hot paths. The
+ * SAMD21 has no FPU and newlib's versions handle every corner of IEEE 754
+ * with double precision intermediates, these don't and are several times
+ * cheaper for it. Subnormal inputs are treated as zero.
+ *
+ * Error bounds, checked by the host fast-math test:
+ *
+ *   fast_log2f, fast_log10f  2e-7 absolute for x in [1e-30, 1e30]
+ *   fast_dbf                 1e-6 dB absolute
+ *   fast_exp2f               4e-7 relative for x in [-126, 127]
+ *   fast_powf                (4e-7 + 2e-7 |y log2 x|) relative, x > 0
+ *   fast_sqrtf               3e-7 relative
+ */
+float fast_log2f(float x);
+
+float fast_log10f(float x);
+
+/**
+ * 20 log10(x), decibels relative to full scale for amplitudes.
+ */
+float fast_dbf(float x);
+
+float fast_exp2f(float x);
+
+float fast_powf(float x, float y);
+
+float fast_sqrtf(float x);
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "flash_parts.h"
+
+namespace fk {
+
+static constexpr uint32_t K = 1024;
+static constexpr uint32_t MHz = 1000000;
+
+static const FlashPart parts[] = {
+    // Winbond
+    { { 0xEF, 0x40, 0x14 }, "W25Q80BV",    256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0xEF, 0x40, 0x15 }, "W25Q16DV",    256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0xEF, 0x40, 0x17 }, "W25Q64FV",    256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0xEF, 0x40, 0x18 }, "W25Q128FV",   256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0xEF, 0x40, 0x19 }, "W25Q256FV",   256, 4 * K,  64 * K, 4, 50 * MHz },
+    // Spansion
+    { { 0x01, 0x02, 0x16 }, "S25FL064A",   256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0x01, 0x02, 0x19 }, "S25FL256S",   256, 4 * K,  64 * K, 4, 50 * MHz },
+    { { 0x01, 0x02, 0x20 }, "S25FL512S",   512, 0,     256 * K, 4, 50 * MHz },
+    { { 0x01, 0x20, 0x18 }, "S25FL127S",   256, 4 * K,  64 * K, 3, 50 * MHz },
+    { { 0x01, 0x40, 0x15 }, "S25FL116K",   256, 4 * K,  64 * K, 3, 50 * MHz },
+    // Macronix
+    { { 0xC2, 0x20, 0x18 }, "MX25L12805D", 256, 4 * K,  64 * K, 3, 33 * MHz },
+    // Micron
+    { { 0x20, 0xBA, 0x20 }, "N25Q512A",    256, 4 * K,  64 * K, 4, 54 * MHz },
+    { { 0x20, 0xBA, 0x21 }, "N25Q00AA",    256, 4 * K,  64 * K, 4, 54 * MHz },
+    { { 0x20, 0xBB, 0x22 }, "MT25QL02GC",  256, 4 * K,  64 * K, 4, 66 * MHz },
+    // SST, the 25 series only program a byte at a time.
+    { { 0xBF, 0x25, 0x02 }, "SST25WF010",  1,   4 * K,  64 * K, 3, 33 * MHz },
+    { { 0xBF, 0x25, 0x03 }, "SST25WF020",  1,   4 * K,  64 * K, 3, 33 * MHz },
+    { { 0xBF, 0x25, 0x04 }, "SST25WF040",  1,   4 * K,  64 * K, 3, 33 * MHz },
+    { { 0xBF, 0x25, 0x41 }, "SST25VF016B", 1,   4 * K,  64 * K, 3, 25 * MHz },
+    { { 0xBF, 0x25, 0x4A }, "SST25VF032",  1,   4 * K,  64 * K, 3, 25 * MHz },
+    { { 0xBF, 0x26, 0x01 }, "SST26VF016",  256, 4 * K,  64 * K, 3, 40 * MHz },
+    { { 0xBF, 0x26, 0x02 }, "SST26VF032",  256, 4 * K,  64 * K, 3, 40 * MHz },
+    { { 0xBF, 0x26, 0x43 }, "SST26VF064",  256, 4 * K,  64 * K, 3, 40 * MHz },
+};
+
+const FlashPart *flash_part_find(const uint8_t *id) {
+    for (auto &part : parts) {
+        if (part.id[0] == id[0] && part.id[1] == id[1] && part.id[2] == id[2]) {
+            return &part;
+        }
+    }
+    return nullptr;
+}
+
+const char *flash_part_name(const uint8_t *id) {
+    auto part = flash_part_find(id);
+    if (part == nullptr) {
+        return "(unknown chip)";
+    }
+    return part->name;
+}
+
+}
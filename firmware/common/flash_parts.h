@@ -0,0 +1,31 @@
+#ifndef FK_FLASH_PARTS_H_INCLUDED
+#define FK_FLASH_PARTS_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+struct FlashPart {
+    uint8_t id[3];
+    const char *name;
+    /* Largest program, 1 for parts that only program bytes. */
+    uint16_t pageSize;
+    /* Smallest erase, 0 if there's no 4k sector erase. */
+    uint32_t sectorSize;
+    uint32_t blockSize;
+    uint8_t addressBytes;
+    /* Fastest clock for the plain 0x03 read, above this we need 0x0B. */
+    uint32_t readClock;
+};
+
+/**
+ * Returns nullptr for parts we don't know the geometry of.
+ */
+const FlashPart *flash_part_find(const uint8_t *id);
+
+const char *flash_part_name(const uint8_t *id);
+
+}
+
+#endif
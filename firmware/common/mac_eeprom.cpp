@@ -0,0 +1,21 @@
+#include "mac_eeprom.h"
+
+namespace fk {
+
+bool MacEeprom::read128bMac(uint8_t *id) {
+    bus_->beginTransmission(address_);
+    bus_->write(0xf8);
+    if (bus_->endTransmission() != 0) {
+        return false;
+    }
+    bus_->requestFrom(address_, MacEepromIdSize);
+
+    size_t index = 0;
+    while (bus_->available() && index < MacEepromIdSize) {
+        id[index++] = bus_->read();
+    }
+
+    return index == MacEepromIdSize;
+}
+
+}
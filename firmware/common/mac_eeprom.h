@@ -0,0 +1,31 @@
+#ifndef FK_MAC_EEPROM_H_INCLUDED
+#define FK_MAC_EEPROM_H_INCLUDED
+
+#include <Wire.h>
+
+namespace fk {
+
+constexpr size_t MacEepromIdSize = 8;
+
+/**
+ * The 24AA02E64 on the core board, its EUI-64 is factory programmed in the
+ * top of the array and is unique to the board.
+ */
+class MacEeprom {
+private:
+    TwoWire *bus_;
+    uint8_t address_;
+
+public:
+    MacEeprom(TwoWire &bus = Wire) : bus_(&bus), address_(0x50) {
+    }
+
+public:
+    /* False unless all MacEepromIdSize bytes were read. */
+    bool read128bMac(uint8_t *id);
+
+};
+
+}
+
+#endif
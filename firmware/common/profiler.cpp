@@ -0,0 +1,188 @@
+#include <Arduino.h>
+
+#include "profiler.h"
+
+#if defined(FK_PROFILER)
+
+#include <SEGGER_RTT.h>
+
+namespace fk {
+
+Profiler profiler;
+
+static_assert((FK_PROFILER_SLOTS & (FK_PROFILER_SLOTS - 1)) == 0, "FK_PROFILER_SLOTS should be a power of two.");
+
+static_assert(FK_PROFILER_RTT_BUFFER > 0 && FK_PROFILER_RTT_BUFFER < SEGGER_RTT_MAX_NUM_UP_BUFFERS,
+              "FK_PROFILER_RTT_BUFFER should be an up-buffer other than the log's.");
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+constexpr uint32_t TimerHz = F_CPU / 64;
+
+static_assert(TimerHz / FK_PROFILER_RATE - 1 <= UINT16_MAX, "FK_PROFILER_RATE is too slow for TC3.");
+
+void Profiler::begin() {
+    clear();
+
+    SEGGER_RTT_ConfigUpBuffer(FK_PROFILER_RTT_BUFFER, "Profiler", buffer_, sizeof(buffer_), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+
+    PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+
+    GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TCC2_TC3);
+    while (GCLK->STATUS.bit.SYNCBUSY);
+
+    TC3->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+    while (TC3->COUNT16.STATUS.bit.SYNCBUSY || TC3->COUNT16.CTRLA.bit.SWRST);
+
+    TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV64;
+    TC3->COUNT16.CC[0].reg = (uint16_t)(TimerHz / FK_PROFILER_RATE - 1);
+    while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+
+    TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+
+    // Highest priority, so we also see time spent in other handlers.
+    NVIC_SetPriority(TC3_IRQn, 0);
+    NVIC_EnableIRQ(TC3_IRQn);
+
+    TC3->COUNT16.CTRLA.bit.ENABLE = 1;
+    while (TC3->COUNT16.STATUS.bit.SYNCBUSY);
+}
+
+void Profiler::pause() {
+    NVIC_DisableIRQ(TC3_IRQn);
+}
+
+void Profiler::resume() {
+    NVIC_EnableIRQ(TC3_IRQn);
+}
+
+#else
+
+void Profiler::begin() {
+    clear();
+
+    SEGGER_RTT_ConfigUpBuffer(FK_PROFILER_RTT_BUFFER, "Profiler", buffer_, sizeof(buffer_), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+void Profiler::pause() {
+}
+
+void Profiler::resume() {
+}
+
+#endif
+
+void Profiler::sample(uint32_t pc, uint32_t lr) {
+    samples_ = samples_ + 1;
+
+    // Thumb instructions are halfword aligned, bit 0 is always the same.
+    auto hash = (pc ^ (lr * 31)) >> 1;
+    for (size_t i = 0; i < MaximumProbes; ++i) {
+        auto &slot = slots_[(hash + i) & (FK_PROFILER_SLOTS - 1)];
+        if (slot.count == 0) {
+            slot.pc = pc;
+            slot.lr = lr;
+            slot.count = 1;
+            return;
+        }
+        if (slot.pc == pc && slot.lr == lr) {
+            slot.count++;
+            return;
+        }
+    }
+
+    dropped_ = dropped_ + 1;
+}
+
+void Profiler::cycle() {
+    if (++cycles_ % FK_PROFILER_DUMP_INTERVAL == 0) {
+        dump();
+    }
+}
+
+bool Profiler::dump() {
+    char line[48];
+
+    pause();
+
+    snprintf(line, sizeof(line), "prof-begin %lu %lu %lu\n", (uint32_t)FK_PROFILER_RATE, (uint32_t)samples_, (uint32_t)dropped_);
+    if (!write(line)) {
+        resume();
+        return false;
+    }
+
+    for (auto &slot : slots_) {
+        if (slot.count > 0) {
+            snprintf(line, sizeof(line), "prof %08lx %08lx %lu\n", slot.pc, slot.lr, slot.count);
+            if (!write(line)) {
+                resume();
+                return false;
+            }
+        }
+    }
+
+    if (!write("prof-end\n")) {
+        resume();
+        return false;
+    }
+
+    clear();
+
+    resume();
+
+    return true;
+}
+
+bool Profiler::write(const char *line) {
+    // Skip mode writes the whole line or nothing, so retry until it fits.
+    auto started = millis();
+    while (SEGGER_RTT_WriteString(FK_PROFILER_RTT_BUFFER, line) == 0) {
+        if (millis() - started > FK_PROFILER_DUMP_WAIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Profiler::clear() {
+    for (auto &slot : slots_) {
+        slot = ProfilerSlot{ 0, 0, 0 };
+    }
+    samples_ = 0;
+    dropped_ = 0;
+}
+
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+extern "C" void fk_profiler_sample(uint32_t *frame) {
+    TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+    // Stacked by the hardware: r0-r3, r12, lr, pc, xpsr.
+    fk::profiler.sample(frame[6], frame[5]);
+}
+
+/**
+ * Finds the exception frame before the compiler pushes anything of its own
+ * and tail calls into C, leaving EXC_RETURN in lr for the return.
+ */
+extern "C" __attribute__((naked)) void TC3_Handler(void) {
+    __asm__ volatile(
+        "movs r0, #4\n"
+        "mov r1, lr\n"
+        "tst r0, r1\n"
+        "beq 1f\n"
+        "mrs r0, psp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, msp\n"
+        "2:\n"
+        "ldr r1, =fk_profiler_sample\n"
+        "bx r1\n"
+        ".ltorg\n"
+    );
+}
+
+#endif
+
+#endif
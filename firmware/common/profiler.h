@@ -0,0 +1,82 @@
+#ifndef FK_PROFILER_H_INCLUDED
+#define FK_PROFILER_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+#ifndef FK_PROFILER_RATE
+#define FK_PROFILER_RATE                  1000
+#endif
+
+#ifndef FK_PROFILER_SLOTS
+#define FK_PROFILER_SLOTS                 128
+#endif
+
+#ifndef FK_PROFILER_DUMP_INTERVAL
+#define FK_PROFILER_DUMP_INTERVAL         10
+#endif
+
+/* RTT up-buffer of our own, so the log never pushes a dump out. */
+#ifndef FK_PROFILER_RTT_BUFFER
+#define FK_PROFILER_RTT_BUFFER            1
+#endif
+
+#ifndef FK_PROFILER_RTT_SIZE
+#define FK_PROFILER_RTT_SIZE              1024
+#endif
+
+/* How long, in ms, a line waits for the host to make room in the buffer. */
+#ifndef FK_PROFILER_DUMP_WAIT
+#define FK_PROFILER_DUMP_WAIT             100
+#endif
+
+struct ProfilerSlot {
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t count;
+};
+
+/**
+ * Samples the interrupted PC and LR from TC3 at FK_PROFILER_RATE and counts
+ * each pair in a small open addressed table. Samples that find no free slot
+ * are only counted as dropped, raise FK_PROFILER_SLOTS if that's common.
+ *
+ * dump() writes the table to its own RTT up-buffer as "prof" lines for
+ * decode-calls.py and starts over. The table is bigger than the buffer, so
+ * each line waits for the host to drain it. With nobody reading the dump is
+ * abandoned without "prof-end" and the samples are kept for the next one.
+ */
+class Profiler {
+public:
+    static constexpr size_t MaximumProbes = 8;
+
+private:
+    ProfilerSlot slots_[FK_PROFILER_SLOTS];
+    volatile uint32_t samples_{ 0 };
+    volatile uint32_t dropped_{ 0 };
+    uint32_t cycles_{ 0 };
+    char buffer_[FK_PROFILER_RTT_SIZE];
+
+public:
+    void begin();
+    void sample(uint32_t pc, uint32_t lr);
+    void cycle();
+    bool dump();
+
+private:
+    bool write(const char *line);
+    void clear();
+    void pause();
+    void resume();
+
+};
+
+#if defined(FK_PROFILER)
+extern Profiler profiler;
+#endif
+
+}
+
+#endif
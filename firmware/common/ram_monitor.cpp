@@ -0,0 +1,87 @@
+#include <Arduino.h>
+
+#include <alogging/alogging.h>
+
+#include "ram_monitor.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+#include <malloc.h>
+
+extern "C" {
+
+extern uint32_t __data_start__;
+extern uint32_t __bss_end__;
+extern uint32_t __StackTop;
+
+char *sbrk(int incr);
+
+}
+#endif
+
+namespace fk {
+
+constexpr const char Log[] = "RAM";
+
+using Logger = SimpleLog<Log>;
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+// Leaves room for our own frame and anything an interrupt pushes while
+// we're painting.
+constexpr uint32_t PaintMargin = 128;
+
+static uint32_t *heap_top() {
+    auto top = (uintptr_t)sbrk(0);
+    return (uint32_t *)((top + 3) & ~(uintptr_t)3);
+}
+
+void RamMonitor::paint() {
+    auto sp = (uint32_t *)__get_MSP();
+    for (auto p = heap_top(); p < sp - PaintMargin / sizeof(uint32_t); ++p) {
+        *p = Paint;
+    }
+}
+
+RamUsage RamMonitor::usage() {
+    RamUsage usage;
+
+    auto heap = heap_top();
+    auto p = heap;
+    while (p < &__StackTop && *p == Paint) {
+        ++p;
+    }
+
+    auto info = mallinfo();
+
+    usage.statics = (uintptr_t)&__bss_end__ - (uintptr_t)&__data_start__;
+    usage.stackHighWater = (uintptr_t)&__StackTop - (uintptr_t)p;
+    usage.stackHeadroom = (uintptr_t)p - (uintptr_t)heap;
+    usage.heapArena = info.arena;
+    usage.heapInUse = info.uordblks;
+    usage.heapFree = info.fordblks;
+    // newlib-nano doesn't walk the free list for us, but the top chunk is
+    // nearly always the largest block. What it could grow into is the
+    // stack's headroom, reported on its own.
+    usage.largestFree = info.keepcost;
+
+    return usage;
+}
+
+#else
+
+void RamMonitor::paint() {
+}
+
+RamUsage RamMonitor::usage() {
+    return RamUsage{};
+}
+
+#endif
+
+void RamMonitor::log(const char *where) {
+    auto u = usage();
+    Logger::info("%s: static=%lu stack=%lu headroom=%lu heap=%lu/%lu free=%lu largest=%lu",
+                 where, u.statics, u.stackHighWater, u.stackHeadroom, u.heapInUse, u.heapArena, u.heapFree, u.largestFree);
+}
+
+}
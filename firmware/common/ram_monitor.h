@@ -0,0 +1,45 @@
+#ifndef FK_RAM_MONITOR_H_INCLUDED
+#define FK_RAM_MONITOR_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+struct RamUsage {
+    /* .data and .bss, fixed at link time. */
+    uint32_t statics{ 0 };
+    /* Deepest the stack has been since paint(), from the top of RAM. */
+    uint32_t stackHighWater{ 0 };
+    /* Painted words nobody has touched, between the heap and the stack. */
+    uint32_t stackHeadroom{ 0 };
+    uint32_t heapArena{ 0 };
+    uint32_t heapInUse{ 0 };
+    uint32_t heapFree{ 0 };
+    /**
+     * Largest allocation the arena can satisfy without growing. Growing it
+     * takes from stackHeadroom, which the stack may still need.
+     */
+    uint32_t largestFree{ 0 };
+};
+
+/**
+ * The SAMD21 has a single stack that interrupts share with the main loop,
+ * so the high water mark covers ISRs too. The stack grows down towards a
+ * heap that grows up. We paint the space between them once at startup and
+ * look for the lowest overwritten word later.
+ */
+class RamMonitor {
+public:
+    static constexpr uint32_t Paint = 0xcdcdcdcd;
+
+public:
+    static void paint();
+    static RamUsage usage();
+    static void log(const char *where);
+
+};
+
+}
+
+#endif
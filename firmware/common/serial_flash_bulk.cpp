@@ -0,0 +1,177 @@
+#include "serial_flash_bulk.h"
+
+namespace fk {
+
+constexpr uint8_t CommandRead = 0x03;
+constexpr uint8_t CommandFastRead = 0x0B;
+constexpr uint8_t CommandPageProgram = 0x02;
+constexpr uint8_t CommandSectorErase = 0x20;
+constexpr uint8_t CommandBlockErase = 0xD8;
+constexpr uint8_t CommandWriteEnable = 0x06;
+constexpr uint8_t CommandReadStatus = 0x05;
+constexpr uint8_t CommandReadId = 0x9F;
+
+// The 4 byte address forms, for parts over 16MB.
+constexpr uint8_t CommandRead4 = 0x13;
+constexpr uint8_t CommandFastRead4 = 0x0C;
+constexpr uint8_t CommandPageProgram4 = 0x12;
+constexpr uint8_t CommandSectorErase4 = 0x21;
+constexpr uint8_t CommandBlockErase4 = 0xDC;
+
+constexpr uint8_t StatusBusy = 0x01;
+
+// Copied to before each transfer, SPI.transfer(buffer, size) overwrites the
+// buffer with what it reads back.
+constexpr size_t ChunkSize = 64;
+
+bool SerialFlashBulk::begin(uint8_t cs) {
+    cs_ = cs;
+
+    settings_ = SPISettings(MaximumClock, MSBFIRST, SPI_MODE0);
+
+    uint8_t id[3];
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    SPI.transfer(CommandReadId);
+    for (auto &b : id) {
+        b = SPI.transfer(0);
+    }
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+
+    part_ = flash_part_find(id);
+    if (part_ == nullptr) {
+        return false;
+    }
+
+    fastRead_ = MaximumClock > part_->readClock;
+
+    return true;
+}
+
+void SerialFlashBulk::command(uint8_t command, uint32_t address, bool dummy) {
+    uint8_t header[6] = { command };
+    size_t size = 1;
+    if (part_->addressBytes == 4) {
+        header[size++] = (uint8_t)(address >> 24);
+    }
+    header[size++] = (uint8_t)(address >> 16);
+    header[size++] = (uint8_t)(address >> 8);
+    header[size++] = (uint8_t)(address);
+    if (dummy) {
+        header[size++] = 0;
+    }
+    SPI.transfer(header, size);
+}
+
+void SerialFlashBulk::writeEnable() {
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    SPI.transfer(CommandWriteEnable);
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+}
+
+void SerialFlashBulk::read(uint32_t address, void *buffer, uint32_t length) {
+    auto four = part_->addressBytes == 4;
+
+    wait();
+
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    if (fastRead_) {
+        command(four ? CommandFastRead4 : CommandFastRead, address, true);
+    }
+    else {
+        command(four ? CommandRead4 : CommandRead, address);
+    }
+    // What we send while reading is ignored, so the buffer can go as is.
+    SPI.transfer(buffer, length);
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+}
+
+void SerialFlashBulk::write(uint32_t address, const void *buffer, uint32_t length) {
+    auto four = part_->addressBytes == 4;
+    auto p = (const uint8_t *)buffer;
+    uint8_t chunk[ChunkSize];
+
+    while (length > 0) {
+        // Programs wrap within their page, so never cross into the next.
+        auto programming = std::min(length, part_->pageSize - address % part_->pageSize);
+
+        wait();
+        writeEnable();
+
+        SPI.beginTransaction(settings_);
+        digitalWrite(cs_, LOW);
+        command(four ? CommandPageProgram4 : CommandPageProgram, address);
+        for (uint32_t i = 0; i < programming; i += ChunkSize) {
+            auto size = std::min(programming - i, (uint32_t)ChunkSize);
+            memcpy(chunk, p + i, size);
+            SPI.transfer(chunk, size);
+        }
+        digitalWrite(cs_, HIGH);
+        SPI.endTransaction();
+
+        busy_ = true;
+
+        address += programming;
+        p += programming;
+        length -= programming;
+    }
+}
+
+void SerialFlashBulk::eraseSector(uint32_t address) {
+    if (part_->sectorSize == 0) {
+        eraseBlock(address);
+        return;
+    }
+
+    wait();
+    writeEnable();
+
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    command(part_->addressBytes == 4 ? CommandSectorErase4 : CommandSectorErase, address);
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+
+    busy_ = true;
+}
+
+void SerialFlashBulk::eraseBlock(uint32_t address) {
+    wait();
+    writeEnable();
+
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    command(part_->addressBytes == 4 ? CommandBlockErase4 : CommandBlockErase, address);
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+
+    busy_ = true;
+}
+
+bool SerialFlashBulk::ready() {
+    // Only programs and erases leave the part busy, skip asking otherwise.
+    if (!busy_) {
+        return true;
+    }
+
+    SPI.beginTransaction(settings_);
+    digitalWrite(cs_, LOW);
+    SPI.transfer(CommandReadStatus);
+    auto status = SPI.transfer(0);
+    digitalWrite(cs_, HIGH);
+    SPI.endTransaction();
+    busy_ = (status & StatusBusy) != 0;
+    return !busy_;
+}
+
+void SerialFlashBulk::wait() {
+    while (!ready()) {
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef FK_SERIAL_FLASH_BULK_H_INCLUDED
+#define FK_SERIAL_FLASH_BULK_H_INCLUDED
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#include "flash_parts.h"
+
+namespace fk {
+
+/**
+ * Large reads and writes straight over SPI, sized for the detected part.
+ * SerialFlash clocks program data out a byte at a time, which costs more
+ * in call overhead than it does on the wire. Here whole chunks go through
+ * SPI.transfer(buffer, size) instead, pages are as large as the part allows,
+ * and 0x0B is used when the bus is faster than the plain read allows.
+ *
+ * SerialFlash.begin() should have been called first, it does any part
+ * specific setup. Don't mix the two while an operation is in progress.
+ */
+class SerialFlashBulk {
+public:
+    static constexpr uint32_t MaximumClock = F_CPU / 2;
+
+private:
+    const FlashPart *part_{ nullptr };
+    SPISettings settings_;
+    uint8_t cs_{ 0 };
+    bool fastRead_{ false };
+    bool busy_{ false };
+
+public:
+    bool begin(uint8_t cs);
+
+    const FlashPart *part() const {
+        return part_;
+    }
+
+    bool fastRead() const {
+        return fastRead_;
+    }
+
+    void fastRead(bool enabled) {
+        fastRead_ = enabled;
+    }
+
+public:
+    void read(uint32_t address, void *buffer, uint32_t length);
+    void write(uint32_t address, const void *buffer, uint32_t length);
+    void eraseSector(uint32_t address);
+    void eraseBlock(uint32_t address);
+    bool ready();
+    void wait();
+
+private:
+    void command(uint8_t command, uint32_t address, bool dummy = false);
+    void writeEnable();
+
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef FK_VARINT_H_INCLUDED
+#define FK_VARINT_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+constexpr size_t VarintMaximumSize = 10;
+
+inline size_t varint_encode(uint8_t *buffer, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        buffer[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = (uint8_t)value;
+    return size;
+}
+
+/**
+ * Returns the number of bytes consumed, or 0 if the buffer ended before the
+ * value did.
+ */
+inline size_t varint_decode(const uint8_t *buffer, size_t size, uint64_t *value) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < size && i < VarintMaximumSize; ++i) {
+        v |= (uint64_t)(buffer[i] & 0x7f) << (7 * i);
+        if (!(buffer[i] & 0x80)) {
+            *value = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+inline uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+}
+
+#endif
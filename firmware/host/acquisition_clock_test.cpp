@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cmath>
+
+#include "acquisition_clock.h"
+#include "simulation.h"
+
+using namespace fk;
+
+/**
+ * Looks at a simulated RTC as the readings do, at the start of a cycle, when
+ * due during the audio window and at the merge, and checks the epoch times
+ * stay within the uncertainty the clock claims: while it learns
+ * the RTC's phase, as the RTC drifts for a week, and after the RTC is set.
+ */
+
+constexpr uint64_t Base = 1530403200;
+
+struct Rtc {
+    uint64_t phase;
+    double drift;
+    int64_t set;
+
+    /* RTC microseconds at t microseconds of uptime. */
+    int64_t at(uint64_t t) const {
+        return (int64_t)(Base * 1000000 + phase + t) + (int64_t)(t * drift / 1000000.0) + set;
+    }
+};
+
+struct Run {
+    uint32_t looks{ 0 };
+    uint32_t failures{ 0 };
+    uint32_t within50{ 0 };
+    uint32_t within10{ 0 };
+    uint32_t uncertainty{ 0 };
+};
+
+static void cycles(AcquisitionClock &clock, const Rtc &rtc, uint64_t &t, uint32_t number, Run &run) {
+    for (uint32_t n = 0; n < number; ++n) {
+        // At the start of the cycle and again at the merge, a look takes
+        // about a ms on the bus.
+        for (auto look = 0; look < 2; ++look) {
+            auto before = (uint32_t)(t / 1000);
+            auto seconds = (uint32_t)(rtc.at(t + 500) / 1000000);
+            auto after = (uint32_t)((t + 1000) / 1000);
+            clock.observe(seconds, before, after);
+            run.looks++;
+
+            auto uptime = (uint32_t)(t / 1000);
+            auto truth = rtc.at((uint64_t)uptime * 1000) / 1000;
+            auto error = (uint32_t)std::abs((int64_t)clock.epoch(uptime) - truth);
+            if (error > clock.uncertainty() + 1) {
+                fprintf(stderr, "look %u: %ums out, claims %ums\n", run.looks, error, clock.uncertainty());
+                run.failures++;
+            }
+            if (run.within50 == 0 && clock.uncertainty() <= 50) {
+                run.within50 = run.looks;
+            }
+            if (run.within10 == 0 && clock.uncertainty() <= 10) {
+                run.within10 = run.looks;
+            }
+
+            if (look == 0) {
+                // The audio window, looking whenever it's due.
+                auto started = t;
+                while (t - started < 2000 * 1000) {
+                    auto uptime = (uint32_t)(t / 1000);
+                    if (clock.due(uptime)) {
+                        clock.observe((uint32_t)(rtc.at(t + 500) / 1000000), uptime, (uint32_t)((t + 1000) / 1000));
+                        run.looks++;
+                    }
+                    t += 4000 + (uint64_t)(sim::simulation.random() * 2000);
+                }
+            }
+            t += (uint64_t)(sim::simulation.random() * 800 * 1000);
+        }
+        t += 57 * 1000 * 1000 + (uint64_t)(sim::simulation.random() * 3000 * 1000);
+    }
+    run.uncertainty = clock.uncertainty();
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t failures = 0;
+
+    // A day of one minute cycles, the RTC's second 437ms into uptime's.
+    {
+        AcquisitionClock clock;
+        Rtc rtc{ 437123, 0.0, 0 };
+        uint64_t t = 0;
+        Run run;
+        cycles(clock, rtc, t, 24 * 60, run);
+        printf("phase:           50ms after %u looks, 10ms after %u, %ums at the end\n", run.within50, run.within10,
+               run.uncertainty);
+        failures += run.failures;
+        if (run.within10 == 0 || run.uncertainty > 10) {
+            fprintf(stderr, "never narrowed\n");
+            failures++;
+        }
+    }
+
+    // A week with the RTC 40ppm fast, 24s over the week.
+    {
+        AcquisitionClock clock;
+        Rtc rtc{ 912000, 40.0, 0 };
+        uint64_t t = 0;
+        Run run;
+        cycles(clock, rtc, t, 7 * 24 * 60, run);
+        printf("drift:           %ums at the end of a week at 40ppm\n", run.uncertainty);
+        failures += run.failures;
+        if (run.uncertainty > 25) {
+            fprintf(stderr, "lost to drift\n");
+            failures++;
+        }
+
+        // Then the RTC is set, three seconds back.
+        rtc.set = -3 * 1000 * 1000;
+        Run after;
+        cycles(clock, rtc, t, 60, after);
+        printf("set:             %ums an hour after the RTC was set\n", after.uncertainty);
+        failures += after.failures;
+        if (after.uncertainty > 25) {
+            fprintf(stderr, "lost after the RTC was set\n");
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
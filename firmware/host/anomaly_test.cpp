@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cmath>
+
+#include "anomaly.h"
+
+using namespace fk;
+
+/**
+ * Feeds channels through the anomaly detector and checks nothing fires
+ * while a channel is warming up, that the noise floor keeps a channel that
+ * has never moved from firing on a step within it, that a heading going
+ * round through 0° is neither an anomaly nor pulls the mean off the circle,
+ * and that a real step fires the channel it was on, the furthest over its
+ * threshold when there's more than one.
+ */
+
+constexpr uint32_t Warmup = FK_NATURALIST_ANOMALY_WARMUP;
+constexpr uint32_t Settled = 50;
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static int32_t update(AnomalyDetector &detector, NaturalistChannel channel, float value) {
+    NaturalistValues values;
+    values.set(channel, value);
+    return detector.update(values);
+}
+
+/* A steady value with a little noise either side, the same every run. */
+static float steady(float value, float noise, uint32_t n) {
+    return value + noise * (float)((int32_t)(n % 3) - 1);
+}
+
+int main(int argc, char *argv[]) {
+    {
+        // Swinging wildly from the second value, but still learning.
+        AnomalyDetector detector;
+        auto fired = false;
+        for (uint32_t n = 0; n < Warmup; ++n) {
+            fired = fired || update(detector, NaturalistChannel::Temp1, n % 2 == 0 ? 20.0f : 80.0f) >= 0;
+        }
+        expect(!fired, "warmup: fired");
+        expect(detector.channel((size_t)NaturalistChannel::Temp1).fired == 0, "warmup: counted");
+    }
+
+    {
+        // Never moved, so the deviation is the noise floor alone.
+        auto channel = NaturalistChannel::Temp1;
+        auto policy = anomaly_policy(channel);
+        AnomalyDetector within;
+        AnomalyDetector over;
+        for (uint32_t n = 0; n < Settled; ++n) {
+            update(within, channel, 20.0f);
+            update(over, channel, 20.0f);
+        }
+        expect(update(within, channel, 20.0f + policy.minimum * policy.threshold * 0.8f) < 0, "minimum: fired within it");
+        expect(update(over, channel, 20.0f + policy.minimum * policy.threshold * 1.2f) == (int32_t)channel,
+               "minimum: didn't fire past it");
+    }
+
+    {
+        // Heading back and forth across north.
+        auto channel = NaturalistChannel::ImuOrienX;
+        AnomalyDetector detector;
+        auto fired = false;
+        auto circle = true;
+        for (uint32_t n = 0; n < Settled; ++n) {
+            fired = fired || update(detector, channel, n % 2 == 0 ? 359.0f : 1.0f) >= 0;
+            auto mean = detector.channel((size_t)channel).mean;
+            circle = circle && mean >= 0.0f && mean < 360.0f;
+        }
+        auto mean = detector.channel((size_t)channel).mean;
+        expect(!fired, "wrap: 359 to 1 fired");
+        expect(circle, "wrap: mean off the circle");
+        expect(std::min(mean, 360.0f - mean) < 2.0f, "wrap: mean not north");
+    }
+
+    {
+        // A step on one channel amongst steady ones.
+        AnomalyDetector detector;
+        for (uint32_t n = 0; n < Settled; ++n) {
+            NaturalistValues values;
+            values.set(NaturalistChannel::Temp1, steady(20.0f, 0.05f, n));
+            values.set(NaturalistChannel::Pressure, steady(101325.0f, 3.0f, n));
+            values.set(NaturalistChannel::ImuOrienX, steady(90.0f, 0.5f, n));
+            values.set(NaturalistChannel::LightIr, steady(1000.0f, 5.0f, n));
+            expect(detector.update(values) < 0, "step: fired while steady");
+        }
+
+        // Unwatched channels never fire, however far they go.
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, 20.0f);
+        values.set(NaturalistChannel::Pressure, 101325.0f);
+        values.set(NaturalistChannel::ImuOrienX, 90.0f);
+        values.set(NaturalistChannel::LightIr, 60000.0f);
+        expect(detector.update(values) < 0, "step: unwatched channel fired");
+
+        // Knocked over, and a little warmer: the heading is further over.
+        values.set(NaturalistChannel::Temp1, 21.0f);
+        values.set(NaturalistChannel::ImuOrienX, 270.0f);
+        expect(detector.update(values) == (int32_t)NaturalistChannel::ImuOrienX, "step: wrong channel");
+        expect(detector.channel((size_t)NaturalistChannel::ImuOrienX).fired == 1 &&
+               detector.channel((size_t)NaturalistChannel::Temp1).fired == 1 &&
+               detector.channel((size_t)NaturalistChannel::Pressure).fired == 0, "step: counts");
+
+        // And a front coming through.
+        values.set(NaturalistChannel::Temp1, 21.0f);
+        values.set(NaturalistChannel::ImuOrienX, 270.0f);
+        values.set(NaturalistChannel::Pressure, 100825.0f);
+        expect(detector.update(values) == (int32_t)NaturalistChannel::Pressure, "step: pressure");
+    }
+
+    printf("warmup:          %u values\n", Warmup);
+    printf("anomaly:         %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "readings.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+static SensorInfo sensors[NumberOfNaturalistChannels];
+static SensorReading readings[NumberOfNaturalistBoards][NumberOfNaturalistChannels];
+static ModuleInfo modules[NumberOfNaturalistBoards];
+
+struct Statistics {
+    uint64_t minimum{ UINT64_MAX };
+    uint64_t maximum{ 0 };
+    uint64_t total{ 0 };
+    uint32_t count{ 0 };
+
+    void add(uint64_t value) {
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        total += value;
+        count++;
+    }
+
+    uint64_t mean() const {
+        return count > 0 ? total / count : 0;
+    }
+};
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [--cycles N] [--interval SECONDS] [--scheduled] [--verbose] [--set name=value]...\n", name);
+    fprintf(stderr, "simulation parameters:\n");
+    sim::simulation_list();
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t cycles = 10;
+    uint32_t interval = 60;
+    auto scheduled = false;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--scheduled") == 0) {
+            scheduled = true;
+        }
+        else if (strcmp(argv[i], "--verbose") == 0) {
+            log_verbose(true);
+        }
+        else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (!sim::simulation_set(argv[++i])) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    Leds leds;
+    CoreState state;
+    for (size_t i = 0; i < NumberOfNaturalistBoards; ++i) {
+        auto &board = naturalist_boards[i];
+        modules[i] = { 0, board.module(), NumberOfNaturalistChannels, 1, board.name(), "fk-naturalist", sensors, readings[i] };
+        state.configure(modules[i]);
+    }
+
+    MainServices services{ &leds, &state };
+    MainServicesState::services(&services);
+
+    TakeNaturalistReadings take;
+    take.setup();
+
+    Statistics simulated;
+    Statistics cpu;
+    auto started = sim::Clock::now();
+
+    for (uint32_t i = 0; i < cycles; ++i) {
+        auto simulatedStarted = sim::Clock::now();
+        auto cpuStarted = sim::host_cpu_ns();
+
+        take.task();
+
+        cpu.add(sim::host_cpu_ns() - cpuStarted);
+        simulated.add(sim::Clock::now() - simulatedStarted);
+
+        #if defined(FK_NATURALIST_MULTI_RATE)
+        // Sleeps until the next sensor is due, rather than a fixed interval.
+        if (scheduled) {
+            sim::Clock::advance((uint64_t)take.readings().schedule().next(fk_uptime()) * 1000);
+            continue;
+        }
+        #endif
+
+        sim::Clock::advance((uint64_t)interval * 1000000);
+    }
+
+    auto elapsed = sim::Clock::now() - started;
+
+    printf("cycles:          %u (%u readings merged)\n", cycles, state.merged());
+    if (NumberOfNaturalistBoards > 1) {
+        printf("boards:          %zu (%u simulated)\n", NumberOfNaturalistBoards, sim::simulation.boards);
+    }
+    #if defined(FK_NATURALIST_DEADBAND)
+    uint32_t suppressed = 0;
+    for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            suppressed += take.readings().deadband(b).channel(i).suppressed;
+        }
+    }
+    printf("suppressed:      %u\n", suppressed);
+    #endif
+    #if defined(FK_NATURALIST_ROLLUPS)
+    auto &rollups = take.readings().rollups();
+    printf("rollups:         %u (%u bytes)\n", rollups.emitted(), rollups.bytes());
+    #endif
+    #if defined(FK_NATURALIST_CYCLE_RECORDS)
+    printf("bytes/cycle:     %.1f (%.1f as readings)\n", (float)take.readings().recordBytes() / cycles,
+           (float)take.readings().readingBytes() / cycles);
+    #endif
+    #if defined(FK_NATURALIST_LORA)
+    auto &lora = take.readings().lora();
+    if (lora.frames() > 0) {
+        printf("lora:            %u frames (%u acked), %.1f bytes (%.1f as floats), %.0fms airtime\n", lora.frames(),
+               lora.acks(), (float)lora.bytes() / lora.frames(), (float)lora.floatBytes() / lora.frames(),
+               (float)lora.airtime() / lora.frames());
+    }
+    #endif
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    {
+        // The simulated RTC's epoch ms, as Clock::getTime has it.
+        auto now = sim::Clock::now();
+        auto rtc = now + sim::simulation.rtc.phase + (int64_t)(now * (double)sim::simulation.rtc.drift / 1000000.0);
+        auto truth = (int64_t)1530403200 * 1000 + (int64_t)(rtc / 1000) - (int64_t)fk_uptime();
+        auto &acquisition = take.readings().acquisition();
+        printf("acquisition:     within %ums after %u looks (%ldms out)\n", acquisition.uncertainty(),
+               acquisition.observations(), (long)(acquisition.offset() - truth));
+    }
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    printf("bursts:          %u (%u cycles)\n", take.readings().bursts(),
+           take.readings().bursts() * FK_NATURALIST_BURST_CYCLES);
+    #endif
+    printf("simulated (ms):  min=%.2f mean=%.2f max=%.2f\n",
+           simulated.minimum / 1000.0, simulated.mean() / 1000.0, simulated.maximum / 1000.0);
+    printf("awake:           %.1f%% of %.0fs\n", 100.0 * simulated.total / elapsed, elapsed / 1000000.0);
+    printf("host cpu (us):   min=%.2f mean=%.2f max=%.2f\n",
+           cpu.minimum / 1000.0, cpu.mean() / 1000.0, cpu.maximum / 1000.0);
+
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    auto &schedule = take.readings().schedule();
+    printf("%-12s %10s %10s %10s\n", "sensor", "period (s)", "achieved", "reads");
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        auto sensor = (NaturalistSensor)i;
+        printf("%-12s %10u %10.1f %10u\n", naturalist_sensor_name(sensor), sensor_schedule_policy(sensor).period,
+               schedule.interval(sensor) / 1000.0, schedule.sensor(sensor).reads);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    printf("%-12s %10s %10s %10s\n", "stage (ms)", "min", "mean", "max");
+    for (size_t i = 0; i < NumberOfNaturalistStages; ++i) {
+        auto &s = stageTimings.stage((NaturalistStage)i);
+        if (s.count == 0) {
+            continue;
+        }
+        printf("%-12s %10.2f %10.2f %10.2f\n", naturalist_stage_name((NaturalistStage)i),
+               s.minimum / 1000.0, s.mean() / 1000.0, s.maximum / 1000.0);
+    }
+    #endif
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+
+#include <SerialFlash.h>
+
+#include "calibration.h"
+#include "hardware.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+/**
+ * Writes a table for a batch of devices, checks this one loads its own
+ * entries and corrects values as the coefficients say, and that tables
+ * that are invalid or corrupt leave it uncalibrated.
+ */
+
+constexpr uint32_t Cycles = 100000;
+
+static CalibrationEntry entry(const uint8_t *id, uint8_t board, NaturalistChannel channel, CalibrationKind kind,
+                              std::initializer_list<float> terms) {
+    CalibrationEntry e;
+    memset(&e, 0, sizeof(e));
+    memcpy(e.id, id, sizeof(e.id));
+    e.board = board;
+    e.channel = (uint8_t)channel;
+    e.kind = kind;
+    e.size = (uint8_t)terms.size();
+    std::copy(terms.begin(), terms.end(), e.terms);
+    return e;
+}
+
+static bool near(float expected, float actual) {
+    return fabsf(expected - actual) <= 1e-5f * std::max(1.0f, fabsf(expected));
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t failures = 0;
+
+    Wire.begin();
+
+    uint8_t id[MacEepromIdSize];
+    MacEeprom eeprom;
+    if (!eeprom.read128bMac(id) || id[0] != 0x00 || id[1] != 0x04 || id[2] != 0xa3) {
+        fprintf(stderr, "no EUI-64\n");
+        return 1;
+    }
+
+    uint8_t other[MacEepromIdSize];
+    memcpy(other, id, sizeof(other));
+    other[7] ^= 0x01;
+
+    CalibrationEntry entries[] = {
+        entry(other, 0, NaturalistChannel::Temp1, CalibrationKind::Polynomial, { 5.0f, 1.0f }),
+        entry(id, 0, NaturalistChannel::Temp1, CalibrationKind::Polynomial, { -0.3f, 1.002f }),
+        entry(id, 0, NaturalistChannel::Humidity, CalibrationKind::PiecewiseLinear, { 10.0f, 11.5f, 50.0f, 51.0f, 90.0f, 88.5f }),
+        entry(id, 0, NaturalistChannel::Pressure, CalibrationKind::Polynomial, { 12.0f, 0.9999f, 1e-9f }),
+        entry(id, 1, NaturalistChannel::Temp1, CalibrationKind::Polynomial, { 0.25f, 1.0f }),
+    };
+    if (!Calibration::write(entries, sizeof(entries) / sizeof(entries[0]))) {
+        fprintf(stderr, "write failed\n");
+        return 1;
+    }
+
+    Calibration calibration;
+    if (!calibration.begin() || calibration.size() != 4) {
+        fprintf(stderr, "loaded %zu entries\n", calibration.size());
+        failures++;
+    }
+
+    {
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, 21.5f);
+        values.set(NaturalistChannel::Humidity, 70.0f);
+        values.set(NaturalistChannel::Pressure, 101325.0f);
+        values.set(NaturalistChannel::Temp2, 21.0f);
+        calibration.apply(0, values);
+
+        if (!near(-0.3f + 1.002f * 21.5f, values.get(NaturalistChannel::Temp1)) ||
+            !near(51.0f + (70.0f - 50.0f) * (88.5f - 51.0f) / 40.0f, values.get(NaturalistChannel::Humidity)) ||
+            !near(12.0f + 0.9999f * 101325.0f + 1e-9f * 101325.0f * 101325.0f, values.get(NaturalistChannel::Pressure)) ||
+            values.get(NaturalistChannel::Temp2) != 21.0f) {
+            fprintf(stderr, "board 0: %f %f %f %f\n", values.get(NaturalistChannel::Temp1), values.get(NaturalistChannel::Humidity),
+                    values.get(NaturalistChannel::Pressure), values.get(NaturalistChannel::Temp2));
+            failures++;
+        }
+
+        NaturalistValues second;
+        second.set(NaturalistChannel::Temp1, 21.5f);
+        second.set(NaturalistChannel::Humidity, 70.0f);
+        calibration.apply(1, second);
+        if (!near(21.75f, second.get(NaturalistChannel::Temp1)) || second.get(NaturalistChannel::Humidity) != 70.0f) {
+            fprintf(stderr, "board 1: %f %f\n", second.get(NaturalistChannel::Temp1), second.get(NaturalistChannel::Humidity));
+            failures++;
+        }
+
+        // Missing channels stay missing.
+        NaturalistValues empty;
+        calibration.apply(0, empty);
+        if (empty.valid != 0 || empty.get(NaturalistChannel::Temp1) != 0.0f) {
+            fprintf(stderr, "calibrated a missing channel\n");
+            failures++;
+        }
+    }
+
+    {
+        // Past either end the first and last segments carry on.
+        float terms[] = { 10.0f, 11.5f, 50.0f, 51.0f, 90.0f, 88.5f };
+        auto low = Calibration::evaluate(CalibrationKind::PiecewiseLinear, terms, 6, 0.0f);
+        auto high = Calibration::evaluate(CalibrationKind::PiecewiseLinear, terms, 6, 100.0f);
+        auto knot = Calibration::evaluate(CalibrationKind::PiecewiseLinear, terms, 6, 50.0f);
+        if (!near(11.5f - 10.0f * 39.5f / 40.0f, low) || !near(88.5f + 10.0f * 37.5f / 40.0f, high) || !near(51.0f, knot)) {
+            fprintf(stderr, "piecewise: %f %f %f\n", low, high, knot);
+            failures++;
+        }
+    }
+
+    {
+        // Entries that can't be evaluated are refused.
+        CalibrationEntry invalid[] = {
+            entry(id, 0, NaturalistChannel::Humidity, CalibrationKind::PiecewiseLinear, { 50.0f, 51.0f, 10.0f, 11.5f }),
+            entry(id, 0, NaturalistChannel::NumberOfChannels, CalibrationKind::Polynomial, { 0.0f, 1.0f }),
+            entry(id, 0, NaturalistChannel::Temp1, CalibrationKind::Polynomial, { NAN, 1.0f }),
+        };
+        for (auto &e : invalid) {
+            if (Calibration::write(&e, 1)) {
+                fprintf(stderr, "wrote an invalid entry for channel %d\n", e.channel);
+                failures++;
+            }
+        }
+    }
+
+    {
+        // Another device in the batch only gets its own.
+        auto serial = sim::simulation.mac.serial;
+        sim::simulation.mac.serial ^= 0x01;
+        Calibration theirs;
+        if (!theirs.begin() || theirs.size() != 1) {
+            fprintf(stderr, "other device loaded %zu entries\n", theirs.size());
+            failures++;
+        }
+        sim::simulation.mac.serial = serial;
+    }
+
+    uint64_t ns = 0;
+    {
+        NaturalistValues values;
+        for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+            values.set((NaturalistChannel)i, 20.0f);
+        }
+        auto started = sim::host_cpu_ns();
+        auto sum = 0.0f;
+        for (uint32_t n = 0; n < Cycles; ++n) {
+            auto copy = values;
+            copy.values[0] += (float)(n % 100) * 0.01f;
+            calibration.apply(0, copy);
+            sum += copy.values[0] + copy.values[1] + copy.values[3];
+        }
+        ns = sim::host_cpu_ns() - started;
+        if (!std::isfinite(sum)) {
+            failures++;
+        }
+    }
+
+    {
+        // A bit cleared in an entry, as the flash wears, and the CRC fails.
+        SerialFlash.begin(Hardware::FLASH_PIN_CS);
+        FlashExtent region;
+        flash_region(FlashRegion::Calibration, region);
+        uint8_t byte = 0;
+        auto address = region.start + sizeof(CalibrationHeader) + sizeof(CalibrationEntry) + 12;
+        SerialFlash.read(address, &byte, 1);
+        byte &= (uint8_t)(byte - 1);
+        SerialFlash.write(address, &byte, 1);
+        Calibration corrupt;
+        if (corrupt.begin() || corrupt.size() != 0) {
+            fprintf(stderr, "loaded a corrupt table\n");
+            failures++;
+        }
+    }
+
+    printf("calibration:     %zu of %zu entries for %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x\n", calibration.size(),
+           sizeof(entries) / sizeof(entries[0]), id[0], id[1], id[2], id[3], id[4], id[5], id[6], id[7]);
+    printf("apply (ns):      %.1f per cycle on the host\n", (double)ns / Cycles);
+
+    return failures == 0 ? 0 : 1;
+}
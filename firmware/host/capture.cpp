@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <SerialFlash.h>
+
+#include "readings.h"
+#include "trace.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+static SensorInfo sensors[NumberOfNaturalistChannels];
+static SensorReading readings[NumberOfNaturalistChannels];
+static ModuleInfo module = { 0, 8, NumberOfNaturalistChannels, 1, "FkNat", "fk-naturalist", sensors, readings };
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [--cycles N] [--interval SECONDS] [--set name=value]... TRACE\n", name);
+    fprintf(stderr, "simulation parameters:\n");
+    sim::simulation_list();
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t cycles = 10;
+    uint32_t interval = 60;
+    const char *path = nullptr;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--verbose") == 0) {
+            log_verbose(true);
+        }
+        else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (!sim::simulation_set(argv[++i])) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (path == nullptr) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Leds leds;
+    CoreState state;
+    state.configure(module);
+
+    MainServices services{ &leds, &state };
+    MainServicesState::services(&services);
+
+    TakeNaturalistReadings take;
+    take.setup();
+
+    for (uint32_t i = 0; i < cycles; ++i) {
+        take.task();
+        sim::Clock::advance((uint64_t)interval * 1000000);
+    }
+
+    // The trace ends at the first erased byte, like the firmware's dump.
+    FlashExtent trace;
+    flash_region(FlashRegion::Trace, trace);
+    auto region = SerialFlash.memory() + trace.start;
+    size_t size = trace.size;
+    while (size > 0 && region[size - 1] == 0xff) {
+        size--;
+    }
+
+    auto file = fopen(path, "wb");
+    if (file == nullptr) {
+        perror(path);
+        return 1;
+    }
+    fwrite(region, 1, size, file);
+    fclose(file);
+
+    printf("captured %u cycles, %zu bytes to %s\n", cycles, size, path);
+
+    return 0;
+}
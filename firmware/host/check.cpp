@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "check_naturalist.h"
+#include "energy_benchmark.h"
+#include "flash_benchmark.h"
+#include "soak_test.h"
+#include "modules.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+int main(int argc, char *argv[]) {
+    uint32_t energyCycles = 0;
+    uint32_t soakHours = 0;
+    auto flash = false;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--energy") == 0 && i + 1 < argc) {
+            energyCycles = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            soakHours = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--flash") == 0) {
+            flash = true;
+        }
+        else if (strcmp(argv[i], "--verbose") == 0) {
+            log_verbose(true);
+        }
+        else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (!sim::simulation_set(argv[++i])) {
+                fprintf(stderr, "unknown parameter: %s\n", argv[i]);
+                sim::simulation_list();
+                return 2;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [--energy CYCLES] [--soak HOURS] [--flash] [--verbose] [--set name=value]...\n", argv[0]);
+            return 2;
+        }
+    }
+
+    CheckNaturalist check;
+    check.setup();
+
+    auto started = sim::Clock::now();
+    auto cpuStarted = sim::host_cpu_ns();
+    auto success = check.check();
+
+    printf("check:           %s\n", success ? "PASSED" : "FAILED");
+    printf("simulated (ms):  %.2f\n", (sim::Clock::now() - started) / 1000.0);
+    printf("host cpu (us):   %.2f\n", (sim::host_cpu_ns() - cpuStarted) / 1000.0);
+
+    if (flash) {
+        FlashBenchmark benchmark;
+        if (!benchmark.run()) {
+            return 1;
+        }
+
+        printf("%-16s %8s %8s %8s %8s %10s\n", "flash (us)", "n", "min", "mean", "max", "KB/s");
+        for (size_t i = 0; i < NumberOfFlashOperations; ++i) {
+            auto &o = benchmark.operation((FlashOperation)i);
+            if (o.count == 0) {
+                continue;
+            }
+            printf("%-16s %8u %8u %8u %8u %10.1f\n", flash_operation_name((FlashOperation)i),
+                   o.count, o.minimum, o.mean(), o.maximum, o.throughput());
+        }
+    }
+
+    if (energyCycles > 0) {
+        NaturalistReadings readings;
+        EnergyBenchmark benchmark;
+        if (!benchmark.run(readings, check.leds(), energyCycles)) {
+            return 1;
+        }
+
+        auto cycles = (float)benchmark.stage(NaturalistStage::Cycle).count;
+        printf("idle (mA):       %.2f\n", benchmark.idle());
+        printf("%-12s %10s %10s %10s\n", "stage (mAh)", "ms", "counted", "integrated");
+        for (size_t i = 0; i < NumberOfNaturalistStages; ++i) {
+            auto &s = benchmark.stage((NaturalistStage)i);
+            if (s.count == 0) {
+                continue;
+            }
+            printf("%-12s %10.2f %10.5f %10.5f\n", naturalist_stage_name((NaturalistStage)i),
+                   s.micros / 1000.0 / cycles, s.counted / cycles, s.integrated / cycles);
+        }
+    }
+
+    if (soakHours > 0) {
+        CoreState state;
+        naturalist_configure(state);
+
+        MainServices services{ &check.leds(), &state };
+        MainServicesState::services(&services);
+
+        static TakeNaturalistReadings take;
+        SoakTest soak;
+        if (!soak.run(take, soakHours)) {
+            return 1;
+        }
+
+        auto &d = soak.durations();
+        auto &l = soak.lateness();
+        printf("soak:            %.1fh, %u cycles (%u overran), %u summaries (%u on SD)\n", soak.elapsed(), soak.cycles(),
+               soak.overruns(), soak.summaries(), soak.written());
+        printf("cycle (ms):      min=%u mean=%u max=%u sd=%.2f\n", d.minimum, d.mean(), d.maximum, soak.jitter());
+        printf("late (ms):       mean=%u max=%u\n", l.mean(), l.maximum);
+        printf("merged:          %u readings\n", state.merged());
+        printf("audio:           %u blocks, %.3f%% dropped\n", soak.audioSamples(),
+               soak.audioSamples() == 0 ? 0.0 : 100.0 * soak.droppedSamples() / soak.audioSamples());
+        printf("battery:         %.3fmAh, %.3fmAh/h\n", soak.used(), soak.used() / soak.elapsed());
+        printf("%-12s %10s %10s %10s\n", "sensor", "failures", "per cycle", "offline");
+        for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+            auto &s = soak.sensor((NaturalistSensor)i);
+            printf("%-12s %10u %10.3f %10u\n", naturalist_sensor_name((NaturalistSensor)i), s.failures,
+                   (float)s.failures / soak.cycles(), s.offline);
+        }
+
+        if (soak.written() != soak.summaries() || state.merged() == 0) {
+            return 1;
+        }
+    }
+
+    return success ? 0 : 1;
+}
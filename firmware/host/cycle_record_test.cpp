@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "cycle_record.h"
+#include "fk-core.h"
+#include "simulation.h"
+
+using namespace fk;
+
+/**
+ * Encodes a day of simulated cycles, decodes the stream a few bytes at a time
+ * as a host reading it off the device would, and checks every value comes
+ * back to within the resolution of its channel.
+ */
+
+constexpr uint32_t Cycles = 24 * 60;
+constexpr uint32_t Interval = 60;
+
+static NaturalistValues cycle(uint32_t n) {
+    NaturalistValues values;
+    auto t = (float)n * Interval;
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        // Some channels missing now and then, like a failing sensor.
+        if ((n + i) % 37 == 0) {
+            continue;
+        }
+        // A few thousand steps of resolution, like the real channels.
+        auto base = 1000.0f * (1 + i % 5) / cycle_record_scale((NaturalistChannel)i);
+        auto value = base + base * 0.2f * sinf(2.0f * 3.14159265f * t / 86400.0f) + sim::simulation.random() * base * 0.01f;
+        values.set((NaturalistChannel)i, value);
+    }
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    // The audio window first, then the conversions it overlapped.
+    uint32_t after[] = { 1000, 2012, 2500, 2110, 2131 };
+    for (size_t i = 0; i < NumberOfNaturalistAcquisitions; ++i) {
+        values.acquired[i] = (uint64_t)(1500000000 + n * Interval) * 1000 + after[i] + (uint32_t)(sim::simulation.random() * 40);
+    }
+    #endif
+    return values;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<uint8_t> stream;
+    std::vector<NaturalistValues> expected;
+
+    CycleRecordEncoder encoder;
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    CycleRecordEncoder unstamped;
+    size_t unstampedBytes = 0;
+    #endif
+    for (uint32_t n = 0; n < Cycles; ++n) {
+        auto values = cycle(n);
+        uint8_t buffer[CycleRecordMaximumSize];
+        auto size = encoder.encode(1500000000 + n * Interval, values, buffer);
+        stream.insert(stream.end(), buffer, buffer + size);
+        expected.push_back(values);
+
+        #if defined(FK_NATURALIST_ACQUISITION_TIME)
+        auto copy = values;
+        memset(copy.acquired, 0, sizeof(copy.acquired));
+        unstampedBytes += unstamped.encode(1500000000 + n * Interval, copy, buffer);
+        #endif
+    }
+
+    CycleRecordDecoder decoder;
+    std::vector<uint8_t> pending;
+    size_t position = 0;
+    uint32_t decoded = 0;
+    uint32_t failures = 0;
+    auto worst = 0.0f;
+
+    while (position < stream.size() || !pending.empty()) {
+        // Arrives in 7 byte pieces.
+        auto available = std::min((size_t)7, stream.size() - position);
+        pending.insert(pending.end(), stream.begin() + position, stream.begin() + position + available);
+        position += available;
+
+        CycleRecord record;
+        size_t consumed;
+        while ((consumed = decoder.decode(pending.data(), pending.size(), record)) > 0) {
+            pending.erase(pending.begin(), pending.begin() + consumed);
+
+            auto &values = expected[decoded];
+            if (record.time != 1500000000 + decoded * Interval) {
+                fprintf(stderr, "cycle %u: time %u\n", decoded, record.time);
+                failures++;
+            }
+            for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+                if (values.has(i) != record.values.has(i)) {
+                    fprintf(stderr, "cycle %u: channel %zu presence\n", decoded, i);
+                    failures++;
+                    continue;
+                }
+                if (!values.has(i)) {
+                    continue;
+                }
+                auto scale = cycle_record_scale((NaturalistChannel)i);
+                auto error = fabsf(values.values[i] - record.values.values[i]) * scale;
+                worst = std::max(worst, error);
+                // Half a step, and the float rounding of the scaled value.
+                if (error > 0.5f + fabsf(values.values[i] * scale) * 2e-7f) {
+                    fprintf(stderr, "cycle %u: channel %zu %f != %f\n", decoded, i, values.values[i], record.values.values[i]);
+                    failures++;
+                }
+            }
+            #if defined(FK_NATURALIST_ACQUISITION_TIME)
+            for (size_t i = 0; i < NumberOfNaturalistAcquisitions; ++i) {
+                auto read = false;
+                for (size_t c = 0; c < NumberOfNaturalistChannels; ++c) {
+                    read = read || (values.has(c) && naturalist_channel_acquisition(c) == i);
+                }
+                if (record.values.acquired[i] != (read ? values.acquired[i] : 0)) {
+                    fprintf(stderr, "cycle %u: sensor %zu acquired %llu\n", decoded, i, (unsigned long long)record.values.acquired[i]);
+                    failures++;
+                }
+            }
+            #endif
+            decoded++;
+        }
+
+        if (available == 0 && !pending.empty()) {
+            fprintf(stderr, "%zu bytes left over\n", pending.size());
+            failures++;
+            break;
+        }
+    }
+
+    auto readings = 0u;
+    for (auto &values : expected) {
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            readings += values.has(i) ? 1 : 0;
+        }
+    }
+
+    printf("cycles:          %u decoded of %u\n", decoded, Cycles);
+    printf("bytes/cycle:     %.1f (%.1f as readings)\n", (float)stream.size() / Cycles,
+           (float)readings * sizeof(IncomingSensorReading) / Cycles);
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    printf("acquired:        %.1f bytes/cycle for the ms of each sensor\n", (float)(stream.size() - unstampedBytes) / Cycles);
+    #endif
+    printf("worst error:     %.3f of resolution\n", worst);
+
+    return failures == 0 && decoded == Cycles ? 0 : 1;
+}
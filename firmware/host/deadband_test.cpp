@@ -0,0 +1,117 @@
+#include <cstdio>
+
+#include "deadband.h"
+
+using namespace fk;
+
+/**
+ * Feeds single channels through the deadband and checks each policy: an
+ * absolute threshold, a relative one taking over once the value is large,
+ * the heartbeat recording an unchanged value and diagnostics always going
+ * through. Also that a suppressed value doesn't become the new reference,
+ * so a slow drift is still recorded once it adds up.
+ */
+
+constexpr uint32_t HeartbeatMs = (uint32_t)FK_NATURALIST_HEARTBEAT * 1000;
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+/* True if the value made it through. */
+static bool filter(Deadband &deadband, NaturalistChannel channel, float value, uint32_t now) {
+    NaturalistValues values;
+    values.set(channel, value);
+    auto suppressed = deadband.filter(values, now);
+    auto kept = values.has((size_t)channel);
+    expect(suppressed == (kept ? 0 : 1), "suppressed count");
+    return kept;
+}
+
+int main(int argc, char *argv[]) {
+    {
+        // Absolute, 0.1 on Temp1.
+        Deadband deadband;
+        auto channel = NaturalistChannel::Temp1;
+        auto threshold = deadband_policy(channel).absolute;
+        uint32_t now = 1000;
+        expect(filter(deadband, channel, 20.0f, now), "first value suppressed");
+        expect(!filter(deadband, channel, 20.0f + threshold / 2, now += 1000), "absolute: small change recorded");
+        expect(!filter(deadband, channel, 20.0f - threshold / 2, now += 1000), "absolute: small drop recorded");
+        // Measured from what was recorded, not the last value seen.
+        expect(filter(deadband, channel, 20.0f + threshold * 1.5f, now += 1000), "absolute: drift never recorded");
+        expect(filter(deadband, channel, 20.0f, now += 1000), "absolute: drop not recorded");
+
+        auto &c = deadband.channel((size_t)channel);
+        expect(c.recorded == 3 && c.suppressed == 2, "absolute: counts");
+    }
+
+    {
+        // Relative, 5% on LightLux once that's more than the absolute 1.
+        Deadband deadband;
+        auto channel = NaturalistChannel::LightLux;
+        auto policy = deadband_policy(channel);
+        uint32_t now = 1000;
+        expect(policy.relative > 0.0f, "LightLux has no relative threshold");
+        expect(filter(deadband, channel, 10000.0f, now), "relative: first value suppressed");
+        // Far over the absolute threshold but under 5%.
+        expect(!filter(deadband, channel, 10000.0f * (1 + policy.relative / 2), now += 1000), "relative: small change recorded");
+        expect(filter(deadband, channel, 10000.0f * (1 + policy.relative * 2), now += 1000), "relative: large change suppressed");
+        // In the dark the absolute threshold is the larger.
+        expect(filter(deadband, channel, 2.0f, now += 1000), "relative: drop to dark suppressed");
+        expect(!filter(deadband, channel, 2.0f + policy.absolute / 2, now += 1000), "relative: absolute ignored when dark");
+        expect(filter(deadband, channel, 2.0f + policy.absolute * 2, now += 1000), "relative: dark change suppressed");
+    }
+
+    {
+        // An unchanged value goes out once a heartbeat, even across the
+        // uptime wrapping.
+        for (uint32_t start : { (uint32_t)1000, UINT32_MAX - HeartbeatMs / 2 }) {
+            Deadband deadband;
+            auto channel = NaturalistChannel::Pressure;
+            expect(filter(deadband, channel, 101325.0f, start), "heartbeat: first value suppressed");
+            expect(!filter(deadband, channel, 101325.0f, start + HeartbeatMs - 1), "heartbeat: recorded early");
+            expect(filter(deadband, channel, 101325.0f, start + HeartbeatMs), "heartbeat: not recorded");
+            expect(!filter(deadband, channel, 101325.0f, start + HeartbeatMs + 1000), "heartbeat: didn't restart");
+        }
+    }
+
+    {
+        // Diagnostics every time, unchanged or not.
+        Deadband deadband;
+        auto channel = NaturalistChannel::DiagCycle;
+        expect(deadband_policy(channel).absolute < 0.0f, "DiagCycle has a deadband");
+        auto all = true;
+        for (uint32_t i = 0; i < 10; ++i) {
+            all = filter(deadband, channel, 2000.0f, 1000 + i * 1000) && all;
+        }
+        expect(all && deadband.channel((size_t)channel).suppressed == 0, "diagnostic suppressed");
+    }
+
+    {
+        // Channels are independent, and ones that aren't there are left alone.
+        Deadband deadband;
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, 20.0f);
+        values.set(NaturalistChannel::Humidity, 50.0f);
+        deadband.filter(values, 1000);
+        values = NaturalistValues{};
+        values.set(NaturalistChannel::Temp1, 20.0f);
+        values.set(NaturalistChannel::Humidity, 60.0f);
+        auto suppressed = deadband.filter(values, 2000);
+        expect(suppressed == 1 && !values.has((size_t)NaturalistChannel::Temp1) &&
+               values.has((size_t)NaturalistChannel::Humidity), "mixed channels");
+        expect(deadband.channel((size_t)NaturalistChannel::Pressure).recorded == 0 &&
+               deadband.channel((size_t)NaturalistChannel::Pressure).suppressed == 0, "missing channel counted");
+    }
+
+    printf("heartbeat:       %us\n", (uint32_t)FK_NATURALIST_HEARTBEAT);
+    printf("deadband:        %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
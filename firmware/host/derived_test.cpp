@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <cmath>
+
+#include "derived.h"
+
+using namespace fk;
+
+/**
+ * Checks the derived metrics against the same formulas evaluated with libm
+ * in double precision, over -40C to 50C, 1% to 100% and 50 to 110kPa, and
+ * against the bounds documented in derived.h.
+ */
+
+static double reference_es(double t) {
+    return 6.1094 * std::exp(17.625 * t / (243.04 + t));
+}
+
+static double reference_dew_point(double t, double rh) {
+    auto gamma = std::log(rh / 100.0) + 17.625 * t / (243.04 + t);
+    return 243.04 * gamma / (17.625 - gamma);
+}
+
+static double reference_absolute_humidity(double t, double rh) {
+    return 216.68 * reference_es(t) * rh / 100.0 / (273.15 + t);
+}
+
+static double reference_heat_index(double c, double rh) {
+    auto t = c * 1.8 + 32.0;
+    auto hi = 0.5 * (t + 61.0 + (t - 68.0) * 1.2 + rh * 0.094);
+    if ((hi + t) / 2.0 >= 80.0) {
+        hi = -42.379 + 2.04901523 * t + 10.14333127 * rh
+            - 0.22475541 * t * rh - 0.00683783 * t * t
+            - 0.05481717 * rh * rh + 0.00122874 * t * t * rh
+            + 0.00085282 * t * rh * rh - 0.00000199 * t * t * rh * rh;
+        if (rh < 13.0 && t >= 80.0 && t <= 112.0) {
+            hi -= ((13.0 - rh) / 4.0) * std::sqrt((17.0 - std::fabs(t - 95.0)) / 17.0);
+        }
+        else if (rh > 85.0 && t >= 80.0 && t <= 87.0) {
+            hi += ((rh - 85.0) / 10.0) * ((87.0 - t) / 5.0);
+        }
+    }
+    return (hi - 32.0) / 1.8;
+}
+
+static double reference_sea_level_pressure(double p, double t, double h) {
+    return p * std::pow(1.0 - 0.0065 * h / (t + 0.0065 * h + 273.15), -5.257);
+}
+
+static double reference_vpd(double t, double rh) {
+    return reference_es(t) * (1.0 - rh / 100.0) / 10.0;
+}
+
+struct Worst {
+    const char *name;
+    double bound;
+    bool relative;
+    double error{ 0.0 };
+    float a{ 0.0f };
+    float b{ 0.0f };
+
+    Worst(const char *name, double bound, bool relative = false) : name(name), bound(bound), relative(relative) {
+    }
+
+    void add(double actual, double expected, float a, float b) {
+        auto e = std::fabs(actual - expected);
+        if (relative) {
+            e /= std::fabs(expected);
+        }
+        if (e > error) {
+            error = e;
+            this->a = a;
+            this->b = b;
+        }
+    }
+
+    bool report() const {
+        auto passed = error <= bound;
+        printf("%-20s %12.3g %12.3g %10.2f %10.2f %s\n", name, error, bound, a, b, passed ? "ok" : "FAILED");
+        return passed;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    Worst dew{ "dew point (C)", 0.001 };
+    Worst absolute{ "abs humidity", 0.00001, true };
+    Worst heat{ "heat index (C)", 0.001 };
+    Worst vpd{ "vpd (kPa)", 0.00005 };
+    Worst slp{ "sea level (Pa)", 0.2 };
+
+    for (auto t = -40.0f; t <= 50.0f; t += 0.25f) {
+        for (auto rh = 1.0f; rh <= 100.0f; rh += 0.5f) {
+            dew.add(dew_point(t, rh), reference_dew_point(t, rh), t, rh);
+            absolute.add(absolute_humidity(t, rh), reference_absolute_humidity(t, rh), t, rh);
+            heat.add(heat_index(t, rh), reference_heat_index(t, rh), t, rh);
+            vpd.add(vapour_pressure_deficit(t, rh), reference_vpd(t, rh), t, rh);
+        }
+        for (auto p = 50000.0f; p <= 110000.0f; p += 500.0f) {
+            for (auto h = 0.0f; h <= 3000.0f; h += 250.0f) {
+                slp.add(sea_level_pressure(p, t, h), reference_sea_level_pressure(p, t, h), p, h);
+            }
+        }
+    }
+
+    printf("%-20s %12s %12s %10s %10s\n", "metric", "error", "bound", "at", "");
+
+    auto passed = true;
+    passed = dew.report() && passed;
+    passed = absolute.report() && passed;
+    passed = heat.report() && passed;
+    passed = vpd.report() && passed;
+    passed = slp.report() && passed;
+
+    return passed ? 0 : 1;
+}
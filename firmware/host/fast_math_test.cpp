@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+
+#include "fast_math.h"
+
+using namespace fk;
+
+/**
+ * Compares fast_math.h against libm over the ranges we use and checks the
+ * error bounds documented there. Timings are for this host, which has an
+ * FPU, so they understate the difference on the SAMD21.
+ */
+
+using Function = float (*)(float);
+
+struct Result {
+    double worst{ 0.0 };
+    float at{ 0.0f };
+    double fastNs{ 0.0 };
+    double libmNs{ 0.0 };
+};
+
+static volatile float sink;
+
+static uint64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+template<typename Fast, typename Reference>
+static Result compare(float low, float high, bool logarithmic, bool relative, size_t n, Fast fast, Reference reference) {
+    Result r;
+    for (size_t i = 0; i < n; ++i) {
+        auto f = (double)i / (n - 1);
+        auto x = logarithmic ? (float)(low * std::pow((double)high / low, f)) : (float)(low + (high - low) * f);
+        auto expected = reference((double)x);
+        auto actual = (double)fast(x);
+        auto error = std::fabs(actual - expected);
+        // Otherwise absolute, until the result is large enough that float
+        // rounding alone is more than that.
+        error /= relative ? std::fabs(expected) : std::max(1.0, std::fabs(expected));
+        if (error > r.worst) {
+            r.worst = error;
+            r.at = x;
+        }
+    }
+
+    constexpr size_t Iterations = 1000000;
+    auto started = now_ns();
+    auto total = 0.0f;
+    for (size_t i = 0; i < Iterations; ++i) {
+        total += fast(low + (high - low) * (i & 1023) / 1024.0f);
+    }
+    r.fastNs = (double)(now_ns() - started) / Iterations;
+    sink = total;
+
+    return r;
+}
+
+template<typename Libm>
+static double time_libm(float low, float high, Libm libm) {
+    constexpr size_t Iterations = 1000000;
+    auto started = now_ns();
+    auto total = 0.0f;
+    for (size_t i = 0; i < Iterations; ++i) {
+        total += libm(low + (high - low) * (i & 1023) / 1024.0f);
+    }
+    sink = total;
+    return (double)(now_ns() - started) / Iterations;
+}
+
+static auto failures = 0;
+
+static void report(const char *name, Result r, double libmNs, double bound) {
+    auto passed = r.worst <= bound;
+    printf("%-18s %12.3g %12.3g %10g %8.2f %8.2f %s\n", name, r.worst, bound, r.at, r.fastNs, libmNs, passed ? "ok" : "FAILED");
+    if (!passed) {
+        failures++;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    constexpr size_t N = 1000000;
+
+    printf("%-18s %12s %12s %10s %8s %8s\n", "function", "error", "bound", "at", "fast ns", "libm ns");
+
+    report("log2f", compare(1e-30f, 1e30f, true, false, N, fast_log2f, [](double x) { return std::log2(x); }),
+           time_libm(1e-30f, 1e30f, [](float x) { return log2f(x); }), 2e-7);
+
+    report("log10f", compare(1e-30f, 1e30f, true, false, N, fast_log10f, [](double x) { return std::log10(x); }),
+           time_libm(1e-30f, 1e30f, [](float x) { return log10f(x); }), 2e-7);
+
+    // Near 1 the absolute error is what matters, these are the dBFS of audio.
+    report("dbf", compare(1e-6f, 1.0f, true, false, N, fast_dbf, [](double x) { return 20.0 * std::log10(x); }),
+           time_libm(1e-6f, 1.0f, [](float x) { return 20.0f * log10f(x); }), 1e-6);
+
+    report("exp2f", compare(-126.0f, 127.0f, false, true, N, fast_exp2f, [](double x) { return std::exp2(x); }),
+           time_libm(-126.0f, 127.0f, [](float x) { return exp2f(x); }), 4e-7);
+
+    // The barometric formula, (p / p0)^0.19 over anywhere we'll deploy.
+    auto altitude = [](float x) { return fast_powf(x, 0.1902632f); };
+    report("powf altitude", compare(0.3f, 1.2f, false, true, N, altitude, [](double x) { return std::pow(x, 0.1902632); }),
+           time_libm(0.3f, 1.2f, [](float x) { return powf(x, 0.1902632f); }), 4e-7 + 2e-7 * 0.33);
+
+    auto cube = [](float x) { return fast_powf(x, 3.0f); };
+    report("powf cube", compare(1e-3f, 1e3f, true, true, N, cube, [](double x) { return x * x * x; }),
+           time_libm(1e-3f, 1e3f, [](float x) { return powf(x, 3.0f); }), 4e-7 + 2e-7 * 30);
+
+    report("sqrtf", compare(1e-30f, 1e30f, true, true, N, fast_sqrtf, [](double x) { return std::sqrt(x); }),
+           time_libm(1e-30f, 1e30f, [](float x) { return sqrtf(x); }), 3e-7);
+
+    auto edges = 0;
+    edges += fast_log2f(0.0f) != -INFINITY;
+    edges += !std::isnan(fast_log2f(-1.0f));
+    edges += fast_log2f(INFINITY) != INFINITY;
+    edges += fast_log2f(1.0f) != 0.0f;
+    edges += fast_exp2f(0.0f) != 1.0f;
+    edges += fast_exp2f(200.0f) != INFINITY;
+    edges += fast_exp2f(-200.0f) != 0.0f;
+    edges += fast_powf(0.0f, 2.0f) != 0.0f;
+    edges += fast_powf(5.0f, 0.0f) != 1.0f;
+    edges += fast_sqrtf(0.0f) != 0.0f;
+    edges += !std::isnan(fast_sqrtf(-1.0f));
+    edges += fast_sqrtf(INFINITY) != INFINITY;
+    printf("edge cases:        %s\n", edges == 0 ? "ok" : "FAILED");
+
+    return failures == 0 && edges == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <cstring>
+
+#include <SerialFlash.h>
+
+#include "flash_layout.h"
+#include "calibration.h"
+#include "hardware.h"
+#include "simulation.h"
+
+using namespace fk;
+
+/**
+ * Lays the regions out for the erase blocks and capacities of the parts in
+ * flash_parts.cpp and checks each is whole blocks, on the chip and clear of
+ * the others, and that the small parts still get what they have room for.
+ * Then, on a part with 256K blocks, erases the upload cursor's
+ * block as SeriesUpload::save() does when its slots fill and checks the
+ * calibration table is still there.
+ */
+
+constexpr uint32_t K = 1024;
+constexpr uint32_t M = 1024 * 1024;
+
+static uint32_t check(uint32_t capacity, uint32_t blockSize) {
+    uint32_t failures = 0;
+    FlashExtent extents[NumberOfFlashRegions];
+    bool placed[NumberOfFlashRegions];
+
+    for (size_t i = 0; i < NumberOfFlashRegions; ++i) {
+        auto &e = extents[i];
+        placed[i] = flash_layout(capacity, blockSize, (FlashRegion)i, e);
+        if (!placed[i]) {
+            continue;
+        }
+        if (e.start % blockSize != 0 || e.size % blockSize != 0 || e.size == 0 || e.end() > capacity) {
+            fprintf(stderr, "%uK/%uK: %s at 0x%x (%u bytes)\n", capacity / K, blockSize / K,
+                    flash_region_name((FlashRegion)i), e.start, e.size);
+            failures++;
+        }
+    }
+
+    for (size_t i = 0; i < NumberOfFlashRegions; ++i) {
+        for (size_t j = i + 1; j < NumberOfFlashRegions; ++j) {
+            if (placed[i] && placed[j] && extents[i].start < extents[j].end() && extents[j].start < extents[i].end()) {
+                fprintf(stderr, "%uK/%uK: %s overlaps %s\n", capacity / K, blockSize / K,
+                        flash_region_name((FlashRegion)i), flash_region_name((FlashRegion)j));
+                failures++;
+            }
+        }
+    }
+
+    for (auto region : { FlashRegion::Calibration, FlashRegion::UploadCursor }) {
+        auto &e = extents[(size_t)region];
+        if (placed[(size_t)region] && e.size != blockSize) {
+            fprintf(stderr, "%uK/%uK: %s is %u bytes\n", capacity / K, blockSize / K, flash_region_name(region), e.size);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t failures = 0;
+
+    for (auto blockSize : { 4 * K, 64 * K, 256 * K }) {
+        for (auto capacity : { 128 * K, 256 * K, 512 * K, 1 * M, 2 * M, 4 * M, 8 * M, 16 * M, 32 * M, 64 * M, 128 * M }) {
+            failures += check(capacity, blockSize);
+        }
+    }
+
+    {
+        // The SST25WF010, only room for a block each of calibration and cursor.
+        FlashExtent e;
+        if (!flash_layout(128 * K, 64 * K, FlashRegion::Calibration, e) ||
+            !flash_layout(128 * K, 64 * K, FlashRegion::UploadCursor, e) ||
+            flash_layout(128 * K, 64 * K, FlashRegion::Series, e) || flash_layout(128 * K, 64 * K, FlashRegion::Trace, e)) {
+            fprintf(stderr, "128K: placed a region that doesn't fit\n");
+            failures++;
+        }
+
+        // The W25Q16, the series gets what's left and the trace nothing.
+        if (!flash_layout(2 * M, 64 * K, FlashRegion::Series, e) || e.size != 2 * M - 128 * K ||
+            flash_layout(2 * M, 64 * K, FlashRegion::Trace, e)) {
+            fprintf(stderr, "2M: series is %u bytes\n", e.size);
+            failures++;
+        }
+
+        // Anything bigger than the regions has all of them, as asked for.
+        if (!flash_layout(8 * M, 64 * K, FlashRegion::Series, e) || e.size != FK_NATURALIST_SERIES_SIZE ||
+            !flash_layout(8 * M, 64 * K, FlashRegion::Trace, e) || e.size != FK_NATURALIST_TRACE_SIZE) {
+            fprintf(stderr, "8M: trace is %u bytes\n", e.size);
+            failures++;
+        }
+    }
+
+    {
+        sim::simulation.flash.blockSize = 256 * K;
+
+        Wire.begin();
+        SerialFlash.begin(Hardware::FLASH_PIN_CS);
+
+        uint8_t id[MacEepromIdSize];
+        MacEeprom eeprom;
+        eeprom.read128bMac(id);
+
+        CalibrationEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.id, id, sizeof(entry.id));
+        entry.channel = (uint8_t)NaturalistChannel::Temp1;
+        entry.kind = CalibrationKind::Polynomial;
+        entry.size = 2;
+        entry.terms[1] = 1.0f;
+        if (!Calibration::write(&entry, 1)) {
+            fprintf(stderr, "write failed\n");
+            return 1;
+        }
+
+        FlashExtent cursor;
+        flash_region(FlashRegion::UploadCursor, cursor);
+        SerialFlash.eraseBlock(cursor.start);
+
+        Calibration calibration;
+        if (!calibration.begin() || calibration.size() != 1) {
+            fprintf(stderr, "erasing the cursor wiped the calibration\n");
+            failures++;
+        }
+
+        printf("%-16s %10s %10s\n", "region (256K)", "start", "size");
+        for (size_t i = 0; i < NumberOfFlashRegions; ++i) {
+            FlashExtent e;
+            if (flash_region((FlashRegion)i, e)) {
+                printf("%-16s %#10x %10u\n", flash_region_name((FlashRegion)i), e.start, e.size);
+            }
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#ifndef FK_HOST_ADAFRUIT_BNO055_H_INCLUDED
+#define FK_HOST_ADAFRUIT_BNO055_H_INCLUDED
+
+#include <Adafruit_Sensor.h>
+#include <Wire.h>
+
+#define BNO055_ADDRESS_A 0x28
+#define BNO055_ADDRESS_B 0x29
+
+class Adafruit_BNO055 {
+private:
+    TwoWire *wire_;
+
+public:
+    Adafruit_BNO055(int32_t sensorId, uint8_t address, TwoWire *wire) : wire_(wire) {
+    }
+
+public:
+    bool begin();
+    void setExtCrystalUse(bool use);
+    void getCalibration(uint8_t *system, uint8_t *gyro, uint8_t *accel, uint8_t *mag);
+    bool getEvent(sensors_event_t *event);
+
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef FK_HOST_ADAFRUIT_MPL3115A2_H_INCLUDED
+#define FK_HOST_ADAFRUIT_MPL3115A2_H_INCLUDED
+
+#include <Wire.h>
+
+#define MPL3115A2_ADDRESS 0x60
+
+class Adafruit_MPL3115A2 {
+public:
+    bool begin();
+    float getPressure();
+    float getAltitude();
+    float getTemperature();
+
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef FK_HOST_ADAFRUIT_SHT31_H_INCLUDED
+#define FK_HOST_ADAFRUIT_SHT31_H_INCLUDED
+
+#include <Wire.h>
+
+#define SHT31_DEFAULT_ADDR 0x44
+
+class Adafruit_SHT31 {
+public:
+    bool begin(uint8_t address = SHT31_DEFAULT_ADDR);
+    float readTemperature();
+    float readHumidity();
+
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef FK_HOST_ADAFRUIT_SENSOR_H_INCLUDED
+#define FK_HOST_ADAFRUIT_SENSOR_H_INCLUDED
+
+#include <Arduino.h>
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+} sensors_vec_t;
+
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t reserved0;
+    int32_t timestamp;
+    sensors_vec_t orientation;
+} sensors_event_t;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef FK_HOST_ADAFRUIT_TSL2561_U_H_INCLUDED
+#define FK_HOST_ADAFRUIT_TSL2561_U_H_INCLUDED
+
+#include <Adafruit_Sensor.h>
+
+#endif
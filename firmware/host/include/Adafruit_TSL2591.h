@@ -0,0 +1,21 @@
+#ifndef FK_HOST_ADAFRUIT_TSL2591_H_INCLUDED
+#define FK_HOST_ADAFRUIT_TSL2591_H_INCLUDED
+
+#include <Adafruit_Sensor.h>
+#include <Wire.h>
+
+#define TSL2591_ADDR 0x29
+
+class Adafruit_TSL2591 {
+public:
+    Adafruit_TSL2591(int32_t sensorId) {
+    }
+
+public:
+    bool begin();
+    uint32_t getFullLuminosity();
+    float calculateLux(uint16_t ch0, uint16_t ch1);
+
+};
+
+#endif
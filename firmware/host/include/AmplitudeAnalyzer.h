@@ -0,0 +1,22 @@
+#ifndef FK_HOST_AMPLITUDE_ANALYZER_H_INCLUDED
+#define FK_HOST_AMPLITUDE_ANALYZER_H_INCLUDED
+
+#include <AudioAnalyzer.h>
+
+/**
+ * Produces one RMS amplitude per block of samples from the simulated
+ * SPH0645, blocks become available as simulated time passes.
+ */
+class AmplitudeAnalyzer : public AudioAnalyzer {
+private:
+    bool configured_{ false };
+    uint64_t next_{ 0 };
+
+public:
+    bool input(AudioIn &input);
+    bool available();
+    float read();
+
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef FK_HOST_ARDUINO_H_INCLUDED
+#define FK_HOST_ARDUINO_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <cinttypes>
+#include <algorithm>
+
+#define F_CPU 48000000L
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define PIN_WIRE_SDA 20
+#define PIN_WIRE_SCL 21
+
+using boolean = bool;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+
+void randomSeed(uint32_t seed);
+
+class Uart {
+private:
+    bool gps_{ false };
+    uint64_t position_{ 0 };
+
+public:
+    Uart(bool gps = false) : gps_(gps) {
+    }
+
+public:
+    void begin(uint32_t baud) {
+    }
+
+    void end() {
+    }
+
+    int available();
+    int read();
+
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t println(const char *s = "");
+
+    explicit operator bool() const {
+        return true;
+    }
+
+};
+
+extern Uart Serial;
+extern Uart Serial2;
+extern Uart Serial5;
+
+#endif
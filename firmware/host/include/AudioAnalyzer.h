@@ -0,0 +1,13 @@
+#ifndef FK_HOST_AUDIO_ANALYZER_H_INCLUDED
+#define FK_HOST_AUDIO_ANALYZER_H_INCLUDED
+
+#include <AudioIn.h>
+
+class AudioAnalyzer {
+public:
+    virtual ~AudioAnalyzer() {
+    }
+
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef FK_HOST_AUDIO_IN_H_INCLUDED
+#define FK_HOST_AUDIO_IN_H_INCLUDED
+
+#include <Arduino.h>
+
+class AudioIn {
+public:
+    virtual ~AudioIn() {
+    }
+
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef FK_HOST_AUDIO_IN_I2S_H_INCLUDED
+#define FK_HOST_AUDIO_IN_I2S_H_INCLUDED
+
+#include <AudioIn.h>
+
+class AudioInI2SClass : public AudioIn {
+public:
+    bool begin(long sampleRate, int bitsPerSample);
+
+};
+
+extern AudioInI2SClass AudioInI2S;
+
+#endif
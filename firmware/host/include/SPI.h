@@ -0,0 +1,41 @@
+#ifndef FK_HOST_SPI_H_INCLUDED
+#define FK_HOST_SPI_H_INCLUDED
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0x02
+
+class SPISettings {
+public:
+    SPISettings() {
+    }
+
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {
+    }
+};
+
+/**
+ * Bytes go to whichever simulated device has its chip select low, see
+ * digitalWrite. Each call costs simulation.bus.spiCall on top of the time on
+ * the wire, so byte at a time transfers are slower than buffered ones.
+ */
+class SPIClass {
+public:
+    void begin() {
+    }
+
+    void beginTransaction(SPISettings settings) {
+    }
+
+    void endTransaction() {
+    }
+
+    uint8_t transfer(uint8_t data);
+    void transfer(void *buffer, size_t size);
+
+};
+
+extern SPIClass SPI;
+
+#endif
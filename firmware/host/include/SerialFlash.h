@@ -0,0 +1,52 @@
+#ifndef FK_HOST_SERIAL_FLASH_H_INCLUDED
+#define FK_HOST_SERIAL_FLASH_H_INCLUDED
+
+#include <Arduino.h>
+
+/**
+ * An in memory W25Q64FV. Erases run in the background like the real part,
+ * anything but ready() waits for them to finish. The capacity can be set,
+ * flash.capacity, and the ID is the W25Q of that size. As can the block
+ * size, flash.blockSize, for the parts that erase more at once.
+ *
+ * The part also answers raw SPI, see SPI.h, for code that talks to it
+ * directly. Commands sent while it's busy are ignored, as on the real part.
+ */
+class SerialFlashChip {
+private:
+    uint8_t *memory_{ nullptr };
+    uint32_t capacity_{ 0 };
+    uint64_t busyUntil_{ 0 };
+    bool selected_{ false };
+    bool writeEnabled_{ false };
+    uint8_t command_{ 0 };
+    uint32_t position_{ 0 };
+    uint32_t address_{ 0 };
+
+public:
+    bool begin(uint8_t cs);
+    void readID(uint8_t *buffer);
+    uint32_t capacity(const uint8_t *id);
+    uint32_t blockSize();
+    void eraseAll();
+    void eraseBlock(uint32_t address);
+    bool ready();
+    void read(uint32_t address, void *buffer, uint32_t length);
+    void write(uint32_t address, const void *buffer, uint32_t length);
+
+public:
+    /* Direct access for host tools, doesn't take any simulated time. */
+    const uint8_t *memory();
+
+    /* Chip select and SPI.transfer, from the HAL. */
+    void select(bool selected);
+    uint8_t transfer(uint8_t data);
+
+private:
+    void wait();
+
+};
+
+extern SerialFlashChip SerialFlash;
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef FK_HOST_WIRE_H_INCLUDED
+#define FK_HOST_WIRE_H_INCLUDED
+
+#include <Arduino.h>
+
+/**
+ * Tracks which simulated devices answer on the bus and hands transactions
+ * to the register models of the parts the firmware reads split phase, see
+ * devices.h. The rest are simulated above this, at the driver. Writes to a
+ * TCA9548A select which board's devices answer.
+ */
+class TwoWire {
+private:
+    uint8_t bus_;
+    uint8_t address_{ 0 };
+    uint8_t channels_{ 0 };
+    uint8_t tx_[32];
+    size_t txSize_{ 0 };
+    uint8_t rx_[32];
+    size_t rxSize_{ 0 };
+    size_t rxPosition_{ 0 };
+
+public:
+    TwoWire(uint8_t bus) : bus_(bus) {
+    }
+
+public:
+    uint8_t bus() const {
+        return bus_;
+    }
+
+    /* Board the mux has selected, the first if none. */
+    uint8_t board() const;
+
+    void begin();
+    void end();
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, size_t quantity, bool stop = true);
+    size_t write(uint8_t data);
+    int available();
+    int read();
+
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire4and3;
+
+#endif
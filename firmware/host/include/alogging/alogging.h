@@ -0,0 +1,44 @@
+#ifndef FK_HOST_ALOGGING_H_INCLUDED
+#define FK_HOST_ALOGGING_H_INCLUDED
+
+#include <Arduino.h>
+
+void log_message(const char *facility, const char *f, ...);
+
+bool log_verbose();
+
+void log_verbose(bool verbose);
+
+void log_uart_set(Uart &uart);
+
+template<const char *FacilityName>
+class SimpleLog {
+public:
+    template<typename... Args>
+    static void log(const char *f, Args... args) {
+        log_message(FacilityName, f, args...);
+    }
+
+    template<typename... Args>
+    static void info(const char *f, Args... args) {
+        log_message(FacilityName, f, args...);
+    }
+
+    template<typename... Args>
+    static void trace(const char *f, Args... args) {
+        log_message(FacilityName, f, args...);
+    }
+
+    template<typename... Args>
+    static void warn(const char *f, Args... args) {
+        log_message(FacilityName, f, args...);
+    }
+
+    template<typename... Args>
+    static void error(const char *f, Args... args) {
+        log_message(FacilityName, f, args...);
+    }
+
+};
+
+#endif
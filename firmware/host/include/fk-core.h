@@ -0,0 +1,11 @@
+#ifndef FK_HOST_FK_CORE_H_INCLUDED
+#define FK_HOST_FK_CORE_H_INCLUDED
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include <alogging/alogging.h>
+
+#include "simulated_core.h"
+
+#endif
@@ -0,0 +1,414 @@
+#ifndef FK_HOST_SIMULATED_CORE_H_INCLUDED
+#define FK_HOST_SIMULATED_CORE_H_INCLUDED
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SerialFlash.h>
+
+/**
+ * Just enough of firmware-common for the naturalist firmware and checks to
+ * compile and run on a host.
+ */
+
+namespace fk {
+
+uint32_t fk_uptime();
+
+enum class TaskEvalState {
+    Idle,
+    Done,
+    Error,
+};
+
+class TaskEval {
+private:
+    TaskEvalState state_;
+
+    TaskEval(TaskEvalState state) : state_(state) {
+    }
+
+public:
+    static TaskEval idle() {
+        return TaskEval{ TaskEvalState::Idle };
+    }
+
+    static TaskEval done() {
+        return TaskEval{ TaskEvalState::Done };
+    }
+
+    static TaskEval error() {
+        return TaskEval{ TaskEvalState::Error };
+    }
+
+    bool isIdle() const {
+        return state_ == TaskEvalState::Idle;
+    }
+
+};
+
+inline bool is_task_running(TaskEval e) {
+    return e.isIdle();
+}
+
+struct SensorInfo {
+    const char *name;
+    const char *unitOfMeasure;
+};
+
+struct SensorReading {
+    uint32_t time;
+    float value;
+    bool available;
+};
+
+/* From fk-module.pb.h, the only type we are. */
+constexpr uint32_t fk_module_ModuleType_SENSOR = 0;
+
+struct ModuleInfo {
+    uint32_t type;
+    uint8_t address;
+    uint8_t numberOfSensors;
+    uint8_t minimumNumberOfReadings;
+    const char *name;
+    const char *module;
+    SensorInfo *sensors;
+    SensorReading *readings;
+};
+
+struct IncomingSensorReading {
+    uint8_t sensor;
+    uint32_t time;
+    float value;
+};
+
+class CoreState {
+private:
+    static constexpr size_t MaximumModules = 4;
+    ModuleInfo *modules_[MaximumModules] = { nullptr };
+    uint32_t merged_{ 0 };
+
+public:
+    void configure(ModuleInfo &module);
+    ModuleInfo *getModule(uint8_t address);
+    void merge(ModuleInfo &module, IncomingSensorReading &reading);
+
+    uint32_t merged() const {
+        return merged_;
+    }
+
+};
+
+class Clock {
+public:
+    void begin() {
+    }
+
+    uint32_t getTime();
+
+};
+
+extern Clock clock;
+
+class SimpleNTP {
+public:
+    SimpleNTP(Clock &clock) {
+    }
+
+public:
+    void enqueued();
+    bool run();
+
+};
+
+template<typename T>
+bool simple_task_run(T &task) {
+    return task.run();
+}
+
+class Leds {
+public:
+    void setup() {
+    }
+
+    void task() {
+    }
+
+    void off() {
+    }
+
+    void notifyHappy() {
+    }
+
+    void notifyFatal() {
+    }
+
+    void notifyCaution() {
+    }
+
+    void notifyReadingsBegin() {
+    }
+
+    void notifyReadingsDone() {
+    }
+
+};
+
+struct MainServices {
+    Leds *leds;
+    CoreState *state;
+
+    void alive() {
+    }
+};
+
+class MainServicesState {
+private:
+    static MainServices *services_;
+
+public:
+    virtual ~MainServicesState() {
+    }
+
+public:
+    virtual const char *name() const = 0;
+    virtual void task() = 0;
+
+public:
+    static void services(MainServices *services) {
+        services_ = services;
+    }
+
+    MainServices &services() {
+        return *services_;
+    }
+
+    void resume() {
+    }
+
+};
+
+struct Hardware {
+    static constexpr uint8_t PERIPHERALS_ENABLE_PIN = 25;
+    static constexpr uint8_t FLASH_PIN_CS = 26;
+    static constexpr uint8_t WIFI_PIN_CS = 7;
+    static constexpr uint8_t WIFI_PIN_IRQ = 16;
+    static constexpr uint8_t WIFI_PIN_RST = 15;
+    static constexpr uint8_t WIFI_PIN_EN = 38;
+    static constexpr uint8_t RFM95_PIN_CS = 5;
+    static constexpr uint8_t RFM95_PIN_D0 = 2;
+    static constexpr uint8_t SD_PIN_CS = 12;
+    static constexpr uint8_t GPS_ENABLE_PIN = 8;
+    static constexpr uint8_t MODULES_ENABLE_PIN = 9;
+
+    static void enableModules() {
+    }
+};
+
+struct CoreBoardConfig {
+    struct {
+        uint8_t peripherals_enable;
+        uint8_t flash_cs;
+        uint8_t spi_cs[4];
+        uint8_t enables[4];
+    } spi;
+    uint8_t sd_cs;
+    uint8_t wifi_cs;
+    uint8_t wifi_enable;
+    uint8_t gps_enable;
+    uint8_t modules_enable;
+};
+
+class CoreBoard {
+public:
+    CoreBoard(CoreBoardConfig config) {
+    }
+
+public:
+    void disable_everything() {
+    }
+
+    void enable_everything() {
+    }
+
+    void enable_spi() {
+    }
+
+    void disable_spi() {
+    }
+
+    void enable_gps() {
+    }
+
+    void disable_gps() {
+    }
+
+    void enable_wifi() {
+    }
+
+    void disable_wifi() {
+    }
+
+};
+
+class TwoWireBus {
+private:
+    TwoWire *bus_;
+
+public:
+    TwoWireBus(TwoWire &bus) : bus_(&bus) {
+    }
+
+public:
+    bool begin() {
+        bus_->begin();
+        return true;
+    }
+
+    TwoWire *twoWire() {
+        return bus_;
+    }
+
+};
+
+class SerialPort {
+public:
+    SerialPort(Uart &uart) {
+    }
+
+public:
+    void begin(uint32_t baud) {
+    }
+
+};
+
+struct BatteryReading {
+    float voltage;
+    float ma;
+    float coulombs;
+    uint32_t counter;
+};
+
+class BatteryGauge {
+public:
+    bool available();
+    BatteryReading read();
+
+};
+
+#define WL_NO_SHIELD 255
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+
+class WiFiClass {
+private:
+    bool associated_{ false };
+
+public:
+    void setPins(int8_t cs, int8_t irq, int8_t rst) {
+    }
+
+    uint8_t status() {
+        return associated_ ? WL_CONNECTED : WL_IDLE_STATUS;
+    }
+
+    const char *firmwareVersion() {
+        return "19.5.2";
+    }
+
+    uint8_t begin(const char *ssid, const char *password);
+
+    void end() {
+        associated_ = false;
+    }
+
+};
+
+extern WiFiClass WiFi;
+
+/**
+ * A TCP connection through the simulated module, see sim::WifiModel. Only
+ * speaks enough HTTP to hand each request with a Content-Length to the
+ * simulated server and queue its response.
+ */
+class WiFiClient {
+private:
+    uint8_t *request_{ nullptr };
+    size_t size_{ 0 };
+    size_t capacity_{ 0 };
+    char response_[64];
+    size_t responseSize_{ 0 };
+    size_t responsePosition_{ 0 };
+    uint64_t respondAt_{ 0 };
+    bool connected_{ false };
+
+public:
+    ~WiFiClient();
+
+public:
+    int connect(const char *host, uint16_t port);
+    size_t write(const uint8_t *buffer, size_t size);
+    int available();
+    int read();
+    void stop();
+    uint8_t connected();
+
+private:
+    void respond();
+
+};
+
+class RTC_PCF8523 {
+public:
+    bool begin() {
+        return true;
+    }
+
+};
+
+}
+
+namespace phylum {
+
+using block_index_t = uint32_t;
+
+struct Geometry {
+    block_index_t number_of_blocks{ 0 };
+    uint16_t pages_per_block{ 0 };
+    uint16_t sectors_per_page{ 0 };
+    uint16_t sector_size{ 0 };
+};
+
+struct BlockAddress {
+    block_index_t block;
+    uint32_t position;
+
+    BlockAddress(block_index_t block = 0, uint32_t position = 0) : block(block), position(position) {
+    }
+};
+
+/**
+ * An in memory card, see SdModel. Writes smaller than a sector cost a read
+ * and a write of the whole sector, as they do over SPI.
+ */
+class ArduinoSdBackend {
+private:
+    Geometry geometry_;
+
+public:
+    bool initialize(const Geometry &g, uint8_t cs);
+    bool open();
+    bool close();
+    Geometry &geometry();
+    size_t size();
+    bool erase(block_index_t block);
+    bool read(BlockAddress addr, void *d, size_t n);
+    bool write(BlockAddress addr, void *d, size_t n);
+
+private:
+    uint8_t *at(BlockAddress addr, size_t n);
+
+};
+
+}
+
+#endif
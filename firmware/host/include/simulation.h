@@ -0,0 +1,266 @@
+#ifndef FK_HOST_SIMULATION_H_INCLUDED
+#define FK_HOST_SIMULATION_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+namespace sim {
+
+/**
+ * Simulated time in microseconds. Only advances when the firmware waits on
+ * something: delays, bus transactions, conversions and polling.
+ */
+class Clock {
+private:
+    static uint64_t now_;
+
+public:
+    static uint64_t now() {
+        return now_;
+    }
+
+    static void advance(uint64_t us) {
+        now_ += us;
+    }
+
+    static void advanceTo(uint64_t us) {
+        if (us > now_) {
+            now_ = us;
+        }
+    }
+
+    static void reset() {
+        now_ = 0;
+    }
+
+};
+
+/**
+ * offset + amplitude * sin(2pi t / period) + uniform noise, t in seconds.
+ * Event is added for eventFor seconds from eventAt, for sudden changes.
+ */
+struct Waveform {
+    float offset;
+    float amplitude;
+    float period;
+    float noise;
+    float event{ 0.0f };
+    float eventAt{ 0.0f };
+    float eventFor{ 0.0f };
+
+    Waveform(float offset = 0.0f, float amplitude = 0.0f, float period = 86400.0f, float noise = 0.0f)
+        : offset(offset), amplitude(amplitude), period(period), noise(noise) {
+    }
+
+    float at(uint64_t us) const;
+};
+
+enum class Device : uint8_t {
+    Sph0645,
+    Sht31,
+    Mpl3115a2,
+    Tsl2591,
+    Bno055,
+};
+
+/**
+ * Supplies recorded results in place of the models, see replay.cpp. Each
+ * returns false when it has nothing for that call.
+ */
+class Playback {
+public:
+    virtual bool begin(Device device, bool &ok) = 0;
+    virtual bool probe(uint8_t bus, uint8_t address, bool &ack) = 0;
+    virtual bool sht31(float &temperature, float &humidity) = 0;
+    virtual bool mpl3115a2(float &pressure, float &altitude, float &temperature) = 0;
+    virtual bool tsl2591(uint32_t &fullLuminosity) = 0;
+    virtual bool bno055(uint8_t *calibration, float *orientation) = 0;
+    virtual bool audio(float &amplitude) = 0;
+
+};
+
+struct SensorModel {
+    bool present{ true };
+    /* Simulated duration of a single measurement, in microseconds. */
+    uint32_t latency{ 0 };
+    /* From starting a conversion to its result, for parts read split phase. */
+    uint32_t conversion{ 0 };
+    /* Probability that a measurement fails. */
+    float failureRate{ 0.0f };
+
+    bool fails() const;
+};
+
+struct Sht31Model : SensorModel {
+    Waveform temperature{ 20.0f, 5.0f, 86400.0f, 0.05f };
+    Waveform humidity{ 55.0f, 15.0f, 86400.0f, 0.2f };
+};
+
+struct Mpl3115a2Model : SensorModel {
+    Waveform pressure{ 101325.0f, 300.0f, 43200.0f, 2.0f };
+    Waveform temperature{ 21.0f, 5.0f, 86400.0f, 0.05f };
+};
+
+struct Tsl2591Model : SensorModel {
+    Waveform full{ 20000.0f, 20000.0f, 86400.0f, 50.0f };
+    Waveform ir{ 6000.0f, 6000.0f, 86400.0f, 20.0f };
+};
+
+struct Bno055Model : SensorModel {
+    Waveform x{ 90.0f, 0.0f, 3600.0f, 0.1f };
+    Waveform y{ 0.0f, 0.0f, 3600.0f, 0.1f };
+    Waveform z{ 0.0f, 0.0f, 3600.0f, 0.1f };
+    uint8_t calibration{ 3 };
+};
+
+struct Sph0645Model : SensorModel {
+    uint32_t sampleRate{ 8000 };
+    uint32_t samplesPerBlock{ 128 };
+    /* RMS amplitude of each block, full scale is 1.0. */
+    Waveform rms{ 0.01f, 0.005f, 60.0f, 0.002f };
+    /* Probability that a block is dropped and reads as zero. */
+    float dropRate{ 0.0f };
+};
+
+struct GpsModel {
+    bool present{ true };
+    /* Time from power on to the first NMEA sentence. */
+    uint32_t startup{ 1000000 };
+};
+
+struct GaugeModel {
+    bool present{ true };
+    float voltage{ 3900.0f };
+    /* Current drawn while awake, in mA. */
+    float current{ 45.0f };
+};
+
+struct MacEepromModel {
+    /* The last four bytes of the EUI-64, after Microchip's OUI. */
+    uint32_t serial{ 0x0b5e1a1d };
+};
+
+struct FlashModel {
+    /* A power of two, as the ID only has room for its log2. */
+    uint32_t capacity{ 8 * 1024 * 1024 };
+    /* What eraseBlock() erases, 256K like an S25FL512S or 64K. */
+    uint32_t blockSize{ 64 * 1024 };
+    /* Command and address overhead of a transaction. */
+    uint32_t command{ 2 };
+    /* Transfer time per byte, 8 clocks at 24MHz. */
+    uint32_t byteNanoseconds{ 333 };
+    uint32_t pageProgram{ 700 };
+    uint32_t sectorErase{ 45 * 1000 };
+    uint32_t blockErase{ 150 * 1000 };
+    /* Milliseconds. */
+    uint32_t chipErase{ 20 * 1000 };
+};
+
+struct SdModel {
+    bool present{ true };
+    uint32_t numberOfBlocks{ 256 };
+    /* Command and response overhead of each sector, in microseconds. */
+    uint32_t command{ 150 };
+    /* Transfer time per byte, 8 clocks at 12MHz. */
+    uint32_t byteNanoseconds{ 667 };
+    /* Card busy after each sector write. */
+    uint32_t writeBusy{ 400 };
+    /* Probability that a write stalls while the card tidies up. */
+    float stallRate{ 0.002f };
+    uint32_t stall{ 80 * 1000 };
+};
+
+/**
+ * Answers HTTP requests sent through WiFiClient, with a status code.
+ */
+class Server {
+public:
+    virtual uint16_t request(const char *path, const uint8_t *body, size_t size) = 0;
+
+};
+
+/**
+ * The ATWINC1500 and the network behind it. Every WiFiClient call is a
+ * command over SPI to the module before any of its bytes move.
+ */
+struct WifiModel {
+    bool present{ true };
+    /* Association and DHCP, in ms. */
+    uint32_t associate{ 3000 };
+    /* TCP connect, in microseconds. */
+    uint32_t connect{ 60 * 1000 };
+    /* Command overhead of each write, and time per byte once it's going. */
+    uint32_t write{ 1500 };
+    uint32_t byteNanoseconds{ 6000 };
+    /* From the end of a request to the start of the response. */
+    uint32_t roundTrip{ 40 * 1000 };
+    /* Probability the connection drops during a write. */
+    float dropRate{ 0.0f };
+    /* Without one every request gets a 200. */
+    Server *server{ nullptr };
+};
+
+struct LoraModel {
+    bool present{ true };
+    /* Probability that a frame, or its ack, is lost. */
+    float lossRate{ 0.1f };
+    /* From the end of a frame to the receiver's ack going out. */
+    uint32_t turnaround{ 50 * 1000 };
+};
+
+struct RtcModel {
+    /* How far into its second the RTC is when the simulation starts. */
+    uint32_t phase{ 0 };
+    /* How much faster than uptime the RTC runs, in parts per million. */
+    float drift{ 0.0f };
+};
+
+struct BusModel {
+    /* Duration of a short I2C transaction (address + a few bytes). */
+    uint32_t i2cTransaction{ 120 };
+    /* Time consumed by each call that polls the time or a peripheral. */
+    uint32_t pollQuantum{ 10 };
+    /* Call overhead of each SPI.transfer, in nanoseconds. */
+    uint32_t spiCall{ 1000 };
+};
+
+struct Simulation {
+    Sht31Model sht31;
+    Mpl3115a2Model mpl3115a2;
+    Tsl2591Model tsl2591;
+    Bno055Model bno055;
+    Sph0645Model sph0645;
+    GpsModel gps;
+    GaugeModel gauge;
+    MacEepromModel mac;
+    FlashModel flash;
+    SdModel sd;
+    LoraModel lora;
+    WifiModel wifi;
+    RtcModel rtc;
+    BusModel bus;
+    /* Sensor boards, those after the first behind a TCA9548A. */
+    uint32_t boards{ 1 };
+    uint64_t seed{ 0x2545F4914F6CDD1DULL };
+    Playback *playback{ nullptr };
+
+    Simulation();
+
+    /* Uniform in [0, 1). Deterministic for a given seed. */
+    float random();
+
+    /* Board is the one the mux has selected, sensors beyond boards are missing. */
+    bool present(uint8_t bus, uint8_t address, uint8_t board = 0) const;
+
+    void reset();
+};
+
+extern Simulation simulation;
+
+}
+
+}
+
+#endif
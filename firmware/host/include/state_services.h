@@ -0,0 +1,6 @@
+#ifndef FK_HOST_STATE_SERVICES_H_INCLUDED
+#define FK_HOST_STATE_SERVICES_H_INCLUDED
+
+#include "fk-core.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef FK_HOST_TWO_WIRE_H_INCLUDED
+#define FK_HOST_TWO_WIRE_H_INCLUDED
+
+#include "fk-core.h"
+
+#endif
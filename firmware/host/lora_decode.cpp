@@ -0,0 +1,91 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include "lora_frame.h"
+#include "derived.h"
+
+using namespace fk;
+
+/**
+ * Decodes LoRa frames one per line, either bare hex as a receiver would log
+ * them or the "frame" lines the uplink logs, and prints their values with
+ * the derived channels worked out again. For example:
+ *
+ *   build-host/bench-naturalist --cycles 60 --verbose 2>&1 | build-host/decode-lora
+ */
+
+static size_t parse(const char *hex, uint8_t *frame, size_t size) {
+    size_t length = 0;
+    while (isxdigit(hex[0]) && isxdigit(hex[1]) && length < size) {
+        unsigned int byte;
+        sscanf(hex, "%2x", &byte);
+        frame[length++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return length;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 1) {
+        fprintf(stderr, "usage: %s < frames\n", argv[0]);
+        return 2;
+    }
+
+    LoraFrameDecoder decoder;
+    uint32_t frames = 0;
+    uint32_t deltas = 0;
+    uint32_t failed = 0;
+    size_t bytes = 0;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        auto hex = strstr(line, "frame ");
+        if (hex != nullptr) {
+            hex += strlen("frame ");
+        }
+        else if (strspn(line, "0123456789abcdefABCDEF") == strcspn(line, "\r\n")) {
+            hex = line;
+        }
+        else {
+            continue;
+        }
+
+        uint8_t buffer[256];
+        auto size = parse(hex, buffer, sizeof(buffer));
+        if (size == 0) {
+            continue;
+        }
+
+        LoraFrame frame;
+        if (!decoder.decode(buffer, size, frame)) {
+            fprintf(stderr, "undecodable: %s", hex);
+            failed++;
+            continue;
+        }
+
+        #if defined(FK_NATURALIST_DERIVED)
+        naturalist_derive(frame.values);
+        #endif
+
+        frames++;
+        deltas += frame.delta ? 1 : 0;
+        bytes += size;
+
+        printf("%08x #%u %u", frame.device, frame.sequence, frame.time);
+        if (frame.delta) {
+            printf(" (delta on #%u)", frame.reference);
+        }
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            if (frame.values.has(i)) {
+                printf(" %zu=%g", i, frame.values.values[i]);
+            }
+        }
+        printf("\n");
+    }
+
+    fprintf(stderr, "%u frames (%u deltas, %.1f bytes each), %u undecodable\n", frames, deltas,
+            frames > 0 ? (float)bytes / frames : 0.0f, failed);
+
+    return failed > 0 ? 1 : 0;
+}
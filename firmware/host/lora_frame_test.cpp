@@ -0,0 +1,241 @@
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "lora_frame.h"
+#include "simulation.h"
+
+using namespace fk;
+
+/**
+ * Sends a day of five minute cycles over a link that loses frames and acks,
+ * decodes what gets through and checks every value comes back to within the
+ * resolution of its channel. Then the corners: clamping, truncation,
+ * deltas against a frame the receiver never got, two devices heard by one
+ * receiver, and a device's references outliving other devices' frames but
+ * not more devices than the receiver keeps.
+ */
+
+constexpr uint32_t Cycles = 24 * 12;
+constexpr uint32_t Interval = 300;
+constexpr float LossRate = 0.15f;
+constexpr uint32_t Device = 0x0b5e1a1d;
+
+static NaturalistValues cycle(uint32_t n) {
+    NaturalistValues values;
+    auto t = (float)n * Interval;
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        // Some channels missing now and then, like a failing sensor.
+        if ((n + i) % 37 == 0) {
+            continue;
+        }
+        // Somewhere in the channel's range, drifting slowly with a few steps
+        // of noise, and now and then a jump too big for a delta.
+        auto &precision = LoraChannelPrecisions[i];
+        auto range = precision.resolution * (float)((1 << precision.bits) - 1);
+        auto value = precision.minimum + range * (0.4f + 0.1f * sinf(2.0f * 3.14159265f * t / 86400.0f));
+        value += (sim::simulation.random() - 0.5f) * 8.0f * precision.resolution;
+        if ((n + i) % 53 == 0) {
+            value += range * 0.3f;
+        }
+        value = std::min(std::max(value, precision.minimum), precision.minimum + range);
+        values.set((NaturalistChannel)i, value);
+    }
+    return values;
+}
+
+static bool within(size_t channel, float expected, float actual) {
+    auto &precision = LoraChannelPrecisions[channel];
+    // Half a step, and the float rounding of the value's offset from the
+    // minimum.
+    auto rounding = (fabsf(expected) + fabsf(precision.minimum)) * 4e-7f;
+    return fabsf(expected - actual) <= precision.resolution * 0.5f + rounding;
+}
+
+int main(int argc, char *argv[]) {
+    LoraFrameEncoder encoder;
+    LoraFrameDecoder decoder;
+    encoder.device(Device);
+    uint32_t failures = 0;
+    uint32_t received = 0;
+    uint32_t deltas = 0;
+    size_t bytes = 0;
+    size_t largest = 0;
+    size_t floats = 0;
+
+    for (uint32_t n = 0; n < Cycles; ++n) {
+        auto values = cycle(n);
+        uint8_t buffer[LoraFrameMaximumSize];
+        auto size = encoder.encode(1500000000 + n * Interval, values, buffer);
+        bytes += size;
+        largest = std::max(largest, size);
+        for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+            floats += values.has(i) ? 1 + sizeof(float) : 0;
+        }
+        floats += sizeof(uint32_t);
+
+        if (size > LoraFrameMaximumSize) {
+            fprintf(stderr, "cycle %u: %zu bytes\n", n, size);
+            failures++;
+        }
+
+        if (sim::simulation.random() < LossRate) {
+            continue;
+        }
+
+        LoraFrame frame;
+        if (!decoder.decode(buffer, size, frame)) {
+            fprintf(stderr, "cycle %u: undecodable\n", n);
+            failures++;
+            continue;
+        }
+        received++;
+        deltas += frame.delta ? 1 : 0;
+
+        if (frame.time != 1500000000 + n * Interval || frame.sequence != encoder.sequence() || frame.device != Device) {
+            fprintf(stderr, "cycle %u: time %u sequence %u device %x\n", n, frame.time, frame.sequence, frame.device);
+            failures++;
+        }
+        for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+            if (values.has(i) != frame.values.has(i)) {
+                fprintf(stderr, "cycle %u: channel %zu presence\n", n, i);
+                failures++;
+                continue;
+            }
+            if (values.has(i) && !within(i, values.values[i], frame.values.values[i])) {
+                fprintf(stderr, "cycle %u: channel %zu %f != %f\n", n, i, values.values[i], frame.values.values[i]);
+                failures++;
+            }
+        }
+
+        if (sim::simulation.random() >= LossRate) {
+            uint8_t ack[LoraFrameAckSize];
+            if (!encoder.acked(ack, decoder.ack(frame, ack))) {
+                fprintf(stderr, "cycle %u: ack refused\n", n);
+                failures++;
+            }
+        }
+    }
+
+    {
+        // Out of range clamps to the ends of it, NaN is left out.
+        LoraFrameEncoder clamping;
+        LoraFrameDecoder receiver;
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, -100.0f);
+        values.set(NaturalistChannel::Humidity, 1000.0f);
+        values.set(NaturalistChannel::Pressure, NAN);
+        uint8_t buffer[LoraFrameMaximumSize];
+        auto size = clamping.encode(0, values, buffer);
+        LoraFrame frame;
+        if (!receiver.decode(buffer, size, frame) || frame.values.get(NaturalistChannel::Temp1) != -40.0f ||
+            frame.values.get(NaturalistChannel::Humidity) < 163.0f || frame.values.has((size_t)NaturalistChannel::Pressure)) {
+            fprintf(stderr, "clamping\n");
+            failures++;
+        }
+
+        // The last byte always has some of the values in it.
+        if (receiver.decode(buffer, size - 1, frame)) {
+            fprintf(stderr, "truncated frame decoded\n");
+            failures++;
+        }
+
+        // A delta against a frame this receiver never saw.
+        clamping.acked(clamping.sequence());
+        size = clamping.encode(Interval, values, buffer);
+        LoraFrameDecoder stranger;
+        if ((buffer[0] & LoraFrameDelta) == 0 || stranger.decode(buffer, size, frame)) {
+            fprintf(stderr, "delta without its reference\n");
+            failures++;
+        }
+    }
+
+    {
+        // Two devices with the same sequences, each delta against its own.
+        LoraFrameEncoder first, second;
+        LoraFrameDecoder receiver;
+        first.device(1);
+        second.device(2);
+        uint8_t buffer[LoraFrameMaximumSize];
+        uint8_t ack[LoraFrameAckSize];
+        LoraFrame frame;
+        for (uint32_t n = 0; n < 4; ++n) {
+            for (auto encoder : { &first, &second }) {
+                auto values = cycle(n * 2 + (encoder == &second ? 1 : 0));
+                auto size = encoder->encode(n * Interval, values, buffer);
+                auto decoded = receiver.decode(buffer, size, frame) && frame.device == (encoder == &first ? 1u : 2u);
+                for (size_t i = 0; decoded && i < NumberOfNaturalistSensorChannels; ++i) {
+                    decoded = !values.has(i) || within(i, values.values[i], frame.values.values[i]);
+                }
+                if (!decoded) {
+                    fprintf(stderr, "device %u, frame %u\n", frame.device, n);
+                    failures++;
+                    continue;
+                }
+                receiver.ack(frame, ack);
+                // Heard by both, only the one it's for takes it.
+                auto other = encoder == &first ? &second : &first;
+                if (other->acked(ack, sizeof(ack)) || !encoder->acked(ack, sizeof(ack))) {
+                    fprintf(stderr, "device %u, ack %u\n", frame.device, n);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    {
+        // Other devices' frames don't push out a device's references...
+        LoraFrameEncoder first, second;
+        LoraFrameDecoder receiver;
+        first.device(1);
+        second.device(2);
+        uint8_t buffer[LoraFrameMaximumSize];
+        uint8_t ack[LoraFrameAckSize];
+        LoraFrame frame;
+        auto size = first.encode(0, cycle(0), buffer);
+        if (!receiver.decode(buffer, size, frame) || !first.acked(ack, receiver.ack(frame, ack))) {
+            fprintf(stderr, "first device's reference\n");
+            failures++;
+        }
+        for (uint32_t n = 0; n < LoraFrameHistory; ++n) {
+            size = second.encode(n * Interval, cycle(n), buffer);
+            if (!receiver.decode(buffer, size, frame) || !second.acked(ack, receiver.ack(frame, ack))) {
+                fprintf(stderr, "second device, frame %u\n", n);
+                failures++;
+            }
+        }
+        size = first.encode(Interval, cycle(1), buffer);
+        if (!receiver.decode(buffer, size, frame) || !frame.delta) {
+            fprintf(stderr, "delta after %zu frames of another device\n", LoraFrameHistory);
+            failures++;
+        }
+
+        // ...but more devices than the receiver keeps push out the one it
+        // heard from least recently.
+        for (uint32_t device = 3; device < 3 + LoraFrameDevices - 1; ++device) {
+            LoraFrameEncoder other;
+            other.device(device);
+            size = other.encode(0, cycle(device), buffer);
+            if (!receiver.decode(buffer, size, frame)) {
+                fprintf(stderr, "device %u\n", device);
+                failures++;
+            }
+        }
+        size = first.encode(2 * Interval, cycle(2), buffer);
+        if (!receiver.decode(buffer, size, frame) || !frame.delta) {
+            fprintf(stderr, "recently heard device forgotten\n");
+            failures++;
+        }
+        size = second.encode(LoraFrameHistory * Interval, cycle(LoraFrameHistory), buffer);
+        if ((buffer[0] & LoraFrameDelta) == 0 || receiver.decode(buffer, size, frame)) {
+            fprintf(stderr, "least recently heard device kept\n");
+            failures++;
+        }
+    }
+
+    printf("frames:          %u received of %u (%u deltas)\n", received, Cycles, deltas);
+    printf("bytes/frame:     %.1f (largest %zu, at most %zu, %.1f as floats)\n", (float)bytes / Cycles, largest,
+           LoraFrameMaximumSize, (float)floats / Cycles);
+
+    return failures == 0 ? 0 : 1;
+}
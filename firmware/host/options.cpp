@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "options.h"
+#include "simulation.h"
+
+namespace fk {
+
+namespace sim {
+
+enum class FieldType {
+    Bool,
+    Uint32,
+    Float,
+};
+
+struct Field {
+    const char *name;
+    FieldType type;
+    void *ptr;
+};
+
+static Field fields[] = {
+    { "boards", FieldType::Uint32, &simulation.boards },
+    { "sht31.present", FieldType::Bool, &simulation.sht31.present },
+    { "sht31.latency", FieldType::Uint32, &simulation.sht31.latency },
+    { "sht31.conversion", FieldType::Uint32, &simulation.sht31.conversion },
+    { "sht31.failureRate", FieldType::Float, &simulation.sht31.failureRate },
+    { "sht31.temperature.offset", FieldType::Float, &simulation.sht31.temperature.offset },
+    { "sht31.temperature.amplitude", FieldType::Float, &simulation.sht31.temperature.amplitude },
+    { "sht31.temperature.period", FieldType::Float, &simulation.sht31.temperature.period },
+    { "sht31.humidity.offset", FieldType::Float, &simulation.sht31.humidity.offset },
+    { "sht31.humidity.amplitude", FieldType::Float, &simulation.sht31.humidity.amplitude },
+    { "mpl3115a2.present", FieldType::Bool, &simulation.mpl3115a2.present },
+    { "mpl3115a2.latency", FieldType::Uint32, &simulation.mpl3115a2.latency },
+    { "mpl3115a2.conversion", FieldType::Uint32, &simulation.mpl3115a2.conversion },
+    { "mpl3115a2.failureRate", FieldType::Float, &simulation.mpl3115a2.failureRate },
+    { "mpl3115a2.pressure.offset", FieldType::Float, &simulation.mpl3115a2.pressure.offset },
+    { "mpl3115a2.pressure.amplitude", FieldType::Float, &simulation.mpl3115a2.pressure.amplitude },
+    { "mpl3115a2.pressure.period", FieldType::Float, &simulation.mpl3115a2.pressure.period },
+    { "mpl3115a2.pressure.event", FieldType::Float, &simulation.mpl3115a2.pressure.event },
+    { "mpl3115a2.pressure.eventAt", FieldType::Float, &simulation.mpl3115a2.pressure.eventAt },
+    { "mpl3115a2.pressure.eventFor", FieldType::Float, &simulation.mpl3115a2.pressure.eventFor },
+    { "tsl2591.present", FieldType::Bool, &simulation.tsl2591.present },
+    { "tsl2591.latency", FieldType::Uint32, &simulation.tsl2591.latency },
+    { "tsl2591.conversion", FieldType::Uint32, &simulation.tsl2591.conversion },
+    { "tsl2591.failureRate", FieldType::Float, &simulation.tsl2591.failureRate },
+    { "tsl2591.full.offset", FieldType::Float, &simulation.tsl2591.full.offset },
+    { "tsl2591.full.amplitude", FieldType::Float, &simulation.tsl2591.full.amplitude },
+    { "tsl2591.full.event", FieldType::Float, &simulation.tsl2591.full.event },
+    { "tsl2591.full.eventAt", FieldType::Float, &simulation.tsl2591.full.eventAt },
+    { "tsl2591.full.eventFor", FieldType::Float, &simulation.tsl2591.full.eventFor },
+    { "bno055.present", FieldType::Bool, &simulation.bno055.present },
+    { "bno055.latency", FieldType::Uint32, &simulation.bno055.latency },
+    { "bno055.x.offset", FieldType::Float, &simulation.bno055.x.offset },
+    { "bno055.x.noise", FieldType::Float, &simulation.bno055.x.noise },
+    { "sph0645.present", FieldType::Bool, &simulation.sph0645.present },
+    { "sph0645.sampleRate", FieldType::Uint32, &simulation.sph0645.sampleRate },
+    { "sph0645.samplesPerBlock", FieldType::Uint32, &simulation.sph0645.samplesPerBlock },
+    { "sph0645.dropRate", FieldType::Float, &simulation.sph0645.dropRate },
+    { "sph0645.rms.offset", FieldType::Float, &simulation.sph0645.rms.offset },
+    { "sph0645.rms.amplitude", FieldType::Float, &simulation.sph0645.rms.amplitude },
+    { "sph0645.rms.event", FieldType::Float, &simulation.sph0645.rms.event },
+    { "sph0645.rms.eventAt", FieldType::Float, &simulation.sph0645.rms.eventAt },
+    { "sph0645.rms.eventFor", FieldType::Float, &simulation.sph0645.rms.eventFor },
+    { "gps.present", FieldType::Bool, &simulation.gps.present },
+    { "gps.startup", FieldType::Uint32, &simulation.gps.startup },
+    { "gauge.present", FieldType::Bool, &simulation.gauge.present },
+    { "gauge.current", FieldType::Float, &simulation.gauge.current },
+    { "mac.serial", FieldType::Uint32, &simulation.mac.serial },
+    { "sd.present", FieldType::Bool, &simulation.sd.present },
+    { "sd.byteNanoseconds", FieldType::Uint32, &simulation.sd.byteNanoseconds },
+    { "sd.writeBusy", FieldType::Uint32, &simulation.sd.writeBusy },
+    { "sd.stallRate", FieldType::Float, &simulation.sd.stallRate },
+    { "sd.stall", FieldType::Uint32, &simulation.sd.stall },
+    { "lora.present", FieldType::Bool, &simulation.lora.present },
+    { "lora.lossRate", FieldType::Float, &simulation.lora.lossRate },
+    { "lora.turnaround", FieldType::Uint32, &simulation.lora.turnaround },
+    { "wifi.present", FieldType::Bool, &simulation.wifi.present },
+    { "wifi.associate", FieldType::Uint32, &simulation.wifi.associate },
+    { "wifi.write", FieldType::Uint32, &simulation.wifi.write },
+    { "wifi.byteNanoseconds", FieldType::Uint32, &simulation.wifi.byteNanoseconds },
+    { "wifi.roundTrip", FieldType::Uint32, &simulation.wifi.roundTrip },
+    { "wifi.dropRate", FieldType::Float, &simulation.wifi.dropRate },
+    { "rtc.phase", FieldType::Uint32, &simulation.rtc.phase },
+    { "rtc.drift", FieldType::Float, &simulation.rtc.drift },
+    { "bus.i2cTransaction", FieldType::Uint32, &simulation.bus.i2cTransaction },
+    { "bus.pollQuantum", FieldType::Uint32, &simulation.bus.pollQuantum },
+    { "bus.spiCall", FieldType::Uint32, &simulation.bus.spiCall },
+    { "flash.capacity", FieldType::Uint32, &simulation.flash.capacity },
+    { "flash.blockSize", FieldType::Uint32, &simulation.flash.blockSize },
+    { "flash.byteNanoseconds", FieldType::Uint32, &simulation.flash.byteNanoseconds },
+    { "flash.pageProgram", FieldType::Uint32, &simulation.flash.pageProgram },
+    { "flash.sectorErase", FieldType::Uint32, &simulation.flash.sectorErase },
+    { "flash.blockErase", FieldType::Uint32, &simulation.flash.blockErase },
+};
+
+bool simulation_set(const char *assignment) {
+    auto equals = strchr(assignment, '=');
+    if (equals == nullptr) {
+        return false;
+    }
+
+    auto length = (size_t)(equals - assignment);
+    auto value = equals + 1;
+
+    for (auto &field : fields) {
+        if (strlen(field.name) != length || strncmp(field.name, assignment, length) != 0) {
+            continue;
+        }
+        switch (field.type) {
+        case FieldType::Bool: *(bool *)field.ptr = atoi(value) != 0; break;
+        case FieldType::Uint32: *(uint32_t *)field.ptr = strtoul(value, nullptr, 10); break;
+        case FieldType::Float: *(float *)field.ptr = strtof(value, nullptr); break;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void simulation_list() {
+    for (auto &field : fields) {
+        switch (field.type) {
+        case FieldType::Bool: fprintf(stderr, "  %s=%d\n", field.name, *(bool *)field.ptr); break;
+        case FieldType::Uint32: fprintf(stderr, "  %s=%u\n", field.name, *(uint32_t *)field.ptr); break;
+        case FieldType::Float: fprintf(stderr, "  %s=%g\n", field.name, *(float *)field.ptr); break;
+        }
+    }
+}
+
+uint64_t host_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+}
+
+}
@@ -0,0 +1,25 @@
+#ifndef FK_HOST_OPTIONS_H_INCLUDED
+#define FK_HOST_OPTIONS_H_INCLUDED
+
+#include <cstdint>
+
+namespace fk {
+
+namespace sim {
+
+/**
+ * Applies "name=value" to a field of the simulation, for example
+ * "sht31.latency=15000" or "tsl2591.present=0". Returns false if the name is
+ * unknown.
+ */
+bool simulation_set(const char *assignment);
+
+void simulation_list();
+
+uint64_t host_cpu_ns();
+
+}
+
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "readings.h"
+#include "trace.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+static SensorInfo sensors[NumberOfNaturalistChannels];
+static SensorReading readings[NumberOfNaturalistChannels];
+static ModuleInfo module = { 0, 8, NumberOfNaturalistChannels, 1, "FkNat", "fk-naturalist", sensors, readings };
+
+/**
+ * Hands back the driver results of one segment of a trace in the order they
+ * were recorded, moving the clock to when each was recorded.
+ */
+class TracePlayback : public sim::Playback {
+private:
+    std::deque<TraceRecord> records_;
+    uint64_t base_{ 0 };
+
+public:
+    void load(std::deque<TraceRecord> records, uint64_t base) {
+        records_ = records;
+        base_ = base;
+    }
+
+    size_t remaining() const {
+        return records_.size();
+    }
+
+    TraceRecordType next() const {
+        return records_.empty() ? TraceRecordType::End : records_.front().type;
+    }
+
+public:
+    bool begin(sim::Device device, bool &ok) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Begin, record)) {
+            return false;
+        }
+        ok = record.begin.ok;
+        return true;
+    }
+
+    bool probe(uint8_t bus, uint8_t address, bool &ack) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Probe, record)) {
+            return false;
+        }
+        if (record.probe.bus != bus || record.probe.address != address) {
+            fprintf(stderr, "replay: probe of %d/0x%02x, recorded %d/0x%02x\n",
+                    bus, address, record.probe.bus, record.probe.address);
+        }
+        ack = record.probe.ack;
+        return true;
+    }
+
+    bool sht31(float &temperature, float &humidity) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Sht31, record)) {
+            return false;
+        }
+        temperature = record.sht31.temperature;
+        humidity = record.sht31.humidity;
+        return true;
+    }
+
+    bool mpl3115a2(float &pressure, float &altitude, float &temperature) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Mpl3115a2, record)) {
+            return false;
+        }
+        pressure = record.mpl3115a2.pressure;
+        altitude = record.mpl3115a2.altitude;
+        temperature = record.mpl3115a2.temperature;
+        return true;
+    }
+
+    bool tsl2591(uint32_t &fullLuminosity) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Tsl2591, record)) {
+            return false;
+        }
+        fullLuminosity = record.tsl2591.fullLuminosity;
+        return true;
+    }
+
+    bool bno055(uint8_t *calibration, float *orientation) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Bno055, record)) {
+            return false;
+        }
+        memcpy(calibration, record.bno055.calibration, sizeof(record.bno055.calibration));
+        memcpy(orientation, record.bno055.orientation, sizeof(record.bno055.orientation));
+        return true;
+    }
+
+    bool audio(float &amplitude) override {
+        TraceRecord record;
+        if (!take(TraceRecordType::Audio, record)) {
+            return false;
+        }
+        amplitude = record.audio.amplitude;
+        return true;
+    }
+
+private:
+    bool take(TraceRecordType type, TraceRecord &record) {
+        if (records_.empty() || records_.front().type != type) {
+            return false;
+        }
+        record = records_.front();
+        records_.pop_front();
+        sim::Clock::advanceTo(base_ + record.time);
+        return true;
+    }
+
+};
+
+struct Cycle {
+    std::deque<TraceRecord> records;
+    uint64_t started{ 0 };
+    uint64_t finished{ 0 };
+    NaturalistValues values;
+    bool complete{ false };
+};
+
+static bool load(const char *path, std::vector<uint8_t> &data) {
+    auto file = fopen(path, "rb");
+    if (file == nullptr) {
+        perror(path);
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = nullptr;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            log_verbose(true);
+        }
+        else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        }
+        else {
+            path = nullptr;
+            break;
+        }
+    }
+
+    if (path == nullptr) {
+        fprintf(stderr, "usage: %s [--verbose] TRACE\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> data;
+    if (!load(path, data)) {
+        return 1;
+    }
+
+    TraceReader reader{ data.data(), data.size() };
+    if (!reader.header()) {
+        fprintf(stderr, "%s: not a trace\n", path);
+        return 1;
+    }
+
+    // Everything before the first cycle is from setup().
+    std::deque<TraceRecord> setup;
+    std::vector<Cycle> cycles;
+    TraceRecord record;
+    while (reader.read(record)) {
+        if (record.type == TraceRecordType::Cycle) {
+            cycles.emplace_back();
+            cycles.back().started = record.time;
+        }
+        else if (record.type == TraceRecordType::Values) {
+            if (!cycles.empty()) {
+                cycles.back().values = record.values;
+                cycles.back().finished = record.time;
+                cycles.back().complete = true;
+            }
+        }
+        else if (cycles.empty()) {
+            setup.push_back(record);
+        }
+        else {
+            cycles.back().records.push_back(record);
+        }
+    }
+
+    Leds leds;
+    CoreState state;
+    state.configure(module);
+
+    MainServices services{ &leds, &state };
+    MainServicesState::services(&services);
+
+    TracePlayback playback;
+    sim::simulation.playback = &playback;
+
+    // Recorded times are relative to the first record of the trace.
+    auto base = sim::Clock::now();
+    playback.load(setup, base);
+
+    TakeNaturalistReadings take;
+    take.setup();
+
+    uint32_t replayed = 0;
+    uint32_t mismatches = 0;
+    uint64_t recordedTotal = 0;
+    uint64_t cpuTotal = 0;
+
+    for (auto &cycle : cycles) {
+        if (!cycle.complete) {
+            break;
+        }
+
+        sim::Clock::advanceTo(base + cycle.started);
+        playback.load(cycle.records, base);
+
+        for (auto &r : readings) {
+            r.available = false;
+        }
+
+        auto cpuStarted = sim::host_cpu_ns();
+        take.task();
+        cpuTotal += sim::host_cpu_ns() - cpuStarted;
+        recordedTotal += cycle.finished - cycle.started;
+
+        if (playback.remaining() > 0) {
+            fprintf(stderr, "cycle %u: %zu records unused, next is type %d\n", replayed, playback.remaining(), (int)playback.next());
+            mismatches++;
+        }
+
+        // Diagnostics are timings of this run, not of the recording.
+        for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+            auto recorded = cycle.values.has(i);
+            if (recorded != readings[i].available) {
+                fprintf(stderr, "cycle %u: channel %zu recorded=%d replayed=%d\n",
+                        replayed, i, recorded, readings[i].available);
+                mismatches++;
+            }
+            else if (recorded && readings[i].value != cycle.values.values[i] &&
+                     !(std::isnan(readings[i].value) && std::isnan(cycle.values.values[i]))) {
+                fprintf(stderr, "cycle %u: channel %zu recorded=%f replayed=%f\n",
+                        replayed, i, cycle.values.values[i], readings[i].value);
+                mismatches++;
+            }
+        }
+
+        replayed++;
+    }
+
+    sim::simulation.playback = nullptr;
+
+    printf("replayed:        %u cycles, %u mismatches\n", replayed, mismatches);
+    if (replayed > 0) {
+        printf("recorded (ms):   mean=%.2f\n", recordedTotal / 1000.0 / replayed);
+        printf("host cpu (us):   mean=%.2f\n", cpuTotal / 1000.0 / replayed);
+    }
+
+    return mismatches == 0 && replayed > 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "rollup.h"
+#include "series_store.h"
+#include "fk-core.h"
+#include "simulation.h"
+
+using namespace fk;
+
+/**
+ * Round trips rollup records through rollup_encode and rollup_decode, then
+ * rolls two hours of a reading every 5s up and checks each minute and hour
+ * bucket is emitted once, when the next one starts, with the statistics of
+ * what went into it. Finally stores those rollups amongst cycle records in
+ * the series store, begins it again as after a reset and checks scan()
+ * gives them all back without upsetting the cycle records around them.
+ */
+
+constexpr uint32_t Start = 1500000000 - 1500000000 % 3600;
+constexpr uint32_t Interval = 5;
+constexpr uint32_t Cycles = 2 * 3600 / Interval;
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static bool same(const RollupRecord &a, const RollupRecord &b) {
+    return a.start == b.start && a.period == b.period && a.channel == b.channel && a.count == b.count &&
+           a.minimum == b.minimum && a.maximum == b.maximum && a.mean == b.mean;
+}
+
+class Collector : public RollupSink {
+public:
+    std::vector<RollupRecord> records;
+
+public:
+    void rollup(const RollupRecord &record) override {
+        records.push_back(record);
+    }
+
+};
+
+class StoredVisitor : public SeriesVisitor {
+public:
+    std::vector<RollupRecord> rollups;
+    uint32_t records{ 0 };
+    uint32_t wrong{ 0 };
+
+public:
+    void visit(const CycleRecord &record) override {
+        auto n = (record.time - Start) / Interval;
+        auto value = record.values.values[(size_t)NaturalistChannel::Temp1];
+        if (!record.values.has((size_t)NaturalistChannel::Temp1) || value != (float)n) {
+            wrong++;
+        }
+        records++;
+    }
+
+    void rollup(const RollupRecord &record) override {
+        rollups.push_back(record);
+    }
+
+};
+
+static SeriesStore store;
+
+int main(int argc, char *argv[]) {
+    {
+        RollupRecord records[] = {
+            { 0, 0, 0, 1, 0.0f, 0.0f, 0.0f },
+            { Start + 3600, 1, (uint8_t)(NumberOfNaturalistDataChannels - 1), 720, -40.5f, 85.25f, 21.125f },
+            { UINT32_MAX - UINT32_MAX % 60, 0, 3, UINT16_MAX, -1e30f, 1e30f, 0.1f },
+        };
+        for (auto &record : records) {
+            uint8_t buffer[RollupRecordMaximumSize];
+            auto size = rollup_encode(record, buffer);
+            expect(size <= RollupRecordMaximumSize, "encoded past RollupRecordMaximumSize");
+
+            RollupRecord decoded;
+            expect(rollup_decode(buffer, size, decoded) == size && same(record, decoded), "round trip");
+            expect(rollup_decode(buffer, size - 1, decoded) == 0, "decoded a truncated record");
+        }
+
+        uint8_t buffer[RollupRecordMaximumSize];
+        auto bad = records[1];
+        bad.period = NumberOfNaturalistRollupPeriods;
+        RollupRecord decoded;
+        expect(rollup_decode(buffer, rollup_encode(bad, buffer), decoded) == 0, "decoded a period we don't have");
+    }
+
+    Collector collector;
+    Rollups rollups;
+    rollups.sink(&collector);
+
+    // Counts up a step a cycle, so each bucket's statistics are known.
+    for (uint32_t n = 0; n <= Cycles; ++n) {
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, (float)n);
+        rollups.add(values, Start + n * Interval);
+    }
+
+    {
+        auto perMinute = 60 / Interval;
+        auto perHour = 3600 / Interval;
+        uint32_t minutes = 0;
+        uint32_t hours = 0;
+        auto ordered = true;
+        for (auto &record : collector.records) {
+            expect(record.channel == (uint8_t)NaturalistChannel::Temp1, "a channel with no readings was emitted");
+            auto period = NaturalistRollupPeriods[record.period];
+            auto perBucket = period / Interval;
+            auto first = (record.start - Start) / Interval;
+            auto ok = record.start % period == 0 && record.count == perBucket && record.minimum == (float)first &&
+                      record.maximum == (float)(first + perBucket - 1) && record.mean == first + (perBucket - 1) / 2.0f;
+            if (!ok) {
+                fprintf(stderr, "%us@%u n=%u min=%f max=%f mean=%f\n", period, record.start, record.count,
+                        record.minimum, record.maximum, record.mean);
+                failures++;
+            }
+            if (record.period == 0) {
+                ordered = ordered && record.start == Start + minutes * 60;
+                minutes++;
+            }
+            else {
+                ordered = ordered && record.start == Start + hours * 3600;
+                hours++;
+            }
+        }
+        // The last reading starts a bucket of each, that's still open.
+        expect(minutes == Cycles / perMinute && hours == Cycles / perHour && ordered, "buckets emitted");
+        expect(rollups.emitted() == collector.records.size(), "emitted");
+    }
+
+    {
+        // A clock set back ends the buckets too.
+        Collector back;
+        Rollups r;
+        r.sink(&back);
+        NaturalistValues values;
+        values.set(NaturalistChannel::Temp1, 1.0f);
+        r.add(values, Start + 3600);
+        r.add(values, Start);
+        expect(back.records.size() == NumberOfNaturalistRollupPeriods, "clock set back");
+    }
+
+    if (!store.begin()) {
+        fprintf(stderr, "no flash\n");
+        return 1;
+    }
+
+    {
+        // Each rollup goes in as the cycle that finished its bucket does.
+        size_t next = 0;
+        for (uint32_t n = 0; n <= Cycles; ++n) {
+            auto time = Start + n * Interval;
+            while (next < collector.records.size() &&
+                   collector.records[next].start + NaturalistRollupPeriods[collector.records[next].period] <= time) {
+                store.append(time, collector.records[next++]);
+            }
+            NaturalistValues values;
+            values.set(NaturalistChannel::Temp1, (float)n);
+            store.append(time, values);
+        }
+
+        store.begin();
+
+        auto all = ((uint64_t)1 << NumberOfNaturalistChannels) - 1;
+        StoredVisitor visitor;
+        store.scan(0, UINT32_MAX, all, visitor);
+
+        auto matched = visitor.rollups.size() == collector.records.size();
+        for (size_t i = 0; matched && i < visitor.rollups.size(); ++i) {
+            matched = same(visitor.rollups[i], collector.records[i]);
+        }
+        expect(matched, "stored rollups");
+        expect(visitor.records == Cycles + 1 && visitor.wrong == 0 && store.records() == Cycles + 1, "cycle records around them");
+
+        StoredVisitor indexed;
+        store.query(0, UINT32_MAX, all, indexed);
+        expect(indexed.rollups.empty() && indexed.records == Cycles + 1, "query visited rollups");
+    }
+
+    printf("rollups:         %u records, %u bytes\n", rollups.emitted(), rollups.bytes());
+    printf("rollup:          %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
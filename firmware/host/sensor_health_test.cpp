@@ -0,0 +1,87 @@
+#include <cstdio>
+
+#include "sensor_health.h"
+
+using namespace fk;
+
+/**
+ * Takes a sensor through the supervisor's states: failures short of going
+ * offline, the backoff doubling from the minimum to the maximum as retries
+ * fail, recovery resetting it, and a disabled sensor never being retried.
+ */
+
+using Supervisor = SensorHealthSupervisor;
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Supervisor supervisor;
+    auto sensor = NaturalistSensor::Sht31;
+    auto &h = supervisor.health(sensor);
+    uint32_t now = 1000;
+
+    // Begun fine, that's not a recovery.
+    supervisor.succeeded(sensor);
+    expect(h.available && h.recoveries == 0, "begin counted as a recovery");
+
+    // A bad read or two and it stays, the next one in a row takes it offline.
+    for (auto i = 1; i < Supervisor::FailuresBeforeOffline; ++i) {
+        supervisor.failed(sensor, now);
+    }
+    expect(h.available, "offline before FailuresBeforeOffline");
+    supervisor.succeeded(sensor);
+    for (auto i = 1; i < Supervisor::FailuresBeforeOffline; ++i) {
+        supervisor.failed(sensor, now);
+    }
+    expect(h.available, "a success didn't reset the count");
+    supervisor.failed(sensor, now);
+    expect(!h.available && h.backoff == Supervisor::MinimumBackoff && h.retryAt == now + Supervisor::MinimumBackoff,
+           "offline after FailuresBeforeOffline");
+    expect(h.failures == 2 * Supervisor::FailuresBeforeOffline - 1, "failures");
+
+    expect(!supervisor.retryDue(sensor, now + Supervisor::MinimumBackoff - 1), "retry before its backoff");
+    expect(supervisor.retryDue(sensor, now + Supervisor::MinimumBackoff), "retry not due after its backoff");
+
+    // Each failed retry doubles the backoff, up to the maximum.
+    uint32_t retries = 0;
+    auto expected = Supervisor::MinimumBackoff;
+    while (h.backoff < Supervisor::MaximumBackoff && retries < 32) {
+        now = h.retryAt;
+        supervisor.offline(sensor, now);
+        expected = expected * 2 < Supervisor::MaximumBackoff ? expected * 2 : Supervisor::MaximumBackoff;
+        expect(h.backoff == expected && h.retryAt == now + expected, "backoff didn't double");
+        retries++;
+    }
+    supervisor.offline(sensor, h.retryAt);
+    expect(h.backoff == Supervisor::MaximumBackoff, "backoff past the maximum");
+
+    // Uptime wraps after 49 days, retries don't stop.
+    now = UINT32_MAX - 1000;
+    supervisor.offline(sensor, now);
+    expect(!supervisor.retryDue(sensor, now) && supervisor.retryDue(sensor, now + Supervisor::MaximumBackoff),
+           "retry across the uptime wrap");
+
+    // Back, and the next time it goes it starts from the minimum again.
+    supervisor.succeeded(sensor);
+    expect(h.available && h.recoveries == 1 && h.backoff == 0, "recovery");
+    expect(!supervisor.retryDue(sensor, now + Supervisor::MaximumBackoff), "retry while available");
+    supervisor.offline(sensor, now);
+    expect(h.backoff == Supervisor::MinimumBackoff, "backoff after recovery");
+
+    // Disabled sensors are never retried.
+    supervisor.disable(NaturalistSensor::Bno055);
+    expect(!supervisor.available(NaturalistSensor::Bno055) && !supervisor.retryDue(NaturalistSensor::Bno055, now),
+           "disabled sensor");
+
+    printf("backoff:         %u to %ums in %u retries\n", Supervisor::MinimumBackoff, Supervisor::MaximumBackoff, retries);
+    printf("supervisor:      %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <cstdio>
+
+#include "sensor_schedule.h"
+
+using namespace fk;
+
+/**
+ * Ticks the sensor schedule on a synthetic uptime clock and checks which
+ * sensors are due: everything on the first tick, nothing on a tick within
+ * the slack of a sensor but before any is due, and a sensor within the slack
+ * of one that is due read along with it without being due again at its own
+ * boundary. Then an hour of ticks that are late by a varying amount, where
+ * rounding to the period boundaries keeps every sensor on its period and
+ * the achieved intervals come out as the periods. Also next() and all().
+ */
+
+constexpr uint32_t Second = 1000;
+constexpr uint32_t SlackMs = (uint32_t)FK_NATURALIST_SCHEDULE_SLACK * Second;
+constexpr uint32_t AudioMs = (uint32_t)FK_NATURALIST_PERIOD_AUDIO * Second;
+constexpr uint32_t Sht31Ms = (uint32_t)FK_NATURALIST_PERIOD_SHT31 * Second;
+constexpr uint32_t Bno055Ms = (uint32_t)FK_NATURALIST_PERIOD_BNO055 * Second;
+constexpr uint8_t Every = (uint8_t)((1 << NumberOfNaturalistSensors) - 1);
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static uint8_t due(const SensorSchedule &schedule) {
+    uint8_t sensors = 0;
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        sensors |= schedule.due((NaturalistSensor)i) ? 1 << i : 0;
+    }
+    return sensors;
+}
+
+static uint8_t bit(NaturalistSensor sensor) {
+    return (uint8_t)(1 << (size_t)sensor);
+}
+
+/* Ticks and reads what's due, as the readings task does for each board. */
+static uint8_t tick(SensorSchedule &schedule, uint32_t now, uint32_t boards = 1) {
+    schedule.tick(now);
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        for (uint32_t b = 0; b < boards && schedule.due((NaturalistSensor)i); ++b) {
+            schedule.read((NaturalistSensor)i, now);
+        }
+    }
+    return due(schedule);
+}
+
+int main(int argc, char *argv[]) {
+    static_assert(Sht31Ms % AudioMs == 0 && AudioMs > SlackMs, "these periods are what the checks below expect");
+
+    {
+        SensorSchedule schedule;
+        expect(tick(schedule, 1 * Second) == Every, "first: not everything");
+        // Due at the boundaries, not a period after the first tick.
+        expect(schedule.sensor(NaturalistSensor::Audio).next == AudioMs &&
+               schedule.sensor(NaturalistSensor::Sht31).next == Sht31Ms &&
+               schedule.sensor(NaturalistSensor::Bno055).next == Bno055Ms, "first: next boundaries");
+        expect(schedule.next(1 * Second) == AudioMs - 1 * Second, "next: until audio");
+
+        // Within the slack of audio, but nothing's due yet.
+        expect(tick(schedule, AudioMs - SlackMs + 1 * Second) == 0, "slack: woke for it alone");
+
+        // Audio's overdue and the SHT31 and MPL3115A2 are in the slack, so
+        // they share the wakeup...
+        auto now = Sht31Ms - SlackMs + 2 * Second;
+        auto early = bit(NaturalistSensor::Sht31) | bit(NaturalistSensor::Mpl3115a2);
+        auto sensors = tick(schedule, now);
+        expect((sensors & early) == early && (sensors & bit(NaturalistSensor::Audio)) &&
+               !(sensors & bit(NaturalistSensor::Bno055)), "slack: not coalesced");
+        expect(schedule.sensor(NaturalistSensor::Sht31).next == 2 * Sht31Ms, "slack: next period");
+        expect(schedule.next(now) == Sht31Ms + AudioMs - now, "next: audio after the slack");
+
+        // ...and aren't due again at their own boundary.
+        expect(tick(schedule, Sht31Ms) == 0, "slack: read again on time");
+        expect(schedule.next(Sht31Ms + AudioMs + 3 * Second) == 0, "next: overdue");
+
+        // Everything once, without moving the schedule.
+        auto next = schedule.sensor(NaturalistSensor::Bno055).next;
+        schedule.tick(Sht31Ms + 1 * Second);
+        schedule.all();
+        expect(due(schedule) == Every && schedule.sensor(NaturalistSensor::Bno055).next == next, "all");
+    }
+
+    {
+        // An hour of ticks every audio period, late by between 0.1 and 0.9s.
+        // Scheduling from when they were read instead of the boundaries would
+        // skip every other one.
+        SensorSchedule schedule;
+        auto ticks = Bno055Ms / AudioMs;
+        auto sht31s = Sht31Ms / AudioMs;
+        uint32_t missed = 0;
+        uint32_t wrong = 0;
+        for (uint32_t n = 0; n <= ticks; ++n) {
+            auto now = n * AudioMs + (n % 2 == 0 ? 900 : 100);
+            // Two boards, still one reading.
+            auto sensors = tick(schedule, now, 2);
+            missed += (sensors & bit(NaturalistSensor::Audio)) && (sensors & bit(NaturalistSensor::Tsl2591)) ? 0 : 1;
+            wrong += ((sensors & bit(NaturalistSensor::Sht31)) != 0) != (n % sht31s == 0) ? 1 : 0;
+            wrong += ((sensors & bit(NaturalistSensor::Bno055)) != 0) != (n % ticks == 0) ? 1 : 0;
+        }
+        expect(missed == 0, "late: audio or light missed");
+        expect(wrong == 0, "late: SHT31 or BNO055 off their period");
+
+        auto audio = schedule.interval(NaturalistSensor::Audio);
+        auto sht31 = schedule.interval(NaturalistSensor::Sht31);
+        expect(schedule.sensor(NaturalistSensor::Audio).reads == ticks + 1, "late: audio reads");
+        expect(audio + 1 * Second > AudioMs && audio < AudioMs + 1 * Second, "late: audio interval");
+        expect(sht31 + 1 * Second > Sht31Ms && sht31 < Sht31Ms + 1 * Second, "late: SHT31 interval");
+        expect(schedule.interval(NaturalistSensor::Bno055) == Bno055Ms, "late: BNO055 interval");
+
+        printf("audio:           %ums\n", audio);
+        printf("sht31:           %ums\n", sht31);
+    }
+
+    printf("sensor-schedule: %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+
+#include <SerialFlash.h>
+
+#include "series_store.h"
+#include "fk-core.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+/**
+ * Fills the series store a cycle a minute and, as it grows, times the
+ * queries a host asks for against reading every block. The store is begun
+ * again at each size, as after a reset, so this also covers rebuilding the
+ * index and picking up part way through a block. Fails if the indexed
+ * queries disagree with the scan, or if a block written with another
+ * channel layout isn't skipped.
+ */
+
+constexpr uint32_t Interval = 60;
+constexpr uint32_t Start = 1500000000;
+constexpr uint32_t Window = 6 * 60 * 60;
+constexpr uint32_t Week = 7 * 24 * 60 * 60;
+
+static NaturalistValues cycle(uint32_t n) {
+    NaturalistValues values;
+    auto t = (float)n * Interval;
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if ((n + i) % 37 == 0) {
+            continue;
+        }
+        auto base = 1000.0f * (1 + i % 5) / cycle_record_scale((NaturalistChannel)i);
+        auto value = base + base * 0.2f * sinf(2.0f * 3.14159265f * t / 86400.0f) + sim::simulation.random() * base * 0.01f;
+        values.set((NaturalistChannel)i, value);
+    }
+    return values;
+}
+
+class CountingVisitor : public SeriesVisitor {
+public:
+    uint32_t records{ 0 };
+    uint32_t values{ 0 };
+
+public:
+    void visit(const CycleRecord &record) override {
+        records++;
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            values += record.values.has(i) ? 1 : 0;
+        }
+    }
+
+};
+
+class RangeVisitor : public SeriesVisitor {
+private:
+    size_t channel_;
+
+public:
+    float minimum{ INFINITY };
+    float maximum{ -INFINITY };
+
+public:
+    RangeVisitor(NaturalistChannel channel) : channel_((size_t)channel) {
+    }
+
+public:
+    void visit(const CycleRecord &record) override {
+        minimum = std::min(minimum, record.values.values[channel_]);
+        maximum = std::max(maximum, record.values.values[channel_]);
+    }
+
+};
+
+template<typename Fn>
+static float timed(Fn fn) {
+    auto started = sim::Clock::now();
+    fn();
+    return (sim::Clock::now() - started) / 1000.0f;
+}
+
+static SeriesStore store;
+
+int main(int argc, char *argv[]) {
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--set") == 0 && i + 1 < argc && sim::simulation_set(argv[i + 1])) {
+            i++;
+            continue;
+        }
+        fprintf(stderr, "usage: %s [--set name=value]...\n", argv[0]);
+        sim::simulation_list();
+        return 2;
+    }
+
+    if (!store.begin()) {
+        fprintf(stderr, "no flash\n");
+        return 1;
+    }
+
+    auto all = ((uint64_t)1 << NumberOfNaturalistChannels) - 1;
+    auto temp1 = (uint64_t)1 << (size_t)NaturalistChannel::Temp1;
+    auto channelScale = cycle_record_scale(NaturalistChannel::Temp1);
+    auto failures = 0;
+    uint32_t n = 0;
+
+    printf("%6s %8s %8s %10s %10s %10s %10s %10s %10s\n", "blocks", "records", "KB", "begin", "6h", "6h temp1",
+           "6h scan", "7d range", "7d scan");
+
+    // Last stage runs on past full, so the oldest blocks have been reused.
+    uint32_t stages[] = { 2, 4, 8, 16, store.blocks(), 0 };
+    for (auto stage : stages) {
+        // Smaller chips have smaller stores.
+        if (stage > store.blocks()) {
+            continue;
+        }
+        auto appending = stage == 0 ? n / 4 : 0;
+        while (store.used() < stage) {
+            store.append(Start + n * Interval, cycle(n));
+            n++;
+        }
+        for (uint32_t i = 0; i < appending; ++i) {
+            store.append(Start + n * Interval, cycle(n));
+            n++;
+        }
+
+        auto beginMs = timed([&] { store.begin(); });
+
+        auto now = Start + (n - 1) * Interval;
+        CountingVisitor recent, recentTemp1, scanned;
+        SeriesQueryStats recentStats;
+        auto recentMs = timed([&] { recentStats = store.query(now - Window, now, all, recent); });
+        auto recentTemp1Ms = timed([&] { store.query(now - Window, now, temp1, recentTemp1); });
+        auto scanMs = timed([&] { store.scan(now - Window, now, all, scanned); });
+
+        float minimum, maximum;
+        SeriesQueryStats rangeStats;
+        auto rangeMs = timed([&] { store.range(now - Week, now, NaturalistChannel::Temp1, minimum, maximum, &rangeStats); });
+        RangeVisitor expected{ NaturalistChannel::Temp1 };
+        auto rangeScanMs = timed([&] { store.scan(now - Week, now, temp1, expected); });
+
+        printf("%6u %8u %8u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", store.used(), store.records(),
+               store.used() * store.blockSize() / 1024, beginMs, recentMs, recentTemp1Ms, scanMs, rangeMs, rangeScanMs);
+        printf("%6s %8s %8s %10s %10u %10s %10s %10u %10s (blocks read)\n", "", "", "", "", recentStats.blocks, "",
+               "", rangeStats.blocks, "");
+
+        if (recent.records != scanned.records || recent.values != scanned.values) {
+            printf("query: %u records %u values, scan: %u records %u values\n", recent.records, recent.values,
+                   scanned.records, scanned.values);
+            failures++;
+        }
+        if (recentTemp1.records == 0 || recentTemp1.values != recentTemp1.records) {
+            printf("temp1 query: %u records %u values\n", recentTemp1.records, recentTemp1.values);
+            failures++;
+        }
+        // Summaries are of the values as appended, scans of them quantized.
+        auto tolerance = 1.0f / channelScale;
+        if (fabsf(minimum - expected.minimum) > tolerance || fabsf(maximum - expected.maximum) > tolerance) {
+            printf("range: %f..%f, scan: %f..%f\n", minimum, maximum, expected.minimum, expected.maximum);
+            failures++;
+        }
+    }
+
+    // As if the oldest block was written by a build with other channels.
+    SeriesExtent oldest;
+    FlashExtent region;
+    if (store.pending(SeriesCursor{}, oldest) && flash_region(FlashRegion::Series, region)) {
+        auto used = store.used();
+        auto sequence = store.sequence();
+        uint16_t layout = NaturalistChannelLayout & 0x00ff;
+        SerialFlash.write(region.start + oldest.block * store.blockSize() + offsetof(SeriesBlockHeader, layout), &layout, sizeof(layout));
+
+        store.begin();
+        auto now = Start + (n - 1) * Interval;
+        CountingVisitor queried;
+        store.scan(Start, now, all, queried);
+        store.append(Start + n * Interval, cycle(n));
+        n++;
+
+        printf("%u blocks from another layout, %u used, %u records\n", store.foreign(), store.used(), queried.records);
+        if (store.foreign() != 1 || store.used() != used - 1 || store.sequence() != sequence) {
+            printf("layout: %u foreign, %u of %u used, sequence %u of %u\n", store.foreign(), store.used(), used,
+                   store.sequence(), sequence);
+            failures++;
+        }
+    }
+
+    printf("series: %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
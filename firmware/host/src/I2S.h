@@ -0,0 +1,16 @@
+#ifndef FK_HOST_I2S_H_INCLUDED
+#define FK_HOST_I2S_H_INCLUDED
+
+#include <Arduino.h>
+
+#define I2S_PHILIPS_MODE 0
+
+class I2SClass {
+public:
+    bool begin(int mode, long sampleRate, int bitsPerSample);
+
+};
+
+extern I2SClass I2S;
+
+#endif
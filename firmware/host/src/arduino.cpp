@@ -0,0 +1,116 @@
+#include <cstdarg>
+
+#include <Arduino.h>
+#include <alogging/alogging.h>
+#include <SerialFlash.h>
+
+#include "hardware.h"
+
+#include "simulation.h"
+
+using fk::sim::Clock;
+using fk::sim::simulation;
+
+Uart Serial;
+Uart Serial2{ true };
+Uart Serial5;
+
+uint32_t millis() {
+    Clock::advance(simulation.bus.pollQuantum);
+    return (uint32_t)(Clock::now() / 1000);
+}
+
+uint32_t micros() {
+    Clock::advance(simulation.bus.pollQuantum);
+    return (uint32_t)Clock::now();
+}
+
+void delay(uint32_t ms) {
+    Clock::advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    Clock::advance(us);
+}
+
+void pinMode(uint32_t pin, uint32_t mode) {
+}
+
+void digitalWrite(uint32_t pin, uint32_t value) {
+    if (pin == fk::Hardware::FLASH_PIN_CS) {
+        SerialFlash.select(value == LOW);
+    }
+}
+
+int digitalRead(uint32_t pin) {
+    return HIGH;
+}
+
+void randomSeed(uint32_t seed) {
+    simulation.seed = seed;
+}
+
+int Uart::available() {
+    Clock::advance(simulation.bus.pollQuantum);
+    if (!gps_ || !simulation.gps.present || Clock::now() < simulation.gps.startup) {
+        return 0;
+    }
+    // 9600 baud, a character every ~1ms.
+    auto produced = (Clock::now() - simulation.gps.startup) / 1042;
+    return produced > position_ ? (int)(produced - position_) : 0;
+}
+
+int Uart::read() {
+    if (available() == 0) {
+        return -1;
+    }
+    constexpr const char Sentence[] = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+    return Sentence[position_++ % (sizeof(Sentence) - 1)];
+}
+
+size_t Uart::print(const char *s) {
+    if (log_verbose()) {
+        fputs(s, stderr);
+    }
+    return strlen(s);
+}
+
+size_t Uart::print(char c) {
+    if (log_verbose()) {
+        fputc(c, stderr);
+    }
+    return 1;
+}
+
+size_t Uart::println(const char *s) {
+    if (log_verbose()) {
+        fprintf(stderr, "%s\n", s);
+    }
+    return strlen(s) + 1;
+}
+
+static bool verbose = false;
+
+bool log_verbose() {
+    return verbose;
+}
+
+void log_verbose(bool value) {
+    verbose = value;
+}
+
+void log_uart_set(Uart &uart) {
+}
+
+void log_message(const char *facility, const char *f, ...) {
+    // Always format, so the cost of logging shows up in host timings.
+    char message[256];
+    va_list args;
+    va_start(args, f);
+    vsnprintf(message, sizeof(message), f, args);
+    va_end(args);
+
+    if (verbose) {
+        fprintf(stderr, "%08" PRIu32 " %-10s %s\n", (uint32_t)(Clock::now() / 1000), facility, message);
+    }
+}
@@ -0,0 +1,101 @@
+#include <fk-core.h>
+
+#include "simulation.h"
+
+using fk::sim::simulation;
+
+namespace fk {
+
+constexpr uint8_t Hardware::PERIPHERALS_ENABLE_PIN;
+constexpr uint8_t Hardware::FLASH_PIN_CS;
+constexpr uint8_t Hardware::WIFI_PIN_CS;
+constexpr uint8_t Hardware::WIFI_PIN_IRQ;
+constexpr uint8_t Hardware::WIFI_PIN_RST;
+constexpr uint8_t Hardware::WIFI_PIN_EN;
+constexpr uint8_t Hardware::RFM95_PIN_CS;
+constexpr uint8_t Hardware::RFM95_PIN_D0;
+constexpr uint8_t Hardware::SD_PIN_CS;
+constexpr uint8_t Hardware::GPS_ENABLE_PIN;
+constexpr uint8_t Hardware::MODULES_ENABLE_PIN;
+
+MainServices *MainServicesState::services_{ nullptr };
+
+Clock clock;
+
+WiFiClass WiFi;
+
+uint32_t fk_uptime() {
+    return millis();
+}
+
+uint32_t Clock::getTime() {
+    // 2018-07-01, plus simulated time.
+    auto now = sim::Clock::now();
+    auto rtc = now + simulation.rtc.phase + (int64_t)(now * (double)simulation.rtc.drift / 1000000.0);
+    return 1530403200 + (uint32_t)(rtc / 1000000);
+}
+
+void SimpleNTP::enqueued() {
+}
+
+bool SimpleNTP::run() {
+    // One round trip to the NTP server.
+    delay(150);
+    return false;
+}
+
+void CoreState::configure(ModuleInfo &module) {
+    for (auto &m : modules_) {
+        if (m == nullptr || m->address == module.address) {
+            m = &module;
+            return;
+        }
+    }
+}
+
+ModuleInfo *CoreState::getModule(uint8_t address) {
+    for (auto m : modules_) {
+        if (m != nullptr && m->address == address) {
+            return m;
+        }
+    }
+    return nullptr;
+}
+
+void CoreState::merge(ModuleInfo &module, IncomingSensorReading &reading) {
+    if (reading.sensor >= module.numberOfSensors) {
+        return;
+    }
+    auto &r = module.readings[reading.sensor];
+    r.time = reading.time;
+    r.value = reading.value;
+    r.available = true;
+    merged_++;
+}
+
+bool BatteryGauge::available() {
+    sim::Clock::advance(simulation.bus.i2cTransaction);
+    return simulation.gauge.present;
+}
+
+BatteryReading BatteryGauge::read() {
+    sim::Clock::advance(simulation.bus.i2cTransaction * 4);
+    auto hours = (float)sim::Clock::now() / (3600.0f * 1000000.0f);
+    // The counter only moves in whole LSBs.
+    auto counter = (uint32_t)(simulation.gauge.current * hours / 0.085f);
+    return BatteryReading{
+        simulation.gauge.voltage,
+        simulation.gauge.current,
+        counter * 0.085f,
+        counter,
+    };
+}
+
+uint8_t WiFiClass::begin(const char *ssid, const char *password) {
+    // Association and DHCP.
+    delay(simulation.wifi.associate);
+    associated_ = simulation.wifi.present;
+    return status();
+}
+
+}
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "simulation.h"
+#include "devices.h"
+
+namespace fk {
+
+namespace sim {
+
+constexpr size_t MaximumBoards = 8;
+
+struct Sht31Device {
+    bool converting{ false };
+    uint64_t readyAt{ 0 };
+};
+
+struct Mpl3115a2Device {
+    uint8_t reg{ 0 };
+    uint8_t ctrl1{ 0 };
+    bool converting{ false };
+    uint64_t readyAt{ 0 };
+    bool sampled{ false };
+    uint8_t out[5] = { 0 };
+};
+
+struct Tsl2591Device {
+    uint8_t reg{ 0 };
+    bool enabled{ false };
+    uint64_t readyAt{ 0 };
+};
+
+/* Only the address pointer, the array reads as erased but for the EUI-64. */
+struct MacEepromDevice {
+    uint8_t reg{ 0 };
+};
+
+static Sht31Device sht31s[MaximumBoards];
+static Mpl3115a2Device mpl3115a2s[MaximumBoards];
+static Tsl2591Device tsl2591s[MaximumBoards];
+static MacEepromDevice macEeprom;
+
+static uint8_t sht31_crc(const uint8_t *data, size_t size) {
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (auto bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t quantize(double value, double scale, double offset) {
+    auto raw = std::round((value + offset) * scale);
+    return (uint16_t)std::max(0.0, std::min(65535.0, raw));
+}
+
+static bool sht31_write(Sht31Device &device, const uint8_t *data, size_t size) {
+    // Single shot, high repeatability, no clock stretching. Resets and the
+    // rest are just acknowledged.
+    if (size >= 2 && data[0] == 0x24 && data[1] == 0x00) {
+        device.converting = true;
+        device.readyAt = Clock::now() + simulation.sht31.conversion;
+    }
+    return true;
+}
+
+static size_t sht31_read(Sht31Device &device, uint8_t *data, size_t size) {
+    // Busy, or nothing to read, is a NACK.
+    if (!device.converting || Clock::now() < device.readyAt || size < 6) {
+        return 0;
+    }
+    device.converting = false;
+
+    auto temperature = NAN;
+    auto humidity = NAN;
+    auto &model = simulation.sht31;
+    if (simulation.playback != nullptr) {
+        if (!simulation.playback->sht31(temperature, humidity)) {
+            return 0;
+        }
+    }
+    else if (!model.fails()) {
+        temperature = model.temperature.at(Clock::now());
+        humidity = model.humidity.at(Clock::now());
+    }
+    if (std::isnan(temperature) || std::isnan(humidity)) {
+        return 0;
+    }
+
+    auto t = quantize(temperature, 65535.0 / 175.0, 45.0);
+    auto h = quantize(humidity, 65535.0 / 100.0, 0.0);
+    data[0] = t >> 8;
+    data[1] = t & 0xff;
+    data[2] = sht31_crc(data, 2);
+    data[3] = h >> 8;
+    data[4] = h & 0xff;
+    data[5] = sht31_crc(data + 3, 2);
+    return 6;
+}
+
+static void mpl3115a2_sample(Mpl3115a2Device &device) {
+    device.converting = false;
+    device.ctrl1 &= ~0x02;
+
+    auto pressure = NAN;
+    auto altitude = 0.0f;
+    auto temperature = NAN;
+    auto &model = simulation.mpl3115a2;
+    if (simulation.playback != nullptr) {
+        if (!simulation.playback->mpl3115a2(pressure, altitude, temperature)) {
+            pressure = NAN;
+        }
+    }
+    else if (!model.fails()) {
+        pressure = model.pressure.at(Clock::now());
+        temperature = model.temperature.at(Clock::now());
+    }
+
+    device.sampled = !std::isnan(pressure) && !std::isnan(temperature);
+    if (!device.sampled) {
+        return;
+    }
+
+    // Q18.2 pascals and Q8.4 celsius, left justified.
+    auto p = (uint32_t)std::round(pressure * 4.0) << 4;
+    auto t = (uint16_t)((int16_t)std::round(temperature * 16.0) << 4);
+    device.out[0] = (p >> 16) & 0xff;
+    device.out[1] = (p >> 8) & 0xff;
+    device.out[2] = p & 0xff;
+    device.out[3] = t >> 8;
+    device.out[4] = t & 0xff;
+}
+
+static bool mpl3115a2_write(Mpl3115a2Device &device, const uint8_t *data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    device.reg = data[0];
+    if (device.reg == 0x26 && size >= 2) {
+        device.ctrl1 = data[1];
+        if (device.ctrl1 & 0x02) {
+            device.converting = true;
+            device.sampled = false;
+            device.readyAt = Clock::now() + simulation.mpl3115a2.conversion;
+        }
+    }
+    return true;
+}
+
+static size_t mpl3115a2_read(Mpl3115a2Device &device, uint8_t *data, size_t size) {
+    if (device.converting && Clock::now() >= device.readyAt) {
+        mpl3115a2_sample(device);
+        // A failed conversion stops answering.
+        if (!device.sampled) {
+            return 0;
+        }
+    }
+
+    memset(data, 0, size);
+    switch (device.reg) {
+    case 0x00: {
+        data[0] = device.sampled ? 0x0E : 0x00;
+        break;
+    }
+    case 0x01: {
+        memcpy(data, device.out, std::min(size, sizeof(device.out)));
+        break;
+    }
+    case 0x0C: {
+        data[0] = 0xC4;
+        break;
+    }
+    case 0x26: {
+        data[0] = device.ctrl1;
+        break;
+    }
+    default: {
+        break;
+    }
+    }
+    return size;
+}
+
+static bool tsl2591_write(Tsl2591Device &device, const uint8_t *data, size_t size) {
+    // Normal transactions only, special functions are just acknowledged.
+    if (size == 0 || (data[0] & 0xE0) != 0xA0) {
+        return true;
+    }
+    device.reg = data[0] & 0x1F;
+    if (device.reg == 0x00 && size >= 2) {
+        auto enabled = (data[1] & 0x03) == 0x03;
+        if (enabled && !device.enabled) {
+            device.readyAt = Clock::now() + simulation.tsl2591.conversion;
+        }
+        device.enabled = enabled;
+    }
+    return true;
+}
+
+static size_t tsl2591_read(Tsl2591Device &device, uint8_t *data, size_t size) {
+    auto valid = device.enabled && Clock::now() >= device.readyAt;
+
+    memset(data, 0, size);
+    switch (device.reg) {
+    case 0x12: {
+        data[0] = 0x50;
+        break;
+    }
+    case 0x13: {
+        data[0] = valid ? 0x01 : 0x00;
+        break;
+    }
+    case 0x14: {
+        if (!valid || size < 4) {
+            break;
+        }
+
+        uint32_t fullLuminosity = 0;
+        auto &model = simulation.tsl2591;
+        if (simulation.playback != nullptr) {
+            if (!simulation.playback->tsl2591(fullLuminosity)) {
+                return 0;
+            }
+        }
+        else {
+            if (model.fails()) {
+                return 0;
+            }
+            auto full = std::max(0.0f, std::min(65535.0f, model.full.at(Clock::now())));
+            auto ir = std::max(0.0f, std::min(full, model.ir.at(Clock::now())));
+            fullLuminosity = ((uint32_t)ir << 16) | (uint32_t)full;
+        }
+
+        data[0] = fullLuminosity & 0xff;
+        data[1] = (fullLuminosity >> 8) & 0xff;
+        data[2] = (fullLuminosity >> 16) & 0xff;
+        data[3] = (fullLuminosity >> 24) & 0xff;
+        break;
+    }
+    default: {
+        break;
+    }
+    }
+    return size;
+}
+
+static bool mac_eeprom_write(MacEepromDevice &device, const uint8_t *data, size_t size) {
+    if (size >= 1) {
+        device.reg = data[0];
+    }
+    return true;
+}
+
+static size_t mac_eeprom_read(MacEepromDevice &device, uint8_t *data, size_t size) {
+    auto serial = simulation.mac.serial;
+    uint8_t eui[] = { 0x00, 0x04, 0xa3, 0x0b, (uint8_t)(serial >> 24), (uint8_t)(serial >> 16), (uint8_t)(serial >> 8), (uint8_t)serial };
+    for (size_t i = 0; i < size; ++i, ++device.reg) {
+        data[i] = device.reg >= 0xf8 ? eui[device.reg - 0xf8] : 0xff;
+    }
+    return size;
+}
+
+bool device_write(uint8_t bus, uint8_t board, uint8_t address, const uint8_t *data, size_t size) {
+    if (bus == 0 && address == 0x50) {
+        return mac_eeprom_write(macEeprom, data, size);
+    }
+    if (bus != 0 || board >= MaximumBoards) {
+        return true;
+    }
+    switch (address) {
+    case 0x44: return sht31_write(sht31s[board], data, size);
+    case 0x60: return mpl3115a2_write(mpl3115a2s[board], data, size);
+    case 0x29: return tsl2591_write(tsl2591s[board], data, size);
+    default: return true;
+    }
+}
+
+size_t device_read(uint8_t bus, uint8_t board, uint8_t address, uint8_t *data, size_t size) {
+    if (bus == 0 && address == 0x50) {
+        return mac_eeprom_read(macEeprom, data, size);
+    }
+    if (bus == 0 && board < MaximumBoards) {
+        switch (address) {
+        case 0x44: return sht31_read(sht31s[board], data, size);
+        case 0x60: return mpl3115a2_read(mpl3115a2s[board], data, size);
+        case 0x29: return tsl2591_read(tsl2591s[board], data, size);
+        default: break;
+        }
+    }
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = 0xA5 ^ (uint8_t)(size - 1 - i);
+    }
+    return size;
+}
+
+}
+
+}
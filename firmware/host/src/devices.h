@@ -0,0 +1,29 @@
+#ifndef FK_HOST_DEVICES_H_INCLUDED
+#define FK_HOST_DEVICES_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+namespace sim {
+
+/**
+ * Register level models of the SHT31, MPL3115A2 and TSL2591, one of each
+ * per board, enough of them for configuring by the drivers and for the
+ * firmware's split phase conversions. A conversion's result is drawn from
+ * the models, or the playback, when it's first read. The core board's MAC
+ * EEPROM has its EUI-64, anything else on the bus reads as a fixed pattern.
+ */
+bool device_write(uint8_t bus, uint8_t board, uint8_t address, const uint8_t *data, size_t size);
+
+/**
+ * Returns the number of bytes read, 0 is a NACK.
+ */
+size_t device_read(uint8_t bus, uint8_t board, uint8_t address, uint8_t *data, size_t size);
+
+}
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <fk-core.h>
+
+#include "simulation.h"
+
+using fk::sim::Clock;
+using fk::sim::simulation;
+
+namespace phylum {
+
+constexpr uint16_t SectorSize = 512;
+constexpr uint16_t SectorsPerPage = 4;
+constexpr uint16_t PagesPerBlock = 4;
+
+static uint8_t *memory = nullptr;
+static size_t capacity = 0;
+
+static void sectors(size_t n, bool writing) {
+    auto count = (n + SectorSize - 1) / SectorSize;
+    for (size_t i = 0; i < count; ++i) {
+        Clock::advance(simulation.sd.command + (uint64_t)SectorSize * simulation.sd.byteNanoseconds / 1000);
+        if (writing) {
+            Clock::advance(simulation.sd.writeBusy);
+            if (simulation.random() < simulation.sd.stallRate) {
+                Clock::advance(simulation.sd.stall);
+            }
+        }
+    }
+}
+
+bool ArduinoSdBackend::initialize(const Geometry &g, uint8_t cs) {
+    if (!simulation.sd.present) {
+        return false;
+    }
+
+    geometry_.number_of_blocks = simulation.sd.numberOfBlocks;
+    geometry_.pages_per_block = PagesPerBlock;
+    geometry_.sectors_per_page = SectorsPerPage;
+    geometry_.sector_size = SectorSize;
+
+    auto required = size();
+    if (memory == nullptr || capacity != required) {
+        free(memory);
+        memory = (uint8_t *)malloc(required);
+        memset(memory, 0xff, required);
+        capacity = required;
+    }
+
+    // Card initialization, CMD0 through ACMD41.
+    Clock::advance(50 * 1000);
+
+    return true;
+}
+
+bool ArduinoSdBackend::open() {
+    return memory != nullptr;
+}
+
+bool ArduinoSdBackend::close() {
+    return true;
+}
+
+Geometry &ArduinoSdBackend::geometry() {
+    return geometry_;
+}
+
+size_t ArduinoSdBackend::size() {
+    return (size_t)geometry_.number_of_blocks * geometry_.pages_per_block * geometry_.sectors_per_page * geometry_.sector_size;
+}
+
+bool ArduinoSdBackend::erase(block_index_t block) {
+    auto p = at(BlockAddress{ block, 0 }, size() / geometry_.number_of_blocks);
+    if (p == nullptr) {
+        return false;
+    }
+    memset(p, 0xff, size() / geometry_.number_of_blocks);
+    Clock::advance(simulation.sd.command + simulation.sd.writeBusy);
+    return true;
+}
+
+bool ArduinoSdBackend::read(BlockAddress addr, void *d, size_t n) {
+    auto p = at(addr, n);
+    if (p == nullptr) {
+        return false;
+    }
+    sectors(n, false);
+    memcpy(d, p, n);
+    return true;
+}
+
+bool ArduinoSdBackend::write(BlockAddress addr, void *d, size_t n) {
+    auto p = at(addr, n);
+    if (p == nullptr) {
+        return false;
+    }
+    // Partial sectors are read and written back whole.
+    if (n % SectorSize != 0 || addr.position % SectorSize != 0) {
+        sectors(n, false);
+    }
+    sectors(n, true);
+    memcpy(p, d, n);
+    return true;
+}
+
+uint8_t *ArduinoSdBackend::at(BlockAddress addr, size_t n) {
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    auto offset = (size_t)addr.block * (size() / geometry_.number_of_blocks) + addr.position;
+    if (offset + n > capacity) {
+        return nullptr;
+    }
+    return memory + offset;
+}
+
+}
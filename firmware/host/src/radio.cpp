@@ -0,0 +1,79 @@
+#include <cmath>
+#include <cstring>
+
+#include <RH_RF95.h>
+
+#include "simulation.h"
+
+using namespace fk::sim;
+
+struct ModemConfig {
+    uint32_t bandwidth;
+    uint8_t spreadingFactor;
+    /* Coding rate, 4/(4 + codingRate). */
+    uint8_t codingRate;
+};
+
+/* Of the receiver's acks, see LoraFrameAck. */
+constexpr uint8_t AckSize = 6;
+
+static const ModemConfig configs[] = {
+    { 125000, 7, 1 },
+    { 500000, 7, 1 },
+    { 31250, 9, 4 },
+    { 125000, 12, 4 },
+};
+
+/**
+ * From the SX1276 datasheet, with an 8 symbol preamble, explicit header and
+ * CRC, and the low data rate optimization above 16ms symbols, as RadioHead
+ * configures it.
+ */
+static uint64_t airtime(const ModemConfig &config, uint8_t size) {
+    auto symbol = (double)(1 << config.spreadingFactor) / config.bandwidth;
+    auto optimize = symbol > 0.016 ? 1 : 0;
+    auto numerator = 8.0 * size - 4.0 * config.spreadingFactor + 28 + 16;
+    auto denominator = 4.0 * (config.spreadingFactor - 2 * optimize);
+    auto payload = 8 + std::max(std::ceil(numerator / denominator) * (config.codingRate + 4), 0.0);
+    return (uint64_t)(((8 + 4.25) + payload) * symbol * 1000000.0);
+}
+
+bool RH_RF95::init() {
+    return simulation.lora.present;
+}
+
+bool RH_RF95::send(const uint8_t *data, uint8_t size) {
+    memcpy(sent_, data, size);
+    size_ = size;
+    heard_ = simulation.random() >= simulation.lora.lossRate;
+    return true;
+}
+
+bool RH_RF95::waitPacketSent() {
+    Clock::advance(airtime(configs[config_], size_));
+    return true;
+}
+
+bool RH_RF95::waitAvailableTimeout(uint16_t timeout) {
+    // The receiver acks every frame it hears, after turning around.
+    if (!heard_ || simulation.random() < simulation.lora.lossRate) {
+        Clock::advance((uint64_t)timeout * 1000);
+        return false;
+    }
+    Clock::advance(simulation.lora.turnaround + airtime(configs[config_], AckSize));
+    heard_ = false;
+    available_ = true;
+    return true;
+}
+
+bool RH_RF95::recv(uint8_t *buffer, uint8_t *size) {
+    if (!available_ || *size < AckSize || size_ < AckSize) {
+        return false;
+    }
+    // The device and sequence, after the frame's version.
+    buffer[0] = 0xAC;
+    memcpy(buffer + 1, sent_ + 1, AckSize - 1);
+    *size = AckSize;
+    available_ = false;
+    return true;
+}
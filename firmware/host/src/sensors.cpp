@@ -0,0 +1,246 @@
+#include <cmath>
+
+#include <Adafruit_BNO055.h>
+#include <Adafruit_MPL3115A2.h>
+#include <Adafruit_TSL2591.h>
+#include <Adafruit_SHT31.h>
+#include <AmplitudeAnalyzer.h>
+#include <AudioInI2S.h>
+#include <../src/I2S.h>
+
+#include "simulation.h"
+
+using fk::sim::Clock;
+using fk::sim::Device;
+using fk::sim::simulation;
+
+AudioInI2SClass AudioInI2S;
+I2SClass I2S;
+
+static bool begin(Device device, const fk::sim::SensorModel &model, const TwoWire &bus = Wire) {
+    auto ok = false;
+    if (simulation.playback != nullptr && simulation.playback->begin(device, ok)) {
+        return ok;
+    }
+    Clock::advance(simulation.bus.i2cTransaction * 2);
+    // Only the boards that are there, whichever the mux has selected.
+    return model.present && bus.board() < simulation.boards;
+}
+
+static float measure(const fk::sim::SensorModel &model, const fk::sim::Waveform &waveform) {
+    Clock::advance(model.latency + simulation.bus.i2cTransaction);
+    if (model.fails()) {
+        return NAN;
+    }
+    return waveform.at(Clock::now());
+}
+
+// Values of the last playback, for the calls that read more than one
+// register of the same conversion.
+static float sht31Humidity = NAN;
+static float mplAltitude = 0.0f;
+static float mplTemperature = 0.0f;
+static float bnoOrientation[3] = { 0.0f };
+
+bool Adafruit_SHT31::begin(uint8_t address) {
+    delay(10);
+    return ::begin(Device::Sht31, simulation.sht31);
+}
+
+float Adafruit_SHT31::readTemperature() {
+    auto temperature = NAN;
+    if (simulation.playback != nullptr) {
+        if (!simulation.playback->sht31(temperature, sht31Humidity)) {
+            sht31Humidity = NAN;
+        }
+        return temperature;
+    }
+    return measure(simulation.sht31, simulation.sht31.temperature);
+}
+
+float Adafruit_SHT31::readHumidity() {
+    if (simulation.playback != nullptr) {
+        return sht31Humidity;
+    }
+    return measure(simulation.sht31, simulation.sht31.humidity);
+}
+
+bool Adafruit_MPL3115A2::begin() {
+    return ::begin(Device::Mpl3115a2, simulation.mpl3115a2);
+}
+
+float Adafruit_MPL3115A2::getPressure() {
+    if (simulation.playback != nullptr) {
+        auto pressure = 0.0f;
+        simulation.playback->mpl3115a2(pressure, mplAltitude, mplTemperature);
+        return pressure;
+    }
+    auto value = measure(simulation.mpl3115a2, simulation.mpl3115a2.pressure);
+    return std::isnan(value) ? 0.0f : value;
+}
+
+float Adafruit_MPL3115A2::getAltitude() {
+    if (simulation.playback != nullptr) {
+        return mplAltitude;
+    }
+    auto pressure = measure(simulation.mpl3115a2, simulation.mpl3115a2.pressure);
+    if (std::isnan(pressure)) {
+        return 0.0f;
+    }
+    return 44330.77f * (1.0f - std::pow(pressure / 101326.0f, 0.1902632f));
+}
+
+float Adafruit_MPL3115A2::getTemperature() {
+    if (simulation.playback != nullptr) {
+        return mplTemperature;
+    }
+    auto value = measure(simulation.mpl3115a2, simulation.mpl3115a2.temperature);
+    return std::isnan(value) ? 0.0f : value;
+}
+
+bool Adafruit_TSL2591::begin() {
+    return ::begin(Device::Tsl2591, simulation.tsl2591);
+}
+
+uint32_t Adafruit_TSL2591::getFullLuminosity() {
+    if (simulation.playback != nullptr) {
+        uint32_t fullLuminosity = 0;
+        simulation.playback->tsl2591(fullLuminosity);
+        return fullLuminosity;
+    }
+    auto &model = simulation.tsl2591;
+    Clock::advance(model.latency + simulation.bus.i2cTransaction * 2);
+    if (model.fails()) {
+        return 0;
+    }
+    auto full = std::max(0.0f, std::min(65535.0f, model.full.at(Clock::now())));
+    auto ir = std::max(0.0f, std::min(full, model.ir.at(Clock::now())));
+    return ((uint32_t)ir << 16) | (uint32_t)full;
+}
+
+float Adafruit_TSL2591::calculateLux(uint16_t ch0, uint16_t ch1) {
+    // Defaults of 100ms integration and medium gain.
+    constexpr float atime = 100.0f;
+    constexpr float again = 25.0f;
+    constexpr float LuxDf = 408.0f;
+    constexpr float LuxCoefB = 1.64f;
+    constexpr float LuxCoefC = 0.59f;
+    constexpr float LuxCoefD = 0.86f;
+
+    if (ch0 == 0xFFFF || ch1 == 0xFFFF) {
+        return 0.0f;
+    }
+
+    auto cpl = (atime * again) / LuxDf;
+    auto lux1 = ((float)ch0 - (LuxCoefB * (float)ch1)) / cpl;
+    auto lux2 = ((LuxCoefC * (float)ch0) - (LuxCoefD * (float)ch1)) / cpl;
+    return std::max(lux1, lux2);
+}
+
+bool Adafruit_BNO055::begin() {
+    if (simulation.playback == nullptr) {
+        // The driver waits for the chip to come out of reset.
+        delay(650);
+    }
+    return ::begin(Device::Bno055, simulation.bno055, Wire4and3);
+}
+
+void Adafruit_BNO055::setExtCrystalUse(bool use) {
+    if (simulation.playback == nullptr) {
+        delay(10);
+    }
+}
+
+void Adafruit_BNO055::getCalibration(uint8_t *system, uint8_t *gyro, uint8_t *accel, uint8_t *mag) {
+    if (simulation.playback != nullptr) {
+        uint8_t calibration[4] = { 0 };
+        simulation.playback->bno055(calibration, bnoOrientation);
+        *system = calibration[0];
+        *gyro = calibration[1];
+        *accel = calibration[2];
+        *mag = calibration[3];
+        return;
+    }
+    Clock::advance(simulation.bus.i2cTransaction);
+    *system = simulation.bno055.calibration;
+    *gyro = simulation.bno055.calibration;
+    *accel = simulation.bno055.calibration;
+    *mag = simulation.bno055.calibration;
+}
+
+bool Adafruit_BNO055::getEvent(sensors_event_t *event) {
+    memset(event, 0, sizeof(sensors_event_t));
+    if (simulation.playback != nullptr) {
+        event->orientation.x = bnoOrientation[0];
+        event->orientation.y = bnoOrientation[1];
+        event->orientation.z = bnoOrientation[2];
+        return true;
+    }
+    auto &model = simulation.bno055;
+    Clock::advance(model.latency);
+    // Heading wraps, like the part's.
+    event->orientation.x = fmodf(model.x.at(Clock::now()) + 360.0f, 360.0f);
+    event->orientation.y = model.y.at(Clock::now());
+    event->orientation.z = model.z.at(Clock::now());
+    return true;
+}
+
+bool AudioInI2SClass::begin(long sampleRate, int bitsPerSample) {
+    auto ok = false;
+    if (simulation.playback != nullptr && simulation.playback->begin(Device::Sph0645, ok)) {
+        return ok;
+    }
+    return simulation.sph0645.present;
+}
+
+bool I2SClass::begin(int mode, long sampleRate, int bitsPerSample) {
+    return simulation.sph0645.present;
+}
+
+bool AmplitudeAnalyzer::input(AudioIn &input) {
+    configured_ = simulation.playback != nullptr || simulation.sph0645.present;
+    next_ = 0;
+    return configured_;
+}
+
+static float playbackAmplitude = 0.0f;
+
+bool AmplitudeAnalyzer::available() {
+    if (simulation.playback != nullptr) {
+        if (simulation.playback->audio(playbackAmplitude)) {
+            return true;
+        }
+        Clock::advance(simulation.bus.pollQuantum);
+        return false;
+    }
+
+    if (!configured_) {
+        Clock::advance(simulation.bus.pollQuantum);
+        return false;
+    }
+
+    auto &model = simulation.sph0645;
+    auto period = (uint64_t)model.samplesPerBlock * 1000000 / model.sampleRate;
+    if (next_ == 0 || next_ + period < Clock::now()) {
+        // Blocks that arrived while we weren't listening are overwritten.
+        next_ = Clock::now() - Clock::now() % period + period;
+    }
+
+    // Spin until the next block is ready, which is all the firmware does
+    // while it's waiting anyway.
+    Clock::advanceTo(next_);
+    return true;
+}
+
+float AmplitudeAnalyzer::read() {
+    if (simulation.playback != nullptr) {
+        return playbackAmplitude;
+    }
+    auto &model = simulation.sph0645;
+    auto period = (uint64_t)model.samplesPerBlock * 1000000 / model.sampleRate;
+    next_ += period;
+    if (model.dropRate > 0.0f && simulation.random() < model.dropRate) {
+        return 0.0f;
+    }
+    return std::max(0.0f, model.rms.at(Clock::now()));
+}
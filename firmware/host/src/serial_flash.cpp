@@ -0,0 +1,211 @@
+#include <algorithm>
+
+#include <SerialFlash.h>
+
+#include "simulation.h"
+
+using fk::sim::Clock;
+using fk::sim::simulation;
+
+SerialFlashChip SerialFlash;
+
+constexpr uint32_t SectorSize = 4 * 1024;
+constexpr uint32_t PageSize = 256;
+
+bool SerialFlashChip::begin(uint8_t cs) {
+    if (memory_ == nullptr || capacity_ != simulation.flash.capacity) {
+        capacity_ = simulation.flash.capacity;
+        memory_ = (uint8_t *)realloc(memory_, capacity_);
+        memset(memory_, 0xff, capacity_);
+    }
+    return true;
+}
+
+void SerialFlashChip::readID(uint8_t *buffer) {
+    wait();
+    // A W25Q of our capacity, the last byte is its log2.
+    uint8_t bits = 0;
+    while (bits < 31 && ((uint32_t)1 << (bits + 1)) <= capacity_) {
+        bits++;
+    }
+    buffer[0] = 0xEF;
+    buffer[1] = 0x40;
+    buffer[2] = bits;
+}
+
+uint32_t SerialFlashChip::capacity(const uint8_t *id) {
+    return (uint32_t)1 << id[2];
+}
+
+uint32_t SerialFlashChip::blockSize() {
+    return simulation.flash.blockSize;
+}
+
+void SerialFlashChip::eraseAll() {
+    wait();
+    memset(memory_, 0xff, capacity_);
+    busyUntil_ = Clock::now() + (uint64_t)simulation.flash.chipErase * 1000;
+}
+
+void SerialFlashChip::eraseBlock(uint32_t address) {
+    wait();
+    auto blockSize = simulation.flash.blockSize;
+    address -= address % blockSize;
+    if (address < capacity_) {
+        memset(memory_ + address, 0xff, std::min(blockSize, capacity_ - address));
+    }
+    busyUntil_ = Clock::now() + simulation.flash.blockErase;
+}
+
+bool SerialFlashChip::ready() {
+    Clock::advance(simulation.bus.pollQuantum);
+    return Clock::now() >= busyUntil_;
+}
+
+void SerialFlashChip::read(uint32_t address, void *buffer, uint32_t length) {
+    wait();
+    Clock::advance(simulation.flash.command + (uint64_t)length * simulation.flash.byteNanoseconds / 1000);
+    for (uint32_t i = 0; i < length; ++i) {
+        ((uint8_t *)buffer)[i] = memory_[(address + i) % capacity_];
+    }
+}
+
+void SerialFlashChip::write(uint32_t address, const void *buffer, uint32_t length) {
+    auto p = (const uint8_t *)buffer;
+    while (length > 0) {
+        wait();
+        auto programming = std::min(length, PageSize - address % PageSize);
+        for (uint32_t i = 0; i < programming; ++i) {
+            // Programming can only clear bits.
+            memory_[(address + i) % capacity_] &= p[i];
+        }
+        // The library clocks program data out a byte at a time.
+        Clock::advance(simulation.flash.command + (uint64_t)programming * (simulation.flash.byteNanoseconds + simulation.bus.spiCall) / 1000);
+        busyUntil_ = Clock::now() + simulation.flash.pageProgram;
+        address += programming;
+        p += programming;
+        length -= programming;
+    }
+}
+
+const uint8_t *SerialFlashChip::memory() {
+    begin(0);
+    return memory_;
+}
+
+void SerialFlashChip::select(bool selected) {
+    if (selected == selected_) {
+        return;
+    }
+
+    begin(0);
+
+    selected_ = selected;
+
+    if (selected) {
+        position_ = 0;
+        return;
+    }
+
+    auto busy = Clock::now() < busyUntil_;
+    auto addressed = position_ >= 4;
+
+    switch (command_) {
+    case 0x02: {
+        if (addressed && position_ > 4 && writeEnabled_ && !busy) {
+            busyUntil_ = Clock::now() + simulation.flash.pageProgram;
+            writeEnabled_ = false;
+        }
+        break;
+    }
+    case 0x20: {
+        if (addressed && writeEnabled_ && !busy) {
+            auto sector = address_ - address_ % SectorSize;
+            memset(memory_ + sector % capacity_, 0xff, SectorSize);
+            busyUntil_ = Clock::now() + simulation.flash.sectorErase;
+            writeEnabled_ = false;
+        }
+        break;
+    }
+    case 0xD8: {
+        if (addressed && writeEnabled_ && !busy) {
+            auto blockSize = simulation.flash.blockSize;
+            auto block = (address_ - address_ % blockSize) % capacity_;
+            memset(memory_ + block, 0xff, std::min(blockSize, capacity_ - block));
+            busyUntil_ = Clock::now() + simulation.flash.blockErase;
+            writeEnabled_ = false;
+        }
+        break;
+    }
+    }
+
+    command_ = 0;
+}
+
+uint8_t SerialFlashChip::transfer(uint8_t data) {
+    if (!selected_) {
+        return 0xff;
+    }
+
+    auto busy = Clock::now() < busyUntil_;
+    auto position = position_++;
+
+    if (position == 0) {
+        command_ = data;
+        address_ = 0;
+        if (data == 0x06 && !busy) {
+            writeEnabled_ = true;
+        }
+        return 0xff;
+    }
+
+    switch (command_) {
+    case 0x05: {
+        return (busy ? 0x01 : 0x00) | (writeEnabled_ ? 0x02 : 0x00);
+    }
+    case 0x9F: {
+        if (busy) {
+            return 0xff;
+        }
+        uint8_t id[3];
+        readID(id);
+        return position <= 3 ? id[position - 1] : 0xff;
+    }
+    case 0x02:
+    case 0x03:
+    case 0x0B:
+    case 0x20:
+    case 0xD8: {
+        if (position <= 3) {
+            address_ = (address_ << 8) | data;
+            return 0xff;
+        }
+        if (busy) {
+            return 0xff;
+        }
+        if (command_ == 0x03) {
+            return memory_[address_++ % capacity_];
+        }
+        if (command_ == 0x0B) {
+            // One dummy byte before the data.
+            if (position == 4) {
+                return 0xff;
+            }
+            return memory_[address_++ % capacity_];
+        }
+        if (command_ == 0x02 && writeEnabled_) {
+            // Programs wrap around within the page.
+            auto page = address_ - address_ % PageSize;
+            auto offset = (address_ + position - 4) % PageSize;
+            memory_[(page + offset) % capacity_] &= data;
+        }
+        return 0xff;
+    }
+    }
+
+    return 0xff;
+}
+
+void SerialFlashChip::wait() {
+    Clock::advanceTo(busyUntil_);
+}
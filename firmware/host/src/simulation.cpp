@@ -0,0 +1,99 @@
+#include <cmath>
+
+#include "simulation.h"
+
+namespace fk {
+
+namespace sim {
+
+uint64_t Clock::now_{ 0 };
+
+Simulation simulation;
+
+float Waveform::at(uint64_t us) const {
+    auto t = (double)us / 1000000.0;
+    auto value = offset + amplitude * (float)std::sin(2.0 * M_PI * t / period);
+    if (noise > 0.0f) {
+        value += noise * (simulation.random() * 2.0f - 1.0f);
+    }
+    if (t >= eventAt && t < eventAt + eventFor) {
+        value += event;
+    }
+    return value;
+}
+
+bool SensorModel::fails() const {
+    if (!present) {
+        return true;
+    }
+    return failureRate > 0.0f && simulation.random() < failureRate;
+}
+
+Simulation::Simulation() {
+    reset();
+}
+
+void Simulation::reset() {
+    // Durations of the blocking driver calls as they are written today, and
+    // typical conversion times from the datasheets.
+    sht31 = Sht31Model{};
+    sht31.latency = 500 * 1000;
+    sht31.conversion = 12500;
+    mpl3115a2 = Mpl3115a2Model{};
+    mpl3115a2.latency = 512 * 1000;
+    mpl3115a2.conversion = 500 * 1000;
+    tsl2591 = Tsl2591Model{};
+    tsl2591.latency = 120 * 1000;
+    tsl2591.conversion = 110 * 1000;
+    bno055 = Bno055Model{};
+    bno055.latency = 2 * 1000;
+    sph0645 = Sph0645Model{};
+    gps = GpsModel{};
+    gauge = GaugeModel{};
+    mac = MacEepromModel{};
+    flash = FlashModel{};
+    sd = SdModel{};
+    lora = LoraModel{};
+    wifi = WifiModel{};
+    rtc = RtcModel{};
+    bus = BusModel{};
+    boards = 1;
+    seed = 0x2545F4914F6CDD1DULL;
+}
+
+float Simulation::random() {
+    // xorshift64*
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    auto value = seed * 0x2545F4914F6CDD1DULL;
+    return (float)(value >> 40) / (float)(1 << 24);
+}
+
+bool Simulation::present(uint8_t bus, uint8_t address, uint8_t board) const {
+    auto fitted = board < boards;
+    if (bus == 0) {
+        switch (address) {
+        case 0x44: return fitted && sht31.present;
+        case 0x60: return fitted && mpl3115a2.present;
+        case 0x29: return fitted && tsl2591.present;
+        case 0x70: return boards > 1;
+        case 0x50: return true;
+        case 0x68: return true;
+        case 0x64: return gauge.present;
+        default: return false;
+        }
+    }
+    if (bus == 1) {
+        switch (address) {
+        case 0x28: return fitted && bno055.present;
+        case 0x70: return boards > 1;
+        default: return false;
+        }
+    }
+    return false;
+}
+
+}
+
+}
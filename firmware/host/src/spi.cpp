@@ -0,0 +1,31 @@
+#include <SPI.h>
+#include <SerialFlash.h>
+
+#include "simulation.h"
+
+using fk::sim::Clock;
+using fk::sim::simulation;
+
+SPIClass SPI;
+
+// Single bytes take less than a microsecond, so carry what's left over.
+static uint64_t nanoseconds = 0;
+
+static void spend(uint64_t ns) {
+    nanoseconds += ns;
+    Clock::advance(nanoseconds / 1000);
+    nanoseconds %= 1000;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+    spend(simulation.bus.spiCall + simulation.flash.byteNanoseconds);
+    return SerialFlash.transfer(data);
+}
+
+void SPIClass::transfer(void *buffer, size_t size) {
+    spend(simulation.bus.spiCall + (uint64_t)size * simulation.flash.byteNanoseconds);
+    auto p = (uint8_t *)buffer;
+    for (size_t i = 0; i < size; ++i) {
+        p[i] = SerialFlash.transfer(p[i]);
+    }
+}
@@ -0,0 +1,110 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <fk-core.h>
+
+#include "simulation.h"
+
+using fk::sim::simulation;
+
+namespace fk {
+
+WiFiClient::~WiFiClient() {
+    free(request_);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+    stop();
+    if (WiFi.status() != WL_CONNECTED) {
+        return 0;
+    }
+    sim::Clock::advance(simulation.wifi.connect);
+    connected_ = true;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+    if (!connected_ || WiFi.status() != WL_CONNECTED) {
+        return 0;
+    }
+
+    sim::Clock::advance(simulation.wifi.write + (uint64_t)size * simulation.wifi.byteNanoseconds / 1000);
+
+    if (simulation.wifi.dropRate > 0.0f && simulation.random() < simulation.wifi.dropRate) {
+        stop();
+        return 0;
+    }
+
+    if (size_ + size > capacity_) {
+        capacity_ = std::max(capacity_ * 2, size_ + size);
+        request_ = (uint8_t *)realloc(request_, capacity_);
+    }
+    memcpy(request_ + size_, buffer, size);
+    size_ += size;
+
+    respond();
+
+    return size;
+}
+
+void WiFiClient::respond() {
+    auto end = (const uint8_t *)memmem(request_, size_, "\r\n\r\n", 4);
+    if (end == nullptr) {
+        return;
+    }
+
+    auto headers = (size_t)(end - request_) + 4;
+    char head[512];
+    auto length = std::min(headers, sizeof(head) - 1);
+    memcpy(head, request_, length);
+    head[length] = 0;
+
+    auto field = strstr(head, "Content-Length: ");
+    auto body = field != nullptr ? strtoul(field + strlen("Content-Length: "), nullptr, 10) : 0;
+    if (size_ < headers + body) {
+        return;
+    }
+
+    char path[128] = { 0 };
+    sscanf(head, "%*s %127s", path);
+
+    uint16_t status = 200;
+    if (simulation.wifi.server != nullptr) {
+        status = simulation.wifi.server->request(path, request_ + headers, body);
+    }
+
+    responseSize_ = snprintf(response_, sizeof(response_), "HTTP/1.1 %u OK\r\nContent-Length: 0\r\n\r\n", status);
+    responsePosition_ = 0;
+    respondAt_ = sim::Clock::now() + simulation.wifi.roundTrip;
+
+    memmove(request_, request_ + headers + body, size_ - headers - body);
+    size_ -= headers + body;
+}
+
+int WiFiClient::available() {
+    if (responsePosition_ < responseSize_ && sim::Clock::now() >= respondAt_) {
+        return responseSize_ - responsePosition_;
+    }
+    sim::Clock::advance(simulation.bus.pollQuantum);
+    return 0;
+}
+
+int WiFiClient::read() {
+    if (available() == 0) {
+        return -1;
+    }
+    return response_[responsePosition_++];
+}
+
+void WiFiClient::stop() {
+    connected_ = false;
+    size_ = 0;
+    responseSize_ = 0;
+    responsePosition_ = 0;
+}
+
+uint8_t WiFiClient::connected() {
+    return connected_ && WiFi.status() == WL_CONNECTED;
+}
+
+}
@@ -0,0 +1,85 @@
+#include <Wire.h>
+
+#include "simulation.h"
+#include "devices.h"
+
+using fk::sim::Clock;
+using fk::sim::simulation;
+
+constexpr uint8_t Tca9548aAddress = 0x70;
+
+TwoWire Wire{ 0 };
+TwoWire Wire4and3{ 1 };
+
+uint8_t TwoWire::board() const {
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (channels_ & (1 << i)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void TwoWire::begin() {
+}
+
+void TwoWire::end() {
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    address_ = address;
+    txSize_ = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+    auto size = txSize_;
+    txSize_ = 0;
+
+    // Only probes are recorded, they're the transmissions with no data.
+    auto ack = false;
+    if (size == 0 && simulation.playback != nullptr && simulation.playback->probe(bus_, address_, ack)) {
+        return ack ? 0 : 2;
+    }
+    Clock::advance(simulation.bus.i2cTransaction);
+    // 2 is a NACK on the address, 3 on the data.
+    if (!simulation.present(bus_, address_, board())) {
+        return 2;
+    }
+    if (address_ == Tca9548aAddress) {
+        if (size > 0) {
+            channels_ = tx_[0];
+        }
+        return 0;
+    }
+    return fk::sim::device_write(bus_, board(), address_, tx_, size) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool stop) {
+    Clock::advance(simulation.bus.i2cTransaction);
+    rxSize_ = 0;
+    rxPosition_ = 0;
+    if (!simulation.present(bus_, address, board())) {
+        return 0;
+    }
+    rxSize_ = fk::sim::device_read(bus_, board(), address, rx_, std::min(quantity, sizeof(rx_)));
+    return rxSize_;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (txSize_ == sizeof(tx_)) {
+        return 0;
+    }
+    tx_[txSize_++] = data;
+    return 1;
+}
+
+int TwoWire::available() {
+    return rxSize_ - rxPosition_;
+}
+
+int TwoWire::read() {
+    if (rxPosition_ == rxSize_) {
+        return -1;
+    }
+    return rx_[rxPosition_++];
+}
@@ -0,0 +1,350 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "series_upload.h"
+#include "varint.h"
+#include "fk-core.h"
+#include "simulation.h"
+#include "options.h"
+
+using namespace fk;
+
+/**
+ * Fills the series store and uploads it over the simulated WiFi two ways:
+ * as today, each reading read back and encoded as a message of its own, and
+ * streamed straight from the flash a short WiFi window at a time, starting
+ * each window from the saved cursor as after a reset. The receiver rebuilds
+ * the blocks and fails the run if they don't decode to what was stored.
+ */
+
+constexpr uint32_t Interval = 60;
+constexpr uint32_t Start = 1500000000;
+
+static SeriesStore store;
+
+static NaturalistValues cycle(uint32_t n) {
+    NaturalistValues values;
+    auto t = (float)n * Interval;
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if ((n + i) % 37 == 0) {
+            continue;
+        }
+        auto base = 1000.0f * (1 + i % 5) / cycle_record_scale((NaturalistChannel)i);
+        auto value = base + base * 0.2f * sinf(2.0f * 3.14159265f * t / 86400.0f) + sim::simulation.random() * base * 0.01f;
+        values.set((NaturalistChannel)i, value);
+    }
+    return values;
+}
+
+/**
+ * A reading as a length delimited message, { time, sensor, value }, about
+ * what the data protocol spends on one.
+ */
+static size_t encode_reading(uint8_t *buffer, uint32_t time, uint8_t sensor, float value) {
+    uint8_t message[32];
+    size_t size = 0;
+    message[size++] = 0x08;
+    size += varint_encode(message + size, time);
+    message[size++] = 0x10;
+    size += varint_encode(message + size, sensor);
+    message[size++] = 0x1d;
+    memcpy(message + size, &value, sizeof(value));
+    size += sizeof(value);
+
+    auto position = varint_encode(buffer, size);
+    memcpy(buffer + position, message, size);
+    return position + size;
+}
+
+/**
+ * Keeps a copy of each block from the segments it's sent, and answers the
+ * record by record uploads by counting them.
+ */
+class Receiver : public sim::Server {
+public:
+    std::map<uint32_t, std::vector<uint8_t>> blocks;
+    std::map<uint32_t, uint32_t> layouts;
+    uint32_t blockSize{ 0 };
+    uint32_t requests{ 0 };
+    uint32_t bytes{ 0 };
+
+public:
+    uint16_t request(const char *path, const uint8_t *body, size_t size) override {
+        requests++;
+        bytes += size;
+
+        if (strcmp(path, FK_NATURALIST_UPLOAD_PATH) != 0) {
+            return 200;
+        }
+
+        uint32_t segment[4];
+        if (size < sizeof(segment)) {
+            return 400;
+        }
+        memcpy(segment, body, sizeof(segment));
+        auto offset = segment[1];
+        auto length = segment[2];
+        if (size != sizeof(segment) + length || offset + length > blockSize) {
+            return 400;
+        }
+
+        auto &block = blocks[segment[0]];
+        if (block.empty()) {
+            block.resize(blockSize, 0xff);
+        }
+        memcpy(block.data() + offset, body + sizeof(segment), length);
+        layouts[segment[0]] = segment[3];
+        return 200;
+    }
+
+    /* Decodes every block, oldest first, false if any of them is corrupt. */
+    bool decode(uint32_t &records, uint32_t &readings, uint64_t &times) const {
+        records = 0;
+        readings = 0;
+        times = 0;
+        for (auto &pair : blocks) {
+            auto &block = pair.second;
+            if (layouts.at(pair.first) != NaturalistChannelLayout) {
+                fprintf(stderr, "block %u has channel layout %#x\n", pair.first, layouts.at(pair.first));
+                return false;
+            }
+            CycleRecordDecoder decoder;
+            auto position = SeriesHeaderSize;
+            while (position < block.size() && block[position] != 0xff) {
+                auto size = block[position];
+                CycleRecord record;
+                if (position + 1 + size > block.size() || decoder.decode(block.data() + position + 1, size, record) != size) {
+                    fprintf(stderr, "block %u corrupt at %u\n", pair.first, position);
+                    return false;
+                }
+                position += 1 + size;
+                if (record.rollup) {
+                    continue;
+                }
+                records++;
+                times += record.time;
+                for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+                    readings += record.values.has(i) ? 1 : 0;
+                }
+            }
+        }
+        return true;
+    }
+
+};
+
+/**
+ * Today's upload: every record decoded, every reading encoded and written
+ * to the module on its own.
+ */
+class LegacyUpload : public SeriesVisitor {
+private:
+    WiFiClient &client_;
+
+public:
+    uint32_t readings{ 0 };
+    uint32_t bytes{ 0 };
+    uint64_t times{ 0 };
+    bool failed{ false };
+
+public:
+    LegacyUpload(WiFiClient &client) : client_(client) {
+    }
+
+public:
+    void visit(const CycleRecord &record) override {
+        times += record.time;
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            if (!record.values.has(i)) {
+                continue;
+            }
+            uint8_t buffer[48];
+            auto size = encode_reading(buffer, record.time, (uint8_t)i, record.values.values[i]);
+            failed = failed || client_.write(buffer, size) != size;
+            readings++;
+            bytes += size;
+        }
+    }
+
+};
+
+class CountingVisitor : public SeriesVisitor {
+public:
+    uint32_t records{ 0 };
+    uint32_t readings{ 0 };
+    uint64_t times{ 0 };
+
+public:
+    void visit(const CycleRecord &record) override {
+        records++;
+        times += record.time;
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            readings += record.values.has(i) ? 1 : 0;
+        }
+    }
+
+};
+
+class SizingVisitor : public SeriesVisitor {
+public:
+    uint32_t bytes{ 0 };
+
+public:
+    void visit(const CycleRecord &record) override {
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            if (record.values.has(i)) {
+                uint8_t buffer[48];
+                bytes += encode_reading(buffer, record.time, (uint8_t)i, record.values.values[i]);
+            }
+        }
+    }
+
+};
+
+static void usage(const char *name) {
+    fprintf(stderr, "usage: %s [--cycles N] [--window MS] [--set name=value]...\n", name);
+    fprintf(stderr, "simulation parameters:\n");
+    sim::simulation_list();
+}
+
+struct Streamed {
+    uint32_t windows{ 0 };
+    uint32_t requests{ 0 };
+    uint32_t bytes{ 0 };
+    uint64_t elapsed{ 0 };
+};
+
+static bool stream(uint32_t window, Streamed &streamed) {
+    while (streamed.windows < 1000) {
+        // Each window is a fresh start, all that's kept is the cursor.
+        SeriesUpload upload;
+        upload.begin();
+
+        WiFi.begin("bench", "");
+        auto started = sim::Clock::now();
+        auto stats = upload.upload(store, "bench", 80, window);
+        streamed.elapsed += sim::Clock::now() - started;
+        WiFi.end();
+
+        streamed.windows++;
+        streamed.requests += stats.requests;
+        streamed.bytes += stats.bytes;
+        if (stats.finished) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t cycles = 3 * 24 * 60;
+    uint32_t window = 10000;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            window = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (!sim::simulation_set(argv[++i])) {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!store.begin()) {
+        fprintf(stderr, "no flash\n");
+        return 1;
+    }
+
+    Receiver receiver;
+    receiver.blockSize = store.blockSize();
+    sim::simulation.wifi.server = &receiver;
+
+    // Most of it now, the rest after the first upload so the second has to
+    // pick up part way through the open block.
+    uint32_t n = 0;
+    for ( ; n < cycles * 3 / 4; ++n) {
+        store.append(Start + n * Interval, cycle(n));
+    }
+
+    auto all = ((uint64_t)1 << NumberOfNaturalistChannels) - 1;
+    auto failures = 0;
+
+    // Today's, with none of the dropped connections, it can't resume.
+    uint32_t legacyReadings = 0;
+    uint32_t legacyBytes = 0;
+    uint64_t legacyElapsed = 0;
+    {
+        SizingVisitor sizing;
+        store.query(0, UINT32_MAX, all, sizing);
+
+        WiFiClient client;
+        LegacyUpload visitor{ client };
+        auto dropRate = sim::simulation.wifi.dropRate;
+        sim::simulation.wifi.dropRate = 0.0f;
+        WiFi.begin("bench", "");
+        auto started = sim::Clock::now();
+        client.connect("bench", 80);
+        char headers[256];
+        auto size = snprintf(headers, sizeof(headers), "POST /readings HTTP/1.1\r\nHost: bench\r\nContent-Length: %u\r\n\r\n", sizing.bytes);
+        client.write((const uint8_t *)headers, size);
+        store.query(0, UINT32_MAX, all, visitor);
+        while (client.available() == 0) {
+        }
+        legacyElapsed = sim::Clock::now() - started;
+        WiFi.end();
+        sim::simulation.wifi.dropRate = dropRate;
+        legacyReadings = visitor.readings;
+        legacyBytes = visitor.bytes;
+        failures += visitor.failed ? 1 : 0;
+    }
+
+    Streamed streamed;
+    auto done = stream(window, streamed);
+
+    for ( ; n < cycles; ++n) {
+        store.append(Start + n * Interval, cycle(n));
+    }
+    auto firstRequests = streamed.requests;
+    done = done && stream(window, streamed);
+
+    uint32_t records = 0, readings = 0;
+    uint64_t times = 0;
+    if (!done || !receiver.decode(records, readings, times)) {
+        failures++;
+    }
+
+    CountingVisitor expected;
+    store.query(0, UINT32_MAX, all, expected);
+
+    if (records != expected.records || readings != expected.readings || times != expected.times) {
+        printf("received %u records %u readings, stored %u records %u readings\n", records, readings, expected.records,
+               expected.readings);
+        failures++;
+    }
+
+    auto legacyMs = legacyElapsed / 1000.0;
+    auto streamedMs = streamed.elapsed / 1000.0;
+    printf("stored:          %u records, %u readings, %u blocks\n", expected.records, expected.readings, store.used());
+    printf("today:           %.0fms, %.1fms/1000 readings, %.1fKB/s (%u readings, %u bytes)\n", legacyMs,
+           legacyMs * 1000.0 / legacyReadings, legacyBytes / legacyMs, legacyReadings, legacyBytes);
+    printf("streamed:        %.0fms, %.1fms/1000 readings, %.1fKB/s (%u bytes, %u requests, %u windows of %ums)\n",
+           streamedMs, streamedMs * 1000.0 / readings, streamed.bytes / streamedMs, streamed.bytes, streamed.requests,
+           streamed.windows, window);
+    printf("resumed:         %u requests for the last %u cycles\n", streamed.requests - firstRequests, cycles - cycles * 3 / 4);
+    printf("upload: %s\n", failures == 0 ? "PASSED" : "FAILED");
+
+    return failures == 0 ? 0 : 1;
+}
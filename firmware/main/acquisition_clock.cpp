@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include <alogging/alogging.h>
+
+#include "acquisition_clock.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Acquisition";
+
+using Logger = SimpleLog<Log>;
+
+void AcquisitionClock::observe(uint32_t rtc, uint32_t before, uint32_t after) {
+    // The second began no later than the RTC was read and ends after it.
+    auto lower = (int64_t)rtc * 1000 - after;
+    auto upper = (int64_t)rtc * 1000 + 999 - before;
+
+    if (observations_ > 0) {
+        auto drift = ((int64_t)(after - last_) * FK_NATURALIST_ACQUISITION_DRIFT + 999999) / 1000000;
+        lower_ -= drift;
+        upper_ += drift;
+    }
+
+    if (observations_ > 0 && lower <= upper_ && upper >= lower_) {
+        lower_ = std::max(lower_, lower);
+        upper_ = std::min(upper_, upper);
+    }
+    else {
+        if (observations_ > 0) {
+            Logger::info("RTC moved, %ldms outside of the last %ldms", (int32_t)(lower > upper_ ? lower - upper_ : lower_ - upper),
+                         (int32_t)(upper_ - lower_));
+        }
+        lower_ = lower;
+        upper_ = upper;
+    }
+
+    last_ = after;
+    observations_++;
+    looked_ = epoch(after) / 1000;
+}
+
+bool AcquisitionClock::due(uint32_t uptime) const {
+    if (observations_ == 0 || uncertainty() <= 1) {
+        return false;
+    }
+    auto epoch = this->epoch(uptime);
+    return epoch / 1000 != looked_ && epoch % 1000 < uncertainty();
+}
+
+uint64_t AcquisitionClock::epoch(uint32_t uptime) const {
+    if (observations_ == 0) {
+        return 0;
+    }
+    return (uint64_t)(offset() + uptime);
+}
+
+}
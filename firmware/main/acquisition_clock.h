@@ -0,0 +1,69 @@
+#ifndef FK_NATURALIST_ACQUISITION_CLOCK_H_INCLUDED
+#define FK_NATURALIST_ACQUISITION_CLOCK_H_INCLUDED
+
+#include <Arduino.h>
+
+/* How far apart the RTC and uptime may drift, in parts per million. */
+#ifndef FK_NATURALIST_ACQUISITION_DRIFT
+#define FK_NATURALIST_ACQUISITION_DRIFT     100
+#endif
+
+namespace fk {
+
+/**
+ * Epoch milliseconds from the RTC's seconds and fk_uptime(). Each look at
+ * the RTC says its second began somewhere in the last 1000ms of uptime, so
+ * the offset between the two clocks is bounded to within a second. Looks
+ * taken at different points in the second narrow that, without waiting on
+ * the RTC for its second to tick over. The bounds widen by as much as the
+ * clocks could have drifted between looks, and if they stop overlapping
+ * anyway the RTC was set and we start over.
+ *
+ * Looks at random points narrow it slowly, the drift allowance keeps it
+ * tens of ms wide. A look just after where the second should tick over
+ * halves it, so anything already waiting, like the audio window, looks
+ * whenever due() says.
+ */
+class AcquisitionClock {
+private:
+    int64_t lower_{ 0 };
+    int64_t upper_{ 0 };
+    uint32_t last_{ 0 };
+    uint64_t looked_{ 0 };
+    uint32_t observations_{ 0 };
+
+public:
+    /**
+     * One look at the RTC, rtc its seconds, with fk_uptime() just before
+     * and just after reading it.
+     */
+    void observe(uint32_t rtc, uint32_t before, uint32_t after);
+
+    /**
+     * True if a look at the RTC now would narrow things down, we're just
+     * past where its second most likely began and haven't looked since.
+     */
+    bool due(uint32_t uptime) const;
+
+    /* Epoch ms at uptime, 0 before the first look. */
+    uint64_t epoch(uint32_t uptime) const;
+
+    /* Most the epoch times can be out by, in ms. */
+    uint32_t uncertainty() const {
+        return (uint32_t)((upper_ - lower_ + 1) / 2);
+    }
+
+    /* Epoch ms less uptime. */
+    int64_t offset() const {
+        return lower_ + (upper_ - lower_) / 2;
+    }
+
+    uint32_t observations() const {
+        return observations_;
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <cmath>
+
+#include "anomaly.h"
+#include "fast_math.h"
+
+namespace fk {
+
+constexpr float Alpha = FK_NATURALIST_ANOMALY_ALPHA;
+
+AnomalyPolicy anomaly_policy(NaturalistChannel channel) {
+    switch (channel) {
+    case NaturalistChannel::Temp1: return { 5.0f, 0.1f };
+    case NaturalistChannel::Humidity: return { 5.0f, 0.5f };
+    // Fronts and squalls, a few hundred pascals over tens of minutes.
+    case NaturalistChannel::Pressure: return { 4.0f, 5.0f };
+    case NaturalistChannel::LightLux: return { 4.0f, 5.0f };
+    // Knocked over or moved. Heading is 0 to 360 and pitch -180 to 180,
+    // both wrap, roll only goes to 90 either way.
+    case NaturalistChannel::ImuOrienX: return { 5.0f, 1.0f, 360.0f };
+    case NaturalistChannel::ImuOrienY: return { 5.0f, 1.0f };
+    case NaturalistChannel::ImuOrienZ: return { 5.0f, 1.0f, 360.0f };
+    case NaturalistChannel::AudioDbfsAvg: return { 4.0f, 1.0f };
+    case NaturalistChannel::AudioDbfsMax: return { 4.0f, 1.0f };
+    // The rest follow one of these, or aren't worth waking up for.
+    default: return { 0.0f, 0.0f };
+    }
+}
+
+/* Into [-period / 2, period / 2), so 359° and 1° are 2° apart. */
+static float wrap(float difference, float period) {
+    if (period <= 0.0f) {
+        return difference;
+    }
+    difference = fmodf(difference + period * 0.5f, period);
+    return (difference < 0.0f ? difference + period : difference) - period * 0.5f;
+}
+
+int32_t AnomalyDetector::update(const NaturalistValues &values) {
+    auto fired = (int32_t)-1;
+    auto furthest = 1.0f;
+
+    for (size_t i = 0; i < NumberOfNaturalistDataChannels; ++i) {
+        auto policy = anomaly_policy((NaturalistChannel)i);
+        if (policy.threshold <= 0.0f || !values.has(i) || std::isnan(values.values[i])) {
+            continue;
+        }
+
+        auto &c = channels_[i];
+        auto value = values.values[i];
+
+        if (c.samples == 0) {
+            c.mean = value;
+            c.variance = 0.0f;
+            c.samples++;
+            continue;
+        }
+
+        // Scored against what came before, then learnt from.
+        auto difference = wrap(value - c.mean, policy.period);
+        auto deviation = std::max(fast_sqrtf(c.variance), policy.minimum);
+        c.z = fabsf(difference) / deviation;
+
+        auto increment = Alpha * difference;
+        c.mean += increment;
+        if (policy.period > 0.0f) {
+            // Back on the circle, the mean of 359° and 1° is 0°, not 180°.
+            c.mean = fmodf(c.mean, policy.period);
+            if (c.mean < 0.0f) {
+                c.mean += policy.period;
+            }
+        }
+        c.variance = (1.0f - Alpha) * (c.variance + difference * increment);
+
+        if (c.samples < FK_NATURALIST_ANOMALY_WARMUP) {
+            c.samples++;
+            continue;
+        }
+
+        auto over = c.z / policy.threshold;
+        if (over > 1.0f) {
+            c.fired++;
+            if (over > furthest) {
+                furthest = over;
+                fired = (int32_t)i;
+            }
+        }
+    }
+
+    return fired;
+}
+
+}
@@ -0,0 +1,81 @@
+#ifndef FK_NATURALIST_ANOMALY_H_INCLUDED
+#define FK_NATURALIST_ANOMALY_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+
+/* Weight of each new value in the running mean and variance. */
+#ifndef FK_NATURALIST_ANOMALY_ALPHA
+#define FK_NATURALIST_ANOMALY_ALPHA     0.05f
+#endif
+
+/* Values each channel learns from before it can fire. */
+#ifndef FK_NATURALIST_ANOMALY_WARMUP
+#define FK_NATURALIST_ANOMALY_WARMUP    10
+#endif
+
+/* Extra cycles taken back to back once an anomaly fires. */
+#ifndef FK_NATURALIST_BURST_CYCLES
+#define FK_NATURALIST_BURST_CYCLES      10
+#endif
+
+/* Least time between the start of burst cycles, in ms. */
+#ifndef FK_NATURALIST_BURST_INTERVAL
+#define FK_NATURALIST_BURST_INTERVAL    5000
+#endif
+
+/* Regular cycles after a burst before another can start. */
+#ifndef FK_NATURALIST_BURST_COOLDOWN
+#define FK_NATURALIST_BURST_COOLDOWN    5
+#endif
+
+namespace fk {
+
+/**
+ * A channel fires when a value is more than threshold standard deviations
+ * from its running mean. The deviation is never taken as less than minimum,
+ * about the sensor's noise, so quiet channels don't fire on a single count.
+ * Channels with no threshold aren't watched. Angles that wrap around have a
+ * period, and are compared the short way round.
+ */
+struct AnomalyPolicy {
+    float threshold;
+    float minimum;
+    float period;
+};
+
+AnomalyPolicy anomaly_policy(NaturalistChannel channel);
+
+struct AnomalyChannel {
+    float mean{ 0.0f };
+    float variance{ 0.0f };
+    float z{ 0.0f };
+    uint32_t samples{ 0 };
+    uint32_t fired{ 0 };
+};
+
+/**
+ * Exponentially weighted mean and variance of each watched channel, in
+ * constant memory and a few multiplies per value.
+ */
+class AnomalyDetector {
+private:
+    AnomalyChannel channels_[NumberOfNaturalistDataChannels];
+
+public:
+    /**
+     * Learns from values and returns the channel furthest over its
+     * threshold, or -1 if none are.
+     */
+    int32_t update(const NaturalistValues &values);
+
+    const AnomalyChannel &channel(size_t i) const {
+        return channels_[i];
+    }
+
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+#if defined(FK_NATURALIST_CALIBRATION)
+
+#include <cmath>
+#include <cstring>
+
+#include <alogging/alogging.h>
+#include <SerialFlash.h>
+
+#include "calibration.h"
+#include "hardware.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Calibration";
+
+using Logger = SimpleLog<Log>;
+
+static uint32_t crc32(uint32_t crc, const void *data, size_t size) {
+    auto bytes = (const uint8_t *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= bytes[i];
+        for (auto bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t entry_address(const FlashExtent &region, uint32_t index) {
+    return region.start + sizeof(CalibrationHeader) + index * sizeof(CalibrationEntry);
+}
+
+bool Calibration::begin() {
+    size_ = 0;
+
+    MacEeprom eeprom;
+    if (!eeprom.read128bMac(id_)) {
+        Logger::info("No EUI-64, uncalibrated.");
+        return false;
+    }
+
+    FlashExtent region;
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS) || !flash_region(FlashRegion::Calibration, region)) {
+        Logger::info("Flash unavailable.");
+        return false;
+    }
+
+    CalibrationHeader header;
+    SerialFlash.read(region.start, &header, sizeof(header));
+    if (header.magic != CalibrationMagic || header.version != CalibrationVersion ||
+        header.entries > (region.size - sizeof(CalibrationHeader)) / sizeof(CalibrationEntry)) {
+        Logger::info("No table, uncalibrated.");
+        return false;
+    }
+
+    // All of it goes through the CRC, ours are only kept if it checks out.
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < header.entries; ++i) {
+        CalibrationEntry entry;
+        SerialFlash.read(entry_address(region, i), &entry, sizeof(entry));
+        crc = crc32(crc, &entry, sizeof(entry));
+
+        if (memcmp(entry.id, id_, sizeof(id_)) != 0 || !valid(entry)) {
+            continue;
+        }
+        if (size_ == FK_NATURALIST_CALIBRATION_CHANNELS) {
+            Logger::info("Too many entries, only using %d.", size_);
+            continue;
+        }
+
+        auto &loaded = loaded_[size_++];
+        loaded.board = entry.board;
+        loaded.channel = entry.channel;
+        loaded.kind = entry.kind;
+        loaded.size = entry.size;
+        memcpy(loaded.terms, entry.terms, sizeof(loaded.terms));
+    }
+
+    if (crc != header.crc) {
+        Logger::info("Table corrupt, uncalibrated.");
+        size_ = 0;
+        return false;
+    }
+
+    Logger::info("%02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x: %d channels of %lu entries", id_[0], id_[1], id_[2], id_[3],
+                 id_[4], id_[5], id_[6], id_[7], size_, header.entries);
+
+    return size_ > 0;
+}
+
+void Calibration::apply(size_t board, NaturalistValues &values) const {
+    for (size_t i = 0; i < size_; ++i) {
+        auto &loaded = loaded_[i];
+        if (loaded.board == board && values.has(loaded.channel)) {
+            auto &value = values.values[loaded.channel];
+            value = evaluate(loaded.kind, loaded.terms, loaded.size, value);
+        }
+    }
+}
+
+bool Calibration::valid(const CalibrationEntry &entry) {
+    // Only what's read from the sensors, the rest are derived from those.
+    if (entry.channel >= NumberOfNaturalistSensorChannels || entry.size == 0 || entry.size > CalibrationMaximumTerms) {
+        return false;
+    }
+    for (size_t i = 0; i < entry.size; ++i) {
+        if (!std::isfinite(entry.terms[i])) {
+            return false;
+        }
+    }
+    switch (entry.kind) {
+    case CalibrationKind::Polynomial: {
+        return true;
+    }
+    case CalibrationKind::PiecewiseLinear: {
+        if (entry.size < 4 || entry.size % 2 != 0) {
+            return false;
+        }
+        for (size_t i = 2; i < entry.size; i += 2) {
+            if (!(entry.terms[i] > entry.terms[i - 2])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    default: {
+        return false;
+    }
+    }
+}
+
+float Calibration::evaluate(CalibrationKind kind, const float *terms, size_t size, float x) {
+    if (kind == CalibrationKind::Polynomial) {
+        auto y = terms[size - 1];
+        for (auto i = (int32_t)size - 2; i >= 0; --i) {
+            y = y * x + terms[i];
+        }
+        return y;
+    }
+
+    // The segment x is in, or the first or last for beyond the ends.
+    size_t i = 2;
+    while (i + 2 < size && x > terms[i]) {
+        i += 2;
+    }
+    auto x0 = terms[i - 2];
+    auto y0 = terms[i - 1];
+    auto x1 = terms[i];
+    auto y1 = terms[i + 1];
+    return y0 + (x - x0) * (y1 - y0) / (x1 - x0);
+}
+
+bool Calibration::write(const CalibrationEntry *entries, size_t size) {
+    FlashExtent region;
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS) || !flash_region(FlashRegion::Calibration, region)) {
+        return false;
+    }
+    if (size > (region.size - sizeof(CalibrationHeader)) / sizeof(CalibrationEntry)) {
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (!valid(entries[i])) {
+            return false;
+        }
+    }
+
+    CalibrationHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CalibrationMagic;
+    header.version = CalibrationVersion;
+    header.entries = size;
+    header.crc = crc32(0, entries, size * sizeof(CalibrationEntry));
+
+    SerialFlash.eraseBlock(region.start);
+    SerialFlash.write(entry_address(region, 0), entries, size * sizeof(CalibrationEntry));
+    // Last, so a table that's half written doesn't look like one.
+    SerialFlash.write(region.start, &header, sizeof(header));
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef FK_NATURALIST_CALIBRATION_H_INCLUDED
+#define FK_NATURALIST_CALIBRATION_H_INCLUDED
+
+#if defined(FK_NATURALIST_CALIBRATION)
+
+#include <Arduino.h>
+
+#include "channels.h"
+#include "mac_eeprom.h"
+#include "flash_layout.h"
+
+/* Most entries kept for this device, the rest of the table is ignored. */
+#ifndef FK_NATURALIST_CALIBRATION_CHANNELS
+#define FK_NATURALIST_CALIBRATION_CHANNELS  16
+#endif
+
+namespace fk {
+
+constexpr uint32_t CalibrationMagic = 0x4c434b46; // "FKCL"
+constexpr uint8_t CalibrationVersion = 1;
+constexpr size_t CalibrationMaximumTerms = 8;
+
+enum class CalibrationKind : uint8_t {
+    /* terms[0] + terms[1] * x + terms[2] * x^2 ... */
+    Polynomial,
+    /* terms are x0, y0, x1, y1 ... with x ascending, extended past the ends. */
+    PiecewiseLinear,
+};
+
+/**
+ * One channel of one board, of one device. A table can hold a whole batch
+ * of devices, each only keeps its own.
+ */
+struct CalibrationEntry {
+    uint8_t id[MacEepromIdSize];
+    uint8_t board;
+    uint8_t channel;
+    CalibrationKind kind;
+    /* Number of terms used. */
+    uint8_t size;
+    float terms[CalibrationMaximumTerms];
+};
+
+struct CalibrationHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved[3];
+    uint32_t entries;
+    /* CRC32 of the entries. */
+    uint32_t crc;
+};
+
+/**
+ * The sensor channels are corrected as they're read, before anything's
+ * derived from them or merged. The table is in the Calibration region of
+ * the SerialFlash, one erase block of its own:
+ *
+ *   [CalibrationHeader] [CalibrationEntry]...
+ *
+ * It's read once at boot and only this device's entries are kept, by the
+ * MAC EEPROM's EUI-64.
+ */
+class Calibration {
+private:
+    struct Loaded {
+        uint8_t board;
+        uint8_t channel;
+        CalibrationKind kind;
+        uint8_t size;
+        float terms[CalibrationMaximumTerms];
+    };
+
+    uint8_t id_[MacEepromIdSize] = { 0 };
+    Loaded loaded_[FK_NATURALIST_CALIBRATION_CHANNELS];
+    size_t size_{ 0 };
+
+public:
+    /* Reads the EUI-64 and loads its entries, false if there aren't any. */
+    bool begin();
+
+    /* Corrects the board's sensor channels in place. */
+    void apply(size_t board, NaturalistValues &values) const;
+
+    size_t size() const {
+        return size_;
+    }
+
+    const uint8_t *id() const {
+        return id_;
+    }
+
+public:
+    /**
+     * Replaces the table, for provisioning. False if an entry isn't valid or
+     * the flash is missing.
+     */
+    static bool write(const CalibrationEntry *entries, size_t size);
+
+    static bool valid(const CalibrationEntry &entry);
+
+    static float evaluate(CalibrationKind kind, const float *terms, size_t size, float x);
+
+};
+
+}
+
+#endif
+
+#endif
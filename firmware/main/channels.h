@@ -0,0 +1,154 @@
+#ifndef FK_NATURALIST_CHANNELS_H_INCLUDED
+#define FK_NATURALIST_CHANNELS_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fk {
+
+/**
+ * Channel indices, these must match the order of the SensorInfo table in
+ * main.cpp.
+ */
+enum class NaturalistChannel : uint8_t {
+    Temp1,
+    Humidity,
+    Temp2,
+    Pressure,
+    Altitude,
+    LightIr,
+    LightVisible,
+    LightLux,
+    ImuCal,
+    ImuOrienX,
+    ImuOrienY,
+    ImuOrienZ,
+    AudioRmsAvg,
+    AudioRmsMin,
+    AudioRmsMax,
+    AudioDbfsAvg,
+    AudioDbfsMin,
+    AudioDbfsMax,
+    #if defined(FK_NATURALIST_DERIVED)
+    DewPoint,
+    AbsoluteHumidity,
+    HeatIndex,
+    SeaLevelPressure,
+    VapourPressureDeficit,
+    #endif
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    DiagCycle,
+    DiagRecovery,
+    DiagAudio,
+    DiagSht31,
+    DiagMpl3115a2,
+    DiagTsl2591,
+    DiagBno055,
+    DiagMerge,
+    DiagLogging,
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    /* Set on burst cycles, to the channel that started the burst. */
+    Burst,
+    #endif
+    NumberOfChannels
+};
+
+constexpr size_t NumberOfNaturalistChannels = (size_t)NaturalistChannel::NumberOfChannels;
+
+/* Channels read from the sensors themselves, ahead of any diagnostics. */
+constexpr size_t NumberOfNaturalistSensorChannels = (size_t)NaturalistChannel::AudioDbfsMax + 1;
+
+/**
+ * The channel count in the low byte and which of the optional groups are
+ * built in above it. Those move the indices of the channels after them, so
+ * anything that keeps channel indices or bitmaps keeps this with them and
+ * is only read back by a build with the same layout.
+ */
+constexpr uint16_t NaturalistChannelLayout = NumberOfNaturalistChannels
+    #if defined(FK_NATURALIST_DERIVED)
+    | 0x0100
+    #endif
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    | 0x0200
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    | 0x0400
+    #endif
+    ;
+
+/* Sensor and derived channels, everything but the diagnostics and tags. */
+#if defined(FK_NATURALIST_STAGE_TIMING)
+constexpr size_t NumberOfNaturalistDataChannels = (size_t)NaturalistChannel::DiagCycle;
+#elif defined(FK_NATURALIST_ANOMALY)
+constexpr size_t NumberOfNaturalistDataChannels = (size_t)NaturalistChannel::Burst;
+#else
+constexpr size_t NumberOfNaturalistDataChannels = NumberOfNaturalistChannels;
+#endif
+
+#if defined(FK_NATURALIST_ACQUISITION_TIME)
+/* One acquisition time per sensor, in NaturalistSensor order. */
+constexpr size_t NumberOfNaturalistAcquisitions = 5;
+
+/**
+ * The sensor a channel is read from, NumberOfNaturalistAcquisitions for the
+ * derived and diagnostic channels, they're from the cycle as a whole.
+ */
+inline size_t naturalist_channel_acquisition(size_t channel) {
+    switch ((NaturalistChannel)channel) {
+    case NaturalistChannel::Temp1:
+    case NaturalistChannel::Humidity: return 1;
+    case NaturalistChannel::Temp2:
+    case NaturalistChannel::Pressure:
+    case NaturalistChannel::Altitude: return 2;
+    case NaturalistChannel::LightIr:
+    case NaturalistChannel::LightVisible:
+    case NaturalistChannel::LightLux: return 3;
+    case NaturalistChannel::ImuCal:
+    case NaturalistChannel::ImuOrienX:
+    case NaturalistChannel::ImuOrienY:
+    case NaturalistChannel::ImuOrienZ: return 4;
+    case NaturalistChannel::AudioRmsAvg:
+    case NaturalistChannel::AudioRmsMin:
+    case NaturalistChannel::AudioRmsMax:
+    case NaturalistChannel::AudioDbfsAvg:
+    case NaturalistChannel::AudioDbfsMin:
+    case NaturalistChannel::AudioDbfsMax: return 0;
+    default: return NumberOfNaturalistAcquisitions;
+    }
+}
+#endif
+
+struct NaturalistValues {
+    float values[NumberOfNaturalistChannels] = { 0.0f };
+    uint64_t valid{ 0 };
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    /* Epoch ms each sensor's values are from, 0 if it wasn't read. */
+    uint64_t acquired[NumberOfNaturalistAcquisitions] = { 0 };
+    #endif
+
+    void set(NaturalistChannel channel, float value) {
+        values[(size_t)channel] = value;
+        valid |= ((uint64_t)1 << (size_t)channel);
+    }
+
+    bool has(size_t channel) const {
+        return valid & ((uint64_t)1 << channel);
+    }
+
+    float get(NaturalistChannel channel) const {
+        return values[(size_t)channel];
+    }
+
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    /* When the channel was read, or 0 if it's from the cycle as a whole. */
+    uint64_t acquisition(size_t channel) const {
+        auto sensor = naturalist_channel_acquisition(channel);
+        return sensor < NumberOfNaturalistAcquisitions ? acquired[sensor] : 0;
+    }
+    #endif
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include <cmath>
+#include <cstring>
+
+#include "cycle_record.h"
+#include "varint.h"
+
+namespace fk {
+
+#if defined(FK_NATURALIST_ACQUISITION_TIME)
+static_assert(NumberOfNaturalistAcquisitions <= 8, "Too many sensors for the acquisition bitmap.");
+#endif
+
+float cycle_record_scale(NaturalistChannel channel) {
+    switch (channel) {
+    case NaturalistChannel::Temp1: return 100.0f;
+    case NaturalistChannel::Humidity: return 100.0f;
+    case NaturalistChannel::Temp2: return 100.0f;
+    // The MPL3115A2 resolves quarter pascals.
+    case NaturalistChannel::Pressure: return 4.0f;
+    case NaturalistChannel::Altitude: return 10.0f;
+    case NaturalistChannel::LightIr: return 1.0f;
+    case NaturalistChannel::LightVisible: return 1.0f;
+    case NaturalistChannel::LightLux: return 100.0f;
+    case NaturalistChannel::ImuCal: return 1.0f;
+    // The BNO055 reports sixteenths of a degree.
+    case NaturalistChannel::ImuOrienX: return 16.0f;
+    case NaturalistChannel::ImuOrienY: return 16.0f;
+    case NaturalistChannel::ImuOrienZ: return 16.0f;
+    case NaturalistChannel::AudioRmsAvg: return 100000.0f;
+    case NaturalistChannel::AudioRmsMin: return 100000.0f;
+    case NaturalistChannel::AudioRmsMax: return 100000.0f;
+    case NaturalistChannel::AudioDbfsAvg: return 100.0f;
+    case NaturalistChannel::AudioDbfsMin: return 100.0f;
+    case NaturalistChannel::AudioDbfsMax: return 100.0f;
+    #if defined(FK_NATURALIST_DERIVED)
+    case NaturalistChannel::DewPoint: return 100.0f;
+    case NaturalistChannel::AbsoluteHumidity: return 100.0f;
+    case NaturalistChannel::HeatIndex: return 100.0f;
+    case NaturalistChannel::SeaLevelPressure: return 4.0f;
+    case NaturalistChannel::VapourPressureDeficit: return 1000.0f;
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    case NaturalistChannel::Burst: return 1.0f;
+    #endif
+    // Diagnostic timings, in ms.
+    default: return 100.0f;
+    }
+}
+
+static int32_t quantize(float value, float scale) {
+    auto scaled = value * scale;
+    if (scaled >= 2147483647.0f) {
+        return INT32_MAX;
+    }
+    if (scaled <= -2147483648.0f) {
+        return INT32_MIN;
+    }
+    return (int32_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+}
+
+size_t CycleRecordEncoder::encode(uint32_t time, const NaturalistValues &values, uint8_t *buffer) {
+    auto keyframe = cycles_ % FK_NATURALIST_CYCLE_KEYFRAME == 0 || time < time_;
+    if (keyframe) {
+        cycles_ = 0;
+    }
+    cycles_++;
+
+    uint64_t present = 0;
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if (values.has(i) && !std::isnan(values.values[i])) {
+            present |= (uint64_t)1 << i;
+        }
+    }
+
+    uint8_t flags = keyframe ? CycleRecordKeyframe : 0;
+
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    // Only for sensors with something in the record.
+    uint8_t acquired = 0;
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        auto sensor = naturalist_channel_acquisition(i);
+        if ((present & ((uint64_t)1 << i)) && sensor < NumberOfNaturalistAcquisitions && values.acquired[sensor] != 0) {
+            acquired |= 1 << sensor;
+        }
+    }
+    flags |= acquired != 0 ? CycleRecordAcquired : 0;
+    #endif
+
+    size_t position = 0;
+    buffer[position++] = flags;
+    position += varint_encode(buffer + position, keyframe ? time : time - time_);
+    position += varint_encode(buffer + position, present);
+
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if (keyframe) {
+            previous_[i] = 0;
+        }
+        if (present & ((uint64_t)1 << i)) {
+            auto value = quantize(values.values[i], cycle_record_scale((NaturalistChannel)i));
+            position += varint_encode(buffer + position, zigzag_encode((int64_t)value - previous_[i]));
+            previous_[i] = value;
+        }
+    }
+
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    if (keyframe) {
+        memset(acquired_, 0, sizeof(acquired_));
+    }
+    if (acquired != 0) {
+        buffer[position++] = acquired;
+        for (size_t i = 0; i < NumberOfNaturalistAcquisitions; ++i) {
+            if (acquired & (1 << i)) {
+                auto offset = (int64_t)values.acquired[i] - (int64_t)time * 1000;
+                position += varint_encode(buffer + position, zigzag_encode(offset - acquired_[i]));
+                acquired_[i] = offset;
+            }
+        }
+    }
+    #endif
+
+    time_ = time;
+
+    return position;
+}
+
+size_t cycle_record_rollup(const RollupRecord &record, uint8_t *buffer) {
+    buffer[0] = CycleRecordRollup;
+    return 1 + rollup_encode(record, buffer + 1);
+}
+
+size_t CycleRecordDecoder::decode(const uint8_t *buffer, size_t size, CycleRecord &record) {
+    if (size < 1) {
+        return 0;
+    }
+
+    auto flags = buffer[0];
+    size_t position = 1;
+
+    if (flags & CycleRecordRollup) {
+        RollupRecord rollup;
+        auto consumed = rollup_decode(buffer + position, size - position, rollup);
+        if (consumed == 0) {
+            return 0;
+        }
+        record = CycleRecord{};
+        record.time = rollup.start;
+        record.rollup = true;
+        record.statistics = rollup;
+        return position + consumed;
+    }
+
+    uint64_t time;
+    auto consumed = varint_decode(buffer + position, size - position, &time);
+    if (consumed == 0) {
+        return 0;
+    }
+    position += consumed;
+
+    uint64_t present;
+    consumed = varint_decode(buffer + position, size - position, &present);
+    if (consumed == 0) {
+        return 0;
+    }
+    position += consumed;
+
+    // Channels this build doesn't have, we can't know their scale.
+    if (NumberOfNaturalistChannels < 64 && (present >> (NumberOfNaturalistChannels % 64)) != 0) {
+        return 0;
+    }
+
+    auto keyframe = (flags & CycleRecordKeyframe) != 0;
+    int32_t values[NumberOfNaturalistChannels];
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        values[i] = keyframe ? 0 : previous_[i];
+        if (present & ((uint64_t)1 << i)) {
+            uint64_t delta;
+            consumed = varint_decode(buffer + position, size - position, &delta);
+            if (consumed == 0) {
+                return 0;
+            }
+            position += consumed;
+            values[i] += (int32_t)zigzag_decode(delta);
+        }
+    }
+
+    auto recordTime = keyframe ? (uint32_t)time : time_ + (uint32_t)time;
+
+    // Read by builds without acquisition times too, they're skipped.
+    uint8_t acquired = 0;
+    int64_t offsets[8];
+    for (size_t i = 0; i < 8; ++i) {
+        offsets[i] = keyframe ? 0 : acquired_[i];
+    }
+    if (flags & CycleRecordAcquired) {
+        if (position >= size) {
+            return 0;
+        }
+        acquired = buffer[position++];
+        for (size_t i = 0; i < 8; ++i) {
+            if (acquired & (1 << i)) {
+                uint64_t delta;
+                consumed = varint_decode(buffer + position, size - position, &delta);
+                if (consumed == 0) {
+                    return 0;
+                }
+                position += consumed;
+                offsets[i] += zigzag_decode(delta);
+            }
+        }
+    }
+
+    // Only now that we have all of it, so a partial record can be retried.
+    memcpy(previous_, values, sizeof(values));
+    memcpy(acquired_, offsets, sizeof(offsets));
+    time_ = recordTime;
+    synchronized_ = synchronized_ || keyframe;
+
+    record = CycleRecord{};
+    record.time = time_;
+    record.keyframe = keyframe;
+    if (synchronized_) {
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            if (present & ((uint64_t)1 << i)) {
+                record.values.set((NaturalistChannel)i, values[i] / cycle_record_scale((NaturalistChannel)i));
+            }
+        }
+        #if defined(FK_NATURALIST_ACQUISITION_TIME)
+        for (size_t i = 0; i < NumberOfNaturalistAcquisitions; ++i) {
+            if (acquired & (1 << i)) {
+                record.values.acquired[i] = (uint64_t)((int64_t)recordTime * 1000 + offsets[i]);
+            }
+        }
+        #endif
+    }
+
+    return position;
+}
+
+}
@@ -0,0 +1,120 @@
+#ifndef FK_NATURALIST_CYCLE_RECORD_H_INCLUDED
+#define FK_NATURALIST_CYCLE_RECORD_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+#include "rollup.h"
+
+/* Cycles between keyframes, a reader can start at any keyframe. */
+#ifndef FK_NATURALIST_CYCLE_KEYFRAME
+#define FK_NATURALIST_CYCLE_KEYFRAME    64
+#endif
+
+namespace fk {
+
+/**
+ * All of a cycle's readings in one record:
+ *
+ *   [flags:u8] [time:varint] [channels:varint] [value:zigzag varint]...
+ *
+ * Channels is a bitmap of the values that follow, in channel order. Values
+ * are scaled to integers, see cycle_record_scale, and written as the
+ * difference from that channel's previous value. In keyframes time is
+ * absolute and values are differences from zero, otherwise time is seconds
+ * since the previous record.
+ *
+ * With CycleRecordAcquired the values are followed by when each sensor
+ * was read:
+ *
+ *   [sensors:u8] [ms:zigzag varint]...
+ *
+ * Sensors is a bitmap in NaturalistSensor order. Each is the sensor's ms
+ * from the record's time, as the difference from its previous one like the
+ * values, so a sensor read about as far into each cycle costs a byte.
+ *
+ * A record with CycleRecordRollup is a rollup instead, the flags and then
+ * rollup_encode's bytes. It has no values and leaves the cycle records'
+ * differences alone, so one can go anywhere in the stream.
+ */
+constexpr uint8_t CycleRecordKeyframe = 0x01;
+constexpr uint8_t CycleRecordAcquired = 0x02;
+constexpr uint8_t CycleRecordRollup = 0x04;
+
+#if defined(FK_NATURALIST_ACQUISITION_TIME)
+constexpr size_t CycleRecordAcquisitionSize = 1 + NumberOfNaturalistAcquisitions * 10;
+#else
+constexpr size_t CycleRecordAcquisitionSize = 0;
+#endif
+
+constexpr size_t CycleRecordMaximumSize = 1 + 5 + 10 + NumberOfNaturalistChannels * 5 + CycleRecordAcquisitionSize;
+
+/**
+ * Units per channel unit, so readings are stored to within half of 1 / scale.
+ */
+float cycle_record_scale(NaturalistChannel channel);
+
+static_assert(1 + RollupRecordMaximumSize <= CycleRecordMaximumSize, "Rollups should fit where a cycle record does.");
+
+struct CycleRecord {
+    uint32_t time{ 0 };
+    bool keyframe{ false };
+    NaturalistValues values;
+    /* A rollup, time is the start of its bucket. */
+    bool rollup{ false };
+    RollupRecord statistics{};
+};
+
+/**
+ * Returns the size of the rollup record written to buffer, which should hold
+ * 1 + RollupRecordMaximumSize.
+ */
+size_t cycle_record_rollup(const RollupRecord &record, uint8_t *buffer);
+
+class CycleRecordEncoder {
+private:
+    int32_t previous_[NumberOfNaturalistChannels] = { 0 };
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    int64_t acquired_[NumberOfNaturalistAcquisitions] = { 0 };
+    #endif
+    uint32_t time_{ 0 };
+    uint32_t cycles_{ 0 };
+
+public:
+    /**
+     * Returns the size of the record written to buffer, which should hold
+     * CycleRecordMaximumSize. NaN values are left out.
+     */
+    size_t encode(uint32_t time, const NaturalistValues &values, uint8_t *buffer);
+
+    /* The next record will be a keyframe. */
+    void keyframe() {
+        cycles_ = 0;
+    }
+
+};
+
+/**
+ * Decodes records in the order they were encoded. Give it as much of the
+ * stream as is available, it only consumes whole records.
+ */
+class CycleRecordDecoder {
+private:
+    int32_t previous_[NumberOfNaturalistChannels] = { 0 };
+    int64_t acquired_[8] = { 0 };
+    uint32_t time_{ 0 };
+    bool synchronized_{ false };
+
+public:
+    /**
+     * Returns the bytes consumed, or 0 if buffer ends before the record does
+     * or it's corrupt (check with size >= CycleRecordMaximumSize). Records
+     * before the first keyframe are skipped and returned with no values.
+     */
+    size_t decode(const uint8_t *buffer, size_t size, CycleRecord &record);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include <alogging/alogging.h>
+
+#include "deadband.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Deadband";
+
+using Logger = SimpleLog<Log>;
+
+constexpr uint32_t HeartbeatMs = (uint32_t)FK_NATURALIST_HEARTBEAT * 1000;
+
+DeadbandPolicy deadband_policy(NaturalistChannel channel) {
+    switch (channel) {
+    case NaturalistChannel::Temp1: return { 0.1f, 0.0f };
+    case NaturalistChannel::Humidity: return { 0.5f, 0.0f };
+    case NaturalistChannel::Temp2: return { 0.1f, 0.0f };
+    case NaturalistChannel::Pressure: return { 10.0f, 0.0f };
+    case NaturalistChannel::Altitude: return { 1.0f, 0.0f };
+    // Light spans several orders of magnitude between night and day.
+    case NaturalistChannel::LightIr: return { 2.0f, 0.05f };
+    case NaturalistChannel::LightVisible: return { 2.0f, 0.05f };
+    case NaturalistChannel::LightLux: return { 1.0f, 0.05f };
+    case NaturalistChannel::ImuCal: return { 0.5f, 0.0f };
+    case NaturalistChannel::ImuOrienX: return { 1.0f, 0.0f };
+    case NaturalistChannel::ImuOrienY: return { 1.0f, 0.0f };
+    case NaturalistChannel::ImuOrienZ: return { 1.0f, 0.0f };
+    case NaturalistChannel::AudioRmsAvg: return { 0.0005f, 0.1f };
+    case NaturalistChannel::AudioRmsMin: return { 0.0005f, 0.1f };
+    case NaturalistChannel::AudioRmsMax: return { 0.0005f, 0.1f };
+    case NaturalistChannel::AudioDbfsAvg: return { 1.0f, 0.0f };
+    case NaturalistChannel::AudioDbfsMin: return { 1.0f, 0.0f };
+    case NaturalistChannel::AudioDbfsMax: return { 1.0f, 0.0f };
+    #if defined(FK_NATURALIST_DERIVED)
+    case NaturalistChannel::DewPoint: return { 0.1f, 0.0f };
+    case NaturalistChannel::AbsoluteHumidity: return { 0.1f, 0.0f };
+    case NaturalistChannel::HeatIndex: return { 0.1f, 0.0f };
+    case NaturalistChannel::SeaLevelPressure: return { 10.0f, 0.0f };
+    case NaturalistChannel::VapourPressureDeficit: return { 0.01f, 0.0f };
+    #endif
+    // Diagnostics are always recorded.
+    default: return { -1.0f, 0.0f };
+    }
+}
+
+size_t Deadband::filter(NaturalistValues &values, uint32_t now) {
+    size_t suppressed = 0;
+
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if (!values.has(i)) {
+            continue;
+        }
+
+        auto &c = channels_[i];
+        auto value = values.values[i];
+        auto policy = deadband_policy((NaturalistChannel)i);
+        auto threshold = std::max(policy.absolute, policy.relative * fabsf(c.last));
+
+        auto record = !c.seen || policy.absolute < 0.0f || fabsf(value - c.last) > threshold ||
+            now - c.recordedAt >= HeartbeatMs;
+
+        if (record) {
+            c.last = value;
+            c.recordedAt = now;
+            c.recorded++;
+            c.seen = true;
+        }
+        else {
+            values.valid &= ~((uint64_t)1 << i);
+            c.suppressed++;
+            suppressed++;
+        }
+    }
+
+    return suppressed;
+}
+
+void Deadband::log() const {
+    uint32_t recorded = 0;
+    uint32_t suppressed = 0;
+    for (auto &c : channels_) {
+        recorded += c.recorded;
+        suppressed += c.suppressed;
+    }
+    Logger::info("Recorded %lu, suppressed %lu", recorded, suppressed);
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef FK_NATURALIST_DEADBAND_H_INCLUDED
+#define FK_NATURALIST_DEADBAND_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+
+/* Longest a channel goes without being recorded, in seconds. */
+#ifndef FK_NATURALIST_HEARTBEAT
+#define FK_NATURALIST_HEARTBEAT         (15 * 60)
+#endif
+
+namespace fk {
+
+/**
+ * A value is recorded when it moves from the last one we recorded by more
+ * than the larger of absolute and relative * |last|, or when the heartbeat
+ * expires. Negative absolute thresholds are recorded every time.
+ */
+struct DeadbandPolicy {
+    float absolute;
+    float relative;
+};
+
+DeadbandPolicy deadband_policy(NaturalistChannel channel);
+
+struct DeadbandChannel {
+    float last{ 0.0f };
+    uint32_t recordedAt{ 0 };
+    uint32_t recorded{ 0 };
+    uint32_t suppressed{ 0 };
+    bool seen{ false };
+};
+
+/**
+ * Sits in front of the merge and clears the channels that haven't changed
+ * enough to be worth storing and sending.
+ */
+class Deadband {
+private:
+    DeadbandChannel channels_[NumberOfNaturalistChannels];
+
+public:
+    /**
+     * Returns the number of channels suppressed.
+     */
+    size_t filter(NaturalistValues &values, uint32_t now);
+
+    const DeadbandChannel &channel(size_t i) const {
+        return channels_[i];
+    }
+
+    void log() const;
+
+};
+
+}
+
+#endif
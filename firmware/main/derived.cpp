@@ -0,0 +1,95 @@
+#include <cmath>
+
+#include "derived.h"
+#include "fast_math.h"
+
+namespace fk {
+
+constexpr float MagnusA = 17.625f;
+constexpr float MagnusB = 243.04f;
+constexpr float MagnusC = 6.1094f;
+constexpr float Log2E = 1.442695040888963f;
+constexpr float Ln2 = 0.693147180559945f;
+constexpr float ZeroCelsius = 273.15f;
+
+float saturation_vapour_pressure(float celsius) {
+    return MagnusC * fast_exp2f(Log2E * MagnusA * celsius / (MagnusB + celsius));
+}
+
+float dew_point(float celsius, float humidity) {
+    auto gamma = fast_log2f(humidity / 100.0f) * Ln2 + MagnusA * celsius / (MagnusB + celsius);
+    return MagnusB * gamma / (MagnusA - gamma);
+}
+
+float absolute_humidity(float celsius, float humidity) {
+    // Water vapour's gas constant, 461.5 J/(kg K), as 100 Pa/hPa * 1000 g/kg / 461.5.
+    constexpr float GramsPerHectopascalKelvin = 216.68f;
+    auto e = saturation_vapour_pressure(celsius) * humidity / 100.0f;
+    return GramsPerHectopascalKelvin * e / (ZeroCelsius + celsius);
+}
+
+float heat_index(float celsius, float humidity) {
+    auto t = celsius * 1.8f + 32.0f;
+    auto rh = humidity;
+
+    auto hi = 0.5f * (t + 61.0f + (t - 68.0f) * 1.2f + rh * 0.094f);
+    if ((hi + t) / 2.0f >= 80.0f) {
+        hi = -42.379f + 2.04901523f * t + 10.14333127f * rh
+            - 0.22475541f * t * rh - 0.00683783f * t * t
+            - 0.05481717f * rh * rh + 0.00122874f * t * t * rh
+            + 0.00085282f * t * rh * rh - 0.00000199f * t * t * rh * rh;
+
+        if (rh < 13.0f && t >= 80.0f && t <= 112.0f) {
+            hi -= ((13.0f - rh) / 4.0f) * fast_sqrtf((17.0f - fabsf(t - 95.0f)) / 17.0f);
+        }
+        else if (rh > 85.0f && t >= 80.0f && t <= 87.0f) {
+            hi += ((rh - 85.0f) / 10.0f) * ((87.0f - t) / 5.0f);
+        }
+    }
+
+    return (hi - 32.0f) / 1.8f;
+}
+
+float sea_level_pressure(float pascals, float celsius, float elevation) {
+    // Standard lapse rate, K/m, and the exponent g / (R L) for dry air.
+    constexpr float LapseRate = 0.0065f;
+    constexpr float Exponent = 5.257f;
+    auto lapse = LapseRate * elevation;
+    return pascals * fast_powf(1.0f - lapse / (celsius + lapse + ZeroCelsius), -Exponent);
+}
+
+float vapour_pressure_deficit(float celsius, float humidity) {
+    return saturation_vapour_pressure(celsius) * (1.0f - humidity / 100.0f) / 10.0f;
+}
+
+#if defined(FK_NATURALIST_DERIVED)
+
+void naturalist_derive(NaturalistValues &values) {
+    auto valid = [&](NaturalistChannel channel) {
+        return values.has((size_t)channel);
+    };
+
+    if (valid(NaturalistChannel::Temp1) && valid(NaturalistChannel::Humidity)) {
+        auto t = values.get(NaturalistChannel::Temp1);
+        auto rh = values.get(NaturalistChannel::Humidity);
+        // Dew point and friends are undefined for dry air.
+        if (rh > 0.0f && rh <= 100.0f) {
+            values.set(NaturalistChannel::DewPoint, dew_point(t, rh));
+            values.set(NaturalistChannel::AbsoluteHumidity, absolute_humidity(t, rh));
+            values.set(NaturalistChannel::HeatIndex, heat_index(t, rh));
+            values.set(NaturalistChannel::VapourPressureDeficit, vapour_pressure_deficit(t, rh));
+        }
+    }
+
+    if (valid(NaturalistChannel::Pressure) && valid(NaturalistChannel::Temp2)) {
+        auto p = values.get(NaturalistChannel::Pressure);
+        auto t = values.get(NaturalistChannel::Temp2);
+        if (p > 0.0f) {
+            values.set(NaturalistChannel::SeaLevelPressure, sea_level_pressure(p, t, FK_NATURALIST_STATION_ELEVATION));
+        }
+    }
+}
+
+#endif
+
+}
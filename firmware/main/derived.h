@@ -0,0 +1,66 @@
+#ifndef FK_NATURALIST_DERIVED_H_INCLUDED
+#define FK_NATURALIST_DERIVED_H_INCLUDED
+
+#include "channels.h"
+
+/* Meters above sea level, for sea level pressure. */
+#ifndef FK_NATURALIST_STATION_ELEVATION
+#define FK_NATURALIST_STATION_ELEVATION    0.0f
+#endif
+
+namespace fk {
+
+/**
+ * These use fast_math.h, the bounds below are over -40C to 50C, 1% to 100%
+ * and 50 to 110kPa, see the host derived test.
+ */
+
+/**
+ * Saturation vapour pressure over water in hPa, the Magnus form with the
+ * Alduchov and Eskridge (1996) coefficients. Within 0.1% of Wexler between
+ * -40C and 50C.
+ */
+float saturation_vapour_pressure(float celsius);
+
+/**
+ * The Magnus dew point. Within 0.001C of the formula in double precision.
+ */
+float dew_point(float celsius, float humidity);
+
+/**
+ * Grams of water per cubic meter of air. Within 0.001% of the formula in
+ * double precision.
+ */
+float absolute_humidity(float celsius, float humidity);
+
+/**
+ * The NWS heat index (Rothfusz regression with its adjustments, or Steadman's
+ * simpler form below 80F), in C. Within 0.001C of the formula in double
+ * precision.
+ */
+float heat_index(float celsius, float humidity);
+
+/**
+ * Station pressure reduced to sea level with the hypsometric equation.
+ * Within 0.2Pa of the formula in double precision.
+ */
+float sea_level_pressure(float pascals, float celsius, float elevation);
+
+/**
+ * Saturation less actual vapour pressure, in kPa. Within 0.05Pa of the formula
+ * in double precision.
+ */
+float vapour_pressure_deficit(float celsius, float humidity);
+
+#if defined(FK_NATURALIST_DERIVED)
+
+/**
+ * Fills the derived channels from whichever raw channels are valid.
+ */
+void naturalist_derive(NaturalistValues &values);
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include <algorithm>
+
+#include <SerialFlash.h>
+
+#include "flash_layout.h"
+
+namespace fk {
+
+const char *flash_region_name(FlashRegion region) {
+    switch (region) {
+    case FlashRegion::Calibration: return "calibration";
+    case FlashRegion::UploadCursor: return "cursor";
+    case FlashRegion::Series: return "series";
+    case FlashRegion::Trace: return "trace";
+    case FlashRegion::Free: return "free";
+    default: return "unknown";
+    }
+}
+
+static uint32_t requested(FlashRegion region, uint32_t blockSize) {
+    switch (region) {
+    case FlashRegion::Calibration: return blockSize;
+    case FlashRegion::UploadCursor: return blockSize;
+    case FlashRegion::Series: return FK_NATURALIST_SERIES_SIZE;
+    case FlashRegion::Trace: return FK_NATURALIST_TRACE_SIZE;
+    default: return 0;
+    }
+}
+
+static uint32_t minimum(FlashRegion region, uint32_t blockSize) {
+    // The block being written and the next to reuse.
+    if (region == FlashRegion::Series) {
+        return 2 * blockSize;
+    }
+    return blockSize;
+}
+
+/* What the region gets with top bytes left below the ones before it. */
+static uint32_t allocate(FlashRegion region, uint32_t blockSize, uint32_t top) {
+    auto size = (requested(region, blockSize) + blockSize - 1) / blockSize * blockSize;
+    size = std::min(size, top);
+    return size < minimum(region, blockSize) ? 0 : size;
+}
+
+bool flash_layout(uint32_t capacity, uint32_t blockSize, FlashRegion region, FlashExtent &extent) {
+    extent = FlashExtent{};
+
+    if (blockSize == 0 || capacity < blockSize) {
+        return false;
+    }
+
+    auto top = capacity - capacity % blockSize;
+    for (size_t i = 0; i < (size_t)region; ++i) {
+        top -= allocate((FlashRegion)i, blockSize, top);
+    }
+
+    if (region == FlashRegion::Free) {
+        extent.size = top;
+        return top > 0;
+    }
+
+    auto size = allocate(region, blockSize, top);
+    if (size == 0) {
+        return false;
+    }
+
+    extent.start = top - size;
+    extent.size = size;
+
+    return true;
+}
+
+bool flash_region(FlashRegion region, FlashExtent &extent) {
+    uint8_t id[3];
+    SerialFlash.readID(id);
+    return flash_layout(SerialFlash.capacity(id), SerialFlash.blockSize(), region, extent);
+}
+
+}
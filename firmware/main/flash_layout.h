@@ -0,0 +1,58 @@
+#ifndef FK_NATURALIST_FLASH_LAYOUT_H_INCLUDED
+#define FK_NATURALIST_FLASH_LAYOUT_H_INCLUDED
+
+#include <Arduino.h>
+
+#ifndef FK_NATURALIST_SERIES_SIZE
+#define FK_NATURALIST_SERIES_SIZE         (2 * 1024 * 1024)
+#endif
+
+#ifndef FK_NATURALIST_TRACE_SIZE
+#define FK_NATURALIST_TRACE_SIZE          (1 * 1024 * 1024)
+#endif
+
+namespace fk {
+
+/**
+ * Our regions of the SerialFlash, in the order they're placed down from the
+ * top of the chip. Every build reserves all of them so they're in the same
+ * place whatever's enabled. Free is what's left below.
+ */
+enum class FlashRegion : uint8_t {
+    Calibration,
+    UploadCursor,
+    Series,
+    Trace,
+    Free,
+};
+
+constexpr size_t NumberOfFlashRegions = (size_t)FlashRegion::Free + 1;
+
+const char *flash_region_name(FlashRegion region);
+
+struct FlashExtent {
+    uint32_t start{ 0 };
+    uint32_t size{ 0 };
+
+    uint32_t end() const {
+        return start + size;
+    }
+};
+
+/**
+ * Each region is a whole number of erase blocks, so erasing one never
+ * touches another whatever the part's block size. On smaller chips the
+ * series and trace shrink to what's left, false if there isn't room for
+ * even the smallest useful region: a block, or two for the series.
+ */
+bool flash_layout(uint32_t capacity, uint32_t blockSize, FlashRegion region, FlashExtent &extent);
+
+/**
+ * The same for the SerialFlash that's fitted, SerialFlash.begin() should
+ * have been called.
+ */
+bool flash_region(FlashRegion region, FlashExtent &extent);
+
+}
+
+#endif
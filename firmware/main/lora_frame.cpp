@@ -0,0 +1,274 @@
+#include <cmath>
+#include <cstring>
+
+#include "lora_frame.h"
+
+namespace fk {
+
+class BitWriter {
+private:
+    uint8_t *buffer_;
+    size_t bits_{ 0 };
+
+public:
+    BitWriter(uint8_t *buffer) : buffer_(buffer) {
+    }
+
+public:
+    void write(uint32_t value, uint8_t bits) {
+        for (auto i = (int32_t)bits - 1; i >= 0; --i) {
+            auto mask = (uint8_t)(0x80 >> (bits_ % 8));
+            if (bits_ % 8 == 0) {
+                buffer_[bits_ / 8] = 0;
+            }
+            if ((value >> i) & 1) {
+                buffer_[bits_ / 8] |= mask;
+            }
+            bits_++;
+        }
+    }
+
+    size_t size() const {
+        return (bits_ + 7) / 8;
+    }
+
+};
+
+class BitReader {
+private:
+    const uint8_t *buffer_;
+    size_t size_;
+    size_t bits_{ 0 };
+
+public:
+    BitReader(const uint8_t *buffer, size_t size) : buffer_(buffer), size_(size) {
+    }
+
+public:
+    bool read(uint32_t &value, uint8_t bits) {
+        if (bits_ + bits > size_ * 8) {
+            return false;
+        }
+        value = 0;
+        for (auto i = 0; i < bits; ++i) {
+            value = (value << 1) | ((buffer_[bits_ / 8] >> (7 - bits_ % 8)) & 1);
+            bits_++;
+        }
+        return true;
+    }
+
+};
+
+static uint32_t quantize(NaturalistChannel channel, float value) {
+    auto &precision = LoraChannelPrecisions[(size_t)channel];
+    auto maximum = ((uint32_t)1 << precision.bits) - 1;
+    auto scaled = (value - precision.minimum) / precision.resolution + 0.5f;
+    if (scaled <= 0.0f) {
+        return 0;
+    }
+    if (scaled >= (float)maximum) {
+        return maximum;
+    }
+    return (uint32_t)scaled;
+}
+
+static float dequantize(NaturalistChannel channel, uint32_t code) {
+    auto &precision = LoraChannelPrecisions[(size_t)channel];
+    return precision.minimum + (float)code * precision.resolution;
+}
+
+size_t LoraFrameEncoder::encode(uint32_t time, const NaturalistValues &values, uint8_t *buffer) {
+    auto sequence = sequence_++;
+    // Receivers only remember so many frames back.
+    auto delta = referenced_ && (uint8_t)(sequence - reference_.sequence) < LoraFrameHistory;
+
+    size_t position = 0;
+    buffer[position++] = LoraFrameVersion | (delta ? LoraFrameDelta : 0);
+    memcpy(buffer + position, &device_, sizeof(device_));
+    position += sizeof(device_);
+    buffer[position++] = sequence;
+    if (delta) {
+        buffer[position++] = reference_.sequence;
+    }
+    memcpy(buffer + position, &time, sizeof(time));
+    position += sizeof(time);
+
+    sent_ = LoraFrameCodes{};
+    sent_.device = device_;
+    sent_.sequence = sequence;
+    pending_ = true;
+
+    BitWriter writer{ buffer + position };
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        auto present = values.has(i) && !std::isnan(values.values[i]);
+        writer.write(present ? 1 : 0, 1);
+        if (present) {
+            sent_.present |= (uint32_t)1 << i;
+            sent_.codes[i] = quantize((NaturalistChannel)i, values.values[i]);
+        }
+    }
+
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        if (!(sent_.present & ((uint32_t)1 << i))) {
+            continue;
+        }
+
+        auto &precision = LoraChannelPrecisions[i];
+        if (delta) {
+            auto difference = (int32_t)sent_.codes[i] - (int32_t)reference_.codes[i];
+            auto limit = precision.deltaBits > 0 ? (int32_t)1 << (precision.deltaBits - 1) : 0;
+            auto fits = (reference_.present & ((uint32_t)1 << i)) && difference >= -limit && difference < limit;
+            writer.write(fits ? 1 : 0, 1);
+            if (fits) {
+                writer.write((uint32_t)difference & (((uint32_t)1 << precision.deltaBits) - 1), precision.deltaBits);
+                continue;
+            }
+        }
+        writer.write(sent_.codes[i], precision.bits);
+    }
+
+    return position + writer.size();
+}
+
+bool LoraFrameEncoder::acked(uint8_t sequence) {
+    if (!pending_ || sequence != sent_.sequence) {
+        return false;
+    }
+    reference_ = sent_;
+    referenced_ = true;
+    pending_ = false;
+    return true;
+}
+
+bool LoraFrameEncoder::acked(const uint8_t *ack, size_t size) {
+    uint32_t device;
+    if (size != LoraFrameAckSize || ack[0] != LoraFrameAck) {
+        return false;
+    }
+    memcpy(&device, ack + 1, sizeof(device));
+    return device == device_ && acked(ack[1 + sizeof(device)]);
+}
+
+bool LoraFrameDecoder::decode(const uint8_t *buffer, size_t size, LoraFrame &frame) {
+    if (size < 1 + sizeof(frame.device) + 1 || (buffer[0] & 0xf0) != LoraFrameVersion) {
+        return false;
+    }
+
+    frame = LoraFrame{};
+    frame.delta = (buffer[0] & LoraFrameDelta) != 0;
+    memcpy(&frame.device, buffer + 1, sizeof(frame.device));
+    frame.sequence = buffer[1 + sizeof(frame.device)];
+
+    size_t position = 1 + sizeof(frame.device) + 1;
+    if (frame.delta) {
+        if (size < position + 1) {
+            return false;
+        }
+        frame.reference = buffer[position++];
+    }
+    if (size < position + sizeof(frame.time)) {
+        return false;
+    }
+    memcpy(&frame.time, buffer + position, sizeof(frame.time));
+    position += sizeof(frame.time);
+
+    auto history = this->history(frame.device);
+    const LoraFrameCodes *reference = nullptr;
+    if (frame.delta) {
+        // Newest first, sequences wrap.
+        auto received = history != nullptr ? history->received : 0;
+        auto kept = received < LoraFrameHistory ? received : LoraFrameHistory;
+        for (size_t i = 1; i <= kept; ++i) {
+            auto &codes = history->frames[(received - i) % LoraFrameHistory];
+            if (codes.sequence == frame.reference) {
+                reference = &codes;
+                break;
+            }
+        }
+        if (reference == nullptr) {
+            return false;
+        }
+    }
+
+    LoraFrameCodes decoded;
+    decoded.device = frame.device;
+    decoded.sequence = frame.sequence;
+
+    BitReader reader{ buffer + position, size - position };
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        uint32_t present;
+        if (!reader.read(present, 1)) {
+            return false;
+        }
+        decoded.present |= present << i;
+    }
+
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        if (!(decoded.present & ((uint32_t)1 << i))) {
+            continue;
+        }
+
+        auto &precision = LoraChannelPrecisions[i];
+        uint32_t code;
+        uint32_t relative = 0;
+        if (frame.delta && !reader.read(relative, 1)) {
+            return false;
+        }
+        if (relative) {
+            if (precision.deltaBits == 0 || !(reference->present & ((uint32_t)1 << i))) {
+                return false;
+            }
+            if (!reader.read(code, precision.deltaBits)) {
+                return false;
+            }
+            // Sign extend.
+            auto difference = (int32_t)(code << (32 - precision.deltaBits)) >> (32 - precision.deltaBits);
+            code = (uint32_t)((int32_t)reference->codes[i] + difference);
+        }
+        else if (!reader.read(code, precision.bits)) {
+            return false;
+        }
+
+        decoded.codes[i] = code;
+        frame.values.set((NaturalistChannel)i, dequantize((NaturalistChannel)i, code));
+    }
+
+    if (history == nullptr) {
+        // Someone new, in place of whoever we've heard from least recently.
+        history = &devices_[0];
+        for (auto &candidate : devices_) {
+            if (candidate.received == 0) {
+                history = &candidate;
+                break;
+            }
+            if (candidate.heard < history->heard) {
+                history = &candidate;
+            }
+        }
+        *history = LoraFrameDeviceHistory{};
+        history->device = frame.device;
+    }
+    history->frames[history->received % LoraFrameHistory] = decoded;
+    history->received++;
+    history->heard = ++heard_;
+
+    return true;
+}
+
+LoraFrameDeviceHistory *LoraFrameDecoder::history(uint32_t device) {
+    for (auto &history : devices_) {
+        if (history.received > 0 && history.device == device) {
+            return &history;
+        }
+    }
+    return nullptr;
+}
+
+size_t LoraFrameDecoder::ack(const LoraFrame &frame, uint8_t *buffer) const {
+    buffer[0] = LoraFrameAck;
+    memcpy(buffer + 1, &frame.device, sizeof(frame.device));
+    buffer[1 + sizeof(frame.device)] = frame.sequence;
+    return LoraFrameAckSize;
+}
+
+}
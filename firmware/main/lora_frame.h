@@ -0,0 +1,192 @@
+#ifndef FK_NATURALIST_LORA_FRAME_H_INCLUDED
+#define FK_NATURALIST_LORA_FRAME_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+
+namespace fk {
+
+/**
+ * A cycle's sensor channels packed for a LoRa uplink, where every byte is
+ * airtime:
+ *
+ *   [version:4 flags:4] [device:u32] [sequence:u8] ([reference:u8]) [time:u32] [bits...]
+ *
+ * Device is the last four bytes of the sender's EUI-64, so a receiver
+ * hearing more than one keeps their sequences and references apart.
+ * The bits are a presence bitmap of the sensor channels followed by each
+ * present channel as a fixed point code of LoraChannelPrecisions[channel].
+ * Both are MSB first and the last byte is padded with zeros. Delta frames
+ * name the reference, the last frame the receiver acked, and put a bit in
+ * front of each code: 1 for a signed difference from the reference's code
+ * in deltaBits, 0 for an absolute code when there's no reference value or
+ * the difference doesn't fit. Derived channels aren't sent, the receiver can
+ * work them out again.
+ */
+constexpr uint8_t LoraFrameVersion = 0x20;
+constexpr uint8_t LoraFrameDelta = 0x01;
+
+/**
+ * What a receiver sends back, [LoraFrameAck] [device:u32] [sequence], once
+ * it has a frame it can use as a reference.
+ */
+constexpr uint8_t LoraFrameAck = 0xAC;
+constexpr size_t LoraFrameAckSize = 1 + 4 + 1;
+
+/**
+ * Frames a receiver keeps of each device to decode deltas against, an
+ * encoder won't use a reference older than this many of its own frames.
+ */
+constexpr size_t LoraFrameHistory = 8;
+
+/**
+ * Devices a receiver keeps that history for. Past this the one heard least
+ * recently is forgotten, and its deltas fail until it's acked again.
+ */
+constexpr size_t LoraFrameDevices = 8;
+
+/**
+ * Codes are minimum + code * resolution, clamped to what fits in bits.
+ */
+struct LoraChannelPrecision {
+    float minimum;
+    float resolution;
+    uint8_t bits;
+    uint8_t deltaBits;
+};
+
+constexpr LoraChannelPrecision LoraChannelPrecisions[NumberOfNaturalistSensorChannels] = {
+    { -40.0f, 0.01f, 14, 8 },       // Temp1, to 123.8°C
+    { 0.0f, 0.01f, 14, 8 },         // Humidity
+    { -40.0f, 0.0625f, 12, 6 },     // Temp2, the MPL3115A2 resolves sixteenths
+    { 20000.0f, 0.25f, 19, 10 },    // Pressure, the MPL3115A2's 20 to 110kPa
+    { -700.0f, 0.1f, 17, 11 },      // Altitude
+    { 0.0f, 1.0f, 16, 12 },         // LightIr
+    { 0.0f, 1.0f, 16, 12 },         // LightVisible
+    { 0.0f, 0.1f, 20, 14 },         // LightLux, to 104kLx
+    { 0.0f, 1.0f, 2, 0 },           // ImuCal
+    { 0.0f, 0.0625f, 13, 8 },       // ImuOrienX, the BNO055 reports sixteenths
+    { -180.0f, 0.0625f, 13, 8 },    // ImuOrienY
+    { -180.0f, 0.0625f, 13, 8 },    // ImuOrienZ
+    { 0.0f, 0.00001f, 17, 12 },     // AudioRmsAvg, full scale is 1
+    { 0.0f, 0.00001f, 17, 12 },     // AudioRmsMin
+    { 0.0f, 0.00001f, 17, 12 },     // AudioRmsMax
+    { -120.0f, 0.01f, 14, 10 },     // AudioDbfsAvg
+    { -120.0f, 0.01f, 14, 10 },     // AudioDbfsMin
+    { -120.0f, 0.01f, 14, 10 },     // AudioDbfsMax
+};
+
+constexpr size_t lora_frame_bits(size_t channel = 0) {
+    return channel == NumberOfNaturalistSensorChannels ? 0 :
+        1 + (LoraChannelPrecisions[channel].bits > LoraChannelPrecisions[channel].deltaBits ?
+             LoraChannelPrecisions[channel].bits : LoraChannelPrecisions[channel].deltaBits) + lora_frame_bits(channel + 1);
+}
+
+constexpr size_t LoraFrameMaximumSize = 1 + 4 + 1 + 1 + 4 + (NumberOfNaturalistSensorChannels + lora_frame_bits() + 7) / 8;
+
+/**
+ * The smallest payload LoRaWAN allows, at SF12 in EU868, so a whole cycle
+ * always goes in one packet.
+ */
+static_assert(LoraFrameMaximumSize <= 51, "LoRa frames should fit a single SF12 packet.");
+
+struct LoraFrame {
+    uint32_t device{ 0 };
+    uint8_t sequence{ 0 };
+    bool delta{ false };
+    uint8_t reference{ 0 };
+    uint32_t time{ 0 };
+    NaturalistValues values;
+};
+
+/**
+ * Codes of one frame's channels, kept by both ends to delta against.
+ */
+struct LoraFrameCodes {
+    uint32_t device{ 0 };
+    uint8_t sequence{ 0 };
+    uint32_t present{ 0 };
+    uint32_t codes[NumberOfNaturalistSensorChannels] = { 0 };
+};
+
+class LoraFrameEncoder {
+private:
+    LoraFrameCodes sent_;
+    LoraFrameCodes reference_;
+    bool referenced_{ false };
+    bool pending_{ false };
+    uint8_t sequence_{ 0 };
+    uint32_t device_{ 0 };
+
+public:
+    /* Who the frames are from, see LoraFrame. */
+    void device(uint32_t device) {
+        device_ = device;
+    }
+
+    /**
+     * Returns the size of the frame written to buffer, which should hold
+     * LoraFrameMaximumSize. NaN values and channels past the sensors are
+     * left out.
+     */
+    size_t encode(uint32_t time, const NaturalistValues &values, uint8_t *buffer);
+
+    /* Sequence number of the last frame encoded. */
+    uint8_t sequence() const {
+        return sent_.sequence;
+    }
+
+    /**
+     * The receiver has the frame with this sequence, later frames can be
+     * deltas against it. Only the last frame encoded can be acked.
+     */
+    bool acked(uint8_t sequence);
+
+    /* The same from the ack as received, false if it's not for us. */
+    bool acked(const uint8_t *ack, size_t size);
+
+    /* Every frame from here on is absolute, until the next ack. */
+    void forget() {
+        referenced_ = false;
+    }
+
+};
+
+/**
+ * The last LoraFrameHistory frames from one device.
+ */
+struct LoraFrameDeviceHistory {
+    uint32_t device{ 0 };
+    uint32_t heard{ 0 };
+    size_t received{ 0 };
+    LoraFrameCodes frames[LoraFrameHistory];
+};
+
+/**
+ * Decodes frames as they arrive, in any order, remembering the last
+ * LoraFrameHistory of them from each device to decode deltas against.
+ */
+class LoraFrameDecoder {
+private:
+    LoraFrameDeviceHistory devices_[LoraFrameDevices];
+    uint32_t heard_{ 0 };
+
+public:
+    /**
+     * False if the frame is truncated, from another version, or a delta
+     * against a frame this decoder never got.
+     */
+    bool decode(const uint8_t *buffer, size_t size, LoraFrame &frame);
+
+    /* The ack for frame, LoraFrameAckSize bytes. */
+    size_t ack(const LoraFrame &frame, uint8_t *buffer) const;
+
+private:
+    LoraFrameDeviceHistory *history(uint32_t device);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#if defined(FK_NATURALIST_LORA)
+
+#include <fk-core.h>
+#include <alogging/alogging.h>
+
+#include "lora_uplink.h"
+#include "mac_eeprom.h"
+
+namespace fk {
+
+constexpr const char Log[] = "LoRa";
+
+using Logger = SimpleLog<Log>;
+
+LoraUplink::LoraUplink() : rf95_(Hardware::RFM95_PIN_CS, Hardware::RFM95_PIN_D0) {
+}
+
+bool LoraUplink::begin() {
+    if (!rf95_.init()) {
+        Logger::info("Radio FAILED");
+        return false;
+    }
+
+    rf95_.setFrequency(FK_NATURALIST_LORA_FREQUENCY);
+    // SF12, 125kHz and 4/8, for range rather than rate.
+    rf95_.setModemConfig(RH_RF95::Bw125Cr48Sf4096);
+    rf95_.setTxPower(23, false);
+    rf95_.sleep();
+
+    // The serial part of the EUI-64, after the OUI.
+    uint8_t id[MacEepromIdSize];
+    MacEeprom eeprom;
+    if (eeprom.read128bMac(id)) {
+        encoder_.device((uint32_t)id[4] << 24 | (uint32_t)id[5] << 16 | (uint32_t)id[6] << 8 | id[7]);
+    }
+    else {
+        Logger::info("No EUI-64, sending as device 0.");
+    }
+
+    ready_ = true;
+
+    return true;
+}
+
+void LoraUplink::queue(uint32_t time, const NaturalistValues &values) {
+    if (!ready_ || size_ > 0) {
+        return;
+    }
+    if (sent_ && time - last_ < FK_NATURALIST_LORA_INTERVAL) {
+        return;
+    }
+
+    size_ = encoder_.encode(time, values, frame_);
+    time_ = time;
+
+    auto present = (uint32_t)0;
+    for (size_t i = 0; i < NumberOfNaturalistSensorChannels; ++i) {
+        present += values.has(i) ? 1 : 0;
+    }
+    queuedFloatBytes_ = sizeof(time) + present * (1 + sizeof(float));
+}
+
+void LoraUplink::send() {
+    if (size_ == 0) {
+        return;
+    }
+
+    auto size = size_;
+    auto sequence = encoder_.sequence();
+    size_ = 0;
+
+    auto started = fk_uptime();
+    if (!rf95_.send(frame_, size) || !rf95_.waitPacketSent()) {
+        Logger::info("Uplink #%d FAILED", sequence);
+        rf95_.sleep();
+        return;
+    }
+    auto elapsed = fk_uptime() - started;
+
+    last_ = time_;
+    sent_ = true;
+    frames_++;
+    bytes_ += size;
+    floatBytes_ += queuedFloatBytes_;
+    airtime_ += elapsed;
+
+    char hex[LoraFrameMaximumSize * 2 + 1];
+    for (size_t i = 0; i < size; ++i) {
+        snprintf(hex + i * 2, 3, "%02x", frame_[i]);
+    }
+    Logger::info("Uplink #%d %d bytes %lums frame %s", sequence, size, elapsed, hex);
+
+    uint8_t ack[RH_RF95_MAX_MESSAGE_LEN];
+    uint8_t length = sizeof(ack);
+    if (rf95_.waitAvailableTimeout(FK_NATURALIST_LORA_ACK_TIMEOUT) && rf95_.recv(ack, &length)) {
+        if (encoder_.acked(ack, length)) {
+            acks_++;
+        }
+    }
+
+    rf95_.sleep();
+}
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef FK_NATURALIST_LORA_UPLINK_H_INCLUDED
+#define FK_NATURALIST_LORA_UPLINK_H_INCLUDED
+
+#if defined(FK_NATURALIST_LORA)
+
+#include <RH_RF95.h>
+
+#include "lora_frame.h"
+
+/* Seconds between uplinks, a frame at SF12 is over a second of airtime. */
+#ifndef FK_NATURALIST_LORA_INTERVAL
+#define FK_NATURALIST_LORA_INTERVAL         300
+#endif
+
+/* How long we listen for the receiver's ack after each frame, in ms. */
+#ifndef FK_NATURALIST_LORA_ACK_TIMEOUT
+#define FK_NATURALIST_LORA_ACK_TIMEOUT      1000
+#endif
+
+#ifndef FK_NATURALIST_LORA_FREQUENCY
+#define FK_NATURALIST_LORA_FREQUENCY        915.0f
+#endif
+
+namespace fk {
+
+/**
+ * Sends a LoraFrame of the cycle's values every FK_NATURALIST_LORA_INTERVAL
+ * and listens for the ack that lets later frames be deltas.
+ *
+ * The frame is encoded during the cycle, as the values are read, and sent
+ * once the cycle's over. A frame at SF12 and its ack take a few seconds,
+ * which would otherwise hold up the merge and everything's timestamps.
+ */
+class LoraUplink {
+private:
+    RH_RF95 rf95_;
+    LoraFrameEncoder encoder_;
+    uint8_t frame_[LoraFrameMaximumSize];
+    size_t size_{ 0 };
+    uint32_t time_{ 0 };
+    uint32_t queuedFloatBytes_{ 0 };
+    uint32_t last_{ 0 };
+    uint32_t frames_{ 0 };
+    uint32_t acks_{ 0 };
+    uint32_t bytes_{ 0 };
+    uint32_t floatBytes_{ 0 };
+    uint32_t airtime_{ 0 };
+    bool ready_{ false };
+    bool sent_{ false };
+
+public:
+    LoraUplink();
+
+public:
+    bool begin();
+
+    /* Encodes values if an uplink is due and there isn't one waiting. */
+    void queue(uint32_t time, const NaturalistValues &values);
+
+    /* Sends the waiting frame, if any, the radio sleeps between them. */
+    void send();
+
+public:
+    uint32_t frames() const {
+        return frames_;
+    }
+
+    uint32_t acks() const {
+        return acks_;
+    }
+
+    /* Bytes sent, and what they'd have been as a channel and float each. */
+    uint32_t bytes() const {
+        return bytes_;
+    }
+
+    uint32_t floatBytes() const {
+        return floatBytes_;
+    }
+
+    /* Total time on air, in ms. */
+    uint32_t airtime() const {
+        return airtime_;
+    }
+
+};
+
+}
+
+#endif
+
+#endif
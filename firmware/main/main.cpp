@@ -10,49 +10,18 @@
 #include "restart_wizard.h"
 #include "initialized.h"
 #include "readings.h"
+#include "modules.h"
 #include "alogging/../printf.h"
 
 #include "seed.h"
 #include "config.h"
+#include "ram_monitor.h"
+#include "profiler.h"
 
 extern "C" {
 
 namespace fk {
 
-SensorInfo sensors[] = {
-    { "temp_1", "°C" },
-    { "humidity", "%" },
-    { "temp_2", "°C" },
-    { "pressure", "pa" },
-    { "altitude", "m" },
-    { "light_ir", "" },
-    { "light_visible", "" },
-    { "light_lux", "" },
-    { "imu_cal", "" },
-    { "imu_orien_x", "" },
-    { "imu_orien_y", "" },
-    { "imu_orien_z", "" },
-    { "audio_rms_avg", "" },
-    { "audio_rms_min", "" },
-    { "audio_rms_max", "" },
-    { "audio_dbfs_avg", "" },
-    { "audio_dbfs_min", "" },
-    { "audio_dbfs_max", "" },
-};
-
-SensorReading readings[18];
-
-ModuleInfo module = {
-    fk_module_ModuleType_SENSOR,
-    8,
-    18,
-    1,
-    "FkNat",
-    "fk-naturalist",
-    sensors,
-    readings
-};
-
 class ConfigureDevice : public MainServicesState {
 public:
     const char *name() const override {
@@ -79,7 +48,7 @@ public:
         log("Configured compile time networks.");
         #endif
 
-        state->configure(module);
+        naturalist_configure(*state);
         state->doneScanning();
 
         CoreFsm::state<TakeNaturalistReadings>().setup();
@@ -132,9 +101,15 @@ void setup() {
     REG_MTB_MASTER = 0x80000000 + 6;
     #endif
 
+    fk::RamMonitor::paint();
+
     SEGGER_RTT_Init();
     SEGGER_RTT_SetFlagsUpBuffer(0, SEGGER_RTT_MODE_NO_BLOCK_SKIP);
 
+    #if defined(FK_PROFILER)
+    fk::profiler.begin();
+    #endif
+
     setup_serial();
     setup_env();
 
@@ -0,0 +1,73 @@
+#include "modules.h"
+#include "channels.h"
+#include "sensor_board.h"
+
+namespace fk {
+
+static SensorInfo sensors[] = {
+    { "temp_1", "°C" },
+    { "humidity", "%" },
+    { "temp_2", "°C" },
+    { "pressure", "pa" },
+    { "altitude", "m" },
+    { "light_ir", "" },
+    { "light_visible", "" },
+    { "light_lux", "" },
+    { "imu_cal", "" },
+    { "imu_orien_x", "" },
+    { "imu_orien_y", "" },
+    { "imu_orien_z", "" },
+    { "audio_rms_avg", "" },
+    { "audio_rms_min", "" },
+    { "audio_rms_max", "" },
+    { "audio_dbfs_avg", "" },
+    { "audio_dbfs_min", "" },
+    { "audio_dbfs_max", "" },
+    #if defined(FK_NATURALIST_DERIVED)
+    { "dew_point", "°C" },
+    { "abs_humidity", "g/m³" },
+    { "heat_index", "°C" },
+    { "sea_level_pressure", "pa" },
+    { "vpd", "kPa" },
+    #endif
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    { "diag_cycle", "ms" },
+    { "diag_recovery", "ms" },
+    { "diag_audio", "ms" },
+    { "diag_sht31", "ms" },
+    { "diag_mpl3115a2", "ms" },
+    { "diag_tsl2591", "ms" },
+    { "diag_bno055", "ms" },
+    { "diag_merge", "ms" },
+    { "diag_logging", "ms" },
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    { "burst", "" },
+    #endif
+};
+
+static_assert(sizeof(sensors) / sizeof(SensorInfo) == NumberOfNaturalistChannels, "SensorInfo table and NaturalistChannel disagree.");
+
+static SensorReading readings[NumberOfNaturalistBoards][NumberOfNaturalistChannels];
+
+// One per board, they share the sensors but each has its own readings.
+static ModuleInfo modules[NumberOfNaturalistBoards];
+
+void naturalist_configure(CoreState &state) {
+    for (size_t i = 0; i < NumberOfNaturalistBoards; ++i) {
+        auto &board = naturalist_boards[i];
+        modules[i] = ModuleInfo{
+            fk_module_ModuleType_SENSOR,
+            board.module(),
+            NumberOfNaturalistChannels,
+            1,
+            board.name(),
+            "fk-naturalist",
+            sensors,
+            readings[i]
+        };
+        state.configure(modules[i]);
+    }
+}
+
+}
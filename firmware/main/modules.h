@@ -0,0 +1,17 @@
+#ifndef FK_NATURALIST_MODULES_H_INCLUDED
+#define FK_NATURALIST_MODULES_H_INCLUDED
+
+#include "core_state.h"
+
+namespace fk {
+
+/**
+ * Configures a module for each board, with the channels as sensors, so the
+ * core has somewhere to merge their readings. ConfigureDevice does this on
+ * the device, and the soak before it takes readings the same way.
+ */
+void naturalist_configure(CoreState &state);
+
+}
+
+#endif
@@ -2,6 +2,10 @@
 
 #include "hardware.h"
 #include "readings.h"
+#include "ram_monitor.h"
+#include "profiler.h"
+#include "fast_math.h"
+#include "derived.h"
 
 namespace fk {
 
@@ -9,22 +13,96 @@ constexpr const char Log[] = "Naturalist";
 
 using Logger = SimpleLog<Log>;
 
+/**
+ * The MPL3115A2's own default sea level pressure, so altitudes are what the
+ * part would have reported in altimeter mode.
+ */
+constexpr float SeaLevelPascals = 101326.0f;
+
+/**
+ * The barometric formula from the MPL3115A2 datasheet. Cheaper than asking
+ * the part, which takes another full conversion in altimeter mode.
+ */
+static float altitude_from_pressure(float pascals) {
+    return 44330.77f * (1.0f - fast_powf(pascals / SeaLevelPascals, 0.1902632f));
+}
+
+#if defined(FK_NATURALIST_STAGE_TIMING)
+static_assert((size_t)NaturalistChannel::DiagLogging - (size_t)NaturalistChannel::DiagCycle + 1 == NumberOfNaturalistStages,
+              "Diagnostic channels and NaturalistStage disagree.");
+#endif
+
+#if defined(FK_NATURALIST_ACQUISITION_TIME)
+static_assert(NumberOfNaturalistAcquisitions == NumberOfNaturalistSensors, "Acquisition times and NaturalistSensor disagree.");
+#endif
+
 void TakeNaturalistReadings::setup() {
     readings_.setup(services().leds);
 }
 
 void TakeNaturalistReadings::task() {
+    run();
+
+    resume();
+}
+
+void TakeNaturalistReadings::run() {
     readings_.setup(services().leds);
 
     services().leds->notifyReadingsBegin();
 
-    while (is_task_running(readings_.task(*services().state))) {
-        services().alive();
+    cycle();
+
+    #if defined(FK_NATURALIST_ANOMALY)
+    // Something's happening, so rather than wait for the next scheduled
+    // reading keep going for a while.
+    while (readings_.bursting()) {
+        auto started = fk_uptime();
+        cycle();
+        auto elapsed = fk_uptime() - started;
+        if (readings_.bursting() && elapsed < FK_NATURALIST_BURST_INTERVAL) {
+            delay(FK_NATURALIST_BURST_INTERVAL - elapsed);
+        }
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    // Crossed since we last armed, most likely while we slept and it's what
+    // woke us, so read now rather than wait for the next scheduled cycle.
+    if (readings_.woken()) {
+        cycle();
     }
+    #endif
+
+    #if defined(FK_NATURALIST_LORA)
+    readings_.uplink();
+    #endif
+
+    #if defined(FK_NATURALIST_SERIES_UPLOAD)
+    readings_.upload();
+    #endif
 
     services().leds->notifyReadingsDone();
+}
 
-    resume();
+void TakeNaturalistReadings::cycle() {
+    {
+        ScopedStageTimer timer{ NaturalistStage::Cycle };
+
+        while (is_task_running(readings_.task(*services().state))) {
+            services().alive();
+        }
+    }
+
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    stageTimings.cycle();
+    #endif
+
+    RamMonitor::log("cycle");
+
+    #if defined(FK_PROFILER)
+    profiler.cycle();
+    #endif
 }
 
 void NaturalistReadings::setup(Leds *leds) {
@@ -39,68 +117,466 @@ void NaturalistReadings::setup(Leds *leds) {
 
     initialized_ = true;
 
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    stageTimings.begin();
+    #endif
+
+    trace_.begin();
+
+    #if defined(FK_NATURALIST_SERIES_STORE)
+    series_.begin();
+    #endif
+
+    #if defined(FK_NATURALIST_SERIES_UPLOAD)
+    upload_.begin();
+    #endif
+
     Wire.begin();
 
+    #if defined(FK_NATURALIST_CALIBRATION)
+    calibration_.begin();
+    #endif
+
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    wake_.begin();
+    #endif
+
+    #if defined(FK_NATURALIST_LORA)
+    lora_.begin();
+    #endif
+
+    for (auto &board : naturalist_boards) {
+        // There's only the one I2S, the microphone is on the first board.
+        if (&board != &naturalist_boards[0]) {
+            board.health().disable(NaturalistSensor::Audio);
+        }
+
+        #if !defined(FK_ENABLE_BNO05)
+        board.health().disable(NaturalistSensor::Bno055);
+        #endif
+
+        for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+            auto sensor = (NaturalistSensor)i;
+            if (!board.health().health(sensor).enabled) {
+                continue;
+            }
+
+            auto ok = begin(board, sensor);
+            trace_.begin((uint8_t)sensor, ok);
+            if (ok) {
+                Logger::info("%s %s ready.", board.name(), naturalist_sensor_name(sensor));
+                board.health().succeeded(sensor);
+            }
+            else {
+                Logger::info("%s %s FAILED", board.name(), naturalist_sensor_name(sensor));
+                board.health().offline(sensor, fk_uptime());
+            }
+        }
+    }
+}
+
+bool NaturalistReadings::begin(SensorBoard &board, NaturalistSensor sensor) {
+    if (sensor != NaturalistSensor::Audio) {
+        return board.begin(sensor);
+    }
+
     Logger::log("Initialize I2S...");
     if (!AudioInI2S.begin(8000, 32)) {
         Logger::info("I2S failed");
+        return false;
+    }
+    return amplitudeAnalyzer_.input(AudioInI2S);
+}
+
+bool NaturalistReadings::probe(TwoWire &bus, uint8_t address) {
+    auto ack = I2cBus::probe(bus, address);
+    trace_.probe(&bus == &Wire ? 0 : 1, address, ack);
+    return ack;
+}
+
+void NaturalistReadings::retry(uint32_t now) {
+    constexpr size_t Retries = NumberOfNaturalistBoards * NumberOfNaturalistSensors;
+
+    auto started = fk_uptime();
+    auto tried = false;
+
+    // Round every board's sensors from where the last cycle stopped, so one
+    // slow to begin doesn't keep the others waiting behind it.
+    for (size_t n = 0; n < Retries; ++n) {
+        auto index = (retryNext_ + n) % Retries;
+        auto &board = naturalist_boards[index / NumberOfNaturalistSensors];
+        auto sensor = (NaturalistSensor)(index % NumberOfNaturalistSensors);
+        auto &health = board.health();
+        if (!health.retryDue(sensor, now)) {
+            continue;
+        }
+
+        auto began = fk_uptime();
+        if (tried && began - started + health.health(sensor).retryTook > FK_NATURALIST_RETRY_BUDGET) {
+            continue;
+        }
+        tried = true;
+        retryNext_ = (index + 1) % Retries;
+
+        // Missing is the usual reason, and it's a lot quicker to find out.
+        // The bus is only reset if something's holding it, or the mux
+        // behind it didn't answer.
+        auto probed = board.select() ? board.probe(sensor) : I2cProbe::Stuck;
+        if (probed == I2cProbe::Stuck) {
+            board.recover(sensor);
+            probed = board.select() ? board.probe(sensor) : I2cProbe::Stuck;
+        }
+        auto ok = probed == I2cProbe::Answered && begin(board, sensor);
+        trace_.begin((uint8_t)sensor, ok);
+        health.retried(sensor, fk_uptime() - began);
+        if (ok) {
+            Logger::info("%s %s recovered.", board.name(), naturalist_sensor_name(sensor));
+            health.succeeded(sensor);
+        }
+        else {
+            health.offline(sensor, now);
+        }
     }
+}
+
+TaskEval NaturalistReadings::task(CoreState &state) {
+    NaturalistValues boards[NumberOfNaturalistBoards];
+    auto &values = boards[0];
+
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    // The drivers expect both parts in standby. Both are on the direct
+    // board, and the mux is still on whichever board was read last.
+    naturalist_boards[0].select();
+    wake_.disarm();
+    #endif
+
+    auto e = read(boards);
+
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    // Around what we just read, before the deadband clears any of it.
+    naturalist_boards[0].select();
+    wake_.arm(values);
+    #endif
 
-    if (!amplitudeAnalyzer_.input(AudioInI2S)) {
-        Logger::info("Amplitude Analyzer failed");
+    #if defined(FK_NATURALIST_CALIBRATION)
+    // After the thresholds, the parts compare against what they measure.
+    for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+        calibration_.apply(b, boards[b]);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_DERIVED)
+    for (auto &v : boards) {
+        naturalist_derive(v);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_STAGE_TIMING)
+    for (size_t i = 0; i < NumberOfNaturalistStages; ++i) {
+        auto channel = (NaturalistChannel)((size_t)NaturalistChannel::DiagCycle + i);
+        values.set(channel, stageTimings.stage((NaturalistStage)i).last / 1000.0f);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_ANOMALY)
+    burst(values);
+    #endif
+
+    #if defined(FK_NATURALIST_LORA)
+    // All of it, before the deadband drops what hasn't changed. It goes
+    // out after the cycle, see uplink().
+    lora_.queue(clock.getTime(), values);
+    #endif
+
+    {
+        ScopedStageTimer timer{ NaturalistStage::Merge };
+
+        #if defined(FK_NATURALIST_ROLLUPS)
+        state_ = &state;
+        rollups_.sink(this);
+        rollups_.add(values, clock.getTime());
+        #endif
+
+        #if defined(FK_NATURALIST_ROLLUPS_ONLY)
+        // Only the diagnostics, the data goes out as rollups.
+        for (size_t i = 0; i < NumberOfNaturalistDataChannels; ++i) {
+            values.valid &= ~((uint64_t)1 << i);
+        }
+        #endif
+
+        auto time = rtc();
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            auto &v = boards[b];
+
+            #if defined(FK_NATURALIST_DEADBAND)
+            #if defined(FK_NATURALIST_ANOMALY)
+            // Bursts are for resolution, keep all of it.
+            if (!values.has((size_t)NaturalistChannel::Burst)) {
+                deadband_[b].filter(v, fk_uptime());
+            }
+            #else
+            deadband_[b].filter(v, fk_uptime());
+            #endif
+            deadband_[b].log();
+            #endif
+
+            auto module = state.getModule(naturalist_boards[b].module());
+            if (module == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+                if (!v.has(i)) {
+                    continue;
+                }
+                #if defined(FK_NATURALIST_ACQUISITION_TIME)
+                // To the second, all the core keeps. The ms are in the
+                // cycle records.
+                auto acquired = v.acquisition(i);
+                auto readingTime = acquired != 0 ? (uint32_t)(acquired / 1000) : time;
+                #else
+                auto readingTime = time;
+                #endif
+                IncomingSensorReading reading{
+                    (uint8_t)i,
+                    readingTime,
+                    v.values[i],
+                };
+                state.merge(*module, reading);
+            }
+        }
+
+        trace_.values(values);
+
+        #if defined(FK_NATURALIST_CYCLE_RECORDS)
+        uint8_t record[CycleRecordMaximumSize];
+        auto size = encoder_.encode(time, values, record);
+        auto readingSize = (uint32_t)0;
+        for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+            readingSize += values.has(i) ? sizeof(IncomingSensorReading) : 0;
+        }
+        recordBytes_ += size;
+        readingBytes_ += readingSize;
+        Logger::info("Record: %d bytes (%lu as readings)", size, readingSize);
+        #endif
+
+        #if defined(FK_NATURALIST_SERIES_STORE)
+        series_.append(time, values);
+        #endif
+    }
+
+    return e;
+}
+
+#if defined(FK_NATURALIST_ANOMALY)
+
+void NaturalistReadings::burst(NaturalistValues &values) {
+    auto tagged = false;
+
+    // Burst cycles aren't learnt from, they'd swamp the regular ones.
+    if (burst_ > 0) {
+        burst_--;
+        if (burst_ == 0) {
+            cooldown_ = FK_NATURALIST_BURST_COOLDOWN;
+        }
+        tagged = true;
     }
     else {
-        Logger::info("Amplitude Analyzer ready.");
-        hasAudioAnalyzer_ = true;
+        auto channel = anomalies_.update(values);
+        if (cooldown_ > 0) {
+            cooldown_--;
+        }
+        else if (channel >= 0) {
+            Logger::info("Anomaly: channel %d z=%f, bursting", channel, anomalies_.channel(channel).z);
+            burstChannel_ = channel;
+            burst_ = FK_NATURALIST_BURST_CYCLES;
+            bursts_++;
+            tagged = true;
+        }
     }
 
-    if (!sht31Sensor_.begin()) {
-        Logger::info("SHT31 FAILED");
+    if (tagged) {
+        values.set(NaturalistChannel::Burst, (float)burstChannel_);
     }
+}
 
-    for (auto i = 0; i < 3; ++i) {
-        if (!mpl3115a2Sensor_.begin()) {
-            Logger::info("MPL3115A2 FAILED");
+#endif
+
+#if defined(FK_NATURALIST_SERIES_UPLOAD)
+
+void NaturalistReadings::upload() {
+    // The core brings WiFi up, with FK_WIFI_STARTUP_ONLY only for a while
+    // after startup, so this catches up whenever that's happening.
+    if (strlen(FK_NATURALIST_UPLOAD_HOST) == 0 || WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+
+    upload_.upload(series_, FK_NATURALIST_UPLOAD_HOST, FK_NATURALIST_UPLOAD_PORT, FK_NATURALIST_UPLOAD_BUDGET);
+}
+
+#endif
+
+#if defined(FK_NATURALIST_ROLLUPS)
+
+void NaturalistReadings::rollup(const RollupRecord &record) {
+    Logger::info("Rollup: %d %lus@%lu n=%d min=%f max=%f mean=%f", record.channel, NaturalistRollupPeriods[record.period],
+                 record.start, record.count, record.minimum, record.maximum, record.mean);
+
+    #if defined(FK_NATURALIST_SERIES_STORE)
+    // Uploaded with the cycle records, with ROLLUPS_ONLY in place of them.
+    series_.append(clock.getTime(), record);
+    #endif
+
+    #if defined(FK_NATURALIST_ROLLUPS_ONLY)
+    // The shortest period's means stand in for the readings.
+    auto module = state_ != nullptr ? state_->getModule(naturalist_boards[0].module()) : nullptr;
+    if (record.period == 0 && module != nullptr) {
+        IncomingSensorReading reading{
+            record.channel,
+            record.start,
+            record.mean,
+        };
+        state_->merge(*module, reading);
+    }
+    #endif
+}
+
+#endif
+
+void NaturalistReadings::succeeded(SensorBoard &board, NaturalistSensor sensor, uint32_t now) {
+    board.health().succeeded(sensor);
+
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    schedule_.read(sensor, now);
+    #endif
+}
+
+void NaturalistReadings::start(SensorBoard &board, uint32_t now) {
+    NaturalistSensor sensors[] = { NaturalistSensor::Sht31, NaturalistSensor::Mpl3115a2, NaturalistSensor::Tsl2591 };
+
+    auto selected = board.select();
+
+    for (auto sensor : sensors) {
+        if (available(board, sensor) && !(selected && board.start(sensor, fk_uptime()))) {
+            board.health().failed(sensor, now);
         }
-        else {
-            break;
+    }
+}
+
+uint32_t NaturalistReadings::rtc() {
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    auto before = fk_uptime();
+    auto time = clock.getTime();
+    acquisition_.observe(time, before, fk_uptime());
+    return time;
+    #else
+    return clock.getTime();
+    #endif
+}
+
+TaskEval NaturalistReadings::read(NaturalistValues *values, bool all) {
+    auto now = fk_uptime();
+
+    trace_.cycle(rtc());
+
+    {
+        ScopedStageTimer timer{ NaturalistStage::Recovery };
+        retry(now);
+    }
+
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    schedule_.tick(now);
+    if (all) {
+        schedule_.all();
+    }
+    #if defined(FK_NATURALIST_ANOMALY)
+    // A burst is to watch what set it off closely, whatever its period.
+    if (bursting()) {
+        schedule_.all();
+    }
+    #endif
+    #endif
+
+    // Every board converts at once, and while we listen, rather than one
+    // after the other.
+    for (auto &board : naturalist_boards) {
+        start(board, now);
+    }
+
+    audio(naturalist_boards[0], values[0], now);
+
+    Logger::info("Taking readings...");
+
+    {
+        ScopedStageTimer timer{ NaturalistStage::Sht31 };
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            sht31(naturalist_boards[b], values[b], now);
         }
     }
 
-    if (!tsl2591Sensor_.begin()) {
-        Logger::info("TSL25911FN FAILED");
+    {
+        ScopedStageTimer timer{ NaturalistStage::Mpl3115a2 };
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            mpl3115a2(naturalist_boards[b], values[b], now);
+        }
     }
 
-    #if defined(FK_ENABLE_BNO05)
-    if (!bno055Wire_.begin()) {
-        Logger::info("BNO055 FAILED");
+    {
+        ScopedStageTimer timer{ NaturalistStage::Tsl2591 };
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            tsl2591(naturalist_boards[b], values[b], now);
+        }
     }
-    else {
-        if (!bnoSensor_.begin()) {
-            Logger::info("BNO055 FAILED");
-        } else {
-            hasBno055_ = true;
-            bnoSensor_.setExtCrystalUse(true);
+
+    {
+        ScopedStageTimer timer{ NaturalistStage::Bno055 };
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            bno055(naturalist_boards[b], values[b], now);
+        }
+    }
+
+    ScopedStageTimer timer{ NaturalistStage::Logging };
+
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    // Most ticks only read some of the sensors.
+    schedule_.log();
+    #else
+    auto channels = ((uint64_t)1 << NumberOfNaturalistSensorChannels) - 1;
+    for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+        // The audio channels are last and only the first board has them.
+        auto expected = b == 0 ? channels : ((uint64_t)1 << (size_t)NaturalistChannel::AudioRmsAvg) - 1;
+        if ((values[b].valid & expected) != expected) {
+            Logger::info("%s: invalid channels 0x%08lx", naturalist_boards[b].name(), (uint32_t)(expected & ~values[b].valid));
         }
     }
     #endif
+
+    return TaskEval::done();
 }
 
-TaskEval NaturalistReadings::task(CoreState &state) {
+void NaturalistReadings::audio(SensorBoard &board, NaturalistValues &values, uint32_t now) {
     constexpr uint32_t AudioSamplingDuration = 2000;
 
+    if (!available(board, NaturalistSensor::Audio)) {
+        return;
+    }
+
     auto numberOfDroppedSamples = 0;
     auto numberOfSamples = 0;
     auto audioRmsMin = 0.0f;
     auto audioRmsMax = 0.0f;
     auto total = 0.0f;
-    if (hasAudioAnalyzer_) {
+
+    {
+        ScopedStageTimer timer{ NaturalistStage::Audio };
+
         Logger::info("Ready, listening for %lums...", AudioSamplingDuration);
 
         auto start = fk_uptime();
+        acquired(values, NaturalistSensor::Audio, start + AudioSamplingDuration / 2);
         while (fk_uptime() - start < AudioSamplingDuration) {
             if (amplitudeAnalyzer_.available()) {
                 auto amplitude = amplitudeAnalyzer_.read();
+                trace_.audio(amplitude);
                 if (amplitude > 0) {
                     if (numberOfSamples == 0) {
                         audioRmsMin = amplitude;
@@ -122,88 +598,158 @@ TaskEval NaturalistReadings::task(CoreState &state) {
                 }
             }
 
+            #if defined(FK_NATURALIST_ACQUISITION_TIME)
+            // We're waiting anyway, it costs a read of the RTC.
+            if (acquisition_.due(fk_uptime())) {
+                rtc();
+            }
+            #endif
+
             leds_->task();
         }
     }
 
-    Logger::info("Taking readings...");
+    audioSamples_ += numberOfSamples + numberOfDroppedSamples;
+    droppedSamples_ += numberOfDroppedSamples;
+
+    if (numberOfSamples == 0) {
+        board.health().failed(NaturalistSensor::Audio, now);
+        return;
+    }
+
+    succeeded(board, NaturalistSensor::Audio, now);
+
+    auto audioRmsAvg = total / (float)numberOfSamples;
+    auto audioDbfsAvg = fast_dbf(audioRmsAvg);
+    auto audioDbfsMin = fast_dbf(audioRmsMin);
+    auto audioDbfsMax = fast_dbf(audioRmsMax);
+
+    values.set(NaturalistChannel::AudioRmsAvg, audioRmsAvg);
+    values.set(NaturalistChannel::AudioRmsMin, audioRmsMin);
+    values.set(NaturalistChannel::AudioRmsMax, audioRmsMax);
+    values.set(NaturalistChannel::AudioDbfsAvg, (float)audioDbfsAvg);
+    values.set(NaturalistChannel::AudioDbfsMin, (float)audioDbfsMin);
+    values.set(NaturalistChannel::AudioDbfsMax, (float)audioDbfsMax);
+
+    Logger::info("Sensors: RMS: min=%f max=%f avg=%f range=%f (%d samples, %d dropped)", audioRmsMin, audioRmsMax, audioRmsMax - audioRmsMin, audioRmsAvg, numberOfSamples, numberOfDroppedSamples);
+    Logger::info("Sensors: dbfs: min=%f max=%f avg=%f", audioDbfsMin, audioDbfsMax, audioDbfsAvg);
+}
 
-    auto audioRmsAvg = numberOfSamples > 0 ? total / (float)numberOfSamples : 0.0f;
-    auto audioDbfsAvg = numberOfSamples > 0 ? 20.0f * log10(audioRmsAvg) : 0.0f;
-    auto audioDbfsMin = numberOfSamples > 0 ? 20.0f * log10(audioRmsMin) : 0.0f;
-    auto audioDbfsMax = numberOfSamples > 0 ? 20.0f * log10(audioRmsMax) : 0.0f;
+void NaturalistReadings::sht31(SensorBoard &board, NaturalistValues &values, uint32_t now) {
+    if (!board.started(NaturalistSensor::Sht31)) {
+        return;
+    }
 
-    auto shtTemperature = 0.0f;
-    auto shtHumidity = 0.0f;
+    auto selected = board.select();
 
+    auto temperature = NAN;
+    auto humidity = NAN;
     for (auto i = 0; i < 3; ++i) {
-        shtTemperature = sht31Sensor_.readTemperature();
-        shtHumidity = sht31Sensor_.readHumidity();
+        if (i > 0 && !(selected && board.start(NaturalistSensor::Sht31, fk_uptime()))) {
+            break;
+        }
+        if (!(selected && board.sht31(temperature, humidity))) {
+            temperature = NAN;
+            humidity = NAN;
+        }
+        trace_.sht31(temperature, humidity);
 
-        Logger::info("SHT31: %f", shtTemperature);
+        Logger::info("%s SHT31: %fC %f%%", board.name(), temperature, humidity);
 
-        if (!isnan(shtTemperature)) {
+        if (!isnan(temperature)) {
             break;
         }
     }
 
-    auto pressurePascals = mpl3115a2Sensor_.getPressure();
-    auto altitudeMeters = mpl3115a2Sensor_.getAltitude();
-    auto mplTempCelsius = mpl3115a2Sensor_.getTemperature();
-    auto pressureInchesMercury = pressurePascals / 3377.0;
+    if (!isnan(temperature) && !isnan(humidity)) {
+        values.set(NaturalistChannel::Temp1, temperature);
+        values.set(NaturalistChannel::Humidity, humidity);
+        acquired(values, NaturalistSensor::Sht31, board.ready(NaturalistSensor::Sht31));
+        succeeded(board, NaturalistSensor::Sht31, now);
+    }
+    else {
+        board.health().failed(NaturalistSensor::Sht31, now);
+    }
+}
+
+void NaturalistReadings::mpl3115a2(SensorBoard &board, NaturalistValues &values, uint32_t now) {
+    if (!board.started(NaturalistSensor::Mpl3115a2)) {
+        return;
+    }
+
+    auto pressure = 0.0f;
+    auto temperature = 0.0f;
+    if (!board.select() || !board.mpl3115a2(pressure, temperature)) {
+        board.health().failed(NaturalistSensor::Mpl3115a2, now);
+        return;
+    }
+
+    auto altitude = altitude_from_pressure(pressure);
+    trace_.mpl3115a2(pressure, altitude, temperature);
+
+    Logger::info("%s MPL3115A2: %fC %fpa %f\"/Hg %fm", board.name(), temperature, pressure, pressure / 3377.0f, altitude);
+
+    values.set(NaturalistChannel::Temp2, temperature);
+    values.set(NaturalistChannel::Pressure, pressure);
+    values.set(NaturalistChannel::Altitude, altitude);
+    acquired(values, NaturalistSensor::Mpl3115a2, board.ready(NaturalistSensor::Mpl3115a2));
+    succeeded(board, NaturalistSensor::Mpl3115a2, now);
+}
+
+void NaturalistReadings::tsl2591(SensorBoard &board, NaturalistValues &values, uint32_t now) {
+    if (!board.started(NaturalistSensor::Tsl2591)) {
+        return;
+    }
+
+    uint32_t fullLuminosity = 0;
+    if (!board.select() || !board.tsl2591(fullLuminosity)) {
+        board.health().failed(NaturalistSensor::Tsl2591, now);
+        return;
+    }
 
-    auto fullLuminosity = tsl2591Sensor_.getFullLuminosity();
+    trace_.tsl2591(fullLuminosity);
     auto ir = fullLuminosity >> 16;
     auto full = fullLuminosity & 0xFFFF;
-    auto lux = tsl2591Sensor_.calculateLux(full, ir);
+    auto lux = board.lux(full, ir);
 
-    uint8_t system = 0, gyro = 0, accel = 0, mag = 0;
-    sensors_event_t event;
-    memset(&event, 0, sizeof(sensors_event_t));
-    if (hasBno055_) {
-        bnoSensor_.getCalibration(&system, &gyro, &accel, &mag);
-        bnoSensor_.getEvent(&event);
-    }
-
-    float values[] = {
-        shtTemperature,
-        shtHumidity,
-        mplTempCelsius,
-        pressurePascals,
-        altitudeMeters,
-        (float)ir,
-        (float)full - ir,
-        lux,
-        (float)system,
-        event.orientation.x,
-        event.orientation.y,
-        event.orientation.z,
-        audioRmsAvg,
-        audioRmsMin,
-        audioRmsMax,
-        (float)audioDbfsAvg,
-        (float)audioDbfsMin,
-        (float)audioDbfsMax
-    };
+    Logger::info("%s TSL2591: ir(%lu) full(%lu) visible(%lu) lux(%f)", board.name(), ir, full, full - ir, lux);
 
-    auto time = clock.getTime();
-    auto module = state.getModule(8);
-    for (size_t i = 0; i < sizeof(values) / sizeof(float); ++i) {
-        IncomingSensorReading reading{
-            (uint8_t)i,
-            time,
-            values[i],
-        };
-        state.merge(*module, reading);
+    values.set(NaturalistChannel::LightIr, (float)ir);
+    values.set(NaturalistChannel::LightVisible, (float)full - ir);
+    values.set(NaturalistChannel::LightLux, lux);
+    acquired(values, NaturalistSensor::Tsl2591, board.ready(NaturalistSensor::Tsl2591));
+    succeeded(board, NaturalistSensor::Tsl2591, now);
+}
+
+void NaturalistReadings::bno055(SensorBoard &board, NaturalistValues &values, uint32_t now) {
+    if (!available(board, NaturalistSensor::Bno055)) {
+        return;
     }
 
-    Logger::info("Sensors: %fC %f%%, %fC %fpa %f\"/Hg %fm", shtTemperature, shtHumidity, mplTempCelsius, pressurePascals, pressureInchesMercury, altitudeMeters);
-    Logger::info("Sensors: ir(%lu) full(%lu) visible(%lu) lux(%f)", ir, full, full - ir, lux);
-    Logger::info("Sensors: cal(%d, %d, %d, %d) xyz(%f, %f, %f)", system, gyro, accel, mag, event.orientation.x, event.orientation.y, event.orientation.z);
-    Logger::info("Sensors: RMS: min=%f max=%f avg=%f range=%f (%d samples, %d dropped)", audioRmsMin, audioRmsMax, audioRmsMax - audioRmsMin, audioRmsAvg, numberOfSamples, numberOfDroppedSamples);
-    Logger::info("Sensors: dbfs: min=%f max=%f avg=%f", audioDbfsMin, audioDbfsMax, audioDbfsAvg);
+    if (!board.select() || !probe(Wire4and3, BNO055_ADDRESS_A)) {
+        board.health().failed(NaturalistSensor::Bno055, now);
+        return;
+    }
 
-    return TaskEval::done();
+    uint8_t system = 0, gyro = 0, accel = 0, mag = 0;
+    sensors_event_t event;
+    memset(&event, 0, sizeof(sensors_event_t));
+    board.bno055().getCalibration(&system, &gyro, &accel, &mag);
+    board.bno055().getEvent(&event);
+    auto read = fk_uptime();
+
+    uint8_t calibration[] = { system, gyro, accel, mag };
+    float orientation[] = { event.orientation.x, event.orientation.y, event.orientation.z };
+    trace_.bno055(calibration, orientation);
+
+    Logger::info("%s BNO055: cal(%d, %d, %d, %d) xyz(%f, %f, %f)", board.name(), system, gyro, accel, mag, event.orientation.x, event.orientation.y, event.orientation.z);
+
+    values.set(NaturalistChannel::ImuCal, (float)system);
+    values.set(NaturalistChannel::ImuOrienX, event.orientation.x);
+    values.set(NaturalistChannel::ImuOrienY, event.orientation.y);
+    values.set(NaturalistChannel::ImuOrienZ, event.orientation.z);
+    acquired(values, NaturalistSensor::Bno055, read);
+    succeeded(board, NaturalistSensor::Bno055, now);
 }
 
 }
@@ -1,13 +1,6 @@
 #ifndef FK_NATURALIST_READINGS_H_INCLUDED
 #define FK_NATURALIST_READINGS_H_INCLUDED
 
-#include <Adafruit_Sensor.h>
-#include <Adafruit_BNO055.h>
-#include <Adafruit_TSL2561_U.h>
-#include <Adafruit_MPL3115A2.h>
-#include <Adafruit_TSL2591.h>
-#include <Adafruit_SHT31.h>
-
 #include <AudioAnalyzer.h>
 #include <AudioIn.h>
 #include <AmplitudeAnalyzer.h>
@@ -17,20 +10,84 @@
 
 #include "task.h"
 #include "core_state.h"
-#include "two_wire.h"
+
+#include "channels.h"
+#include "sensor_health.h"
+#include "sensor_board.h"
+#include "stage_timing.h"
+#include "trace.h"
+#include "deadband.h"
+#include "rollup.h"
+#include "cycle_record.h"
+#include "series_store.h"
+#include "series_upload.h"
+#include "anomaly.h"
+#include "threshold_wake.h"
+#include "sensor_schedule.h"
+#include "lora_uplink.h"
+#include "acquisition_clock.h"
+#include "calibration.h"
+
+// The rollups are of the first board only, the others would go out with
+// nothing at all.
+#if defined(FK_NATURALIST_ROLLUPS_ONLY) && FK_NATURALIST_BOARDS > 1
+#error "FK_NATURALIST_ROLLUPS_ONLY only rolls up the first board, see FK_NATURALIST_BOARDS."
+#endif
 
 namespace fk {
 
+#if defined(FK_NATURALIST_ROLLUPS)
+class NaturalistReadings : public RollupSink {
+#else
 class NaturalistReadings {
+#endif
 private:
-    TwoWireBus bno055Wire_{ Wire4and3 };
-    Adafruit_SHT31 sht31Sensor_;
-    Adafruit_MPL3115A2 mpl3115a2Sensor_;
-    Adafruit_TSL2591 tsl2591Sensor_{ 2591 };
-    Adafruit_BNO055 bnoSensor_{ 55, BNO055_ADDRESS_A, &Wire4and3 };
     AmplitudeAnalyzer amplitudeAnalyzer_;
-    bool hasBno055_{ false };
-    bool hasAudioAnalyzer_{ false };
+    NaturalistTrace trace_;
+    #if defined(FK_NATURALIST_DEADBAND)
+    Deadband deadband_[NumberOfNaturalistBoards];
+    #endif
+    #if defined(FK_NATURALIST_ROLLUPS)
+    Rollups rollups_;
+    CoreState *state_{ nullptr };
+    #endif
+    #if defined(FK_NATURALIST_CYCLE_RECORDS)
+    CycleRecordEncoder encoder_;
+    uint32_t recordBytes_{ 0 };
+    uint32_t readingBytes_{ 0 };
+    #endif
+    #if defined(FK_NATURALIST_SERIES_STORE)
+    SeriesStore series_;
+    #endif
+    #if defined(FK_NATURALIST_SERIES_UPLOAD)
+    SeriesUpload upload_;
+    #endif
+    #if defined(FK_NATURALIST_ANOMALY)
+    AnomalyDetector anomalies_;
+    int32_t burstChannel_{ -1 };
+    uint32_t bursts_{ 0 };
+    uint8_t burst_{ 0 };
+    uint8_t cooldown_{ 0 };
+    #endif
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    ThresholdWake wake_{ Wire };
+    #endif
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    SensorSchedule schedule_;
+    #endif
+    #if defined(FK_NATURALIST_LORA)
+    LoraUplink lora_;
+    #endif
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    AcquisitionClock acquisition_;
+    #endif
+    #if defined(FK_NATURALIST_CALIBRATION)
+    Calibration calibration_;
+    #endif
+    uint32_t audioSamples_{ 0 };
+    uint32_t droppedSamples_{ 0 };
+    /* Board and sensor, as one index, whose retry goes first next cycle. */
+    size_t retryNext_{ 0 };
     bool initialized_{ false };
     Leds *leds_;
 
@@ -38,6 +95,151 @@ public:
     void setup(Leds *leds);
     TaskEval task(CoreState &state);
 
+    /**
+     * Reads every available sensor into values, one per board, without
+     * merging them. task() is this plus the merge. With MULTI_RATE only the
+     * due sensors are read, unless all is set, as benchmarks that read back
+     * to back want.
+     */
+    TaskEval read(NaturalistValues *values, bool all = false);
+
+public:
+    /* Audio is with the first board's sensors, it has the microphone. */
+    const SensorHealthSupervisor &health(size_t board = 0) const {
+        return naturalist_boards[board].health();
+    }
+
+    /* Audio blocks read since boot, and how many of those came back empty. */
+    uint32_t audioSamples() const {
+        return audioSamples_;
+    }
+
+    uint32_t droppedSamples() const {
+        return droppedSamples_;
+    }
+
+    #if defined(FK_NATURALIST_DEADBAND)
+    const Deadband &deadband(size_t board = 0) const {
+        return deadband_[board];
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_ROLLUPS)
+    const Rollups &rollups() const {
+        return rollups_;
+    }
+
+    void rollup(const RollupRecord &record) override;
+    #endif
+
+    #if defined(FK_NATURALIST_CYCLE_RECORDS)
+    /* Bytes of cycle records so far, and of the readings they replace. */
+    uint32_t recordBytes() const {
+        return recordBytes_;
+    }
+
+    uint32_t readingBytes() const {
+        return readingBytes_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_SERIES_STORE)
+    SeriesStore &series() {
+        return series_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_SERIES_UPLOAD)
+    /* Uploads what's new in the series store, if there's WiFi. */
+    void upload();
+    #endif
+
+    #if defined(FK_NATURALIST_ANOMALY)
+    const AnomalyDetector &anomalies() const {
+        return anomalies_;
+    }
+
+    /* True while there are burst cycles to take. */
+    bool bursting() const {
+        return burst_ > 0;
+    }
+
+    uint32_t bursts() const {
+        return bursts_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_MULTI_RATE)
+    const SensorSchedule &schedule() const {
+        return schedule_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_LORA)
+    /* Sends the LoRa frame the cycles queued, if one was due. */
+    void uplink() {
+        lora_.send();
+    }
+
+    const LoraUplink &lora() const {
+        return lora_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_ACQUISITION_TIME)
+    const AcquisitionClock &acquisition() const {
+        return acquisition_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_CALIBRATION)
+    const Calibration &calibration() const {
+        return calibration_;
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_THRESHOLD_WAKE)
+    /* True if a threshold was crossed since the last call. */
+    bool woken() {
+        return wake_.triggered() != 0;
+    }
+    #endif
+
+private:
+    bool begin(SensorBoard &board, NaturalistSensor sensor);
+    bool probe(TwoWire &bus, uint8_t address);
+    void retry(uint32_t now);
+    void succeeded(SensorBoard &board, NaturalistSensor sensor, uint32_t now);
+    bool available(SensorBoard &board, NaturalistSensor sensor) const {
+        return board.health().available(sensor) && due(sensor);
+    }
+    void start(SensorBoard &board, uint32_t now);
+    void audio(SensorBoard &board, NaturalistValues &values, uint32_t now);
+    void sht31(SensorBoard &board, NaturalistValues &values, uint32_t now);
+    void mpl3115a2(SensorBoard &board, NaturalistValues &values, uint32_t now);
+    void tsl2591(SensorBoard &board, NaturalistValues &values, uint32_t now);
+    void bno055(SensorBoard &board, NaturalistValues &values, uint32_t now);
+
+    /* Reads the RTC, and with ACQUISITION_TIME learns from it. */
+    uint32_t rtc();
+
+    void acquired(NaturalistValues &values, NaturalistSensor sensor, uint32_t uptime) {
+        #if defined(FK_NATURALIST_ACQUISITION_TIME)
+        values.acquired[(size_t)sensor] = acquisition_.epoch(uptime);
+        #endif
+    }
+
+    bool due(NaturalistSensor sensor) const {
+        #if defined(FK_NATURALIST_MULTI_RATE)
+        return schedule_.due(sensor);
+        #else
+        return true;
+        #endif
+    }
+    #if defined(FK_NATURALIST_ANOMALY)
+    void burst(NaturalistValues &values);
+    #endif
+
 };
 
 class TakeNaturalistReadings : public MainServicesState {
@@ -53,6 +255,20 @@ public:
     void setup();
     void task() override;
 
+    /**
+     * What task() does short of handing back to the core: the cycle, any
+     * bursts or re-cycle after it, then the uplink and upload. The soak
+     * calls this, it has no core to hand back to.
+     */
+    void run();
+
+    const NaturalistReadings &readings() const {
+        return readings_;
+    }
+
+private:
+    void cycle();
+
 };
 
 }
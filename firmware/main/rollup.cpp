@@ -0,0 +1,109 @@
+#include "rollup.h"
+#include "varint.h"
+
+namespace fk {
+
+size_t rollup_encode(const RollupRecord &record, uint8_t *buffer) {
+    size_t position = 0;
+    buffer[position++] = record.channel;
+    buffer[position++] = record.period;
+    position += varint_encode(buffer + position, record.start);
+    position += varint_encode(buffer + position, record.count);
+    memcpy(buffer + position, &record.minimum, sizeof(float));
+    position += sizeof(float);
+    memcpy(buffer + position, &record.maximum, sizeof(float));
+    position += sizeof(float);
+    memcpy(buffer + position, &record.mean, sizeof(float));
+    position += sizeof(float);
+    return position;
+}
+
+size_t rollup_decode(const uint8_t *buffer, size_t size, RollupRecord &record) {
+    if (size < 2) {
+        return 0;
+    }
+
+    size_t position = 0;
+    record.channel = buffer[position++];
+    record.period = buffer[position++];
+    if (record.channel >= NumberOfNaturalistDataChannels || record.period >= NumberOfNaturalistRollupPeriods) {
+        return 0;
+    }
+
+    uint64_t value;
+    auto consumed = varint_decode(buffer + position, size - position, &value);
+    if (consumed == 0) {
+        return 0;
+    }
+    record.start = (uint32_t)value;
+    position += consumed;
+
+    consumed = varint_decode(buffer + position, size - position, &value);
+    if (consumed == 0) {
+        return 0;
+    }
+    record.count = (uint16_t)value;
+    position += consumed;
+
+    if (size - position < 3 * sizeof(float)) {
+        return 0;
+    }
+    memcpy(&record.minimum, buffer + position, sizeof(float));
+    position += sizeof(float);
+    memcpy(&record.maximum, buffer + position, sizeof(float));
+    position += sizeof(float);
+    memcpy(&record.mean, buffer + position, sizeof(float));
+    position += sizeof(float);
+
+    return position;
+}
+
+void Rollups::add(const NaturalistValues &values, uint32_t now) {
+    for (size_t p = 0; p < NumberOfNaturalistRollupPeriods; ++p) {
+        auto period = NaturalistRollupPeriods[p];
+        auto start = now - now % period;
+
+        // Clock changes can move us backwards, that ends the bucket too.
+        if (start != started_[p]) {
+            emit(p);
+            started_[p] = start;
+        }
+
+        for (size_t i = 0; i < NumberOfNaturalistDataChannels; ++i) {
+            if (values.has(i)) {
+                buckets_[p][i].add(values.values[i]);
+            }
+        }
+    }
+}
+
+void Rollups::emit(size_t period) {
+    for (size_t i = 0; i < NumberOfNaturalistDataChannels; ++i) {
+        auto &bucket = buckets_[period][i];
+        if (bucket.count == 0) {
+            continue;
+        }
+
+        RollupRecord record{
+            started_[period],
+            (uint8_t)period,
+            (uint8_t)i,
+            bucket.count,
+            bucket.minimum,
+            bucket.maximum,
+            bucket.mean(),
+        };
+
+        uint8_t buffer[RollupRecordMaximumSize];
+        bytes_ += rollup_encode(record, buffer);
+        emitted_++;
+
+        if (sink_ != nullptr) {
+            sink_->rollup(record);
+        }
+
+        bucket = RollupStatistics{};
+    }
+}
+
+}
@@ -0,0 +1,104 @@
+#ifndef FK_NATURALIST_ROLLUP_H_INCLUDED
+#define FK_NATURALIST_ROLLUP_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+
+/* Bucket lengths in seconds, shortest first. */
+#ifndef FK_NATURALIST_ROLLUP_PERIODS
+#define FK_NATURALIST_ROLLUP_PERIODS    60, 60 * 60
+#endif
+
+namespace fk {
+
+constexpr uint32_t NaturalistRollupPeriods[] = { FK_NATURALIST_ROLLUP_PERIODS };
+
+constexpr size_t NumberOfNaturalistRollupPeriods = sizeof(NaturalistRollupPeriods) / sizeof(uint32_t);
+
+struct RollupStatistics {
+    float minimum{ 0.0f };
+    float maximum{ 0.0f };
+    float total{ 0.0f };
+    uint16_t count{ 0 };
+
+    void add(float value) {
+        if (count == 0 || value < minimum) {
+            minimum = value;
+        }
+        if (count == 0 || value > maximum) {
+            maximum = value;
+        }
+        total += value;
+        count++;
+    }
+
+    float mean() const {
+        return count == 0 ? 0.0f : total / count;
+    }
+};
+
+struct RollupRecord {
+    /* Seconds, aligned to the period. */
+    uint32_t start;
+    uint8_t period;
+    uint8_t channel;
+    uint16_t count;
+    float minimum;
+    float maximum;
+    float mean;
+};
+
+/**
+ *   [channel:u8] [period:u8] [start:varint] [count:varint] [minimum:f32]
+ *   [maximum:f32] [mean:f32]
+ */
+constexpr size_t RollupRecordMaximumSize = 2 + 5 + 3 + 3 * sizeof(float);
+
+size_t rollup_encode(const RollupRecord &record, uint8_t *buffer);
+
+size_t rollup_decode(const uint8_t *buffer, size_t size, RollupRecord &record);
+
+class RollupSink {
+public:
+    virtual void rollup(const RollupRecord &record) = 0;
+
+};
+
+/**
+ * Running statistics of each data channel over buckets of every period, in
+ * fixed memory. A bucket is emitted to the sink once a reading arrives for a
+ * later one, empty buckets emit nothing.
+ */
+class Rollups {
+private:
+    RollupStatistics buckets_[NumberOfNaturalistRollupPeriods][NumberOfNaturalistDataChannels];
+    uint32_t started_[NumberOfNaturalistRollupPeriods] = { 0 };
+    RollupSink *sink_{ nullptr };
+    uint32_t emitted_{ 0 };
+    uint32_t bytes_{ 0 };
+
+public:
+    void sink(RollupSink *sink) {
+        sink_ = sink;
+    }
+
+    void add(const NaturalistValues &values, uint32_t now);
+
+    /* Records emitted, and what they'd be encoded. */
+    uint32_t emitted() const {
+        return emitted_;
+    }
+
+    uint32_t bytes() const {
+        return bytes_;
+    }
+
+private:
+    void emit(size_t period);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,337 @@
+#include <fk-core.h>
+#include <alogging/alogging.h>
+
+#include "sensor_board.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Board";
+
+using Logger = SimpleLog<Log>;
+
+constexpr uint8_t Wire4and3PinSda = 4;
+constexpr uint8_t Wire4and3PinScl = 3;
+
+constexpr uint8_t Tca9548aAddress = 0x70;
+
+constexpr uint8_t Sht31Address = 0x44;
+// Single shot, high repeatability, no clock stretching. 15ms at most.
+constexpr uint8_t Sht31Measure[] = { 0x24, 0x00 };
+constexpr uint32_t Sht31ConversionMs = 15;
+
+constexpr uint8_t Mpl3115a2Address = 0x60;
+constexpr uint8_t Mpl3115a2RegisterStatus = 0x00;
+constexpr uint8_t Mpl3115a2RegisterOutP = 0x01;
+constexpr uint8_t Mpl3115a2RegisterCtrl1 = 0x26;
+constexpr uint8_t Mpl3115a2StatusPdr = 0x04;
+// Barometer, 128x oversampling, one shot. Pressure and temperature come from
+// the same conversion, 512ms at most.
+constexpr uint8_t Mpl3115a2Ctrl1OneShot = 0x3A;
+constexpr uint32_t Mpl3115a2ConversionMs = 512;
+
+constexpr uint8_t Tsl2591Address = 0x29;
+constexpr uint8_t Tsl2591Command = 0xA0;
+constexpr uint8_t Tsl2591RegisterEnable = 0x00;
+constexpr uint8_t Tsl2591RegisterStatus = 0x13;
+constexpr uint8_t Tsl2591RegisterC0DataL = 0x14;
+constexpr uint8_t Tsl2591EnablePowerOn = 0x01;
+constexpr uint8_t Tsl2591EnableAls = 0x02;
+constexpr uint8_t Tsl2591StatusValid = 0x01;
+// The driver's 100ms integration, and its allowance for the ADC.
+constexpr uint32_t Tsl2591ConversionMs = 120;
+
+// How long past the expected end of a conversion we'll keep polling.
+constexpr uint32_t PollMs = 10;
+constexpr uint32_t PollTimeoutMs = 100;
+
+SensorBoard naturalist_boards[NumberOfNaturalistBoards] = {
+    { 8, "FkNat", SensorBoardDirect },
+    #if FK_NATURALIST_BOARDS > 1
+    { 9, "FkNat2", 1 },
+    #endif
+    #if FK_NATURALIST_BOARDS > 2
+    { 10, "FkNat3", 2 },
+    #endif
+    #if FK_NATURALIST_BOARDS > 3
+    { 11, "FkNat4", 3 },
+    #endif
+};
+
+static uint8_t sht31_crc(const uint8_t *data, size_t size) {
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (auto bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+#if FK_NATURALIST_BOARDS > 1
+static bool mux(TwoWire &bus, uint8_t channels) {
+    bus.beginTransmission(Tca9548aAddress);
+    bus.write(channels);
+    return bus.endTransmission() == 0;
+}
+#endif
+
+bool SensorBoard::select() {
+    #if FK_NATURALIST_BOARDS > 1
+    // The direct board shares its addresses with every board behind the mux,
+    // so all of them are switched off while it's in use.
+    auto direct = channel_ == SensorBoardDirect;
+    auto channels = direct ? (uint8_t)0 : (uint8_t)(1 << channel_);
+    auto wire = mux(Wire, channels);
+    auto wire4and3 = mux(Wire4and3, channels);
+    // Without a mux we'd only be talking to the direct board again, and
+    // nothing we started on this one can be read.
+    if (!direct && !(wire && wire4and3)) {
+        started_ = 0;
+        return false;
+    }
+    return true;
+    #else
+    return true;
+    #endif
+}
+
+bool SensorBoard::begin(NaturalistSensor sensor) {
+    if (!select()) {
+        return false;
+    }
+
+    switch (sensor) {
+    case NaturalistSensor::Sht31: {
+        return sht31Sensor_.begin();
+    }
+    case NaturalistSensor::Mpl3115a2: {
+        for (auto i = 0; i < 3; ++i) {
+            if (mpl3115a2Sensor_.begin()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    case NaturalistSensor::Tsl2591: {
+        return tsl2591Sensor_.begin();
+    }
+    case NaturalistSensor::Bno055: {
+        if (!bno055Wire_.begin()) {
+            return false;
+        }
+        if (!bnoSensor_.begin()) {
+            return false;
+        }
+        bnoSensor_.setExtCrystalUse(true);
+        return true;
+    }
+    default: {
+        return false;
+    }
+    }
+}
+
+I2cProbe SensorBoard::probe(NaturalistSensor sensor) {
+    switch (sensor) {
+    case NaturalistSensor::Sht31: return I2cBus::probe(Wire, Sht31Address, PIN_WIRE_SDA);
+    case NaturalistSensor::Mpl3115a2: return I2cBus::probe(Wire, Mpl3115a2Address, PIN_WIRE_SDA);
+    case NaturalistSensor::Tsl2591: return I2cBus::probe(Wire, Tsl2591Address, PIN_WIRE_SDA);
+    case NaturalistSensor::Bno055: return I2cBus::probe(Wire4and3, BNO055_ADDRESS_A, Wire4and3PinSda);
+    default: return I2cProbe::Answered;
+    }
+}
+
+void SensorBoard::recover(NaturalistSensor sensor) {
+    switch (sensor) {
+    case NaturalistSensor::Sht31:
+    case NaturalistSensor::Mpl3115a2:
+    case NaturalistSensor::Tsl2591: {
+        Wire.end();
+        if (!I2cBus::recover(PIN_WIRE_SDA, PIN_WIRE_SCL)) {
+            Logger::info("Wire stuck (SDA low)");
+        }
+        Wire.begin();
+        break;
+    }
+    case NaturalistSensor::Bno055: {
+        Wire4and3.end();
+        if (!I2cBus::recover(Wire4and3PinSda, Wire4and3PinScl)) {
+            Logger::info("Wire4and3 stuck (SDA low)");
+        }
+        bno055Wire_.begin();
+        break;
+    }
+    default: {
+        break;
+    }
+    }
+}
+
+bool SensorBoard::start(NaturalistSensor sensor, uint32_t now) {
+    auto ok = false;
+    auto duration = (uint32_t)0;
+
+    switch (sensor) {
+    case NaturalistSensor::Sht31: {
+        ok = write(Sht31Address, Sht31Measure, sizeof(Sht31Measure));
+        duration = Sht31ConversionMs;
+        break;
+    }
+    case NaturalistSensor::Mpl3115a2: {
+        uint8_t command[] = { Mpl3115a2RegisterCtrl1, Mpl3115a2Ctrl1OneShot };
+        ok = write(Mpl3115a2Address, command, sizeof(command));
+        duration = Mpl3115a2ConversionMs;
+        break;
+    }
+    case NaturalistSensor::Tsl2591: {
+        uint8_t command[] = { Tsl2591Command | Tsl2591RegisterEnable, Tsl2591EnablePowerOn | Tsl2591EnableAls };
+        ok = write(Tsl2591Address, command, sizeof(command));
+        duration = Tsl2591ConversionMs;
+        break;
+    }
+    default: {
+        break;
+    }
+    }
+
+    auto bit = (uint8_t)(1 << (size_t)sensor);
+    if (ok) {
+        started_ |= bit;
+        ready_[(size_t)sensor] = now + duration;
+    }
+    else {
+        started_ &= ~bit;
+    }
+
+    return ok;
+}
+
+bool SensorBoard::wait(NaturalistSensor sensor) {
+    if (!started(sensor)) {
+        return false;
+    }
+
+    started_ &= ~(uint8_t)(1 << (size_t)sensor);
+
+    auto remaining = (int32_t)(ready_[(size_t)sensor] - fk_uptime());
+    if (remaining > 0) {
+        delay(remaining);
+    }
+
+    return true;
+}
+
+bool SensorBoard::sht31(float &temperature, float &humidity) {
+    if (!wait(NaturalistSensor::Sht31)) {
+        return false;
+    }
+
+    uint8_t data[6];
+    if (!read(Sht31Address, nullptr, data, sizeof(data))) {
+        return false;
+    }
+    if (sht31_crc(data, 2) != data[2] || sht31_crc(data + 3, 2) != data[5]) {
+        return false;
+    }
+
+    auto t = (uint16_t)(data[0] << 8 | data[1]);
+    auto h = (uint16_t)(data[3] << 8 | data[4]);
+    temperature = -45.0f + 175.0f * (float)t / 65535.0f;
+    humidity = 100.0f * (float)h / 65535.0f;
+
+    return true;
+}
+
+bool SensorBoard::mpl3115a2(float &pressure, float &temperature) {
+    if (!wait(NaturalistSensor::Mpl3115a2)) {
+        return false;
+    }
+
+    uint8_t status = 0;
+    for (uint32_t waited = 0; ; waited += PollMs) {
+        if (!read(Mpl3115a2Address, &Mpl3115a2RegisterStatus, &status, 1)) {
+            return false;
+        }
+        if ((status & Mpl3115a2StatusPdr) != 0) {
+            break;
+        }
+        if (waited >= PollTimeoutMs) {
+            return false;
+        }
+        delay(PollMs);
+    }
+
+    uint8_t data[5];
+    if (!read(Mpl3115a2Address, &Mpl3115a2RegisterOutP, data, sizeof(data))) {
+        return false;
+    }
+
+    // Q18.2 pascals and Q8.4 celsius, both left justified.
+    auto p = ((uint32_t)data[0] << 16 | (uint32_t)data[1] << 8 | data[2]) >> 4;
+    auto t = (int16_t)((uint16_t)data[3] << 8 | data[4]) >> 4;
+    pressure = (float)p / 4.0f;
+    temperature = (float)t / 16.0f;
+
+    return true;
+}
+
+bool SensorBoard::tsl2591(uint32_t &fullLuminosity) {
+    if (!wait(NaturalistSensor::Tsl2591)) {
+        return false;
+    }
+
+    auto ok = false;
+    uint8_t status = 0;
+    uint8_t reg = Tsl2591Command | Tsl2591RegisterStatus;
+    for (uint32_t waited = 0; ; waited += PollMs) {
+        if (!read(Tsl2591Address, &reg, &status, 1)) {
+            break;
+        }
+        if ((status & Tsl2591StatusValid) != 0) {
+            uint8_t data[4];
+            reg = Tsl2591Command | Tsl2591RegisterC0DataL;
+            if (read(Tsl2591Address, &reg, data, sizeof(data))) {
+                // Same packing as the driver, IR (CH1) above full (CH0).
+                auto full = (uint32_t)(data[1] << 8 | data[0]);
+                auto ir = (uint32_t)(data[3] << 8 | data[2]);
+                fullLuminosity = ir << 16 | full;
+                ok = true;
+            }
+            break;
+        }
+        if (waited >= PollTimeoutMs) {
+            break;
+        }
+        delay(PollMs);
+    }
+
+    // Powered down between readings, as the driver leaves it.
+    uint8_t command[] = { Tsl2591Command | Tsl2591RegisterEnable, 0x00 };
+    write(Tsl2591Address, command, sizeof(command));
+
+    return ok;
+}
+
+bool SensorBoard::write(uint8_t address, const uint8_t *data, size_t size) {
+    Wire.beginTransmission(address);
+    for (size_t i = 0; i < size; ++i) {
+        Wire.write(data[i]);
+    }
+    return Wire.endTransmission() == 0;
+}
+
+bool SensorBoard::read(uint8_t address, const uint8_t *reg, uint8_t *data, size_t size) {
+    if (reg != nullptr && !write(address, reg, 1)) {
+        return false;
+    }
+    if (Wire.requestFrom(address, size) != size) {
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (uint8_t)Wire.read();
+    }
+    return true;
+}
+
+}
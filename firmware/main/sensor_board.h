@@ -0,0 +1,143 @@
+#ifndef FK_NATURALIST_SENSOR_BOARD_H_INCLUDED
+#define FK_NATURALIST_SENSOR_BOARD_H_INCLUDED
+
+#include <Adafruit_Sensor.h>
+#include <Adafruit_BNO055.h>
+#include <Adafruit_MPL3115A2.h>
+#include <Adafruit_TSL2591.h>
+#include <Adafruit_SHT31.h>
+
+#include "two_wire.h"
+
+#include "sensor_health.h"
+
+/*
+ * Number of naturalist sensor boards on this core. Every board has the same
+ * fixed addresses, so boards after the first sit behind a TCA9548A on both
+ * Wire and Wire4and3, see naturalist_boards.
+ */
+#ifndef FK_NATURALIST_BOARDS
+#define FK_NATURALIST_BOARDS 1
+#endif
+
+namespace fk {
+
+constexpr size_t NumberOfNaturalistBoards = FK_NATURALIST_BOARDS;
+
+static_assert(NumberOfNaturalistBoards >= 1 && NumberOfNaturalistBoards <= 4, "One to four naturalist boards.");
+
+/* A board wired straight to the buses rather than through the mux. */
+constexpr uint8_t SensorBoardDirect = 0xff;
+
+/**
+ * One sensor board's I2C sensors. The drivers configure them but their reads
+ * block for a whole conversion, so the SHT31, MPL3115A2 and TSL2591 are read
+ * split phase instead: start() begins a conversion and the read waits for
+ * whatever is left of it. Starting every board's conversions before reading
+ * any overlaps them with each other and with the audio window.
+ */
+class SensorBoard {
+private:
+    uint8_t module_;
+    const char *name_;
+    uint8_t channel_;
+    TwoWireBus bno055Wire_{ Wire4and3 };
+    Adafruit_SHT31 sht31Sensor_;
+    Adafruit_MPL3115A2 mpl3115a2Sensor_;
+    Adafruit_TSL2591 tsl2591Sensor_{ 2591 };
+    Adafruit_BNO055 bnoSensor_{ 55, BNO055_ADDRESS_A, &Wire4and3 };
+    SensorHealthSupervisor health_;
+    uint32_t ready_[NumberOfNaturalistSensors] = { 0 };
+    uint8_t started_{ 0 };
+
+public:
+    SensorBoard(uint8_t module, const char *name, uint8_t channel) : module_(module), name_(name), channel_(channel) {
+    }
+
+public:
+    /* Address of this board's module, its channels are a block of their own. */
+    uint8_t module() const {
+        return module_;
+    }
+
+    const char *name() const {
+        return name_;
+    }
+
+    SensorHealthSupervisor &health() {
+        return health_;
+    }
+
+    const SensorHealthSupervisor &health() const {
+        return health_;
+    }
+
+    Adafruit_BNO055 &bno055() {
+        return bnoSensor_;
+    }
+
+public:
+    /**
+     * Points the mux at this board, a no-op with only the one board. False
+     * if this board is behind a mux that didn't answer. Every call below
+     * expects this board to be selected.
+     */
+    bool select();
+    bool begin(NaturalistSensor sensor);
+    void recover(NaturalistSensor sensor);
+
+    /**
+     * True if the sensor answers to its address, a transaction where
+     * begin() can take a second. Audio isn't on I2C so always answers.
+     */
+    bool present(NaturalistSensor sensor) {
+        return probe(sensor) == I2cProbe::Answered;
+    }
+
+    /**
+     * As present(), and if not whether the sensor's bus needs recovering.
+     */
+    I2cProbe probe(NaturalistSensor sensor);
+
+    /**
+     * Starts a conversion of one of the split phase sensors, false if the
+     * part didn't answer.
+     */
+    bool start(NaturalistSensor sensor, uint32_t now);
+    bool started(NaturalistSensor sensor) const {
+        return (started_ & (1 << (size_t)sensor)) != 0;
+    }
+
+    /* Uptime the last conversion start() began is done by. */
+    uint32_t ready(NaturalistSensor sensor) const {
+        return ready_[(size_t)sensor];
+    }
+
+    /**
+     * These wait for the conversion start() began and read it, false if
+     * there wasn't one or it never finished.
+     */
+    bool sht31(float &temperature, float &humidity);
+    bool mpl3115a2(float &pressure, float &temperature);
+    bool tsl2591(uint32_t &fullLuminosity);
+
+    float lux(uint16_t full, uint16_t ir) {
+        return tsl2591Sensor_.calculateLux(full, ir);
+    }
+
+private:
+    bool wait(NaturalistSensor sensor);
+    bool write(uint8_t address, const uint8_t *data, size_t size);
+    bool read(uint8_t address, const uint8_t *reg, uint8_t *data, size_t size);
+
+};
+
+/**
+ * The first board is wired directly, the rest are behind the mux on the
+ * channel of the same number. Module addresses count up from 8.
+ */
+extern SensorBoard naturalist_boards[NumberOfNaturalistBoards];
+
+}
+
+#endif
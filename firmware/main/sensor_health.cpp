@@ -0,0 +1,133 @@
+#include <alogging/alogging.h>
+
+#include "sensor_health.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Health";
+
+using Logger = SimpleLog<Log>;
+
+const char *naturalist_sensor_name(NaturalistSensor sensor) {
+    switch (sensor) {
+    case NaturalistSensor::Audio: return "Audio";
+    case NaturalistSensor::Sht31: return "SHT31";
+    case NaturalistSensor::Mpl3115a2: return "MPL3115A2";
+    case NaturalistSensor::Tsl2591: return "TSL25911FN";
+    case NaturalistSensor::Bno055: return "BNO055";
+    default: return "Unknown";
+    }
+}
+
+bool I2cBus::probe(TwoWire &bus, uint8_t address) {
+    bus.beginTransmission(address);
+    return bus.endTransmission() == 0;
+}
+
+I2cProbe I2cBus::probe(TwoWire &bus, uint8_t address, uint8_t sda) {
+    bus.beginTransmission(address);
+    auto status = bus.endTransmission();
+    if (status == 0) {
+        return I2cProbe::Answered;
+    }
+    // A bus error or lost arbitration comes back as a NACK on the address
+    // too, so look at the line as well.
+    if (status == 2 && digitalRead(sda) == HIGH) {
+        return I2cProbe::Missing;
+    }
+    return I2cProbe::Stuck;
+}
+
+bool I2cBus::recover(uint8_t sda, uint8_t scl) {
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, OUTPUT);
+    digitalWrite(scl, HIGH);
+    delayMicroseconds(5);
+
+    if (digitalRead(sda) == HIGH) {
+        return true;
+    }
+
+    // A slave in the middle of a read holds SDA low until it has clocked out
+    // the remainder of its byte, nine clocks is always enough.
+    for (auto i = 0; i < 9 && digitalRead(sda) == LOW; ++i) {
+        digitalWrite(scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(scl, HIGH);
+        delayMicroseconds(5);
+    }
+
+    pinMode(sda, OUTPUT);
+    digitalWrite(sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(sda, HIGH);
+    delayMicroseconds(5);
+
+    pinMode(sda, INPUT_PULLUP);
+    pinMode(scl, INPUT_PULLUP);
+
+    return digitalRead(sda) == HIGH;
+}
+
+bool SensorHealthSupervisor::retryDue(NaturalistSensor sensor, uint32_t now) const {
+    auto &h = health(sensor);
+    if (!h.enabled || h.available) {
+        return false;
+    }
+    return (int32_t)(now - h.retryAt) >= 0;
+}
+
+void SensorHealthSupervisor::disable(NaturalistSensor sensor) {
+    auto &h = health_[(size_t)sensor];
+    h.enabled = false;
+    h.available = false;
+}
+
+void SensorHealthSupervisor::succeeded(NaturalistSensor sensor) {
+    auto &h = health_[(size_t)sensor];
+    if (!h.available && h.failures > 0) {
+        h.recoveries++;
+    }
+    h.available = true;
+    h.consecutiveFailures = 0;
+    h.backoff = 0;
+}
+
+void SensorHealthSupervisor::failed(NaturalistSensor sensor, uint32_t now) {
+    auto &h = health_[(size_t)sensor];
+    h.failures++;
+    h.consecutiveFailures++;
+
+    if (h.consecutiveFailures >= FailuresBeforeOffline) {
+        schedule(sensor, now);
+    }
+}
+
+void SensorHealthSupervisor::offline(NaturalistSensor sensor, uint32_t now) {
+    health_[(size_t)sensor].failures++;
+    schedule(sensor, now);
+}
+
+void SensorHealthSupervisor::retried(NaturalistSensor sensor, uint32_t took) {
+    health_[(size_t)sensor].retryTook = took;
+}
+
+void SensorHealthSupervisor::schedule(NaturalistSensor sensor, uint32_t now) {
+    auto &h = health_[(size_t)sensor];
+    h.available = false;
+    h.consecutiveFailures = 0;
+    if (h.backoff == 0) {
+        h.backoff = MinimumBackoff;
+    }
+    else if (h.backoff < MaximumBackoff / 2) {
+        h.backoff *= 2;
+    }
+    else {
+        h.backoff = MaximumBackoff;
+    }
+    h.retryAt = now + h.backoff;
+
+    Logger::info("%s offline (failures=%lu, retry in %lums)", naturalist_sensor_name(sensor), h.failures, h.backoff);
+}
+
+}
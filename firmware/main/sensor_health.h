@@ -0,0 +1,114 @@
+#ifndef FK_NATURALIST_SENSOR_HEALTH_H_INCLUDED
+#define FK_NATURALIST_SENSOR_HEALTH_H_INCLUDED
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/**
+ * Most ms the retries of offline sensors may take at the top of each cycle.
+ * The first due is always tried, those that wouldn't fit after it wait for
+ * a later cycle, the next in turn going first.
+ */
+#ifndef FK_NATURALIST_RETRY_BUDGET
+#define FK_NATURALIST_RETRY_BUDGET 250
+#endif
+
+namespace fk {
+
+enum class NaturalistSensor : uint8_t {
+    Audio,
+    Sht31,
+    Mpl3115a2,
+    Tsl2591,
+    Bno055,
+    NumberOfSensors
+};
+
+constexpr size_t NumberOfNaturalistSensors = (size_t)NaturalistSensor::NumberOfSensors;
+
+const char *naturalist_sensor_name(NaturalistSensor sensor);
+
+enum class I2cProbe : uint8_t {
+    Answered,
+    /* A NACK on the address with the bus free, nothing's there. */
+    Missing,
+    /* SDA held low or the transaction failed, recover() might help. */
+    Stuck,
+};
+
+class I2cBus {
+public:
+    /**
+     * Returns true if a device ACKs its address. This is our guard against
+     * the driver polling loops that never terminate when a device is missing.
+     */
+    static bool probe(TwoWire &bus, uint8_t address);
+
+    /**
+     * As probe(), but tells a missing device apart from a bus that needs
+     * recovering, sda being the bus's data pin.
+     */
+    static I2cProbe probe(TwoWire &bus, uint8_t address, uint8_t sda);
+
+    /**
+     * Frees a bus that a slave is holding by clocking SCL until SDA is
+     * released and then issuing a STOP. The bus should be ended before this
+     * is called and begun afterwards. Returns false if SDA is still low.
+     */
+    static bool recover(uint8_t sda, uint8_t scl);
+
+};
+
+struct SensorHealth {
+    bool enabled{ true };
+    bool available{ false };
+    uint8_t consecutiveFailures{ 0 };
+    uint32_t failures{ 0 };
+    uint32_t recoveries{ 0 };
+    uint32_t backoff{ 0 };
+    uint32_t retryAt{ 0 };
+    /* How long the last retry took, in ms, so the next can be budgeted. */
+    uint32_t retryTook{ 0 };
+};
+
+/**
+ * Tracks failures per sensor and schedules retries of sensors that have gone
+ * offline with an exponential backoff. Retries are only ever attempted from
+ * the top of the reading cycle, at most once per sensor and within
+ * FK_NATURALIST_RETRY_BUDGET.
+ */
+class SensorHealthSupervisor {
+public:
+    static constexpr uint32_t MinimumBackoff = 5 * 1000;
+    static constexpr uint32_t MaximumBackoff = 10 * 60 * 1000;
+    static constexpr uint8_t FailuresBeforeOffline = 3;
+
+private:
+    SensorHealth health_[NumberOfNaturalistSensors];
+
+public:
+    const SensorHealth &health(NaturalistSensor sensor) const {
+        return health_[(size_t)sensor];
+    }
+
+    bool available(NaturalistSensor sensor) const {
+        return health(sensor).available;
+    }
+
+    bool retryDue(NaturalistSensor sensor, uint32_t now) const;
+
+public:
+    void disable(NaturalistSensor sensor);
+    void succeeded(NaturalistSensor sensor);
+    void failed(NaturalistSensor sensor, uint32_t now);
+    void offline(NaturalistSensor sensor, uint32_t now);
+    void retried(NaturalistSensor sensor, uint32_t took);
+
+private:
+    void schedule(NaturalistSensor sensor, uint32_t now);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include <alogging/alogging.h>
+
+#include "sensor_schedule.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Schedule";
+
+using Logger = SimpleLog<Log>;
+
+constexpr uint32_t SlackMs = (uint32_t)FK_NATURALIST_SCHEDULE_SLACK * 1000;
+
+SensorSchedulePolicy sensor_schedule_policy(NaturalistSensor sensor) {
+    switch (sensor) {
+    case NaturalistSensor::Audio: return { FK_NATURALIST_PERIOD_AUDIO, 0 };
+    case NaturalistSensor::Sht31: return { FK_NATURALIST_PERIOD_SHT31, 0 };
+    case NaturalistSensor::Mpl3115a2: return { FK_NATURALIST_PERIOD_MPL3115A2, 0 };
+    case NaturalistSensor::Tsl2591: return { FK_NATURALIST_PERIOD_TSL2591, 0 };
+    case NaturalistSensor::Bno055: return { FK_NATURALIST_PERIOD_BNO055, 0 };
+    default: return { 60, 0 };
+    }
+}
+
+void SensorSchedule::tick(uint32_t now) {
+    due_ = 0;
+
+    auto any = false;
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        any = any || (int32_t)(now - sensors_[i].next) >= 0;
+    }
+    if (!any) {
+        return;
+    }
+
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        auto &s = sensors_[i];
+        if ((int32_t)(now + SlackMs - s.next) < 0) {
+            continue;
+        }
+
+        due_ |= 1 << i;
+
+        // The first period boundary past the slack, so reading early doesn't
+        // make it due again right away and lateness doesn't accumulate.
+        auto policy = sensor_schedule_policy((NaturalistSensor)i);
+        auto period = policy.period * 1000;
+        auto phase = policy.phase * 1000;
+        if (period == 0) {
+            // Every tick.
+            s.next = now;
+            continue;
+        }
+        auto after = now + SlackMs;
+        s.next = after < phase ? phase : ((after - phase) / period + 1) * period + phase;
+    }
+}
+
+void SensorSchedule::read(NaturalistSensor sensor, uint32_t now) {
+    auto &s = sensors_[(size_t)sensor];
+    // Every board reads the sensor in the same tick, that's one reading.
+    if (s.reads > 0 && s.last == now) {
+        return;
+    }
+    if (s.reads == 0) {
+        s.first = now;
+    }
+    s.last = now;
+    s.reads++;
+}
+
+uint32_t SensorSchedule::next(uint32_t now) const {
+    auto soonest = UINT32_MAX;
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        if (sensor_schedule_policy((NaturalistSensor)i).period == 0) {
+            continue;
+        }
+        auto remaining = (int32_t)(sensors_[i].next - now);
+        soonest = std::min(soonest, remaining > 0 ? (uint32_t)remaining : 0);
+    }
+    return soonest;
+}
+
+uint32_t SensorSchedule::interval(NaturalistSensor sensor) const {
+    auto &s = sensors_[(size_t)sensor];
+    return s.reads > 1 ? (s.last - s.first) / (s.reads - 1) : 0;
+}
+
+void SensorSchedule::log() const {
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        auto sensor = (NaturalistSensor)i;
+        if (due(sensor)) {
+            Logger::info("%s: every %lus, achieved %lums (%lu reads)", naturalist_sensor_name(sensor),
+                         sensor_schedule_policy(sensor).period, interval(sensor), sensors_[i].reads);
+        }
+    }
+}
+
+}
@@ -0,0 +1,111 @@
+#ifndef FK_NATURALIST_SENSOR_SCHEDULE_H_INCLUDED
+#define FK_NATURALIST_SENSOR_SCHEDULE_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "sensor_health.h"
+
+/* Seconds between readings of each sensor. */
+#ifndef FK_NATURALIST_PERIOD_AUDIO
+#define FK_NATURALIST_PERIOD_AUDIO          10
+#endif
+
+#ifndef FK_NATURALIST_PERIOD_SHT31
+#define FK_NATURALIST_PERIOD_SHT31          60
+#endif
+
+#ifndef FK_NATURALIST_PERIOD_MPL3115A2
+#define FK_NATURALIST_PERIOD_MPL3115A2      60
+#endif
+
+#ifndef FK_NATURALIST_PERIOD_TSL2591
+#define FK_NATURALIST_PERIOD_TSL2591        10
+#endif
+
+/* Orientation only changes if the mount does. */
+#ifndef FK_NATURALIST_PERIOD_BNO055
+#define FK_NATURALIST_PERIOD_BNO055         3600
+#endif
+
+/* Seconds early a sensor is read to share a wakeup with one that's due. */
+#ifndef FK_NATURALIST_SCHEDULE_SLACK
+#define FK_NATURALIST_SCHEDULE_SLACK        5
+#endif
+
+namespace fk {
+
+/**
+ * A sensor is due every period seconds, offset by phase. Keeping the
+ * periods multiples of each other and the phases the same lines the sensors
+ * up so they share wakeups.
+ */
+struct SensorSchedulePolicy {
+    uint32_t period;
+    uint32_t phase;
+};
+
+SensorSchedulePolicy sensor_schedule_policy(NaturalistSensor sensor);
+
+struct ScheduledSensor {
+    uint32_t next{ 0 };
+    uint32_t reads{ 0 };
+    uint32_t first{ 0 };
+    uint32_t last{ 0 };
+};
+
+/**
+ * Decides which sensors are read on each tick. Times are uptime in ms, so
+ * setting the clock doesn't disturb the schedule.
+ *
+ * Ticks are the core's reading cycles, and nothing here changes how often
+ * the core wakes us. So on the device a sensor is read at most once per
+ * core cycle, periods shorter than that come out as the core's interval and
+ * only the longer ones save anything. next() is for a caller that does
+ * choose when to wake, the host bench's --scheduled.
+ */
+class SensorSchedule {
+private:
+    ScheduledSensor sensors_[NumberOfNaturalistSensors];
+    uint8_t due_{ 0 };
+
+public:
+    /**
+     * Picks the sensors to read now: those that are due and, if any are,
+     * those due within the slack. Each is scheduled for its next period.
+     */
+    void tick(uint32_t now);
+
+    /* Every sensor is read this tick, without moving when they're next due. */
+    void all() {
+        due_ = (uint8_t)((1 << NumberOfNaturalistSensors) - 1);
+    }
+
+    bool due(NaturalistSensor sensor) const {
+        return due_ & (1 << (size_t)sensor);
+    }
+
+    /* Records a reading, for the achieved rates. */
+    void read(NaturalistSensor sensor, uint32_t now);
+
+    /**
+     * Milliseconds from now until the next sensor is due, the longest we
+     * could sleep. Sensors read every tick don't count.
+     */
+    uint32_t next(uint32_t now) const;
+
+    const ScheduledSensor &sensor(NaturalistSensor sensor) const {
+        return sensors_[(size_t)sensor];
+    }
+
+    /**
+     * Mean ms between readings of sensor, 0 until it's been read twice.
+     */
+    uint32_t interval(NaturalistSensor sensor) const;
+
+    void log() const;
+
+};
+
+}
+
+#endif
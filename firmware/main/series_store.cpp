@@ -0,0 +1,468 @@
+#if defined(FK_NATURALIST_SERIES_STORE)
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <alogging/alogging.h>
+#include <SerialFlash.h>
+
+#include "series_store.h"
+#include "hardware.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Series";
+
+using Logger = SimpleLog<Log>;
+
+/* Records are framed by a size byte, erased flash reads as this. */
+constexpr uint8_t SeriesErased = 0xff;
+
+static_assert(CycleRecordMaximumSize < SeriesErased, "Cycle records too large to frame.");
+
+class SeriesRangeVisitor : public SeriesVisitor {
+private:
+    size_t channel_;
+
+public:
+    float minimum{ INFINITY };
+    float maximum{ -INFINITY };
+    bool found{ false };
+
+public:
+    SeriesRangeVisitor(NaturalistChannel channel) : channel_((size_t)channel) {
+    }
+
+public:
+    void visit(const CycleRecord &record) override {
+        auto value = record.values.values[channel_];
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        found = true;
+    }
+
+};
+
+bool SeriesStore::begin() {
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS)) {
+        Logger::info("Flash unavailable.");
+        return false;
+    }
+
+    FlashExtent extent;
+    if (!flash_region(FlashRegion::Series, extent)) {
+        Logger::info("No room on the flash.");
+        blocks_ = 0;
+        return false;
+    }
+
+    start_ = extent.start;
+    blockSize_ = SerialFlash.blockSize();
+    blocks_ = std::min<uint32_t>(extent.size / blockSize_, SeriesMaximumBlocks);
+    head_ = blocks_ - 1;
+    sequence_ = 0;
+    foreign_ = 0;
+    open_ = false;
+
+    // Only the headers are read, a few hundred bytes for the whole store.
+    auto found = false;
+    for (uint32_t block = 0; block < blocks_; ++block) {
+        auto &entry = index_[block];
+        entry = SeriesIndexEntry{};
+
+        SeriesBlockHeader header;
+        SerialFlash.read(address(block), &header, sizeof(header));
+        if (header.magic != SeriesMagic) {
+            continue;
+        }
+
+        // Older versions and other layouts still place the head, so the
+        // blocks we write next are newer than them.
+        if (!found || header.sequence > sequence_) {
+            sequence_ = header.sequence;
+            head_ = block;
+            found = true;
+        }
+
+        if (header.version != SeriesVersion || header.layout != NaturalistChannelLayout) {
+            foreign_++;
+            continue;
+        }
+
+        SeriesBlockSummary summary;
+        SerialFlash.read(address(block, sizeof(header)), &summary, offsetof(SeriesBlockSummary, minimum));
+
+        entry.used = true;
+        entry.sequence = header.sequence;
+        entry.first = header.first;
+        entry.last = header.first;
+        if (summary.records != 0xffffffff) {
+            entry.closed = true;
+            entry.first = summary.first;
+            entry.last = summary.last;
+            entry.channels = summary.channels;
+            entry.records = summary.records;
+        }
+    }
+
+    if (found && index_[head_].used && !index_[head_].closed) {
+        recover();
+    }
+
+    if (foreign_ > 0) {
+        Logger::info("%lu blocks from another channel layout, skipping.", foreign_);
+    }
+
+    Logger::info("%lu of %lu blocks, %lu records", used(), blocks_, records());
+
+    return true;
+}
+
+void SeriesStore::recover() {
+    auto &entry = index_[head_];
+
+    summary_.first = entry.first;
+    summary_.last = entry.first;
+    summary_.records = 0;
+    summary_.channels = 0;
+    for (size_t i = 0; i < SeriesMaximumChannels; ++i) {
+        summary_.minimum[i] = INFINITY;
+        summary_.maximum[i] = -INFINITY;
+    }
+
+    CycleRecordDecoder decoder;
+    uint8_t buffer[CycleRecordMaximumSize + 1];
+
+    position_ = SeriesHeaderSize;
+    open_ = true;
+
+    while (position_ < blockSize_) {
+        SerialFlash.read(address(head_, position_), buffer, 1);
+        auto size = buffer[0];
+        if (size == SeriesErased) {
+            break;
+        }
+
+        CycleRecord record;
+        auto valid = size > 0 && size <= CycleRecordMaximumSize && position_ + 1 + size <= blockSize_;
+        if (valid) {
+            SerialFlash.read(address(head_, position_ + 1), buffer + 1, size);
+            valid = decoder.decode(buffer + 1, size, record) == size;
+        }
+        if (!valid) {
+            // Probably lost power part way through a write, nothing more can
+            // go in this block.
+            Logger::info("Block %lu corrupt at %lu, closing.", head_, position_);
+            close();
+            return;
+        }
+
+        if (!record.rollup) {
+            summarize(record.time, record.values);
+        }
+        position_ += 1 + size;
+    }
+
+    // Picks up where we left off, the encoder starts over with a keyframe.
+    encoder_.keyframe();
+}
+
+bool SeriesStore::open(uint32_t time) {
+    if (blocks_ == 0) {
+        return false;
+    }
+
+    // Oldest block is always the one after the head.
+    head_ = (head_ + 1) % blocks_;
+    sequence_++;
+
+    SerialFlash.eraseBlock(address(head_));
+
+    SeriesBlockHeader header{ SeriesMagic, sequence_, time, SeriesVersion, 0, NaturalistChannelLayout };
+    SerialFlash.write(address(head_), &header, sizeof(header));
+
+    auto &entry = index_[head_];
+    entry = SeriesIndexEntry{};
+    entry.used = true;
+    entry.sequence = sequence_;
+    entry.first = time;
+    entry.last = time;
+
+    summary_.first = time;
+    summary_.last = time;
+    summary_.records = 0;
+    summary_.channels = 0;
+    for (size_t i = 0; i < SeriesMaximumChannels; ++i) {
+        summary_.minimum[i] = INFINITY;
+        summary_.maximum[i] = -INFINITY;
+    }
+
+    position_ = SeriesHeaderSize;
+    open_ = true;
+
+    encoder_.keyframe();
+
+    return true;
+}
+
+void SeriesStore::close() {
+    SerialFlash.write(address(head_, sizeof(SeriesBlockHeader)), &summary_, sizeof(summary_));
+
+    index_[head_].closed = true;
+    open_ = false;
+}
+
+void SeriesStore::summarize(uint32_t time, const NaturalistValues &values) {
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if (values.has(i) && !std::isnan(values.values[i])) {
+            summary_.channels |= (uint64_t)1 << i;
+            summary_.minimum[i] = std::min(summary_.minimum[i], values.values[i]);
+            summary_.maximum[i] = std::max(summary_.maximum[i], values.values[i]);
+        }
+    }
+    summary_.first = std::min(summary_.first, time);
+    summary_.last = std::max(summary_.last, time);
+    summary_.records++;
+
+    auto &entry = index_[head_];
+    entry.first = summary_.first;
+    entry.last = summary_.last;
+    entry.channels = summary_.channels;
+    entry.records = summary_.records;
+}
+
+bool SeriesStore::append(uint32_t time, const NaturalistValues &values) {
+    uint8_t buffer[CycleRecordMaximumSize + 1];
+
+    if (!open_ && !open(time)) {
+        return false;
+    }
+
+    auto size = encoder_.encode(time, values, buffer + 1);
+    if (position_ + 1 + size > blockSize_) {
+        close();
+        if (!open(time)) {
+            return false;
+        }
+        size = encoder_.encode(time, values, buffer + 1);
+    }
+
+    buffer[0] = (uint8_t)size;
+    SerialFlash.write(address(head_, position_), buffer, size + 1);
+    position_ += 1 + size;
+
+    summarize(time, values);
+
+    return true;
+}
+
+bool SeriesStore::append(uint32_t time, const RollupRecord &record) {
+    uint8_t buffer[1 + 1 + RollupRecordMaximumSize];
+
+    if (!open_ && !open(time)) {
+        return false;
+    }
+
+    auto size = cycle_record_rollup(record, buffer + 1);
+    if (position_ + 1 + size > blockSize_) {
+        close();
+        if (!open(time)) {
+            return false;
+        }
+    }
+
+    buffer[0] = (uint8_t)size;
+    SerialFlash.write(address(head_, position_), buffer, size + 1);
+    position_ += 1 + size;
+
+    return true;
+}
+
+bool SeriesStore::read(uint32_t block, uint32_t from, uint32_t to, uint64_t channels, bool rollups, SeriesVisitor &visitor, SeriesQueryStats &stats) {
+    CycleRecordDecoder decoder;
+    uint8_t buffer[256];
+    size_t filled = 0;
+    size_t consumed = 0;
+
+    static_assert(sizeof(buffer) >= CycleRecordMaximumSize + 1, "Series read buffer too small.");
+
+    auto offset = SeriesHeaderSize;
+    auto end = (open_ && block == head_) ? position_ : blockSize_;
+
+    stats.blocks++;
+
+    while (true) {
+        if (filled - consumed < CycleRecordMaximumSize + 1 && offset < end) {
+            memmove(buffer, buffer + consumed, filled - consumed);
+            filled -= consumed;
+            consumed = 0;
+
+            auto reading = std::min<uint32_t>(sizeof(buffer) - filled, end - offset);
+            SerialFlash.read(address(block, offset), buffer + filled, reading);
+            filled += reading;
+            offset += reading;
+            stats.bytes += reading;
+        }
+
+        if (consumed == filled) {
+            return true;
+        }
+
+        auto size = buffer[consumed];
+        if (size == SeriesErased) {
+            return true;
+        }
+        if (size == 0 || consumed + 1 + size > filled) {
+            return false;
+        }
+
+        CycleRecord record;
+        if (decoder.decode(buffer + consumed + 1, size, record) != size) {
+            return false;
+        }
+
+        consumed += 1 + size;
+
+        if (record.time < from || record.time > to) {
+            continue;
+        }
+
+        if (record.rollup) {
+            if (rollups && (channels & ((uint64_t)1 << record.statistics.channel)) != 0) {
+                visitor.rollup(record.statistics);
+            }
+            continue;
+        }
+
+        record.values.valid &= channels;
+        if (record.values.valid == 0) {
+            continue;
+        }
+
+        stats.records++;
+        visitor.visit(record);
+    }
+}
+
+SeriesQueryStats SeriesStore::query(uint32_t from, uint32_t to, uint64_t channels, SeriesVisitor &visitor) {
+    SeriesQueryStats stats;
+
+    for (uint32_t i = 1; i <= blocks_; ++i) {
+        auto block = (head_ + i) % blocks_;
+        auto &entry = index_[block];
+        if (!entry.used || entry.last < from || entry.first > to || (entry.channels & channels) == 0) {
+            continue;
+        }
+
+        if (!read(block, from, to, channels, false, visitor, stats)) {
+            Logger::info("Block %lu corrupt.", block);
+        }
+    }
+
+    return stats;
+}
+
+SeriesQueryStats SeriesStore::scan(uint32_t from, uint32_t to, uint64_t channels, SeriesVisitor &visitor) {
+    SeriesQueryStats stats;
+
+    for (uint32_t i = 1; i <= blocks_; ++i) {
+        auto block = (head_ + i) % blocks_;
+        if (!index_[block].used) {
+            continue;
+        }
+
+        if (!read(block, from, to, channels, true, visitor, stats)) {
+            Logger::info("Block %lu corrupt.", block);
+        }
+    }
+
+    return stats;
+}
+
+bool SeriesStore::range(uint32_t from, uint32_t to, NaturalistChannel channel, float &minimum, float &maximum, SeriesQueryStats *stats) {
+    SeriesRangeVisitor visitor{ channel };
+    SeriesQueryStats ignored;
+    auto &counted = stats != nullptr ? *stats : ignored;
+    auto bit = (uint64_t)1 << (size_t)channel;
+
+    for (uint32_t i = 1; i <= blocks_; ++i) {
+        auto block = (head_ + i) % blocks_;
+        auto &entry = index_[block];
+        if (!entry.used || entry.last < from || entry.first > to || (entry.channels & bit) == 0) {
+            continue;
+        }
+
+        // Blocks entirely inside the range are answered by their summary.
+        if (entry.closed && entry.first >= from && entry.last <= to) {
+            float extremes[2];
+            auto offset = sizeof(SeriesBlockHeader) + offsetof(SeriesBlockSummary, minimum) + (size_t)channel * sizeof(float);
+            SerialFlash.read(address(block, offset), &extremes[0], sizeof(float));
+            SerialFlash.read(address(block, offset + SeriesMaximumChannels * sizeof(float)), &extremes[1], sizeof(float));
+            visitor.minimum = std::min(visitor.minimum, extremes[0]);
+            visitor.maximum = std::max(visitor.maximum, extremes[1]);
+            visitor.found = true;
+            counted.blocks++;
+            counted.bytes += sizeof(extremes);
+            continue;
+        }
+
+        read(block, from, to, bit, false, visitor, counted);
+    }
+
+    minimum = visitor.minimum;
+    maximum = visitor.maximum;
+
+    return visitor.found;
+}
+
+bool SeriesStore::pending(const SeriesCursor &cursor, SeriesExtent &extent) const {
+    // Oldest first, so sequences only go up.
+    for (uint32_t i = 1; i <= blocks_; ++i) {
+        auto block = (head_ + i) % blocks_;
+        auto &entry = index_[block];
+        if (!entry.used || entry.sequence < cursor.sequence) {
+            continue;
+        }
+
+        auto offset = entry.sequence == cursor.sequence ? std::max(cursor.offset, SeriesHeaderSize) : SeriesHeaderSize;
+        auto end = (open_ && block == head_) ? position_ : blockSize_;
+        if (offset >= end) {
+            continue;
+        }
+
+        extent.block = block;
+        extent.sequence = entry.sequence;
+        extent.offset = offset;
+        extent.end = end;
+        return true;
+    }
+
+    return false;
+}
+
+void SeriesStore::read(const SeriesExtent &extent, uint32_t offset, void *buffer, size_t size) const {
+    SerialFlash.read(address(extent.block, offset), buffer, size);
+}
+
+uint32_t SeriesStore::used() const {
+    uint32_t used = 0;
+    for (uint32_t block = 0; block < blocks_; ++block) {
+        if (index_[block].used) {
+            used++;
+        }
+    }
+    return used;
+}
+
+uint32_t SeriesStore::records() const {
+    uint32_t records = 0;
+    for (uint32_t block = 0; block < blocks_; ++block) {
+        records += index_[block].records;
+    }
+    return records;
+}
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef FK_NATURALIST_SERIES_STORE_H_INCLUDED
+#define FK_NATURALIST_SERIES_STORE_H_INCLUDED
+
+#if defined(FK_NATURALIST_SERIES_STORE)
+
+#include <Arduino.h>
+
+#include "channels.h"
+#include "cycle_record.h"
+#include "flash_layout.h"
+
+namespace fk {
+
+constexpr uint32_t SeriesMagic = 0x53524b46; // "FKRS"
+constexpr uint8_t SeriesVersion = 4;
+constexpr size_t SeriesMaximumChannels = 40;
+constexpr size_t SeriesMaximumBlocks = 32;
+/* Block header and summary, records start after this. */
+constexpr uint32_t SeriesHeaderSize = 512;
+
+static_assert(NumberOfNaturalistChannels <= SeriesMaximumChannels, "Too many channels for the series store.");
+
+/**
+ * Written when a block is opened. Layout is the NaturalistChannelLayout of
+ * the build that wrote it, blocks from another are kept out of the index.
+ */
+struct SeriesBlockHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t first;
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t layout;
+};
+
+/**
+ * Written after the header when a block is full. Until then it reads as
+ * erased, so records is 0xffffffff. First and last are the earliest and
+ * latest times, which only differ from the header if the clock was set back.
+ */
+struct SeriesBlockSummary {
+    uint64_t channels;
+    uint32_t first;
+    uint32_t last;
+    uint32_t records;
+    uint32_t reserved;
+    float minimum[SeriesMaximumChannels];
+    float maximum[SeriesMaximumChannels];
+};
+
+static_assert(sizeof(SeriesBlockHeader) + sizeof(SeriesBlockSummary) <= SeriesHeaderSize, "Series header too large.");
+
+struct SeriesIndexEntry {
+    uint32_t sequence{ 0 };
+    uint32_t first{ 0 };
+    uint32_t last{ 0 };
+    uint64_t channels{ 0 };
+    uint32_t records{ 0 };
+    bool used{ false };
+    bool closed{ false };
+};
+
+struct SeriesQueryStats {
+    uint32_t blocks{ 0 };
+    uint32_t bytes{ 0 };
+    uint32_t records{ 0 };
+};
+
+/**
+ * A position in the store, by block sequence so it survives the blocks
+ * moving around. Offsets count from the start of the block.
+ */
+struct SeriesCursor {
+    uint32_t sequence{ 0 };
+    uint32_t offset{ 0 };
+};
+
+/**
+ * A run of stored bytes in one block, from offset up to end.
+ */
+struct SeriesExtent {
+    uint32_t block{ 0 };
+    uint32_t sequence{ 0 };
+    uint32_t offset{ 0 };
+    uint32_t end{ 0 };
+};
+
+class SeriesVisitor {
+public:
+    virtual void visit(const CycleRecord &record) = 0;
+
+    virtual void rollup(const RollupRecord &record) {
+    }
+
+};
+
+/**
+ * Cycle records in a circular run of SerialFlash blocks, the Series region
+ * of the flash layout, oldest overwritten first so every block wears evenly:
+ *
+ *   [SeriesBlockHeader] [SeriesBlockSummary] ... [size:u8] [cycle record] ...
+ *
+ * Each block starts with a keyframe so it can be read on its own. RAM holds
+ * the time range and channels of each block, rebuilt from the headers at
+ * begin(), so queries only read the blocks they need. Summaries answer min
+ * and max over whole blocks without reading any records.
+ *
+ * Rollups go in amongst the cycle records, see CycleRecordRollup. They're
+ * not in the index or the summaries, so only scan() visits them.
+ *
+ * Blocks written with another channel layout, by firmware built with other
+ * channels, can't be decoded so they're skipped until they're reused. Their
+ * sequences still count, so new blocks sort after them.
+ */
+class SeriesStore {
+private:
+    SeriesIndexEntry index_[SeriesMaximumBlocks];
+    SeriesBlockSummary summary_;
+    CycleRecordEncoder encoder_;
+    uint32_t start_{ 0 };
+    uint32_t blockSize_{ 0 };
+    uint32_t blocks_{ 0 };
+    uint32_t head_{ 0 };
+    uint32_t position_{ 0 };
+    uint32_t sequence_{ 0 };
+    uint32_t foreign_{ 0 };
+    bool open_{ false };
+
+public:
+    bool begin();
+    bool append(uint32_t time, const NaturalistValues &values);
+    bool append(uint32_t time, const RollupRecord &record);
+
+    /**
+     * Visits records with times in [from, to], with only the requested
+     * channels. Those with none of them are skipped.
+     */
+    SeriesQueryStats query(uint32_t from, uint32_t to, uint64_t channels, SeriesVisitor &visitor);
+
+    /**
+     * The same, reading every block as we did before there was an index.
+     * Also visits the rollups with starts in [from, to] of the channels.
+     */
+    SeriesQueryStats scan(uint32_t from, uint32_t to, uint64_t channels, SeriesVisitor &visitor);
+
+    /**
+     * Minimum and maximum of a channel over [from, to], false if there are
+     * no readings of it.
+     */
+    bool range(uint32_t from, uint32_t to, NaturalistChannel channel, float &minimum, float &maximum, SeriesQueryStats *stats = nullptr);
+
+    /**
+     * The stored records after cursor, as they are on the flash: the rest of
+     * the first block after it that has any. Blocks that have been closed
+     * run to the end of the block, readers stop at an erased size byte.
+     * False if there's nothing after cursor.
+     */
+    bool pending(const SeriesCursor &cursor, SeriesExtent &extent) const;
+
+    /* Raw bytes of a block, no decoding. */
+    void read(const SeriesExtent &extent, uint32_t offset, void *buffer, size_t size) const;
+
+public:
+    uint32_t blocks() const {
+        return blocks_;
+    }
+
+    uint32_t blockSize() const {
+        return blockSize_;
+    }
+
+    /* Sequence of the newest block, they count up from 1. */
+    uint32_t sequence() const {
+        return sequence_;
+    }
+
+    /* Blocks from another channel layout, found at begin(). */
+    uint32_t foreign() const {
+        return foreign_;
+    }
+
+    /* Blocks holding records, including the one being written. */
+    uint32_t used() const;
+
+    uint32_t records() const;
+
+private:
+    uint32_t address(uint32_t block, uint32_t offset = 0) const {
+        return start_ + block * blockSize_ + offset;
+    }
+
+    bool open(uint32_t time);
+    void close();
+    void recover();
+    void summarize(uint32_t time, const NaturalistValues &values);
+    bool read(uint32_t block, uint32_t from, uint32_t to, uint64_t channels, bool rollups, SeriesVisitor &visitor, SeriesQueryStats &stats);
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,243 @@
+#if defined(FK_NATURALIST_SERIES_UPLOAD)
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <alogging/alogging.h>
+#include <SerialFlash.h>
+
+#include "series_upload.h"
+#include "hardware.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Upload";
+
+using Logger = SimpleLog<Log>;
+
+constexpr size_t SeriesUploadSegmentSize = 4 * sizeof(uint32_t);
+
+static uint32_t slot_check(uint32_t sequence, uint32_t offset) {
+    return ~(SeriesUploadMagic ^ sequence ^ offset);
+}
+
+bool SeriesUpload::erased(uint32_t slot) const {
+    uint32_t magic;
+    SerialFlash.read(address(slot), &magic, sizeof(magic));
+    return magic == 0xffffffff;
+}
+
+bool SeriesUpload::begin() {
+    slots_ = 0;
+    cursor_ = SeriesCursor{};
+
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS)) {
+        Logger::info("Flash unavailable.");
+        return false;
+    }
+
+    FlashExtent extent;
+    if (!flash_region(FlashRegion::UploadCursor, extent)) {
+        Logger::info("No room on the flash for the cursor.");
+        return false;
+    }
+
+    // Only ever one erase block, so it's erased with a single eraseBlock().
+    start_ = extent.start;
+    slots_ = SerialFlash.blockSize() / sizeof(SeriesUploadSlot);
+
+    // Slots are written in order, so the first erased one is found by
+    // bisection rather than reading the whole block.
+    uint32_t low = 0;
+    uint32_t high = slots_;
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        if (erased(middle)) {
+            high = middle;
+        }
+        else {
+            low = middle + 1;
+        }
+    }
+    slot_ = low;
+
+    // Anything torn by a reset part way through a write is skipped.
+    for (auto slot = slot_; slot > 0; --slot) {
+        SeriesUploadSlot saved;
+        SerialFlash.read(address(slot - 1), &saved, sizeof(saved));
+        if (saved.magic == SeriesUploadMagic && saved.check == slot_check(saved.sequence, saved.offset)) {
+            cursor_.sequence = saved.sequence;
+            cursor_.offset = saved.offset;
+            break;
+        }
+    }
+
+    Logger::info("Cursor %lu:%lu (slot %lu)", cursor_.sequence, cursor_.offset, slot_);
+
+    return true;
+}
+
+void SeriesUpload::save() {
+    if (slot_ >= slots_) {
+        SerialFlash.eraseBlock(start_);
+        slot_ = 0;
+    }
+
+    SeriesUploadSlot saved{ SeriesUploadMagic, cursor_.sequence, cursor_.offset, slot_check(cursor_.sequence, cursor_.offset) };
+    SerialFlash.write(address(slot_), &saved, sizeof(saved));
+    slot_++;
+}
+
+SeriesUploadStats SeriesUpload::upload(SeriesStore &store, const char *host, uint16_t port, uint32_t budget) {
+    SeriesUploadStats stats;
+    auto started = fk_uptime();
+
+    // Without somewhere to keep the cursor every window would start over.
+    if (slots_ == 0) {
+        return stats;
+    }
+
+    // The store was erased since, it starts counting again.
+    if (cursor_.sequence > store.sequence()) {
+        Logger::info("Cursor %lu:%lu is past the store, starting over.", cursor_.sequence, cursor_.offset);
+        cursor_ = SeriesCursor{};
+    }
+
+    while (fk_uptime() - started < budget) {
+        SeriesExtent extent;
+        if (!store.pending(cursor_, extent)) {
+            stats.finished = true;
+            break;
+        }
+
+        if (cursor_.sequence != 0 && extent.sequence > cursor_.sequence + 1) {
+            Logger::info("Blocks %lu to %lu overwritten before upload.", cursor_.sequence, extent.sequence - 1);
+        }
+
+        if (!client_.connected() && !client_.connect(host, port)) {
+            Logger::info("Connecting to %s FAILED", host);
+            break;
+        }
+
+        auto size = std::min<uint32_t>(extent.end - extent.offset, FK_NATURALIST_UPLOAD_BATCH);
+        if (!send(store, extent, size, host)) {
+            Logger::info("Upload of %lu:%lu FAILED", extent.sequence, extent.offset);
+            client_.stop();
+            break;
+        }
+
+        auto status = response();
+        if (status < 200 || status >= 300) {
+            Logger::info("Upload of %lu:%lu refused (%d)", extent.sequence, extent.offset, status);
+            client_.stop();
+            break;
+        }
+
+        cursor_.sequence = extent.sequence;
+        cursor_.offset = extent.offset + size;
+        save();
+
+        stats.requests++;
+        stats.bytes += size;
+    }
+
+    stats.elapsed = fk_uptime() - started;
+
+    Logger::info("Uploaded %lu bytes in %lu requests, %lums (cursor %lu:%lu%s)", stats.bytes, stats.requests,
+                 stats.elapsed, cursor_.sequence, cursor_.offset, stats.finished ? ", done" : "");
+
+    return stats;
+}
+
+bool SeriesUpload::send(SeriesStore &store, const SeriesExtent &extent, uint32_t size, const char *host) {
+    uint8_t buffer[FK_NATURALIST_UPLOAD_BUFFER];
+
+    auto position = (size_t)snprintf((char *)buffer, sizeof(buffer),
+                                     "POST %s HTTP/1.1\r\n"
+                                     "Host: %s\r\n"
+                                     "Content-Type: application/vnd.fk.series\r\n"
+                                     "Content-Length: %lu\r\n"
+                                     "\r\n",
+                                     FK_NATURALIST_UPLOAD_PATH, host, (uint32_t)(SeriesUploadSegmentSize + size));
+    if (position + SeriesUploadSegmentSize >= sizeof(buffer)) {
+        return false;
+    }
+
+    uint32_t segment[] = { extent.sequence, extent.offset, size, NaturalistChannelLayout };
+    memcpy(buffer + position, segment, sizeof(segment));
+    position += sizeof(segment);
+
+    // Every write but the last is a full buffer, the headers share the first.
+    auto offset = extent.offset;
+    auto end = extent.offset + size;
+    while (true) {
+        auto reading = std::min<uint32_t>(sizeof(buffer) - position, end - offset);
+        store.read(extent, offset, buffer + position, reading);
+        offset += reading;
+        position += reading;
+
+        if (client_.write(buffer, position) != position) {
+            return false;
+        }
+        position = 0;
+
+        if (offset == end) {
+            return true;
+        }
+    }
+}
+
+uint16_t SeriesUpload::response() {
+    char line[64];
+    size_t length = 0;
+    uint16_t status = 0;
+    uint32_t body = 0;
+    auto first = true;
+    auto started = fk_uptime();
+
+    while (fk_uptime() - started < FK_NATURALIST_UPLOAD_TIMEOUT) {
+        if (!client_.connected() && client_.available() == 0) {
+            return 0;
+        }
+        if (client_.available() == 0) {
+            continue;
+        }
+
+        auto c = client_.read();
+        if (c != '\n') {
+            if (c != '\r' && length < sizeof(line) - 1) {
+                line[length++] = (char)c;
+            }
+            continue;
+        }
+        line[length] = 0;
+
+        if (first) {
+            // HTTP/1.1 200 OK
+            auto space = strchr(line, ' ');
+            status = space != nullptr ? (uint16_t)atoi(space + 1) : 0;
+            first = false;
+        }
+        else if (length == 0) {
+            // Only the headers are ours to read, anything more is skipped.
+            while (body > 0 && fk_uptime() - started < FK_NATURALIST_UPLOAD_TIMEOUT) {
+                if (client_.available() > 0) {
+                    client_.read();
+                    body--;
+                }
+            }
+            return status;
+        }
+        else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            body = strtoul(line + 15, nullptr, 10);
+        }
+        length = 0;
+    }
+
+    return 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef FK_NATURALIST_SERIES_UPLOAD_H_INCLUDED
+#define FK_NATURALIST_SERIES_UPLOAD_H_INCLUDED
+
+#if defined(FK_NATURALIST_SERIES_UPLOAD)
+
+#if !defined(FK_NATURALIST_SERIES_STORE)
+#error "FK_NATURALIST_SERIES_UPLOAD uploads the series store, see FK_NATURALIST_SERIES_STORE."
+#endif
+
+#include <WiFi101.h>
+
+#include "series_store.h"
+
+/* Where the store goes, nothing is uploaded without a host. */
+#ifndef FK_NATURALIST_UPLOAD_HOST
+#define FK_NATURALIST_UPLOAD_HOST           ""
+#endif
+
+#ifndef FK_NATURALIST_UPLOAD_PORT
+#define FK_NATURALIST_UPLOAD_PORT           80
+#endif
+
+#ifndef FK_NATURALIST_UPLOAD_PATH
+#define FK_NATURALIST_UPLOAD_PATH           "/series"
+#endif
+
+/* Most bytes in one request, and so the most a closing window can waste. */
+#ifndef FK_NATURALIST_UPLOAD_BATCH
+#define FK_NATURALIST_UPLOAD_BATCH          (16 * 1024)
+#endif
+
+/* Bytes per write to the module, the only copy the records are in RAM. */
+#ifndef FK_NATURALIST_UPLOAD_BUFFER
+#define FK_NATURALIST_UPLOAD_BUFFER         512
+#endif
+
+/* How long we wait for each response, in ms. */
+#ifndef FK_NATURALIST_UPLOAD_TIMEOUT
+#define FK_NATURALIST_UPLOAD_TIMEOUT        5000
+#endif
+
+/* How long each call to upload() may keep going, in ms. */
+#ifndef FK_NATURALIST_UPLOAD_BUDGET
+#define FK_NATURALIST_UPLOAD_BUDGET         20000
+#endif
+
+namespace fk {
+
+constexpr uint32_t SeriesUploadMagic = 0x43554b46; // "FKUC"
+
+/**
+ * Cursors are appended to their block until it's full so it's only erased
+ * every few thousand uploads. The last one that checks out is current.
+ */
+struct SeriesUploadSlot {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t offset;
+    uint32_t check;
+};
+
+struct SeriesUploadStats {
+    uint32_t requests{ 0 };
+    uint32_t bytes{ 0 };
+    uint32_t elapsed{ 0 };
+    /* Everything in the store has been uploaded. */
+    bool finished{ false };
+};
+
+/**
+ * Uploads the series store as it is on the flash, each request a POST of
+ * one segment:
+ *
+ *   [sequence:u32] [offset:u32] [size:u32] [layout:u32] [block bytes...]
+ *
+ * The bytes are the block's size framed cycle records, and rollups, from
+ * offset on, read from the flash straight into the buffer that's written to
+ * the module. The receiver keeps its own copy of each block and decodes
+ * that, with the channels of the NaturalistChannelLayout in layout; the
+ * store only has blocks in this build's. The cursor is saved after each
+ * request the receiver accepts, so an upload cut off by the end of the WiFi
+ * window, or a reset, resends at most one batch.
+ */
+class SeriesUpload {
+private:
+    WiFiClient client_;
+    SeriesCursor cursor_;
+    uint32_t start_{ 0 };
+    uint32_t slot_{ 0 };
+    uint32_t slots_{ 0 };
+
+public:
+    /* Loads the saved cursor, from the UploadCursor region of the flash. */
+    bool begin();
+
+    /* Uploads from the cursor until the store is done or budget ms pass. */
+    SeriesUploadStats upload(SeriesStore &store, const char *host, uint16_t port, uint32_t budget);
+
+    const SeriesCursor &cursor() const {
+        return cursor_;
+    }
+
+private:
+    bool send(SeriesStore &store, const SeriesExtent &extent, uint32_t size, const char *host);
+    uint16_t response();
+    void save();
+
+    uint32_t address(uint32_t slot) const {
+        return start_ + slot * sizeof(SeriesUploadSlot);
+    }
+
+    bool erased(uint32_t slot) const;
+
+};
+
+}
+
+#endif
+
+#endif
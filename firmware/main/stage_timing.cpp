@@ -0,0 +1,102 @@
+#include <alogging/alogging.h>
+
+#include "stage_timing.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Timing";
+
+using Logger = SimpleLog<Log>;
+
+const char *naturalist_stage_name(NaturalistStage stage) {
+    switch (stage) {
+    case NaturalistStage::Cycle: return "cycle";
+    case NaturalistStage::Recovery: return "recovery";
+    case NaturalistStage::Audio: return "audio";
+    case NaturalistStage::Sht31: return "sht31";
+    case NaturalistStage::Mpl3115a2: return "mpl3115a2";
+    case NaturalistStage::Tsl2591: return "tsl2591";
+    case NaturalistStage::Bno055: return "bno055";
+    case NaturalistStage::Merge: return "merge";
+    case NaturalistStage::Logging: return "logging";
+    default: return "unknown";
+    }
+}
+
+#if defined(FK_NATURALIST_STAGE_TIMING)
+
+StageTimings stageTimings;
+
+void CycleCounter::begin() {
+    #if defined(ARDUINO_ARCH_SAMD)
+    PM->APBCMASK.reg |= PM_APBCMASK_TC4 | PM_APBCMASK_TC5;
+
+    GCLK->CLKCTRL.reg = (uint16_t)(GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TC4_TC5);
+    while (GCLK->STATUS.bit.SYNCBUSY);
+
+    TC4->COUNT32.CTRLA.reg = TC_CTRLA_SWRST;
+    while (TC4->COUNT32.STATUS.bit.SYNCBUSY || TC4->COUNT32.CTRLA.bit.SWRST);
+
+    TC4->COUNT32.CTRLA.reg = TC_CTRLA_MODE_COUNT32 | TC_CTRLA_WAVEGEN_NFRQ | TC_CTRLA_PRESCALER_DIV16;
+    while (TC4->COUNT32.STATUS.bit.SYNCBUSY);
+
+    // Continuous read synchronization, so reading COUNT is a single load.
+    TC4->COUNT32.READREQ.reg = TC_READREQ_RCONT | TC_READREQ_ADDR(TC_COUNT32_COUNT_OFFSET);
+    while (TC4->COUNT32.STATUS.bit.SYNCBUSY);
+
+    TC4->COUNT32.CTRLA.bit.ENABLE = 1;
+    while (TC4->COUNT32.STATUS.bit.SYNCBUSY);
+    #endif
+}
+
+void StageTimings::begin() {
+    CycleCounter::begin();
+}
+
+void StageTimings::started(NaturalistStage stage) {
+    if (observer_ != nullptr) {
+        observer_->started(stage);
+    }
+}
+
+void StageTimings::record(NaturalistStage stage, uint32_t ticks) {
+    auto &s = stages_[(size_t)stage];
+    auto elapsed = CycleCounter::micros(ticks);
+    s.count++;
+    s.last = elapsed;
+    s.total += elapsed;
+    if (elapsed < s.minimum) {
+        s.minimum = elapsed;
+    }
+    if (elapsed > s.maximum) {
+        s.maximum = elapsed;
+    }
+
+    if (observer_ != nullptr) {
+        observer_->finished(stage, elapsed);
+    }
+}
+
+void StageTimings::cycle() {
+    cycles_++;
+
+    if (cycles_ % SummaryInterval == 0) {
+        log();
+    }
+}
+
+void StageTimings::log() const {
+    Logger::info("Stages after %lu cycles (us):", cycles_);
+    for (size_t i = 0; i < NumberOfNaturalistStages; ++i) {
+        auto &s = stages_[i];
+        if (s.count == 0) {
+            continue;
+        }
+        Logger::info("  %-10s n=%lu min=%lu max=%lu mean=%lu last=%lu",
+                     naturalist_stage_name((NaturalistStage)i), s.count, s.minimum, s.maximum, s.mean(), s.last);
+    }
+}
+
+#endif
+
+}
@@ -0,0 +1,141 @@
+#ifndef FK_NATURALIST_STAGE_TIMING_H_INCLUDED
+#define FK_NATURALIST_STAGE_TIMING_H_INCLUDED
+
+#include <Arduino.h>
+
+namespace fk {
+
+enum class NaturalistStage : uint8_t {
+    Cycle,
+    Recovery,
+    Audio,
+    Sht31,
+    Mpl3115a2,
+    Tsl2591,
+    Bno055,
+    Merge,
+    Logging,
+    NumberOfStages
+};
+
+constexpr size_t NumberOfNaturalistStages = (size_t)NaturalistStage::NumberOfStages;
+
+const char *naturalist_stage_name(NaturalistStage stage);
+
+#if defined(FK_NATURALIST_STAGE_TIMING)
+
+/**
+ * Free running 32bit counter built from TC4 and TC5 clocked from GCLK0, the
+ * M0+ has no DWT cycle counter. This takes the timers used by tone() and
+ * Servo, neither of which we use. Off target this is just micros().
+ */
+class CycleCounter {
+public:
+    #if defined(ARDUINO_ARCH_SAMD)
+    static constexpr uint32_t TicksPerMicrosecond = F_CPU / 16 / 1000000;
+    #else
+    static constexpr uint32_t TicksPerMicrosecond = 1;
+    #endif
+
+public:
+    static void begin();
+
+    static uint32_t ticks() {
+        #if defined(ARDUINO_ARCH_SAMD)
+        return TC4->COUNT32.COUNT.reg;
+        #else
+        return ::micros();
+        #endif
+    }
+
+    static uint32_t micros(uint32_t ticks) {
+        return ticks / TicksPerMicrosecond;
+    }
+
+};
+
+struct StageStatistics {
+    uint32_t count{ 0 };
+    uint32_t last{ 0 };
+    uint32_t minimum{ UINT32_MAX };
+    uint32_t maximum{ 0 };
+    uint64_t total{ 0 };
+
+    uint32_t mean() const {
+        return count > 0 ? (uint32_t)(total / count) : 0;
+    }
+};
+
+/**
+ * Told as each stage starts and ends, outside of the time being measured.
+ */
+class StageObserver {
+public:
+    virtual void started(NaturalistStage stage) = 0;
+    virtual void finished(NaturalistStage stage, uint32_t elapsed) = 0;
+
+};
+
+/**
+ * Elapsed times per stage of the reading cycle, all in microseconds.
+ */
+class StageTimings {
+public:
+    static constexpr uint32_t SummaryInterval = 10;
+
+private:
+    StageStatistics stages_[NumberOfNaturalistStages];
+    StageObserver *observer_{ nullptr };
+    uint32_t cycles_{ 0 };
+
+public:
+    const StageStatistics &stage(NaturalistStage stage) const {
+        return stages_[(size_t)stage];
+    }
+
+    void observer(StageObserver *observer) {
+        observer_ = observer;
+    }
+
+public:
+    void begin();
+    void started(NaturalistStage stage);
+    void record(NaturalistStage stage, uint32_t ticks);
+    void cycle();
+    void log() const;
+
+};
+
+extern StageTimings stageTimings;
+
+class ScopedStageTimer {
+private:
+    NaturalistStage stage_;
+    uint32_t started_;
+
+public:
+    ScopedStageTimer(NaturalistStage stage) : stage_(stage) {
+        stageTimings.started(stage);
+        started_ = CycleCounter::ticks();
+    }
+
+    ~ScopedStageTimer() {
+        stageTimings.record(stage_, CycleCounter::ticks() - started_);
+    }
+
+};
+
+#else
+
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(NaturalistStage stage) {
+    }
+
+};
+
+#endif
+
+}
+
+#endif
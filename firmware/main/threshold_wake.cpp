@@ -0,0 +1,173 @@
+#if defined(FK_NATURALIST_THRESHOLD_WAKE)
+
+#include <cmath>
+
+#include <alogging/alogging.h>
+
+#include "threshold_wake.h"
+
+namespace fk {
+
+constexpr const char Log[] = "Wake";
+
+using Logger = SimpleLog<Log>;
+
+constexpr uint8_t Tsl2591Address = 0x29;
+// Normal transactions auto increment, special functions act on their own.
+constexpr uint8_t Tsl2591Command = 0xA0;
+constexpr uint8_t Tsl2591ClearInterrupts = 0xE7;
+constexpr uint8_t Tsl2591RegisterEnable = 0x00;
+constexpr uint8_t Tsl2591RegisterAilt = 0x04;
+constexpr uint8_t Tsl2591RegisterPersist = 0x0C;
+constexpr uint8_t Tsl2591EnablePowerOn = 0x01;
+constexpr uint8_t Tsl2591EnableAls = 0x02;
+constexpr uint8_t Tsl2591EnableAlsInterrupt = 0x10;
+// Three consecutive conversions outside the window, a passing shadow won't do.
+constexpr uint8_t Tsl2591Persist = 0x03;
+
+constexpr uint8_t Mpl3115a2Address = 0x60;
+constexpr uint8_t Mpl3115a2RegisterTarget = 0x16;
+constexpr uint8_t Mpl3115a2RegisterWindow = 0x1A;
+constexpr uint8_t Mpl3115a2RegisterCtrl1 = 0x26;
+constexpr uint8_t Mpl3115a2RegisterCtrl2 = 0x27;
+constexpr uint8_t Mpl3115a2RegisterCtrl3 = 0x28;
+// Barometer, 16x oversampling (66ms), standby.
+constexpr uint8_t Mpl3115a2Ctrl1Standby = 0x20;
+constexpr uint8_t Mpl3115a2Ctrl1Active = 0x21;
+// Autonomous conversions every 2^4 seconds.
+constexpr uint8_t Mpl3115a2Ctrl2Step = 0x04;
+// Active low, push pull.
+constexpr uint8_t Mpl3115a2Ctrl3 = 0x00;
+// Pressure threshold interrupt, routed to INT1.
+constexpr uint8_t Mpl3115a2Ctrl4Threshold = 0x08;
+constexpr uint8_t Mpl3115a2Ctrl5Int1 = 0x08;
+
+static volatile uint8_t triggered_ = 0;
+
+#if defined(FK_NATURALIST_TSL2591_PIN_INT)
+static void tsl2591_isr() {
+    triggered_ |= (uint8_t)WakeSource::Light;
+}
+#endif
+
+#if defined(FK_NATURALIST_MPL3115A2_PIN_INT)
+static void mpl3115a2_isr() {
+    triggered_ |= (uint8_t)WakeSource::Pressure;
+}
+#endif
+
+bool ThresholdWake::begin() {
+    auto wired = false;
+
+    // attachInterrupt also sets the pin's EIC wakeup bit, so these bring us
+    // out of standby.
+    #if defined(FK_NATURALIST_TSL2591_PIN_INT)
+    pinMode(FK_NATURALIST_TSL2591_PIN_INT, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(FK_NATURALIST_TSL2591_PIN_INT), tsl2591_isr, FALLING);
+    wired = true;
+    #endif
+
+    #if defined(FK_NATURALIST_MPL3115A2_PIN_INT)
+    pinMode(FK_NATURALIST_MPL3115A2_PIN_INT, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(FK_NATURALIST_MPL3115A2_PIN_INT), mpl3115a2_isr, FALLING);
+    wired = true;
+    #endif
+
+    if (!wired) {
+        Logger::info("No INT pins, threshold wakeups disabled.");
+    }
+
+    return wired;
+}
+
+void ThresholdWake::arm(const NaturalistValues &values) {
+    // Every cycle disarms both, but not every cycle reads both.
+    if (values.has((size_t)NaturalistChannel::LightIr) && values.has((size_t)NaturalistChannel::LightVisible)) {
+        light_ = (uint32_t)(values.get(NaturalistChannel::LightIr) + values.get(NaturalistChannel::LightVisible));
+        lit_ = true;
+    }
+    if (values.has((size_t)NaturalistChannel::Pressure) && !std::isnan(values.get(NaturalistChannel::Pressure))) {
+        pressure_ = values.get(NaturalistChannel::Pressure);
+    }
+
+    #if defined(FK_NATURALIST_TSL2591_PIN_INT)
+    if (lit_) {
+        auto ch0 = light_;
+        auto window = std::max((uint32_t)(ch0 * FK_NATURALIST_WAKE_LIGHT_RATIO), (uint32_t)FK_NATURALIST_WAKE_LIGHT_MINIMUM);
+        auto low = ch0 > window ? ch0 - window : 0;
+        auto high = std::min(ch0 + window, (uint32_t)0xffff);
+        uint8_t thresholds[] = {
+            (uint8_t)(low & 0xff), (uint8_t)(low >> 8),
+            (uint8_t)(high & 0xff), (uint8_t)(high >> 8),
+        };
+        uint8_t enable = Tsl2591EnablePowerOn | Tsl2591EnableAls | Tsl2591EnableAlsInterrupt;
+
+        write(Tsl2591Address, Tsl2591Command | Tsl2591RegisterAilt, thresholds, sizeof(thresholds));
+        write(Tsl2591Address, Tsl2591Command | Tsl2591RegisterPersist, &Tsl2591Persist, 1);
+        write(Tsl2591Address, Tsl2591ClearInterrupts, nullptr, 0);
+        write(Tsl2591Address, Tsl2591Command | Tsl2591RegisterEnable, &enable, 1);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_MPL3115A2_PIN_INT)
+    if (!std::isnan(pressure_)) {
+        // Both in units of 2Pa.
+        auto target = (uint16_t)(pressure_ / 2.0f);
+        auto window = (uint16_t)(FK_NATURALIST_WAKE_PRESSURE_WINDOW / 2.0f);
+        uint8_t targetBytes[] = { (uint8_t)(target >> 8), (uint8_t)(target & 0xff) };
+        uint8_t windowBytes[] = { (uint8_t)(window >> 8), (uint8_t)(window & 0xff) };
+        uint8_t control[] = { Mpl3115a2Ctrl2Step, Mpl3115a2Ctrl3, Mpl3115a2Ctrl4Threshold, Mpl3115a2Ctrl5Int1 };
+
+        // Only configurable in standby.
+        write(Mpl3115a2Address, Mpl3115a2RegisterCtrl1, &Mpl3115a2Ctrl1Standby, 1);
+        write(Mpl3115a2Address, Mpl3115a2RegisterTarget, targetBytes, sizeof(targetBytes));
+        write(Mpl3115a2Address, Mpl3115a2RegisterWindow, windowBytes, sizeof(windowBytes));
+        write(Mpl3115a2Address, Mpl3115a2RegisterCtrl2, control, sizeof(control));
+        write(Mpl3115a2Address, Mpl3115a2RegisterCtrl1, &Mpl3115a2Ctrl1Active, 1);
+    }
+    #endif
+}
+
+void ThresholdWake::disarm() {
+    #if defined(FK_NATURALIST_TSL2591_PIN_INT)
+    {
+        uint8_t enable = Tsl2591EnablePowerOn | Tsl2591EnableAls;
+        write(Tsl2591Address, Tsl2591Command | Tsl2591RegisterEnable, &enable, 1);
+        write(Tsl2591Address, Tsl2591ClearInterrupts, nullptr, 0);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_MPL3115A2_PIN_INT)
+    {
+        uint8_t control[] = { 0x00, Mpl3115a2Ctrl3, 0x00, 0x00 };
+        write(Mpl3115a2Address, Mpl3115a2RegisterCtrl1, &Mpl3115a2Ctrl1Standby, 1);
+        write(Mpl3115a2Address, Mpl3115a2RegisterCtrl2, control, sizeof(control));
+    }
+    #endif
+}
+
+uint8_t ThresholdWake::triggered() {
+    noInterrupts();
+    auto sources = triggered_;
+    triggered_ = 0;
+    interrupts();
+
+    if (sources != 0) {
+        Logger::info("Woken (%x)", sources);
+    }
+
+    return sources;
+}
+
+bool ThresholdWake::write(uint8_t address, uint8_t reg, const uint8_t *data, size_t size) {
+    bus_.beginTransmission(address);
+    bus_.write(reg);
+    for (size_t i = 0; i < size; ++i) {
+        bus_.write(data[i]);
+    }
+    return bus_.endTransmission() == 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef FK_NATURALIST_THRESHOLD_WAKE_H_INCLUDED
+#define FK_NATURALIST_THRESHOLD_WAKE_H_INCLUDED
+
+#if defined(FK_NATURALIST_THRESHOLD_WAKE)
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "channels.h"
+
+/*
+ * SAMD21 pins the sensors' INT outputs are wired to. The current sensor
+ * board leaves the TSL2591 INT and both MPL3115A2 INT pins unconnected, so
+ * there are no defaults and a sensor without a pin is never armed.
+ */
+// #define FK_NATURALIST_TSL2591_PIN_INT
+// #define FK_NATURALIST_MPL3115A2_PIN_INT
+
+/* Light window either side of the last reading, as a fraction of CH0. */
+#ifndef FK_NATURALIST_WAKE_LIGHT_RATIO
+#define FK_NATURALIST_WAKE_LIGHT_RATIO      0.5f
+#endif
+
+/* Smallest light window, in CH0 counts, so darkness doesn't wake us on noise. */
+#ifndef FK_NATURALIST_WAKE_LIGHT_MINIMUM
+#define FK_NATURALIST_WAKE_LIGHT_MINIMUM    64
+#endif
+
+/* Pressure window either side of the last reading, in pascals. */
+#ifndef FK_NATURALIST_WAKE_PRESSURE_WINDOW
+#define FK_NATURALIST_WAKE_PRESSURE_WINDOW  100.0f
+#endif
+
+namespace fk {
+
+enum class WakeSource : uint8_t {
+    None = 0,
+    Light = 1,
+    Pressure = 2,
+};
+
+/**
+ * Programs the TSL2591's ALS and the MPL3115A2's pressure threshold windows
+ * around the last readings and wakes us through the external interrupt
+ * controller when either crosses. The drivers leave both parts in standby
+ * between readings, so arm() leaves them converting on their own: the
+ * TSL2591 continuously and the MPL3115A2 every 16s. Disarm before reading,
+ * the drivers reconfigure both parts.
+ */
+class ThresholdWake {
+private:
+    TwoWire &bus_;
+    /**
+     * Where the windows were last centred, a part that wasn't read this
+     * cycle is armed around its last reading again.
+     */
+    uint32_t light_{ 0 };
+    bool lit_{ false };
+    float pressure_{ NAN };
+
+public:
+    ThresholdWake(TwoWire &bus) : bus_(bus) {
+    }
+
+public:
+    /**
+     * False if no sensor has an INT pin.
+     */
+    bool begin();
+    /**
+     * Windows are centred on the pressure and CH0 (IR + visible) in values,
+     * or the last ones armed around for sensors missing from them. Sensors
+     * that have never been read stay disarmed.
+     */
+    void arm(const NaturalistValues &values);
+    void disarm();
+
+    /**
+     * The WakeSource bits raised since the last call.
+     */
+    uint8_t triggered();
+
+private:
+    bool write(uint8_t address, uint8_t reg, const uint8_t *data, size_t size);
+
+};
+
+}
+
+#endif
+
+#endif
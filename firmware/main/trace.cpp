@@ -0,0 +1,294 @@
+#include <alogging/alogging.h>
+
+#include "trace.h"
+#include "varint.h"
+
+#if defined(FK_NATURALIST_TRACE_CAPTURE)
+#include <SerialFlash.h>
+#include "hardware.h"
+#endif
+
+namespace fk {
+
+constexpr const char Log[] = "Trace";
+
+using Logger = SimpleLog<Log>;
+
+static size_t trace_payload_size(TraceRecordType type) {
+    switch (type) {
+    case TraceRecordType::Cycle: return 4;
+    case TraceRecordType::Begin: return 2;
+    case TraceRecordType::Probe: return 3;
+    case TraceRecordType::Sht31: return 8;
+    case TraceRecordType::Mpl3115a2: return 12;
+    case TraceRecordType::Tsl2591: return 4;
+    case TraceRecordType::Bno055: return 16;
+    case TraceRecordType::Audio: return 4;
+    default: return 0;
+    }
+}
+
+void TraceWriter::begin(TraceSink *sink) {
+    sink_ = sink;
+    started_ = false;
+}
+
+bool TraceWriter::append(TraceRecordType type, uint32_t now, const void *payload, size_t size) {
+    if (sink_ == nullptr) {
+        return false;
+    }
+
+    if (!started_) {
+        uint8_t header[TraceHeaderSize];
+        memcpy(header, &TraceMagic, sizeof(TraceMagic));
+        header[4] = TraceVersion;
+        if (!sink_->write(header, sizeof(header))) {
+            return false;
+        }
+        previous_ = now;
+        started_ = true;
+    }
+
+    uint8_t buffer[TraceMaximumRecordSize];
+    auto position = (size_t)0;
+    buffer[position++] = (uint8_t)type;
+    position += varint_encode(buffer + position, now - previous_);
+    memcpy(buffer + position, payload, size);
+    position += size;
+
+    previous_ = now;
+
+    return sink_->write(buffer, position);
+}
+
+bool TraceWriter::values(uint32_t now, const NaturalistValues &values) {
+    uint8_t payload[sizeof(uint64_t) + NumberOfNaturalistChannels * sizeof(float)];
+    auto position = sizeof(uint64_t);
+    memcpy(payload, &values.valid, sizeof(uint64_t));
+    for (size_t i = 0; i < NumberOfNaturalistChannels; ++i) {
+        if (values.has(i)) {
+            memcpy(payload + position, &values.values[i], sizeof(float));
+            position += sizeof(float);
+        }
+    }
+    return append(TraceRecordType::Values, now, payload, position);
+}
+
+void TraceWriter::flush() {
+    if (sink_ != nullptr) {
+        sink_->flush();
+    }
+}
+
+bool TraceReader::header() {
+    if (size_ < TraceHeaderSize) {
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, buffer_, sizeof(magic));
+    if (magic != TraceMagic || buffer_[4] != TraceVersion) {
+        return false;
+    }
+    position_ = TraceHeaderSize;
+    return true;
+}
+
+bool TraceReader::read(TraceRecord &record) {
+    if (position_ >= size_) {
+        return false;
+    }
+
+    auto type = (TraceRecordType)buffer_[position_];
+    if (type == TraceRecordType::End) {
+        return false;
+    }
+
+    uint64_t delta = 0;
+    auto consumed = varint_decode(buffer_ + position_ + 1, size_ - position_ - 1, &delta);
+    if (consumed == 0) {
+        return false;
+    }
+
+    auto p = buffer_ + position_ + 1 + consumed;
+    auto remaining = size_ - position_ - 1 - consumed;
+
+    record = TraceRecord{};
+    record.type = type;
+
+    if (type == TraceRecordType::Values) {
+        if (remaining < sizeof(uint64_t)) {
+            return false;
+        }
+        uint64_t valid;
+        memcpy(&valid, p, sizeof(valid));
+        auto size = sizeof(uint64_t);
+        // Traces from builds with more channels than us are still readable.
+        for (size_t i = 0; i < 64; ++i) {
+            if (valid & ((uint64_t)1 << i)) {
+                if (size + sizeof(float) > remaining) {
+                    return false;
+                }
+                if (i < NumberOfNaturalistChannels) {
+                    float value;
+                    memcpy(&value, p + size, sizeof(float));
+                    record.values.set((NaturalistChannel)i, value);
+                }
+                size += sizeof(float);
+            }
+        }
+        position_ += 1 + consumed + size;
+    }
+    else {
+        auto size = trace_payload_size(type);
+        if (size == 0 || size > remaining) {
+            return false;
+        }
+        // The payload structs are laid out exactly as they're written.
+        memcpy(record.payload, p, size);
+        position_ += 1 + consumed + size;
+    }
+
+    time_ += delta;
+    record.time = time_;
+
+    return true;
+}
+
+#if defined(FK_NATURALIST_TRACE_CAPTURE)
+
+bool FlashTraceSink::begin() {
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS) || !flash_region(FlashRegion::Trace, region_)) {
+        Logger::info("Flash unavailable, not capturing.");
+        full_ = true;
+        return false;
+    }
+
+    address_ = region_.start;
+    erased_ = region_.start;
+
+    Logger::info("Capturing to 0x%lx (%lu bytes)", region_.start, region_.size);
+
+    return true;
+}
+
+bool FlashTraceSink::write(const uint8_t *data, size_t size) {
+    if (full_) {
+        return false;
+    }
+
+    while (size > 0) {
+        auto copying = std::min(size, sizeof(buffer_) - buffered_);
+        memcpy(buffer_ + buffered_, data, copying);
+        buffered_ += copying;
+        data += copying;
+        size -= copying;
+
+        if (buffered_ == sizeof(buffer_)) {
+            flush();
+        }
+    }
+
+    return !full_;
+}
+
+void FlashTraceSink::flush() {
+    if (buffered_ == 0 || full_) {
+        return;
+    }
+
+    if (address_ + buffered_ > region_.end()) {
+        Logger::info("Trace full.");
+        full_ = true;
+        return;
+    }
+
+    auto blockSize = SerialFlash.blockSize();
+    while (erased_ < address_ + buffered_) {
+        SerialFlash.eraseBlock(erased_);
+        erased_ += blockSize;
+    }
+
+    SerialFlash.write(address_, buffer_, buffered_);
+    address_ += buffered_;
+    buffered_ = 0;
+}
+
+void FlashTraceSink::dump() {
+    FlashExtent region;
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS) || !flash_region(FlashRegion::Trace, region)) {
+        return;
+    }
+
+    uint8_t buffer[32];
+    char line[sizeof(buffer) * 2 + 1];
+    for (uint32_t offset = 0; offset < region.size; offset += sizeof(buffer)) {
+        SerialFlash.read(region.start + offset, buffer, sizeof(buffer));
+
+        auto erased = true;
+        for (size_t i = 0; i < sizeof(buffer); ++i) {
+            snprintf(line + i * 2, 3, "%02x", buffer[i]);
+            erased = erased && buffer[i] == 0xff;
+        }
+        if (erased) {
+            break;
+        }
+
+        Logger::info("dump %08lx %s", offset, line);
+    }
+}
+
+void NaturalistTrace::begin() {
+    #if defined(FK_NATURALIST_TRACE_DUMP)
+    sink_.dump();
+    #endif
+    sink_.begin();
+    writer_.begin(&sink_);
+}
+
+void NaturalistTrace::cycle(uint32_t time) {
+    writer_.append(TraceRecordType::Cycle, micros(), &time, sizeof(time));
+}
+
+void NaturalistTrace::begin(uint8_t sensor, bool ok) {
+    uint8_t payload[] = { sensor, ok };
+    writer_.append(TraceRecordType::Begin, micros(), payload, sizeof(payload));
+}
+
+void NaturalistTrace::probe(uint8_t bus, uint8_t address, bool ack) {
+    uint8_t payload[] = { bus, address, ack };
+    writer_.append(TraceRecordType::Probe, micros(), payload, sizeof(payload));
+}
+
+void NaturalistTrace::sht31(float temperature, float humidity) {
+    float payload[] = { temperature, humidity };
+    writer_.append(TraceRecordType::Sht31, micros(), payload, sizeof(payload));
+}
+
+void NaturalistTrace::mpl3115a2(float pressure, float altitude, float temperature) {
+    float payload[] = { pressure, altitude, temperature };
+    writer_.append(TraceRecordType::Mpl3115a2, micros(), payload, sizeof(payload));
+}
+
+void NaturalistTrace::tsl2591(uint32_t fullLuminosity) {
+    writer_.append(TraceRecordType::Tsl2591, micros(), &fullLuminosity, sizeof(fullLuminosity));
+}
+
+void NaturalistTrace::bno055(const uint8_t *calibration, const float *orientation) {
+    uint8_t payload[16];
+    memcpy(payload, calibration, 4);
+    memcpy(payload + 4, orientation, 12);
+    writer_.append(TraceRecordType::Bno055, micros(), payload, sizeof(payload));
+}
+
+void NaturalistTrace::audio(float amplitude) {
+    writer_.append(TraceRecordType::Audio, micros(), &amplitude, sizeof(amplitude));
+}
+
+void NaturalistTrace::values(const NaturalistValues &values) {
+    writer_.values(micros(), values);
+    writer_.flush();
+}
+
+#endif
+
+}
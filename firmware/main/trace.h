@@ -0,0 +1,186 @@
+#ifndef FK_NATURALIST_TRACE_H_INCLUDED
+#define FK_NATURALIST_TRACE_H_INCLUDED
+
+#include <Arduino.h>
+
+#include "channels.h"
+#include "flash_layout.h"
+
+namespace fk {
+
+/**
+ * A trace is a header followed by records of the form:
+ *
+ *   [type:u8] [microseconds since previous record:varint] [payload]
+ *
+ * Payloads are fixed size for each type and little endian. Erased flash
+ * reads as 0xff, which ends the trace.
+ */
+enum class TraceRecordType : uint8_t {
+    Cycle = 1,
+    Begin,
+    Probe,
+    Sht31,
+    Mpl3115a2,
+    Tsl2591,
+    Bno055,
+    Audio,
+    Values,
+    End = 0xff,
+};
+
+constexpr uint32_t TraceMagic = 0x52544b46; // "FKTR"
+constexpr uint8_t TraceVersion = 1;
+constexpr size_t TraceHeaderSize = 5;
+constexpr size_t TraceMaximumRecordSize = 1 + 10 + 8 + NumberOfNaturalistChannels * sizeof(float);
+
+struct TraceRecord {
+    TraceRecordType type;
+    /* Microseconds since the start of the trace. */
+    uint64_t time;
+    union {
+        uint8_t payload[16];
+        struct {
+            uint32_t time;
+        } cycle;
+        struct {
+            uint8_t sensor;
+            uint8_t ok;
+        } begin;
+        struct {
+            uint8_t bus;
+            uint8_t address;
+            uint8_t ack;
+        } probe;
+        struct {
+            float temperature;
+            float humidity;
+        } sht31;
+        struct {
+            float pressure;
+            float altitude;
+            float temperature;
+        } mpl3115a2;
+        struct {
+            uint32_t fullLuminosity;
+        } tsl2591;
+        struct {
+            uint8_t calibration[4];
+            float orientation[3];
+        } bno055;
+        struct {
+            float amplitude;
+        } audio;
+        NaturalistValues values;
+    };
+
+    TraceRecord() : type(TraceRecordType::End), time(0), values() {
+    }
+};
+
+class TraceSink {
+public:
+    virtual bool write(const uint8_t *data, size_t size) = 0;
+    virtual void flush() = 0;
+
+};
+
+class TraceWriter {
+private:
+    TraceSink *sink_{ nullptr };
+    uint32_t previous_{ 0 };
+    bool started_{ false };
+
+public:
+    void begin(TraceSink *sink);
+    bool append(TraceRecordType type, uint32_t now, const void *payload, size_t size);
+    bool values(uint32_t now, const NaturalistValues &values);
+    void flush();
+
+};
+
+class TraceReader {
+private:
+    const uint8_t *buffer_;
+    size_t size_;
+    size_t position_{ 0 };
+    uint64_t time_{ 0 };
+
+public:
+    TraceReader(const uint8_t *buffer, size_t size) : buffer_(buffer), size_(size) {
+    }
+
+public:
+    bool header();
+    bool read(TraceRecord &record);
+
+};
+
+#if defined(FK_NATURALIST_TRACE_CAPTURE)
+
+/**
+ * Appends to the Trace region of the SerialFlash, erasing a block at a time
+ * as the trace reaches it. Capture stops when the region is full.
+ */
+class FlashTraceSink : public TraceSink {
+private:
+    uint8_t buffer_[128];
+    size_t buffered_{ 0 };
+    FlashExtent region_;
+    uint32_t address_{ 0 };
+    uint32_t erased_{ 0 };
+    bool full_{ false };
+
+public:
+    bool begin();
+    bool write(const uint8_t *data, size_t size) override;
+    void flush() override;
+    void dump();
+
+};
+
+/**
+ * Records the results of every driver call made by NaturalistReadings, along
+ * with the values we merged, so a host can replay them.
+ */
+class NaturalistTrace {
+private:
+    FlashTraceSink sink_;
+    TraceWriter writer_;
+
+public:
+    void begin();
+    void cycle(uint32_t time);
+    void begin(uint8_t sensor, bool ok);
+    void probe(uint8_t bus, uint8_t address, bool ack);
+    void sht31(float temperature, float humidity);
+    void mpl3115a2(float pressure, float altitude, float temperature);
+    void tsl2591(uint32_t fullLuminosity);
+    void bno055(const uint8_t *calibration, const float *orientation);
+    void audio(float amplitude);
+    void values(const NaturalistValues &values);
+
+};
+
+#else
+
+class NaturalistTrace {
+public:
+    void begin() { }
+    void cycle(uint32_t time) { }
+    void begin(uint8_t sensor, bool ok) { }
+    void probe(uint8_t bus, uint8_t address, bool ack) { }
+    void sht31(float temperature, float humidity) { }
+    void mpl3115a2(float pressure, float altitude, float temperature) { }
+    void tsl2591(uint32_t fullLuminosity) { }
+    void bno055(const uint8_t *calibration, const float *orientation) { }
+    void audio(float amplitude) { }
+    void values(const NaturalistValues &values) { }
+
+};
+
+#endif
+
+}
+
+#endif
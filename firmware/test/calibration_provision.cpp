@@ -0,0 +1,41 @@
+#include <initializer_list>
+
+#include <alogging/alogging.h>
+
+#include "calibration_provision.h"
+
+#if defined(FK_NATURALIST_PROVISION)
+
+#include "calibration_table.h"
+
+namespace fk {
+
+constexpr const char LogName[] = "Provision";
+
+using Log = SimpleLog<LogName>;
+
+bool CalibrationProvision::run() {
+    // An initializer list, so the table can be empty.
+    std::initializer_list<CalibrationEntry> table = { FK_CALIBRATION_TABLE };
+
+    if (!Calibration::write(table.begin(), table.size())) {
+        Log::info("Writing %lu entries failed.", (uint32_t)table.size());
+        return false;
+    }
+
+    written_ = table.size();
+
+    Calibration calibration;
+    calibration.begin();
+    ours_ = calibration.size();
+
+    auto id = calibration.id();
+    Log::info("Wrote %lu entries, %lu for %02x%02x%02x%02x%02x%02x%02x%02x", (uint32_t)written_, (uint32_t)ours_,
+              id[0], id[1], id[2], id[3], id[4], id[5], id[6], id[7]);
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CALIBRATION_PROVISION_H_INCLUDED
+#define CALIBRATION_PROVISION_H_INCLUDED
+
+#if defined(FK_NATURALIST_PROVISION)
+
+#if !defined(FK_NATURALIST_CALIBRATION)
+#error "FK_NATURALIST_PROVISION writes the calibration table, see FK_NATURALIST_CALIBRATION."
+#endif
+
+#include "calibration.h"
+
+namespace fk {
+
+/**
+ * Replaces the calibration table on the SerialFlash with the one in
+ * calibration_table.h, then loads it back as the standard firmware will at
+ * boot. The check firmware is flashed first, so this is how a batch's
+ * tables get onto their devices.
+ */
+class CalibrationProvision {
+private:
+    size_t written_{ 0 };
+    size_t ours_{ 0 };
+
+public:
+    bool run();
+
+    /* Entries in the table, and those that are this device's. */
+    size_t written() const {
+        return written_;
+    }
+
+    size_t ours() const {
+        return ours_;
+    }
+
+};
+
+}
+
+#endif
+
+#endif
@@ -1,5 +1,8 @@
 #include "check_core.h"
 #include "board_definition.h"
+#include "flash_parts.h"
+#include "mac_eeprom.h"
+#include "sd_benchmark.h"
 #include "config.h"
 
 #include <RH_RF95.h>
@@ -10,30 +13,6 @@ constexpr const char LogName[] = "Check";
 
 using Log = SimpleLog<LogName>;
 
-class MacEeprom {
-private:
-    uint8_t address;
-
-public:
-    MacEeprom() : address(0x50) {
-    }
-
-public:
-    bool read128bMac(uint8_t *id) {
-        Wire.beginTransmission(address);
-        Wire.write(0xf8);
-        Wire.endTransmission();
-        Wire.requestFrom(address, 8);
-
-        uint8_t index = 0;
-        while (Wire.available()){
-            id[index++] = Wire.read();
-        }
-
-        return true;
-    }
-};
-
 void CheckCore::setup() {
     #ifdef PIN_LED_RXL
     Log::info("Please undefine PIN_LED_RXL in variant.h.");
@@ -58,36 +37,41 @@ void CheckCore::setup() {
     delay(100);
 }
 
-bool CheckCore::fuelGauge() {
-    Log::info("Checking gauge...");
+CheckStatus GaugeCheck::task() {
+    if (tries_ == 0 && next_ == 0) {
+        Log::info("Checking gauge...");
 
-    BatteryGauge gauge;
+        if (!gauge_.available()) {
+            Log::info("Gauge FAILED (MISSING)");
+            return CheckStatus::Failed;
+        }
+    }
 
-    if (!gauge.available()) {
-        Log::info("Gauge FAILED (MISSING)");
-        return false;
+    if (millis() < next_) {
+        return CheckStatus::Running;
     }
 
-    for (auto i = 0; i < 10; ++i) {
-        auto reading = gauge_.read();
+    auto reading = gauge_.read();
 
-        Log::info("Battery: v=%fmv i=%fmA cc=%fmAh (%fmAh) c=%d",
-                  reading.voltage, reading.ma, reading.coulombs,
-                  reading.coulombs - previous_, reading.counter);
+    Log::info("Battery: v=%fmv i=%fmA cc=%fmAh c=%d",
+              reading.voltage, reading.ma, reading.coulombs, reading.counter);
 
-        if (reading.voltage > 2500.0f) {
-            Log::info("Gauge PASSED");
-            return true;
-        }
+    if (reading.voltage > 2500.0f) {
+        Log::info("Gauge PASSED");
+        return CheckStatus::Passed;
+    }
 
-        delay(500);
+    if (++tries_ == MaximumTries) {
+        Log::info("Gauge FAILED (VOLTAGE)");
+        return CheckStatus::Failed;
     }
 
-    Log::info("Gauge FAILED (VOLTAGE)");
-    return false;
+    next_ = millis() + RetryInterval;
+
+    return CheckStatus::Running;
 }
 
-bool CheckCore::flashMemory() {
+bool FlashCheck::identify() {
     Log::info("Checking flash memory...");
 
     if (!SerialFlash.begin(Hardware::FLASH_PIN_CS)) {
@@ -109,71 +93,73 @@ bool CheckCore::flashMemory() {
         return false;
     }
 
-    auto blockSize = SerialFlash.blockSize();
+    blockSize_ = SerialFlash.blockSize();
 
     Log::info("Read Chip Identification:");
     Log::info("  JEDEC ID:     %x %x %x", buffer[0], buffer[1], buffer[2]);
-    Log::info("  Part Nummber: %s", id2chip(buffer));
-    Log::info("  Memory Size:  %lu bytes Block Size: %lu bytes", chipSize, blockSize);
+    Log::info("  Part Nummber: %s", flash_part_name(buffer));
+    Log::info("  Memory Size:  %lu bytes Block Size: %lu bytes", chipSize, blockSize_);
     Log::info("Flash memory PASSED");
 
-    if (chipSize > 0) {
-        if (false) {
-            Log::info("Erasing ALL Flash Memory (%lu)", chipSize);
-
-            SerialFlash.eraseAll();
+    return true;
+}
 
-            auto started = millis();
-            while (SerialFlash.ready() == false) {
-                if (millis() - started > 1000) {
-                    started = millis();
-                }
-            }
-        }
-        else {
-            for (auto i = 0; i < 10; ++i) {
-                Log::info("Erasing block %d (%lu)", i, i * blockSize);
-                SerialFlash.eraseBlock(i * blockSize);
-            }
+CheckStatus FlashCheck::task() {
+    if (!identified_) {
+        if (!identify()) {
+            return CheckStatus::Failed;
         }
+        identified_ = true;
+        return CheckStatus::Running;
+    }
 
-        Log::info("Erase completed");
+    // The chip erases on its own, we only need the bus to start each one.
+    if (!SerialFlash.ready()) {
+        return CheckStatus::Running;
     }
 
-    return true;
-}
+    if (erased_ < NumberOfBlocks) {
+        Log::info("Erasing block %d (%lu)", erased_, erased_ * blockSize_);
+        SerialFlash.eraseBlock(erased_ * blockSize_);
+        erased_++;
+        return CheckStatus::Running;
+    }
 
-bool CheckCore::gps() {
-    Log::info("Checking gps...");
+    Log::info("Erase completed");
 
-    Uart& gpsSerial = Serial2;
-    SerialPort gpsPort{ gpsSerial };
-    gpsPort.begin(9600);
+    return CheckStatus::Passed;
+}
 
-    uint32_t charactersRead = 0;
-    uint32_t start = millis();
-    while (millis() - start < 5 * 1000 && charactersRead < 100)  {
-        while (gpsSerial.available()) {
-            Serial.print((char)gpsSerial.read());
-            charactersRead++;
-        }
+CheckStatus GpsCheck::task() {
+    if (!listening_) {
+        Log::info("Checking gps...");
+        port_.begin(9600);
+        listening_ = true;
     }
 
-    if (Serial) {
-        Serial.println();
+    auto &gpsSerial = Serial2;
+    while (gpsSerial.available()) {
+        auto c = (char)gpsSerial.read();
+        if (charactersRead_ < RequiredCharacters) {
+            received_[charactersRead_] = c;
+        }
+        charactersRead_++;
     }
-    else {
-        Serial5.println();
+
+    if (charactersRead_ >= RequiredCharacters) {
+        // Logged in one go so other checks can't break it up.
+        received_[RequiredCharacters] = 0;
+        Log::info("GPS: %s", received_);
+        Log::info("GPS PASSED");
+        return CheckStatus::Passed;
     }
 
-    if (charactersRead < 100) {
+    if (millis() - started() >= ListenTime) {
         Log::info("GPS FAILED");
-        return false;
+        return CheckStatus::Failed;
     }
 
-    Log::info("GPS PASSED");
-
-    return true;
+    return CheckStatus::Running;
 }
 
 bool CheckCore::sdCard() {
@@ -191,6 +177,15 @@ bool CheckCore::sdCard() {
         return false;
     }
 
+    #if defined(FK_NATURALIST_SD_BENCHMARK)
+    SdBenchmark benchmark;
+    if (!benchmark.run(storage)) {
+        digitalWrite(Hardware::SD_PIN_CS, HIGH);
+        Log::info("SD FAILED (below performance floor)");
+        return false;
+    }
+    #endif
+
     digitalWrite(Hardware::SD_PIN_CS, HIGH);
     Log::info("SD PASSED");
 
@@ -213,47 +208,58 @@ bool CheckCore::radio() {
     return true;
 }
 
-bool CheckCore::wifi() {
-    Log::info("Checking wifi...");
-
-    // TODO: Move this into CoreBoard?
-    WiFi.setPins(Hardware::WIFI_PIN_CS, Hardware::WIFI_PIN_IRQ, Hardware::WIFI_PIN_RST);
-
-    if (WiFi.status() == WL_NO_SHIELD) {
-        Log::info("Wifi FAILED");
-        return false;
-    }
+CheckStatus WifiCheck::task() {
+    switch (phase_) {
+    case Phase::Module: {
+        Log::info("Checking wifi...");
 
-    Log::info("Wifi firmware version: ");
-    auto fv = WiFi.firmwareVersion();
-    Log::info("Version: %s", fv);
-    Log::info("Wifi PASSED");
+        // TODO: Move this into CoreBoard?
+        WiFi.setPins(Hardware::WIFI_PIN_CS, Hardware::WIFI_PIN_IRQ, Hardware::WIFI_PIN_RST);
 
-    #if defined(FK_CONFIG_WIFI_1_SSID) && defined(FK_CONFIG_WIFI_1_PASSWORD)
-    Log::info("Connecting to %s", FK_CONFIG_WIFI_1_SSID);
-    if (WiFi.begin(FK_CONFIG_WIFI_1_SSID, FK_CONFIG_WIFI_1_PASSWORD) != WL_CONNECTED) {
-        Log::info("Connection failed!");
-        return false;
-    }
-    Log::info("Connected. Syncing time, check for a battery!");
+        if (WiFi.status() == WL_NO_SHIELD) {
+            Log::info("Wifi FAILED");
+            return CheckStatus::Failed;
+        }
 
-    clock.begin();
+        Log::info("Wifi firmware version: ");
+        auto fv = WiFi.firmwareVersion();
+        Log::info("Version: %s", fv);
+        Log::info("Wifi PASSED");
+
+        #if defined(FK_CONFIG_WIFI_1_SSID) && defined(FK_CONFIG_WIFI_1_PASSWORD)
+        phase_ = Phase::Connect;
+        return CheckStatus::Running;
+        #else
+        Log::info("Skipping connection test, no config.");
+        return CheckStatus::Passed;
+        #endif
+    }
+    case Phase::Connect: {
+        #if defined(FK_CONFIG_WIFI_1_SSID) && defined(FK_CONFIG_WIFI_1_PASSWORD)
+        Log::info("Connecting to %s", FK_CONFIG_WIFI_1_SSID);
+        if (WiFi.begin(FK_CONFIG_WIFI_1_SSID, FK_CONFIG_WIFI_1_PASSWORD) != WL_CONNECTED) {
+            Log::info("Connection failed!");
+            return CheckStatus::Failed;
+        }
+        Log::info("Connected. Syncing time, check for a battery!");
+        #endif
 
-    SimpleNTP ntp(clock);
+        clock.begin();
 
-    ntp.enqueued();
+        ntp_.enqueued();
 
-    while (true) {
-        if (!simple_task_run(ntp)) {
-            break;
+        phase_ = Phase::Sync;
+        return CheckStatus::Running;
+    }
+    case Phase::Sync: {
+        if (simple_task_run(ntp_)) {
+            return CheckStatus::Running;
         }
+        return CheckStatus::Passed;
+    }
     }
 
-    #else
-    Log::info("Skipping connection test, no config.");
-    #endif
-
-    return true;
+    return CheckStatus::Failed;
 }
 
 bool CheckCore::rtc() {
@@ -285,6 +291,31 @@ bool CheckCore::macEeprom() {
     return success;
 }
 
+void CheckCore::checks(CheckRunner &runner) {
+    // Slow checks that mostly wait go first, so they're under way before the
+    // blocking ones start.
+    runner.add(gpsCheck_);
+    runner.add(flashCheck_);
+    #if defined(FK_ENABLE_FUEL_GAUGE)
+    runner.add(gaugeCheck_);
+    #else
+    Log::info("Fuel gauge disabled.");
+    #endif
+    runner.add(macEepromCheck_);
+    runner.add(rtcCheck_);
+    #if defined(FK_ENABLE_RADIO)
+    runner.add(radioCheck_);
+    #else
+    Log::info("Radio disabled");
+    #endif
+    runner.add(sdCardCheck_);
+    // Associating blocks for seconds, long enough to overflow the GPS UART
+    // and to leave the flash idle between erases.
+    wifiCheck_.after(gpsCheck_);
+    wifiCheck_.after(flashCheck_);
+    runner.add(wifiCheck_);
+}
+
 bool CheckCore::check() {
     auto have_gauge = false;
     auto have_sd = false;
@@ -293,40 +324,35 @@ bool CheckCore::check() {
     caution_ = false;
     sampling_ = true;
 
+    CheckRunner runner;
+    checks(runner);
+    runner.run(leds_);
+    runner.log();
+
     #if defined(FK_ENABLE_FUEL_GAUGE)
-    if (!fuelGauge()) {
+    if (!gaugeCheck_.passed()) {
         have_gauge = false;
         success_ = false;
         sampling_ = false;
     }
-    #else
-    Log::info("Fuel gauge disabled.");
     #endif
-    success_ = macEeprom() && success_;
-    success_ = rtc() && success_;
-    success_ = flashMemory() && success_;
+    success_ = macEepromCheck_.passed() && success_;
+    success_ = rtcCheck_.passed() && success_;
+    success_ = flashCheck_.passed() && success_;
 
     if (success_) {
         Log::info("Top PASSED");
-        leds().notifyCaution();
-        leds().task();
-    }
-    else {
-        leds().notifyFatal();
-        leds().task();
     }
 
     #if defined(FK_ENABLE_RADIO)
-    success_ = radio() && success_;
-    #else
-    Log::info("Radio disabled");
+    success_ = radioCheck_.passed() && success_;
     #endif
-    success_ = gps() && success_;
-    if (!sdCard()) {
+    success_ = gpsCheck_.passed() && success_;
+    if (!sdCardCheck_.passed()) {
         have_sd = false;
         success_ = false;
     }
-    success_ = wifi() && success_;
+    success_ = wifiCheck_.passed() && success_;
 
     leds().off();
 
@@ -394,63 +420,4 @@ void CheckCore::sample() {
     previous_ = reading.coulombs;
 }
 
-const char *CheckCore::id2chip(const unsigned char *id) {
-    if (id[0] == 0xEF) {
-        // Winbond
-        if (id[1] == 0x40) {
-            if (id[2] == 0x14) return "W25Q80BV";
-            if (id[2] == 0x15) return "W25Q16DV";
-            if (id[2] == 0x17) return "W25Q64FV";
-            if (id[2] == 0x18) return "W25Q128FV";
-            if (id[2] == 0x19) return "W25Q256FV";
-        }
-    }
-    if (id[0] == 0x01) {
-        // Spansion
-        if (id[1] == 0x02) {
-            if (id[2] == 0x16) return "S25FL064A";
-            if (id[2] == 0x19) return "S25FL256S";
-            if (id[2] == 0x20) return "S25FL512S";
-        }
-        if (id[1] == 0x20) {
-            if (id[2] == 0x18) return "S25FL127S";
-        }
-        if (id[1] == 0x40) {
-            if (id[2] == 0x15) return "S25FL116K";
-        }
-    }
-    if (id[0] == 0xC2) {
-        // Macronix
-        if (id[1] == 0x20) {
-            if (id[2] == 0x18) return "MX25L12805D";
-        }
-    }
-    if (id[0] == 0x20) {
-        // Micron
-        if (id[1] == 0xBA) {
-            if (id[2] == 0x20) return "N25Q512A";
-            if (id[2] == 0x21) return "N25Q00AA";
-        }
-        if (id[1] == 0xBB) {
-            if (id[2] == 0x22) return "MT25QL02GC";
-        }
-    }
-    if (id[0] == 0xBF) {
-        // SST
-        if (id[1] == 0x25) {
-            if (id[2] == 0x02) return "SST25WF010";
-            if (id[2] == 0x03) return "SST25WF020";
-            if (id[2] == 0x04) return "SST25WF040";
-            if (id[2] == 0x41) return "SST25VF016B";
-            if (id[2] == 0x4A) return "SST25VF032";
-        }
-        if (id[1] == 0x25) {
-            if (id[2] == 0x01) return "SST26VF016";
-            if (id[2] == 0x02) return "SST26VF032";
-            if (id[2] == 0x43) return "SST26VF064";
-        }
-    }
-    return "(unknown chip)";
-}
-
 }
@@ -4,12 +4,110 @@
 #include <fk-core.h>
 #include <battery_gauge.h>
 
+#include "check_runner.h"
+
 namespace fk {
 
+class GaugeCheck : public CheckTask {
+public:
+    static constexpr uint8_t MaximumTries = 10;
+    static constexpr uint32_t RetryInterval = 500;
+
+private:
+    BatteryGauge gauge_;
+    uint8_t tries_{ 0 };
+    uint32_t next_{ 0 };
+
+public:
+    const char *name() const override {
+        return "gauge";
+    }
+
+    CheckStatus task() override;
+
+};
+
+class FlashCheck : public CheckTask {
+public:
+    static constexpr uint8_t NumberOfBlocks = 10;
+
+private:
+    uint32_t blockSize_{ 0 };
+    uint8_t erased_{ 0 };
+    bool identified_{ false };
+
+public:
+    const char *name() const override {
+        return "flash";
+    }
+
+    uint32_t timeout() const override {
+        return 60 * 1000;
+    }
+
+    CheckStatus task() override;
+
+private:
+    bool identify();
+
+};
+
+class GpsCheck : public CheckTask {
+public:
+    static constexpr uint32_t ListenTime = 5 * 1000;
+    static constexpr uint32_t RequiredCharacters = 100;
+
+private:
+    SerialPort port_{ Serial2 };
+    char received_[RequiredCharacters + 1];
+    uint32_t charactersRead_{ 0 };
+    bool listening_{ false };
+
+public:
+    const char *name() const override {
+        return "gps";
+    }
+
+    CheckStatus task() override;
+
+};
+
+class WifiCheck : public CheckTask {
+private:
+    enum class Phase {
+        Module,
+        Connect,
+        Sync,
+    };
+
+    Phase phase_{ Phase::Module };
+    SimpleNTP ntp_{ clock };
+
+public:
+    const char *name() const override {
+        return "wifi";
+    }
+
+    uint32_t timeout() const override {
+        return 2 * 60 * 1000;
+    }
+
+    CheckStatus task() override;
+
+};
+
 class CheckCore {
 private:
     Leds leds_;
     BatteryGauge gauge_;
+    GaugeCheck gaugeCheck_;
+    FlashCheck flashCheck_;
+    GpsCheck gpsCheck_;
+    WifiCheck wifiCheck_;
+    BlockingCheck<CheckCore> macEepromCheck_{ "mac", this, &CheckCore::macEeprom };
+    BlockingCheck<CheckCore> rtcCheck_{ "rtc", this, &CheckCore::rtc };
+    BlockingCheck<CheckCore> radioCheck_{ "radio", this, &CheckCore::radio };
+    BlockingCheck<CheckCore> sdCardCheck_{ "sd", this, &CheckCore::sdCard };
     uint32_t checked_{ 0 };
     uint32_t toggled_{ 0 };
     float previous_{ 0.0f };
@@ -41,25 +139,25 @@ public:
 
 public:
     void setup();
-    bool fuelGauge();
-    bool flashMemory();
-    bool gps();
     bool sdCard();
     bool radio();
-    bool wifi();
     bool rtc();
     bool macEeprom();
 
 public:
     virtual bool check();
+
+    /**
+     * Adds the checks to run alongside each other, subclasses add theirs and
+     * then call this.
+     */
+    virtual void checks(CheckRunner &runner);
     virtual void task();
     virtual void sample();
 
-private:
-    const char *id2chip(const unsigned char *id);
-
 };
 
+
 }
 
 #endif
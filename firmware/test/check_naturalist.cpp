@@ -14,29 +14,30 @@ bool CheckNaturalist::check() {
     Wire.begin();
     Wire4and3.begin();
 
-    if (!mpl3115a2()) {
+    // The sensors are checked alongside the core, see checks().
+    if (!CheckCore::check()) {
         success = false;
+        leds().notifyFatal();
     }
-    if (!tsl2591()) {
+
+    if (!mpl3115a2Check_.passed()) {
         success = false;
     }
-    if (!sht31()) {
+    if (!tsl2591Check_.passed()) {
         success = false;
     }
-    if (!sph0645()) {
+    if (!sht31Check_.passed()) {
         success = false;
     }
-
-    #if defined(FK_ENABLE_BNO05)
-    if (!bno055()) {
+    if (!sph0645Check_.passed()) {
         success = false;
     }
-    #endif
 
-    if (!CheckCore::check()) {
+    #if defined(FK_ENABLE_BNO05)
+    if (!bno055Check_.passed()) {
         success = false;
-        leds().notifyFatal();
     }
+    #endif
 
     Log::info("test: SUCCESS (Naturalist)");
 
@@ -45,6 +46,18 @@ bool CheckNaturalist::check() {
     return success;
 }
 
+void CheckNaturalist::checks(CheckRunner &runner) {
+    CheckCore::checks(runner);
+
+    runner.add(mpl3115a2Check_);
+    runner.add(tsl2591Check_);
+    runner.add(sht31Check_);
+    runner.add(sph0645Check_);
+    #if defined(FK_ENABLE_BNO05)
+    runner.add(bno055Check_);
+    #endif
+}
+
 bool CheckNaturalist::sht31() {
     if (!sht31Sensor_.begin()) {
         Log::info("SHT31 FAILED");
@@ -141,10 +154,10 @@ void CheckNaturalist::sample() {
 
         #if defined(FK_ENABLE_BNO05)
         uint8_t system = 0, gyro = 0, accel = 0, mag = 0;
-        bnoSensor.getCalibration(&system, &gyro, &accel, &mag);
+        bnoSensor_.getCalibration(&system, &gyro, &accel, &mag);
 
         sensors_event_t event;
-        bnoSensor.getEvent(&event);
+        bnoSensor_.getEvent(&event);
 
         Log::info("sensors: cal(%d, %d, %d, %d) xyz(%f, %f, %f)", system, gyro, accel, mag, event.orientation.x, event.orientation.y, event.orientation.z);
         #endif
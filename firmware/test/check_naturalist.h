@@ -20,6 +20,11 @@ private:
     Adafruit_TSL2591 tsl2591Sensor_{ 2591 };
     Adafruit_MPL3115A2 mpl3115a2Sensor_;
     Adafruit_SHT31 sht31Sensor_;
+    BlockingCheck<CheckNaturalist> mpl3115a2Check_{ "mpl3115a2", this, &CheckNaturalist::mpl3115a2 };
+    BlockingCheck<CheckNaturalist> tsl2591Check_{ "tsl2591", this, &CheckNaturalist::tsl2591 };
+    BlockingCheck<CheckNaturalist> sht31Check_{ "sht31", this, &CheckNaturalist::sht31 };
+    BlockingCheck<CheckNaturalist> sph0645Check_{ "sph0645", this, &CheckNaturalist::sph0645 };
+    BlockingCheck<CheckNaturalist> bno055Check_{ "bno055", this, &CheckNaturalist::bno055 };
 
 public:
     bool sht31();
@@ -30,6 +35,7 @@ public:
 
 public:
     bool check() override;
+    void checks(CheckRunner &runner) override;
     void sample() override;
 
 public:
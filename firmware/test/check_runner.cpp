@@ -0,0 +1,97 @@
+#include "check_runner.h"
+
+namespace fk {
+
+constexpr const char LogName[] = "Check";
+
+using Log = SimpleLog<LogName>;
+
+const char *check_status_name(CheckStatus status) {
+    switch (status) {
+    case CheckStatus::Waiting: return "WAITING";
+    case CheckStatus::Running: return "RUNNING";
+    case CheckStatus::Passed: return "PASSED";
+    case CheckStatus::Failed: return "FAILED";
+    case CheckStatus::TimedOut: return "TIMEOUT";
+    default: return "UNKNOWN";
+    }
+}
+
+bool CheckRunner::add(CheckTask &check) {
+    if (size_ == MaximumChecks) {
+        Log::info("Too many checks, skipping %s", check.name());
+        return false;
+    }
+    checks_[size_++] = &check;
+    return true;
+}
+
+void CheckRunner::run(Leds &leds) {
+    started_ = millis();
+
+    while (true) {
+        auto running = false;
+        auto blocked = false;
+
+        for (size_t i = 0; i < size_; ++i) {
+            auto &check = *checks_[i];
+            if (check.finished()) {
+                continue;
+            }
+
+            if (check.blocking() && blocked) {
+                running = true;
+                continue;
+            }
+
+            if (check.status_ == CheckStatus::Waiting) {
+                if (!check.ready()) {
+                    running = true;
+                    continue;
+                }
+                check.started_ = millis();
+                check.status_ = CheckStatus::Running;
+            }
+
+            auto status = check.task();
+            blocked = blocked || check.blocking();
+            check.elapsed_ = millis() - check.started_;
+
+            // A blocking check can only be caught once it returns, but one
+            // that took too long to pass hasn't passed.
+            if ((status == CheckStatus::Running || status == CheckStatus::Passed) && check.elapsed_ > check.timeout()) {
+                Log::info("%s TIMEOUT after %lums", check.name(), check.elapsed_);
+                status = CheckStatus::TimedOut;
+            }
+
+            check.status_ = status;
+
+            if (!check.finished()) {
+                running = true;
+            }
+        }
+
+        leds.task();
+
+        if (!running) {
+            break;
+        }
+    }
+
+    elapsed_ = millis() - started_;
+}
+
+void CheckRunner::log() const {
+    uint32_t total = 0;
+
+    Log::info("Checks (ms):");
+    for (size_t i = 0; i < size_; ++i) {
+        auto &check = *checks_[i];
+        Log::info("  %-10s %-8s start=%-6lu took=%lu", check.name(), check_status_name(check.status()),
+                  check.started() - started_, check.elapsed());
+        total += check.elapsed();
+    }
+    Log::info("  took %lums, checks sum to %lums", elapsed_, total);
+}
+
+}
@@ -0,0 +1,161 @@
+#ifndef CHECK_RUNNER_H_INCLUDED
+#define CHECK_RUNNER_H_INCLUDED
+
+#include <fk-core.h>
+
+namespace fk {
+
+enum class CheckStatus : uint8_t {
+    Waiting,
+    Running,
+    Passed,
+    Failed,
+    TimedOut,
+};
+
+const char *check_status_name(CheckStatus status);
+
+/**
+ * A check that can be polled. task() should do a bounded amount of work,
+ * typically one bus transaction or one step of a longer operation, and
+ * return Running while there's more to do. Transactions are never split
+ * between two polls, so checks on the same bus interleave safely.
+ */
+class CheckTask {
+public:
+    static constexpr size_t MaximumPrerequisites = 2;
+
+private:
+    CheckStatus status_{ CheckStatus::Waiting };
+    CheckTask *after_[MaximumPrerequisites] = { nullptr };
+    uint32_t started_{ 0 };
+    uint32_t elapsed_{ 0 };
+
+public:
+    virtual const char *name() const = 0;
+
+    /**
+     * Past this a check is TimedOut, even a blocking one that went on to
+     * pass. Nothing can stop one that blocks, it's only marked once it
+     * returns.
+     */
+    virtual uint32_t timeout() const {
+        return 10 * 1000;
+    }
+
+    virtual CheckStatus task() = 0;
+
+    /**
+     * Checks that hold the CPU for a while run one per pass, so the others
+     * are polled between them.
+     */
+    virtual bool blocking() const {
+        return false;
+    }
+
+public:
+    /**
+     * Holds this check back until another has finished, for checks that
+     * would starve it by blocking for a long time.
+     */
+    bool after(CheckTask &check) {
+        for (auto &p : after_) {
+            if (p == nullptr) {
+                p = &check;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ready() const {
+        for (auto p : after_) {
+            if (p != nullptr && !p->finished()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    CheckStatus status() const {
+        return status_;
+    }
+
+    bool passed() const {
+        return status_ == CheckStatus::Passed;
+    }
+
+    bool finished() const {
+        return status_ != CheckStatus::Waiting && status_ != CheckStatus::Running;
+    }
+
+    uint32_t started() const {
+        return started_;
+    }
+
+    uint32_t elapsed() const {
+        return elapsed_;
+    }
+
+    friend class CheckRunner;
+
+};
+
+/**
+ * Wraps one of the existing blocking checks, which finishes on its first
+ * poll.
+ */
+template<typename T>
+class BlockingCheck : public CheckTask {
+public:
+    using Check = bool (T::*)();
+
+private:
+    const char *name_;
+    T *target_;
+    Check check_;
+
+public:
+    BlockingCheck(const char *name, T *target, Check check) : name_(name), target_(target), check_(check) {
+    }
+
+public:
+    const char *name() const override {
+        return name_;
+    }
+
+    CheckStatus task() override {
+        return (target_->*check_)() ? CheckStatus::Passed : CheckStatus::Failed;
+    }
+
+    bool blocking() const override {
+        return true;
+    }
+
+};
+
+/**
+ * Polls every check in turn until they've all passed, failed or run past
+ * their timeouts. Checks are started in the order they were added, so slow
+ * ones that mostly wait should go first.
+ */
+class CheckRunner {
+public:
+    static constexpr size_t MaximumChecks = 16;
+
+private:
+    CheckTask *checks_[MaximumChecks];
+    size_t size_{ 0 };
+    uint32_t started_{ 0 };
+    uint32_t elapsed_{ 0 };
+
+public:
+    bool add(CheckTask &check);
+    void run(Leds &leds);
+    void log() const;
+
+};
+
+}
+
+#endif
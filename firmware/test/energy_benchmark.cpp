@@ -0,0 +1,87 @@
+#include "energy_benchmark.h"
+
+#if defined(FK_NATURALIST_ENERGY_BENCHMARK)
+
+namespace fk {
+
+constexpr const char LogName[] = "Energy";
+
+using Log = SimpleLog<LogName>;
+
+constexpr uint32_t BaselineDuration = 10 * 1000;
+
+constexpr float MicrosPerHour = 3600.0f * 1000000.0f;
+
+bool EnergyBenchmark::run(NaturalistReadings &readings, Leds &leds, uint32_t cycles) {
+    if (!gauge_.available()) {
+        Log::info("Gauge missing, no energy benchmark.");
+        return false;
+    }
+
+    readings.setup(&leds);
+
+    idle_ = baseline(BaselineDuration);
+
+    Log::info("Idle: %fmA, running %lu cycles...", idle_, cycles);
+
+    stageTimings.begin();
+    stageTimings.observer(this);
+
+    for (uint32_t i = 0; i < cycles; ++i) {
+        NaturalistValues values[NumberOfNaturalistBoards];
+
+        ScopedStageTimer timer{ NaturalistStage::Cycle };
+
+        // Every sensor every cycle, whatever the schedule says.
+        while (is_task_running(readings.read(values, true))) {
+        }
+    }
+
+    stageTimings.observer(nullptr);
+
+    log();
+
+    return true;
+}
+
+float EnergyBenchmark::baseline(uint32_t duration) {
+    auto before = gauge_.read();
+    delay(duration);
+    auto after = gauge_.read();
+    return (before.ma + after.ma) / 2.0f;
+}
+
+void EnergyBenchmark::started(NaturalistStage stage) {
+    started_[(size_t)stage] = gauge_.read();
+}
+
+void EnergyBenchmark::finished(NaturalistStage stage, uint32_t elapsed) {
+    auto &before = started_[(size_t)stage];
+    auto after = gauge_.read();
+    auto &s = stages_[(size_t)stage];
+    s.count++;
+    s.micros += elapsed;
+    s.counted += after.coulombs - before.coulombs;
+    s.integrated += (before.ma + after.ma) / 2.0f * (float)elapsed / MicrosPerHour;
+}
+
+void EnergyBenchmark::log() const {
+    Log::info("Energy per cycle (mAh), idle draw is %fmA:", idle_);
+    for (size_t i = 0; i < NumberOfNaturalistStages; ++i) {
+        auto &s = stages_[i];
+        if (s.count == 0) {
+            continue;
+        }
+        auto cycles = (float)stages_[(size_t)NaturalistStage::Cycle].count;
+        auto idle = idle_ * ((float)s.micros / MicrosPerHour);
+        Log::info("  %-10s n=%lu ms=%f counted=%f integrated=%f above-idle=%f",
+                  naturalist_stage_name((NaturalistStage)i), s.count,
+                  (float)s.micros / 1000.0f / cycles,
+                  s.counted / cycles, s.integrated / cycles,
+                  (s.integrated - idle) / cycles);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef ENERGY_BENCHMARK_H_INCLUDED
+#define ENERGY_BENCHMARK_H_INCLUDED
+
+#if defined(FK_NATURALIST_ENERGY_BENCHMARK)
+
+#if !defined(FK_NATURALIST_STAGE_TIMING)
+#error "FK_NATURALIST_ENERGY_BENCHMARK needs FK_NATURALIST_STAGE_TIMING"
+#endif
+
+#include <fk-core.h>
+#include <battery_gauge.h>
+
+#include "readings.h"
+
+#ifndef FK_NATURALIST_ENERGY_CYCLES
+#define FK_NATURALIST_ENERGY_CYCLES       20
+#endif
+
+namespace fk {
+
+struct StageEnergy {
+    uint32_t count{ 0 };
+    uint64_t micros{ 0 };
+    /* From the coulomb counter, in mAh. */
+    float counted{ 0.0f };
+    /* Mean of the currents at either end times the elapsed time, in mAh. */
+    float integrated{ 0.0f };
+};
+
+/**
+ * Runs the naturalist reading cycle back to back and brackets each stage
+ * with BatteryGauge snapshots. One LSB of the coulomb counter is far more
+ * than most stages draw, so the counted figures only mean something summed
+ * over many cycles and the integrated ones are there to compare against.
+ */
+class EnergyBenchmark : public StageObserver {
+private:
+    BatteryGauge gauge_;
+    BatteryReading started_[NumberOfNaturalistStages];
+    StageEnergy stages_[NumberOfNaturalistStages];
+    float idle_{ 0.0f };
+
+public:
+    const StageEnergy &stage(NaturalistStage stage) const {
+        return stages_[(size_t)stage];
+    }
+
+    float idle() const {
+        return idle_;
+    }
+
+public:
+    bool run(NaturalistReadings &readings, Leds &leds, uint32_t cycles);
+    void log() const;
+
+public:
+    void started(NaturalistStage stage) override;
+    void finished(NaturalistStage stage, uint32_t elapsed) override;
+
+private:
+    float baseline(uint32_t duration);
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,243 @@
+#include "flash_benchmark.h"
+
+#if defined(FK_NATURALIST_FLASH_BENCHMARK)
+
+#include <alogging/alogging.h>
+#include <SerialFlash.h>
+
+#include "hardware.h"
+
+namespace fk {
+
+constexpr const char LogName[] = "FlashBench";
+
+using Log = SimpleLog<LogName>;
+
+constexpr size_t MaximumPageSize = 512;
+constexpr size_t ReadSize = 512;
+constexpr size_t RandomReadSize = 32;
+constexpr size_t NumberOfRandomReads = 256;
+constexpr size_t NumberOfSectorErases = 16;
+
+const char *flash_operation_name(FlashOperation operation) {
+    switch (operation) {
+    case FlashOperation::Read: return "read";
+    case FlashOperation::BulkRead: return "bulk-read";
+    case FlashOperation::BulkFastRead: return "bulk-fast-read";
+    case FlashOperation::RandomRead: return "random-read";
+    case FlashOperation::BulkRandomRead: return "bulk-random-read";
+    case FlashOperation::Program: return "program";
+    case FlashOperation::BulkProgram: return "bulk-program";
+    case FlashOperation::SectorErase: return "sector-erase";
+    case FlashOperation::BlockErase: return "block-erase";
+    default: return "unknown";
+    }
+}
+
+static uint8_t pattern(uint32_t address) {
+    return (uint8_t)(address ^ (address >> 8) ^ (address >> 16));
+}
+
+bool FlashBenchmark::run() {
+    if (!SerialFlash.begin(Hardware::FLASH_PIN_CS)) {
+        Log::info("Flash unavailable.");
+        return false;
+    }
+
+    if (!bulk_.begin(Hardware::FLASH_PIN_CS)) {
+        Log::info("Unknown part, no bulk access.");
+        return false;
+    }
+
+    auto part = bulk_.part();
+    auto size = (FK_NATURALIST_FLASH_BENCHMARK_SIZE + part->blockSize - 1) / part->blockSize * part->blockSize;
+    FlashExtent free;
+    if (!flash_region(FlashRegion::Free, free) || free.size < size) {
+        Log::info("No room for the benchmark.");
+        return false;
+    }
+
+    auto end = free.end();
+    auto start = end - size;
+    auto middle = start + size / 2;
+
+    Log::info("%s page=%d sector=%lu block=%lu, 0x%lx-0x%lx", part->name, part->pageSize,
+              part->sectorSize, part->blockSize, start, end);
+
+    erase(FlashOperation::BlockErase, start, end, part->blockSize);
+
+    // Half the region each, so both are programming erased pages.
+    if (!program(FlashOperation::Program, start, middle)) {
+        return false;
+    }
+    if (!program(FlashOperation::BulkProgram, middle, end)) {
+        return false;
+    }
+
+    if (!read(FlashOperation::Read, start, end)) {
+        return false;
+    }
+
+    bulk_.fastRead(false);
+    if (!read(FlashOperation::BulkRead, start, end)) {
+        return false;
+    }
+
+    bulk_.fastRead(true);
+    if (!read(FlashOperation::BulkFastRead, start, end)) {
+        return false;
+    }
+
+    bulk_.fastRead(SerialFlashBulk::MaximumClock > part->readClock);
+
+    if (!random(FlashOperation::RandomRead, start, end)) {
+        return false;
+    }
+    if (!random(FlashOperation::BulkRandomRead, start, end)) {
+        return false;
+    }
+
+    if (part->sectorSize > 0) {
+        erase(FlashOperation::SectorErase, start, start + NumberOfSectorErases * part->sectorSize, part->sectorSize);
+    }
+
+    log();
+
+    return true;
+}
+
+bool FlashBenchmark::program(FlashOperation operation, uint32_t start, uint32_t end) {
+    auto &latency = operations_[(size_t)operation];
+    uint8_t buffer[MaximumPageSize];
+    // Byte program parts are timed 256 bytes at a time.
+    auto size = std::max((uint32_t)bulk_.part()->pageSize, (uint32_t)256);
+
+    for (auto address = start; address < end; address += size) {
+        for (uint32_t i = 0; i < size; ++i) {
+            buffer[i] = pattern(address + i);
+        }
+
+        auto started = micros();
+        if (operation == FlashOperation::Program) {
+            SerialFlash.write(address, buffer, size);
+            while (!SerialFlash.ready()) {
+            }
+        }
+        else {
+            bulk_.write(address, buffer, size);
+            bulk_.wait();
+        }
+        latency.add(micros() - started, size);
+    }
+
+    return true;
+}
+
+bool FlashBenchmark::read(FlashOperation operation, uint32_t start, uint32_t end) {
+    auto &latency = operations_[(size_t)operation];
+    uint8_t buffer[ReadSize];
+
+    for (auto address = start; address < end; address += sizeof(buffer)) {
+        auto started = micros();
+        if (operation == FlashOperation::Read) {
+            SerialFlash.read(address, buffer, sizeof(buffer));
+        }
+        else {
+            bulk_.read(address, buffer, sizeof(buffer));
+        }
+        latency.add(micros() - started, sizeof(buffer));
+
+        for (size_t i = 0; i < sizeof(buffer); ++i) {
+            if (buffer[i] != pattern(address + i)) {
+                Log::info("%s: mismatch at 0x%lx (0x%02x != 0x%02x)", flash_operation_name(operation),
+                          address + i, buffer[i], pattern(address + i));
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool FlashBenchmark::random(FlashOperation operation, uint32_t start, uint32_t end) {
+    auto &latency = operations_[(size_t)operation];
+    uint8_t buffer[RandomReadSize];
+    // Same addresses for both, so they're comparable.
+    uint32_t state = 0x2545F491;
+
+    for (size_t n = 0; n < NumberOfRandomReads; ++n) {
+        state = state * 1664525 + 1013904223;
+        auto address = start + (state >> 8) % (end - start - sizeof(buffer));
+
+        auto started = micros();
+        if (operation == FlashOperation::RandomRead) {
+            SerialFlash.read(address, buffer, sizeof(buffer));
+        }
+        else {
+            bulk_.read(address, buffer, sizeof(buffer));
+        }
+        latency.add(micros() - started, sizeof(buffer));
+
+        if (buffer[0] != pattern(address) || buffer[sizeof(buffer) - 1] != pattern(address + sizeof(buffer) - 1)) {
+            Log::info("%s: mismatch at 0x%lx", flash_operation_name(operation), address);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FlashBenchmark::erase(FlashOperation operation, uint32_t start, uint32_t end, uint32_t size) {
+    auto &latency = operations_[(size_t)operation];
+
+    for (auto address = start; address < end; address += size) {
+        auto started = micros();
+        if (operation == FlashOperation::BlockErase) {
+            SerialFlash.eraseBlock(address);
+            while (!SerialFlash.ready()) {
+            }
+        }
+        else {
+            bulk_.eraseSector(address);
+            bulk_.wait();
+        }
+        latency.add(micros() - started, size);
+    }
+}
+
+void FlashBenchmark::log() const {
+    for (size_t i = 0; i < NumberOfFlashOperations; ++i) {
+        auto &o = operations_[i];
+        if (o.count == 0) {
+            continue;
+        }
+
+        Log::info("%-16s n=%lu min=%luus mean=%luus max=%luus %.1fKB/s", flash_operation_name((FlashOperation)i),
+                  o.count, o.minimum, o.mean(), o.maximum, o.throughput());
+
+        char line[LatencyStats::NumberOfBuckets * 12 + 1];
+        o.histogram(line, sizeof(line));
+        Log::info("%-16s us>=%s", "", line);
+    }
+
+    auto read = operation(FlashOperation::Read).throughput();
+    auto bulk = operation(FlashOperation::BulkRead).throughput();
+    auto fast = operation(FlashOperation::BulkFastRead).throughput();
+    if (fast > bulk && fast > read) {
+        Log::info("Fastest reads: bulk with 0x0B");
+    }
+    else if (bulk > read) {
+        Log::info("Fastest reads: bulk with 0x03");
+    }
+    else {
+        Log::info("Fastest reads: SerialFlash");
+    }
+
+    auto programs = operation(FlashOperation::Program).throughput();
+    auto bulkPrograms = operation(FlashOperation::BulkProgram).throughput();
+    Log::info("Fastest programs: %s", bulkPrograms > programs ? "bulk" : "SerialFlash");
+}
+
+}
+
+#endif
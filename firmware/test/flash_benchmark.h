@@ -0,0 +1,70 @@
+#ifndef FLASH_BENCHMARK_H_INCLUDED
+#define FLASH_BENCHMARK_H_INCLUDED
+
+#if defined(FK_NATURALIST_FLASH_BENCHMARK)
+
+#include <Arduino.h>
+
+#include "serial_flash_bulk.h"
+#include "latency_stats.h"
+#include "flash_layout.h"
+
+/* Scratch, at the top of the Free region. Everything in here is erased. */
+#ifndef FK_NATURALIST_FLASH_BENCHMARK_SIZE
+#define FK_NATURALIST_FLASH_BENCHMARK_SIZE      (256 * 1024)
+#endif
+
+namespace fk {
+
+enum class FlashOperation {
+    Read,
+    BulkRead,
+    BulkFastRead,
+    RandomRead,
+    BulkRandomRead,
+    Program,
+    BulkProgram,
+    SectorErase,
+    BlockErase,
+};
+
+constexpr size_t NumberOfFlashOperations = (size_t)FlashOperation::BlockErase + 1;
+
+const char *flash_operation_name(FlashOperation operation);
+
+/**
+ * Times the ways we have of getting data in and out of SerialFlash over a
+ * scratch region: the library against SerialFlashBulk, sequential and random
+ * reads, page programs and both erase sizes. Program and erase latencies
+ * include waiting for the part to finish.
+ */
+class FlashBenchmark {
+private:
+    SerialFlashBulk bulk_;
+    LatencyStats operations_[NumberOfFlashOperations];
+
+public:
+    bool run();
+    void log() const;
+
+    const LatencyStats &operation(FlashOperation operation) const {
+        return operations_[(size_t)operation];
+    }
+
+    const FlashPart *part() const {
+        return bulk_.part();
+    }
+
+private:
+    bool program(FlashOperation operation, uint32_t start, uint32_t end);
+    bool read(FlashOperation operation, uint32_t start, uint32_t end);
+    bool random(FlashOperation operation, uint32_t start, uint32_t end);
+    void erase(FlashOperation operation, uint32_t start, uint32_t end, uint32_t size);
+
+};
+
+}
+
+#endif
+
+#endif
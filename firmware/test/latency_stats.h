@@ -0,0 +1,60 @@
+#ifndef LATENCY_STATS_H_INCLUDED
+#define LATENCY_STATS_H_INCLUDED
+
+#include <Arduino.h>
+
+namespace fk {
+
+/**
+ * Timings of a repeated operation in microseconds, and how many bytes it
+ * moved, for the benchmarks.
+ */
+struct LatencyStats {
+    static constexpr size_t NumberOfBuckets = 20;
+
+    uint32_t count{ 0 };
+    uint32_t minimum{ UINT32_MAX };
+    uint32_t maximum{ 0 };
+    uint64_t total{ 0 };
+    uint64_t bytes{ 0 };
+    /* Bucket n counts latencies in [2^n, 2^(n+1)) microseconds. */
+    uint16_t buckets[NumberOfBuckets] = { 0 };
+
+    void add(uint32_t elapsed, uint32_t size) {
+        count++;
+        total += elapsed;
+        bytes += size;
+        minimum = std::min(minimum, elapsed);
+        maximum = std::max(maximum, elapsed);
+
+        size_t bucket = 0;
+        while (bucket < NumberOfBuckets - 1 && (elapsed >> (bucket + 1)) > 0) {
+            bucket++;
+        }
+        buckets[bucket]++;
+    }
+
+    uint32_t mean() const {
+        return count == 0 ? 0 : (uint32_t)(total / count);
+    }
+
+    /* KB/s, 0 if nothing was timed. */
+    float throughput() const {
+        return total == 0 ? 0.0f : (bytes * 1000000.0f / 1024.0f) / total;
+    }
+
+    /* The buckets that have anything in them, as " 1024:3 2048:1" */
+    void histogram(char *buffer, size_t size) const {
+        auto position = (size_t)0;
+        buffer[0] = 0;
+        for (size_t b = 0; b < NumberOfBuckets && position < size; ++b) {
+            if (buckets[b] > 0) {
+                position += snprintf(buffer + position, size - position, " %lu:%d", (unsigned long)1 << b, buckets[b]);
+            }
+        }
+    }
+};
+
+}
+
+#endif
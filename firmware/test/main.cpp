@@ -2,6 +2,12 @@
 
 #include "check_naturalist.h"
 #include "board_definition.h"
+#include "ram_monitor.h"
+#include "energy_benchmark.h"
+#include "flash_benchmark.h"
+#include "soak_test.h"
+#include "calibration_provision.h"
+#include "modules.h"
 
 using namespace fk;
 
@@ -10,6 +16,8 @@ constexpr const char LogName[] = "Check";
 using Log = SimpleLog<LogName>;
 
 void setup() {
+    RamMonitor::paint();
+
     Serial5.begin(115200);
     Serial.begin(115200);
 
@@ -26,7 +34,18 @@ void setup() {
     CheckNaturalist check;
     check.setup();
 
-    if (!check.check()) {
+    auto passed = check.check();
+
+    #if defined(FK_NATURALIST_PROVISION)
+    if (passed) {
+        CalibrationProvision provision;
+        passed = provision.run();
+    }
+    #endif
+
+    RamMonitor::log("checked");
+
+    if (!passed) {
         check.leds().notifyFatal();
 
         while (true) {
@@ -37,6 +56,38 @@ void setup() {
 
     check.leds().notifyHappy();
 
+    #if defined(FK_NATURALIST_FLASH_BENCHMARK)
+    {
+        FlashBenchmark benchmark;
+        benchmark.run();
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_ENERGY_BENCHMARK)
+    {
+        // Too big for the stack.
+        static NaturalistReadings readings;
+        EnergyBenchmark benchmark;
+        benchmark.run(readings, check.leds(), FK_NATURALIST_ENERGY_CYCLES);
+    }
+    #endif
+
+    #if defined(FK_NATURALIST_SOAK)
+    {
+        // Modules and services as the core sets them up, so the cycles merge.
+        static CoreState state;
+        naturalist_configure(state);
+
+        static MainServices services{ &check.leds(), &state };
+        MainServicesState::services(&services);
+
+        // Too big for the stack.
+        static TakeNaturalistReadings take;
+        SoakTest soak;
+        soak.run(take, FK_NATURALIST_SOAK_HOURS);
+    }
+    #endif
+
     while (true) {
         check.task();
         delay(10);
@@ -0,0 +1,134 @@
+#include "sd_benchmark.h"
+
+#if defined(FK_NATURALIST_SD_BENCHMARK)
+
+namespace fk {
+
+constexpr const char LogName[] = "SdBench";
+
+using Log = SimpleLog<LogName>;
+
+constexpr size_t SectorSize = 512;
+constexpr uint32_t AppendSize = 48;
+constexpr uint32_t MaximumAppends = 256;
+
+const char *sd_operation_name(SdOperation operation) {
+    switch (operation) {
+    case SdOperation::Write: return "write";
+    case SdOperation::Read: return "read";
+    case SdOperation::Append: return "append";
+    case SdOperation::Erase: return "erase";
+    default: return "unknown";
+    }
+}
+
+static uint8_t pattern(uint32_t block, uint32_t position) {
+    return (uint8_t)(block ^ position ^ (position >> 8));
+}
+
+bool SdBenchmark::run(phylum::ArduinoSdBackend &storage) {
+    auto &g = storage.geometry();
+    auto blockSize = (uint32_t)g.pages_per_block * g.sectors_per_page * g.sector_size;
+    if (g.number_of_blocks <= FK_NATURALIST_SD_BENCHMARK_BLOCKS || blockSize < SectorSize) {
+        Log::info("Card too small to benchmark.");
+        return false;
+    }
+
+    auto first = (phylum::block_index_t)(g.number_of_blocks - FK_NATURALIST_SD_BENCHMARK_BLOCKS);
+    auto last = g.number_of_blocks;
+    uint8_t buffer[SectorSize];
+
+    Log::info("Blocks %lu-%lu (%lu bytes each)", (uint32_t)first, (uint32_t)last - 1, blockSize);
+
+    for (auto block = first; block < last; ++block) {
+        auto started = micros();
+        if (!storage.erase(block)) {
+            Log::info("Erase failed (%lu)", (uint32_t)block);
+            return false;
+        }
+        operations_[(size_t)SdOperation::Erase].add(micros() - started, blockSize);
+    }
+
+    // The last block is kept for appends.
+    for (auto block = first; block < last - 1; ++block) {
+        for (uint32_t position = 0; position < blockSize; position += sizeof(buffer)) {
+            for (size_t i = 0; i < sizeof(buffer); ++i) {
+                buffer[i] = pattern(block, position + i);
+            }
+
+            auto started = micros();
+            if (!storage.write(phylum::BlockAddress{ block, position }, buffer, sizeof(buffer))) {
+                Log::info("Write failed (%lu, %lu)", (uint32_t)block, position);
+                return false;
+            }
+            operations_[(size_t)SdOperation::Write].add(micros() - started, sizeof(buffer));
+        }
+    }
+
+    for (auto block = first; block < last - 1; ++block) {
+        for (uint32_t position = 0; position < blockSize; position += sizeof(buffer)) {
+            auto started = micros();
+            if (!storage.read(phylum::BlockAddress{ block, position }, buffer, sizeof(buffer))) {
+                Log::info("Read failed (%lu, %lu)", (uint32_t)block, position);
+                return false;
+            }
+            operations_[(size_t)SdOperation::Read].add(micros() - started, sizeof(buffer));
+
+            for (size_t i = 0; i < sizeof(buffer); ++i) {
+                if (buffer[i] != pattern(block, position + i)) {
+                    Log::info("Mismatch (%lu, %lu)", (uint32_t)block, position + i);
+                    return false;
+                }
+            }
+        }
+    }
+
+    auto appends = std::min(blockSize / AppendSize, MaximumAppends);
+    for (uint32_t n = 0; n < appends; ++n) {
+        auto position = n * AppendSize;
+        for (uint32_t i = 0; i < AppendSize; ++i) {
+            buffer[i] = pattern(last - 1, position + i);
+        }
+
+        auto started = micros();
+        if (!storage.write(phylum::BlockAddress{ last - 1, position }, buffer, AppendSize)) {
+            Log::info("Append failed (%lu)", position);
+            return false;
+        }
+        operations_[(size_t)SdOperation::Append].add(micros() - started, AppendSize);
+    }
+
+    log();
+
+    return passed();
+}
+
+bool SdBenchmark::passed() const {
+    return writeThroughput() >= FK_NATURALIST_SD_MINIMUM_WRITE && worstLatency() <= FK_NATURALIST_SD_MAXIMUM_LATENCY;
+}
+
+void SdBenchmark::log() const {
+    for (size_t i = 0; i < NumberOfSdOperations; ++i) {
+        auto &o = operations_[i];
+        if (o.count == 0) {
+            continue;
+        }
+
+        char line[LatencyStats::NumberOfBuckets * 12 + 1];
+        o.histogram(line, sizeof(line));
+        Log::info("%-8s n=%lu min=%luus mean=%luus max=%luus %.1fKB/s", sd_operation_name((SdOperation)i),
+                  o.count, o.minimum, o.mean(), o.maximum, o.throughput());
+        Log::info("%-8s us>=%s", "", line);
+    }
+
+    if (writeThroughput() < FK_NATURALIST_SD_MINIMUM_WRITE) {
+        Log::info("Writes too slow: %.1fKB/s < %dKB/s", writeThroughput(), FK_NATURALIST_SD_MINIMUM_WRITE);
+    }
+    if (worstLatency() > FK_NATURALIST_SD_MAXIMUM_LATENCY) {
+        Log::info("Writes stall: %lums > %dms", worstLatency(), FK_NATURALIST_SD_MAXIMUM_LATENCY);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SD_BENCHMARK_H_INCLUDED
+#define SD_BENCHMARK_H_INCLUDED
+
+#if defined(FK_NATURALIST_SD_BENCHMARK)
+
+#include <fk-core.h>
+
+#include "latency_stats.h"
+
+/* Scratch blocks at the end of the card, these are overwritten. */
+#ifndef FK_NATURALIST_SD_BENCHMARK_BLOCKS
+#define FK_NATURALIST_SD_BENCHMARK_BLOCKS       8
+#endif
+
+/* Cards slower than this at sustained writes fail, in KB/s. */
+#ifndef FK_NATURALIST_SD_MINIMUM_WRITE
+#define FK_NATURALIST_SD_MINIMUM_WRITE          200
+#endif
+
+/* As do cards that ever take longer than this for one write, in ms. */
+#ifndef FK_NATURALIST_SD_MAXIMUM_LATENCY
+#define FK_NATURALIST_SD_MAXIMUM_LATENCY        250
+#endif
+
+namespace fk {
+
+enum class SdOperation {
+    Write,
+    Read,
+    Append,
+    Erase,
+};
+
+constexpr size_t NumberOfSdOperations = (size_t)SdOperation::Erase + 1;
+
+const char *sd_operation_name(SdOperation operation);
+
+/**
+ * Sustained sector writes and reads, and small appends like the ones our
+ * readings make, through the phylum backend. A card passes when it keeps up
+ * FK_NATURALIST_SD_MINIMUM_WRITE and never stalls past
+ * FK_NATURALIST_SD_MAXIMUM_LATENCY.
+ */
+class SdBenchmark {
+private:
+    LatencyStats operations_[NumberOfSdOperations];
+
+public:
+    bool run(phylum::ArduinoSdBackend &storage);
+    void log() const;
+
+    const LatencyStats &operation(SdOperation operation) const {
+        return operations_[(size_t)operation];
+    }
+
+    /* KB/s, of sequential writes. */
+    float writeThroughput() const {
+        return operation(SdOperation::Write).throughput();
+    }
+
+    /* Worst write of either kind, in ms. */
+    uint32_t worstLatency() const {
+        return std::max(operation(SdOperation::Write).maximum, operation(SdOperation::Append).maximum) / 1000;
+    }
+
+    bool passed() const;
+
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+#include <cstdarg>
+#include <cstring>
+
+#include "soak_test.h"
+
+#if defined(FK_NATURALIST_SOAK)
+
+namespace fk {
+
+constexpr const char LogName[] = "Soak";
+
+using Log = SimpleLog<LogName>;
+
+constexpr uint32_t Interval = FK_NATURALIST_SOAK_INTERVAL * 1000;
+constexpr uint32_t SummaryInterval = FK_NATURALIST_SOAK_SUMMARY * 60 * 1000;
+
+static size_t append(char *buffer, size_t size, size_t position, const char *f, ...) {
+    if (position >= size) {
+        return position;
+    }
+    va_list args;
+    va_start(args, f);
+    auto n = vsnprintf(buffer + position, size - position, f, args);
+    va_end(args);
+    return n < 0 ? position : std::min(size - 1, position + n);
+}
+
+bool SoakTest::run(TakeNaturalistReadings &take, uint32_t hours) {
+    auto &readings = take.readings();
+
+    take.setup();
+
+    haveGauge_ = gauge_.available();
+    if (!haveGauge_) {
+        Log::info("Gauge missing, no battery drain.");
+    }
+
+    if (!open()) {
+        Log::info("No card, summaries are only logged.");
+    }
+
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            failuresBefore_[i] += readings.health(b).health((NaturalistSensor)i).failures;
+        }
+    }
+    audioBefore_ = readings.audioSamples();
+    droppedBefore_ = readings.droppedSamples();
+
+    Log::info("Soaking for %luh, a cycle every %lus...", hours, (uint32_t)FK_NATURALIST_SOAK_INTERVAL);
+
+    auto duration = hours * 3600 * 1000;
+    started_ = fk_uptime();
+    auto scheduled = started_;
+    auto summarizeAt = started_ + SummaryInterval;
+
+    while (fk_uptime() - started_ < duration) {
+        auto now = fk_uptime();
+        if ((int32_t)(scheduled - now) > 0) {
+            delay(scheduled - now);
+        }
+        lateness_.add(fk_uptime() - scheduled, 0);
+
+        for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+            for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+                auto &h = readings.health(b).health((NaturalistSensor)i);
+                if (h.enabled && !h.available) {
+                    sensors_[i].offline++;
+                    break;
+                }
+            }
+        }
+
+        // The whole wake, bursts, uplink and upload included.
+        auto began = micros();
+        take.run();
+        auto elapsed = micros() - began;
+
+        cycle(readings, elapsed);
+
+        // An overrun starts the next one as soon as it can, and the rest
+        // keep to the new slot rather than trying to catch up.
+        scheduled += Interval;
+        if ((int32_t)(fk_uptime() - scheduled) > 0) {
+            overruns_++;
+            scheduled = fk_uptime();
+        }
+
+        if ((int32_t)(fk_uptime() - summarizeAt) >= 0) {
+            summarize();
+            summarizeAt += SummaryInterval;
+        }
+    }
+
+    if (summarized_ != cycles_) {
+        summarize();
+    }
+
+    return cycles_ > 0;
+}
+
+void SoakTest::cycle(const NaturalistReadings &readings, uint32_t elapsed) {
+    cycles_++;
+    durations_.add(elapsed / 1000, 0);
+
+    // Welford's, a sum of squares in floats is useless after a few hours.
+    auto ms = elapsed / 1000.0f;
+    auto delta = ms - mean_;
+    mean_ += delta / cycles_;
+    m2_ += delta * (ms - mean_);
+
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        uint32_t failures = 0;
+        for (size_t b = 0; b < NumberOfNaturalistBoards; ++b) {
+            failures += readings.health(b).health((NaturalistSensor)i).failures;
+        }
+        sensors_[i].failures = failures - failuresBefore_[i];
+    }
+    audioSamples_ = readings.audioSamples() - audioBefore_;
+    droppedSamples_ = readings.droppedSamples() - droppedBefore_;
+
+    lastRam_ = RamMonitor::usage();
+    if (cycles_ == 1) {
+        firstRam_ = lastRam_;
+    }
+    heapPeak_ = std::max(heapPeak_, lastRam_.heapInUse);
+
+    if (haveGauge_) {
+        lastBattery_ = gauge_.read();
+        if (cycles_ == 1) {
+            firstBattery_ = lastBattery_;
+        }
+    }
+
+    elapsed_ = fk_uptime() - started_;
+}
+
+void SoakTest::summarize() {
+    char buffer[SummarySize] = { 0 };
+    summary(buffer, sizeof(buffer));
+
+    summaries_++;
+    summarized_ = cycles_;
+
+    log();
+
+    if (write(buffer)) {
+        written_++;
+    }
+}
+
+void SoakTest::summary(char *buffer, size_t size) const {
+    char histogram[LatencyStats::NumberOfBuckets * 12 + 1];
+    auto hours = std::max(elapsed(), 1.0f / 60.0f);
+    size_t p = 0;
+
+    p = append(buffer, size, p, "soak %.2fh: %lu cycles, %lu overran\n", elapsed(), cycles_, overruns_);
+
+    durations_.histogram(histogram, sizeof(histogram));
+    p = append(buffer, size, p, "cycle: min=%lums mean=%.1fms max=%lums sd=%.1fms\n", durations_.minimum, mean_,
+               durations_.maximum, jitter());
+    p = append(buffer, size, p, "cycle ms>=%s\n", histogram);
+
+    lateness_.histogram(histogram, sizeof(histogram));
+    p = append(buffer, size, p, "late: mean=%lums max=%lums ms>=%s\n", lateness_.mean(), lateness_.maximum,
+               histogram);
+
+    // Failures and cycles offline, per sensor.
+    p = append(buffer, size, p, "sensors:");
+    for (size_t i = 0; i < NumberOfNaturalistSensors; ++i) {
+        p = append(buffer, size, p, " %s=%lu/%lu", naturalist_sensor_name((NaturalistSensor)i), sensors_[i].failures,
+                   sensors_[i].offline);
+    }
+    p = append(buffer, size, p, "\n");
+
+    p = append(buffer, size, p, "audio: %lu blocks, %lu dropped (%.3f%%)\n", audioSamples_, droppedSamples_,
+               audioSamples_ == 0 ? 0.0f : 100.0f * droppedSamples_ / audioSamples_);
+
+    p = append(buffer, size, p, "ram: stack=%lu (%+ld) heap=%lu (%+ld) peak=%lu\n", lastRam_.stackHighWater,
+               (int32_t)(lastRam_.stackHighWater - firstRam_.stackHighWater), lastRam_.heapInUse,
+               (int32_t)(lastRam_.heapInUse - firstRam_.heapInUse), heapPeak_);
+
+    if (haveGauge_) {
+        p = append(buffer, size, p, "battery: %.3fmAh (%.3fmAh/h) %.0fmV (%.1fmV/h)\n", used(), used() / hours,
+                   lastBattery_.voltage, -voltageDrop() / hours);
+    }
+}
+
+void SoakTest::log() const {
+    char buffer[SummarySize];
+    summary(buffer, sizeof(buffer));
+
+    auto line = buffer;
+    while (*line != 0) {
+        auto end = strchr(line, '\n');
+        auto length = end == nullptr ? strlen(line) : (size_t)(end - line);
+        Log::info("%.*s", (int32_t)length, line);
+        if (end == nullptr) {
+            break;
+        }
+        line = end + 1;
+    }
+}
+
+bool SoakTest::open() {
+    phylum::Geometry g;
+    if (!storage_.initialize(g, Hardware::SD_PIN_CS) || !storage_.open()) {
+        digitalWrite(Hardware::SD_PIN_CS, HIGH);
+        return false;
+    }
+
+    auto &geometry = storage_.geometry();
+    auto blockSize = (uint32_t)geometry.pages_per_block * geometry.sectors_per_page * geometry.sector_size;
+    if (geometry.number_of_blocks <= FK_NATURALIST_SD_BENCHMARK_BLOCKS + FK_NATURALIST_SOAK_BLOCKS ||
+        blockSize < SummarySize) {
+        digitalWrite(Hardware::SD_PIN_CS, HIGH);
+        return false;
+    }
+
+    first_ = (phylum::block_index_t)(geometry.number_of_blocks - FK_NATURALIST_SD_BENCHMARK_BLOCKS -
+                                     FK_NATURALIST_SOAK_BLOCKS);
+    haveSd_ = true;
+
+    digitalWrite(Hardware::SD_PIN_CS, HIGH);
+
+    Log::info("Summaries to blocks %lu-%lu", (uint32_t)first_, (uint32_t)first_ + FK_NATURALIST_SOAK_BLOCKS - 1);
+
+    return true;
+}
+
+bool SoakTest::write(const char *summary) {
+    if (!haveSd_) {
+        return false;
+    }
+
+    auto &g = storage_.geometry();
+    auto perBlock = (uint32_t)g.pages_per_block * g.sectors_per_page * g.sector_size / SummarySize;
+    // summaries_ counts this one already.
+    auto index = (summaries_ - 1) % (perBlock * FK_NATURALIST_SOAK_BLOCKS);
+    auto block = (phylum::block_index_t)(first_ + index / perBlock);
+    auto position = (uint32_t)((index % perBlock) * SummarySize);
+
+    auto success = (position > 0 || storage_.erase(block)) &&
+                   storage_.write(phylum::BlockAddress{ block, position }, (void *)summary, SummarySize);
+
+    digitalWrite(Hardware::SD_PIN_CS, HIGH);
+
+    if (!success) {
+        Log::info("Write failed (%lu, %lu)", (uint32_t)block, position);
+    }
+
+    return success;
+}
+
+}
+
+#endif
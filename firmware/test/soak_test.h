@@ -0,0 +1,191 @@
+#ifndef SOAK_TEST_H_INCLUDED
+#define SOAK_TEST_H_INCLUDED
+
+#if defined(FK_NATURALIST_SOAK)
+
+#include <math.h>
+
+#include <fk-core.h>
+#include <battery_gauge.h>
+
+#include "readings.h"
+#include "ram_monitor.h"
+#include "latency_stats.h"
+#include "sd_benchmark.h"
+
+#ifndef FK_NATURALIST_SOAK_HOURS
+#define FK_NATURALIST_SOAK_HOURS          24
+#endif
+
+/* From the start of one cycle to the start of the next, in seconds. */
+#ifndef FK_NATURALIST_SOAK_INTERVAL
+#define FK_NATURALIST_SOAK_INTERVAL       60
+#endif
+
+/* Between summaries, in minutes. */
+#ifndef FK_NATURALIST_SOAK_SUMMARY
+#define FK_NATURALIST_SOAK_SUMMARY        60
+#endif
+
+/* Blocks of the card for the summaries, these are overwritten. */
+#ifndef FK_NATURALIST_SOAK_BLOCKS
+#define FK_NATURALIST_SOAK_BLOCKS         4
+#endif
+
+/* The summaries go just before these, whether or not the benchmark's built. */
+#ifndef FK_NATURALIST_SD_BENCHMARK_BLOCKS
+#define FK_NATURALIST_SD_BENCHMARK_BLOCKS 8
+#endif
+
+namespace fk {
+
+struct SoakSensor {
+    /* Failures counted by the boards' supervisors during the soak. */
+    uint32_t failures{ 0 };
+    /* Cycles that began with it offline on any board. */
+    uint32_t offline{ 0 };
+};
+
+/**
+ * Runs the naturalist reading cycle on a fixed schedule for hours and keeps
+ * what only shows up over that long: how much the cycle time and its start
+ * wander, how often sensors fail and audio blocks come back empty, whether
+ * the stack and heap creep up and how fast the battery goes down.
+ *
+ * Every FK_NATURALIST_SOAK_SUMMARY minutes, and at the end, a summary is
+ * logged and written as one sector to FK_NATURALIST_SOAK_BLOCKS blocks near
+ * the end of the card, going round when they're full.
+ */
+class SoakTest {
+public:
+    static constexpr size_t SummarySize = 512;
+
+private:
+    BatteryGauge gauge_;
+    bool haveGauge_{ false };
+    BatteryReading firstBattery_{};
+    BatteryReading lastBattery_{};
+    RamUsage firstRam_;
+    RamUsage lastRam_;
+    uint32_t heapPeak_{ 0 };
+    phylum::ArduinoSdBackend storage_;
+    bool haveSd_{ false };
+    phylum::block_index_t first_{ 0 };
+    LatencyStats durations_;
+    LatencyStats lateness_;
+    /* Running mean and sum of squared differences of the cycle times, in ms. */
+    float mean_{ 0.0f };
+    float m2_{ 0.0f };
+    uint32_t cycles_{ 0 };
+    uint32_t overruns_{ 0 };
+    SoakSensor sensors_[NumberOfNaturalistSensors];
+    uint32_t failuresBefore_[NumberOfNaturalistSensors] = { 0 };
+    uint32_t audioSamples_{ 0 };
+    uint32_t droppedSamples_{ 0 };
+    uint32_t audioBefore_{ 0 };
+    uint32_t droppedBefore_{ 0 };
+    uint32_t started_{ 0 };
+    uint32_t elapsed_{ 0 };
+    uint32_t summaries_{ 0 };
+    uint32_t summarized_{ 0 };
+    uint32_t written_{ 0 };
+
+public:
+    /**
+     * MainServicesState's services should have the CoreState, configured
+     * with naturalist_configure() as ConfigureDevice does, so each cycle is
+     * a whole TakeNaturalistReadings wake, merge and all.
+     */
+    bool run(TakeNaturalistReadings &take, uint32_t hours);
+
+    /* The summary as text, a line per statistic. */
+    void summary(char *buffer, size_t size) const;
+    void log() const;
+
+public:
+    uint32_t cycles() const {
+        return cycles_;
+    }
+
+    /* Cycles that took longer than the interval, and pushed the next back. */
+    uint32_t overruns() const {
+        return overruns_;
+    }
+
+    /* How long each cycle took. These are in ms, cycles are too long for the buckets in us. */
+    const LatencyStats &durations() const {
+        return durations_;
+    }
+
+    /* How far after its slot each cycle began, in ms. */
+    const LatencyStats &lateness() const {
+        return lateness_;
+    }
+
+    /* Standard deviation of the cycle times, in ms. */
+    float jitter() const {
+        return cycles_ > 1 ? sqrtf(m2_ / (cycles_ - 1)) : 0.0f;
+    }
+
+    const SoakSensor &sensor(NaturalistSensor sensor) const {
+        return sensors_[(size_t)sensor];
+    }
+
+    uint32_t audioSamples() const {
+        return audioSamples_;
+    }
+
+    uint32_t droppedSamples() const {
+        return droppedSamples_;
+    }
+
+    /* From after the first cycle, once everything's allocated. */
+    const RamUsage &firstRam() const {
+        return firstRam_;
+    }
+
+    const RamUsage &lastRam() const {
+        return lastRam_;
+    }
+
+    uint32_t heapPeak() const {
+        return heapPeak_;
+    }
+
+    /* Charge used so far, in mAh, 0 without a gauge. */
+    float used() const {
+        return haveGauge_ ? lastBattery_.coulombs - firstBattery_.coulombs : 0.0f;
+    }
+
+    /* In mV, 0 without a gauge. */
+    float voltageDrop() const {
+        return haveGauge_ ? firstBattery_.voltage - lastBattery_.voltage : 0.0f;
+    }
+
+    /* In hours. */
+    float elapsed() const {
+        return elapsed_ / (3600.0f * 1000.0f);
+    }
+
+    uint32_t summaries() const {
+        return summaries_;
+    }
+
+    /* Summaries that made it to the card. */
+    uint32_t written() const {
+        return written_;
+    }
+
+private:
+    bool open();
+    void cycle(const NaturalistReadings &readings, uint32_t elapsed);
+    void summarize();
+    bool write(const char *summary);
+
+};
+
+}
+
+#endif
+
+#endif
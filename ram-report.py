@@ -0,0 +1,99 @@
+#!/usr/bin/python
+
+# Static RAM (.data and .bss) per object file or library, from the symbols
+# in the firmware ELF. Needs a build with debug information for nm -l. With
+# a budget, exits non-zero if the total or any listed group is over, eg:
+#
+#   ./ram-report.py build/firmware/main/fk-naturalist-standard.elf --budget ram-budget
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+RAM_TYPES = "bBdD"
+
+def group_of(path):
+    if path is None:
+        return "(unknown)"
+    m = re.search(r"/gitdeps/([^/]+)/", path)
+    if m:
+        return m.group(1)
+    m = re.search(r"/(firmware/[^/]+/[^/:]+)", path)
+    if m:
+        return m.group(1)
+    m = re.search(r"/libraries/([^/]+)/", path)
+    if m:
+        return m.group(1)
+    if "/cores/arduino/" in path:
+        return "arduino-core"
+    if "/variants/" in path:
+        return "arduino-variant"
+    return os.path.basename(path)
+
+def read_symbols(nm, elf):
+    output = subprocess.check_output([nm, "-C", "-S", "-l", "--size-sort", elf])
+    if not isinstance(output, str):
+        output = output.decode("utf-8", "replace")
+    for line in output.splitlines():
+        location = None
+        if "\t" in line:
+            line, location = line.split("\t", 1)
+            location = location.rsplit(":", 1)[0]
+        fields = line.split(" ", 3)
+        if len(fields) != 4 or fields[2] not in RAM_TYPES:
+            continue
+        yield fields[3], int(fields[1], 16), location
+
+def read_budget(path):
+    budget = {}
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if line:
+                name, size = line.rsplit(None, 1)
+                budget[name] = int(size, 0)
+    return budget
+
+def main():
+    parser = argparse.ArgumentParser(description="Static RAM per object file or library.")
+    parser.add_argument("elf")
+    parser.add_argument("--nm", default=os.environ.get("NM", "arm-none-eabi-nm"))
+    parser.add_argument("--budget", help="file of 'group bytes' lines, 'total' for everything")
+    parser.add_argument("--symbols", type=int, default=0, help="also list the N largest symbols")
+    args = parser.parse_args()
+
+    groups = {}
+    symbols = []
+    total = 0
+    for name, size, location in read_symbols(args.nm, args.elf):
+        group = group_of(location)
+        groups[group] = groups.get(group, 0) + size
+        symbols.append((size, name, group))
+        total += size
+
+    for group, size in sorted(groups.items(), key=lambda g: -g[1]):
+        print("%8d  %s" % (size, group))
+    print("%8d  total" % total)
+
+    if args.symbols > 0:
+        print()
+        for size, name, group in sorted(symbols, reverse=True)[:args.symbols]:
+            print("%8d  %s (%s)" % (size, name, group))
+
+    if args.budget:
+        groups["total"] = total
+        over = False
+        for name, limit in sorted(read_budget(args.budget).items()):
+            used = groups.get(name, 0)
+            if used > limit:
+                print("over budget: %s uses %d of %d bytes" % (name, used, limit), file=sys.stderr)
+                over = True
+        if over:
+            sys.exit(1)
+
+if __name__ == "__main__":
+    main()
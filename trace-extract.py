@@ -0,0 +1,33 @@
+#!/usr/bin/python
+
+# Rebuilds a binary trace from the "dump" lines logged by firmware built with
+# FK_NATURALIST_TRACE_CAPTURE and FK_NATURALIST_TRACE_DUMP, for example:
+#
+#   ./tail-device /dev/ttyACM0 | ./trace-extract.py site.trace
+#   build-host/replay-naturalist site.trace
+
+import re
+import sys
+
+if len(sys.argv) != 2:
+    sys.stderr.write("usage: %s TRACE < log\n" % sys.argv[0])
+    sys.exit(2)
+
+pattern = re.compile(r"dump ([0-9a-f]{8}) ([0-9a-f]+)")
+chunks = {}
+for line in sys.stdin:
+    m = pattern.search(line)
+    if m:
+        chunks[int(m.group(1), 16)] = bytearray.fromhex(m.group(2))
+
+data = bytearray()
+for offset in sorted(chunks.keys()):
+    if offset != len(data):
+        sys.stderr.write("gap at %08x, stopping\n" % len(data))
+        break
+    data += chunks[offset]
+
+with open(sys.argv[1], "wb") as f:
+    f.write(data)
+
+sys.stderr.write("%d bytes\n" % len(data))